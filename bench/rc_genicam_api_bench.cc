@@ -0,0 +1,989 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rc_genicam_api/image.h>
+#include <rc_genicam_api/image_store.h>
+#include <rc_genicam_api/image_codec.h>
+#include <rc_genicam_api/image_pyramid.h>
+#include <rc_genicam_api/recording.h>
+#include <rc_genicam_api/pointcloud.h>
+#include <rc_genicam_api/project_version.h>
+
+#include <rc_genicam_api/pixel_formats.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+namespace
+{
+
+/*
+  Print help text on standard output.
+*/
+
+void printHelp(const char *prgname)
+{
+  // show help
+
+  std::cout << prgname << " -h | [-f json|csv] [-o <file>] [-d <dir>] [-s <w>x<h>,...] [-n <n>] [-t <s>] [-b <name>]" << std::endl;
+  std::cout << std::endl;
+  std::cout << "Measures the time of image conversion and storage functions on deterministic synthetic images and prints the results in a machine readable format." << std::endl;
+  std::cout << std::endl;
+  std::cout << "Options:" << std::endl;
+  std::cout << "-h              Prints help information and exits" << std::endl;
+  std::cout << "-f json|csv     Output format. Default is json" << std::endl;
+  std::cout << "-o <file>       Output file. Default is standard output" << std::endl;
+  std::cout << "-d <dir>        Directory for temporary files of storage functions. Default is '.'" << std::endl;
+  std::cout << "-s <w>x<h>,...  Comma separated list of image sizes. Default is 640x480,1280x960" << std::endl;
+  std::cout << "-n <n>          Minimum number of iterations per benchmark. Default is 3" << std::endl;
+  std::cout << "-t <s>          Minimum time in seconds per benchmark. Default is 0.5" << std::endl;
+  std::cout << "-b <name>       Only run benchmarks with the given string in their name" << std::endl;
+}
+
+/*
+  Simple deterministic random number generator, so that the synthetic images
+  are the same on all platforms.
+*/
+
+class Random
+{
+  public:
+
+    Random() : state(0x2545f4914f6cdd1dULL) { }
+
+    uint32_t next()
+    {
+      state^=state<<13;
+      state^=state>>7;
+      state^=state<<17;
+
+      return static_cast<uint32_t>(state>>32);
+    }
+
+  private:
+
+    uint64_t state;
+};
+
+/*
+  Returns the name of the pixel format.
+*/
+
+std::string getFormatName(uint64_t format)
+{
+  if (format == Error8)
+  {
+    return "Error8";
+  }
+
+  return GetPixelFormatName(static_cast<PfncFormat>(format));
+}
+
+/*
+  Creates an image of the given format with a smooth pattern and some noise,
+  which is more representative for compression than pure noise.
+*/
+
+std::shared_ptr<const rcg::Image> createImage(uint64_t format, size_t width, size_t height)
+{
+  Random rnd;
+
+  const size_t bits=static_cast<size_t>((format>>16)&0xff);
+  const size_t lstep=(width*bits+7)/8;
+
+  std::vector<uint8_t> pixel(lstep*height);
+
+  uint8_t *p=pixel.data();
+  for (size_t k=0; k<height; k++)
+  {
+    for (size_t i=0; i<lstep; i++)
+    {
+      *p++=static_cast<uint8_t>(((i+2*k)>>1)+(rnd.next()&0x7));
+    }
+  }
+
+  return std::make_shared<rcg::Image>(pixel.data(), width, height, 0, format);
+}
+
+/*
+  Creates a little endian disparity image in Coord3D_C16 format, with a
+  scale of 1/16 of a pixel, that shows a slanted plane with an invalid left
+  border and some invalid pixels.
+*/
+
+std::shared_ptr<const rcg::Image> createDisparity(size_t width, size_t height)
+{
+  Random rnd;
+
+  std::vector<uint8_t> pixel(2*width*height);
+
+  const double dmax=0.1*width;
+  const size_t border=static_cast<size_t>(std::ceil(dmax));
+
+  uint8_t *p=pixel.data();
+  for (size_t k=0; k<height; k++)
+  {
+    for (size_t i=0; i<width; i++)
+    {
+      uint16_t v=0;
+
+      if (i >= border && (rnd.next()&0x1f) != 0)
+      {
+        const double d=dmax*(0.5+0.3*i/width+0.2*k/height);
+        v=static_cast<uint16_t>(16*d+0.5);
+      }
+
+      *p++=static_cast<uint8_t>(v&0xff);
+      *p++=static_cast<uint8_t>(v>>8);
+    }
+  }
+
+  return std::make_shared<rcg::Image>(pixel.data(), width, height, 0, Coord3D_C16);
+}
+
+/*
+  Creates a confidence or error image in the given format.
+*/
+
+std::shared_ptr<const rcg::Image> createConfErr(uint64_t format, size_t width, size_t height)
+{
+  Random rnd;
+
+  std::vector<uint8_t> pixel(width*height);
+
+  for (size_t i=0; i<pixel.size(); i++)
+  {
+    if (format == Error8)
+    {
+      pixel[i]=static_cast<uint8_t>(rnd.next()&0x3);
+    }
+    else
+    {
+      pixel[i]=static_cast<uint8_t>(128+(rnd.next()&0x7f));
+    }
+  }
+
+  return std::make_shared<rcg::Image>(pixel.data(), width, height, 0, format);
+}
+
+/*
+  Results of one benchmark.
+*/
+
+struct Result
+{
+  std::string name;
+  std::string variant;
+  std::string format;
+  size_t width;
+  size_t height;
+  size_t iterations;
+  double min_ms;
+  double median_ms;
+  double mean_ms;
+  double mpixel_per_s;
+  size_t bytes;
+};
+
+/*
+  Settings and collected results of all benchmarks.
+*/
+
+struct Bench
+{
+  std::string dir;
+  std::string filter;
+  size_t min_iterations;
+  double min_time;
+
+  std::vector<Result> result;
+};
+
+/*
+  Used for preventing the compiler from optimizing computations away.
+*/
+
+volatile uint32_t sink=0;
+
+void consume(const uint8_t *p, size_t n)
+{
+  uint32_t s=0;
+  for (size_t i=0; i<n; i+=64)
+  {
+    s+=p[i];
+  }
+
+  sink+=s;
+}
+
+/*
+  Returns the size of the given file and removes it.
+*/
+
+size_t removeFile(const std::string &name)
+{
+  size_t ret=0;
+
+  {
+    std::ifstream in(name, std::ios::binary | std::ios::ate);
+
+    if (in.is_open())
+    {
+      ret=static_cast<size_t>(in.tellg());
+    }
+  }
+
+  std::remove(name.c_str());
+
+  return ret;
+}
+
+/*
+  Calls the given function repeatedly after one warm up call, until the
+  minimum number of iterations and the minimum time are reached. If the
+  function returns a file name, then the file is removed after each call
+  without taking the time for this into account.
+*/
+
+void run(Bench &bench, const std::string &name, const std::string &variant, uint64_t format,
+  size_t width, size_t height, const std::function<std::string ()> &fn)
+{
+  if (bench.filter.size() > 0 && name.find(bench.filter) == std::string::npos)
+  {
+    return;
+  }
+
+  Result res;
+
+  res.name=name;
+  res.variant=variant;
+  res.format=getFormatName(format);
+  res.width=width;
+  res.height=height;
+  res.bytes=0;
+
+  std::cerr << name << " " << variant << " " << res.format << " " << width << "x" << height <<
+    std::endl;
+
+  try
+  {
+    std::string file=fn();
+
+    if (file.size() > 0)
+    {
+      res.bytes=removeFile(file);
+    }
+
+    std::vector<double> ms;
+    double total=0;
+
+    while (ms.size() < bench.min_iterations || total < bench.min_time)
+    {
+      std::chrono::steady_clock::time_point t0=std::chrono::steady_clock::now();
+      file=fn();
+      std::chrono::steady_clock::time_point t1=std::chrono::steady_clock::now();
+
+      if (file.size() > 0)
+      {
+        removeFile(file);
+      }
+
+      double t=std::chrono::duration<double>(t1-t0).count();
+
+      ms.push_back(1000*t);
+      total+=t;
+    }
+
+    std::sort(ms.begin(), ms.end());
+
+    res.iterations=ms.size();
+    res.min_ms=ms.front();
+    res.median_ms=ms[ms.size()/2];
+    res.mean_ms=1000*total/ms.size();
+    res.mpixel_per_s=width*height/(1000*res.median_ms);
+
+    bench.result.push_back(res);
+  }
+  catch (const std::exception &ex)
+  {
+    std::cerr << "  skipped: " << ex.what() << std::endl;
+  }
+}
+
+/*
+  Runs all benchmarks for the given image size.
+*/
+
+void runAll(Bench &bench, size_t width, size_t height)
+{
+  const std::string prefix=bench.dir+"/rcg_bench";
+
+  // conversion of images into rgb and monochrome
+
+  {
+    const uint64_t format[]={Mono8, RGB8, BayerRG8, BayerBG8, BayerGR8, BayerGB8, YCbCr411_8,
+      YCbCr422_8, YUV422_8, Mono10p, Mono12, Mono12p, Mono12Packed, Mono16, BayerRG12p};
+
+    std::vector<uint8_t> rgb(3*width*height), mono(width*height);
+
+    for (uint64_t f : format)
+    {
+      std::shared_ptr<const rcg::Image> img=createImage(f, width, height);
+
+      run(bench, "convertImage", "rgb", f, width, height, [&]()
+      {
+        rcg::convertImage(rgb.data(), 0, img->getPixels(), f, width, height, 0);
+        consume(rgb.data(), rgb.size());
+        return std::string();
+      });
+
+      run(bench, "convertImage", "mono", f, width, height, [&]()
+      {
+        rcg::convertImage(0, mono.data(), img->getPixels(), f, width, height, 0);
+        consume(mono.data(), mono.size());
+        return std::string();
+      });
+    }
+  }
+
+  // downscaling with box and gauss filter
+
+  {
+    const uint64_t format[]={Mono8, RGB8, YCbCr411_8, Coord3D_C16};
+
+    for (uint64_t f : format)
+    {
+      std::shared_ptr<const rcg::Image> img;
+
+      if (f == Coord3D_C16)
+      {
+        img=createDisparity(width, height);
+      }
+      else
+      {
+        img=createImage(f, width, height);
+      }
+
+      run(bench, "downscale", "box2", f, width, height, [&]()
+      {
+        std::shared_ptr<const rcg::Image> out=rcg::downscale(*img, 2);
+        consume(out->getPixels(), out->getHeight()*out->getWidth());
+        return std::string();
+      });
+
+      run(bench, "downscale", "gauss2", f, width, height, [&]()
+      {
+        std::shared_ptr<const rcg::Image> out=rcg::downscale(*img, 2, rcg::DOWNSCALE_GAUSS);
+        consume(out->getPixels(), out->getHeight()*out->getWidth());
+        return std::string();
+      });
+
+      run(bench, "createImagePyramid", "gauss4", f, width, height, [&]()
+      {
+        std::vector<std::shared_ptr<const rcg::Image> > out=rcg::createImagePyramid(*img, 4);
+        consume(out.back()->getPixels(), out.back()->getHeight()*out.back()->getWidth());
+        return std::string();
+      });
+    }
+  }
+
+  // conversion into downscaled previews, which do not interpolate bayer images
+
+  {
+    const uint64_t format[]={Mono8, RGB8, BayerRG8, YCbCr411_8, BayerRG12p};
+
+    std::vector<uint8_t> rgb(3*width*height);
+
+    for (uint64_t f : format)
+    {
+      std::shared_ptr<const rcg::Image> img=createImage(f, width, height);
+
+      for (uint32_t ds=2; ds<=4; ds+=2)
+      {
+        std::ostringstream variant;
+        variant << "ds" << ds;
+
+        run(bench, "convertImageDownscaled", variant.str(), f, width, height, [&]()
+        {
+          rcg::convertImageDownscaled(rgb.data(), 0, *img, ds);
+          consume(rgb.data(), 3*(width/ds)*(height/ds));
+          return std::string();
+        });
+      }
+    }
+  }
+
+  // getting the (averaged) color of all pixels
+
+  {
+    const uint64_t format[]={Mono8, RGB8, YCbCr411_8, YCbCr422_8, Mono12p, BayerRG8};
+
+    std::vector<uint8_t> rgb;
+
+    for (uint64_t f : format)
+    {
+      std::shared_ptr<const rcg::Image> img=createImage(f, width, height);
+
+      for (uint32_t ds=1; ds<=2; ds++)
+      {
+        std::ostringstream variant;
+        variant << "ds" << ds;
+
+        run(bench, "getColor", variant.str(), f, width, height, [&]()
+        {
+          const uint32_t w=static_cast<uint32_t>(width/ds);
+          const uint32_t h=static_cast<uint32_t>(height/ds);
+
+          uint32_t s=0;
+          for (uint32_t k=0; k<h; k++)
+          {
+            for (uint32_t i=0; i<w; i++)
+            {
+              uint8_t v[3];
+              rcg::getColor(v, img, ds, i, k);
+              s+=v[0]+v[1]+v[2];
+            }
+          }
+
+          sink+=s;
+          return std::string();
+        });
+
+        run(bench, "getColorImage", variant.str(), f, width, height, [&]()
+        {
+          rgb.resize(3*(width/ds)*(height/ds));
+          rcg::getColorImage(rgb.data(), *img, ds);
+          consume(rgb.data(), rgb.size());
+          return std::string();
+        });
+      }
+    }
+  }
+
+  // conversion of YCbCr formats, pixel by pixel and in groups of four pixels
+
+  {
+    std::vector<uint8_t> rgb(3*width);
+
+    std::shared_ptr<const rcg::Image> img411=createImage(YCbCr411_8, width, height);
+    std::shared_ptr<const rcg::Image> img422=createImage(YCbCr422_8, width, height);
+
+    run(bench, "convYCbCr411toRGB", "", YCbCr411_8, width, height, [&]()
+    {
+      const uint8_t *p=img411->getPixels();
+      for (size_t k=0; k<height; k++)
+      {
+        for (size_t i=0; i<width; i++)
+        {
+          rcg::convYCbCr411toRGB(rgb.data()+3*i, p, static_cast<int>(i));
+        }
+
+        consume(rgb.data(), rgb.size());
+        p+=width*6/4;
+      }
+
+      return std::string();
+    });
+
+    run(bench, "convYCbCr411toQuadRGB", "", YCbCr411_8, width, height, [&]()
+    {
+      const uint8_t *p=img411->getPixels();
+      for (size_t k=0; k<height; k++)
+      {
+        for (size_t i=0; i<width; i+=4)
+        {
+          rcg::convYCbCr411toQuadRGB(rgb.data()+3*i, p, static_cast<int>(i));
+        }
+
+        consume(rgb.data(), rgb.size());
+        p+=width*6/4;
+      }
+
+      return std::string();
+    });
+
+    run(bench, "convYCbCr422toRGB", "", YCbCr422_8, width, height, [&]()
+    {
+      const uint8_t *p=img422->getPixels();
+      for (size_t k=0; k<height; k++)
+      {
+        for (size_t i=0; i<width; i++)
+        {
+          rcg::convYCbCr422toRGB(rgb.data()+3*i, p, static_cast<int>(i));
+        }
+
+        consume(rgb.data(), rgb.size());
+        p+=width*2;
+      }
+
+      return std::string();
+    });
+
+    run(bench, "convYCbCr422toQuadRGB", "", YCbCr422_8, width, height, [&]()
+    {
+      const uint8_t *p=img422->getPixels();
+      for (size_t k=0; k<height; k++)
+      {
+        for (size_t i=0; i<width; i+=4)
+        {
+          rcg::convYCbCr422toQuadRGB(rgb.data()+3*i, p, static_cast<int>(i));
+        }
+
+        consume(rgb.data(), rgb.size());
+        p+=width*2;
+      }
+
+      return std::string();
+    });
+  }
+
+  // storing images
+
+  {
+    const uint64_t format[]={Mono8, Mono16, Coord3D_C16, RGB8, BayerRG8, YCbCr411_8, YCbCr422_8};
+
+    for (uint64_t f : format)
+    {
+      std::shared_ptr<const rcg::Image> img;
+
+      if (f == Coord3D_C16)
+      {
+        img=createDisparity(width, height);
+      }
+      else
+      {
+        img=createImage(f, width, height);
+      }
+
+      run(bench, "storeImage", "PNM", f, width, height, [&]()
+      {
+        return rcg::storeImage(prefix, rcg::PNM, *img);
+      });
+
+      run(bench, "storeImage", "PNG", f, width, height, [&]()
+      {
+        return rcg::storeImage(prefix, rcg::PNG, *img);
+      });
+
+      rcg::PNGParameter fast;
+      fast.level=1;
+
+      run(bench, "storeImage", "PNG-z1", f, width, height, [&]()
+      {
+        return rcg::storeImage(prefix, rcg::PNG, *img, 0, 0, fast);
+      });
+
+      rcg::PNGParameter parallel;
+      parallel.threads=4;
+
+      run(bench, "storeImage", "PNG-j4", f, width, height, [&]()
+      {
+        return rcg::storeImage(prefix, rcg::PNG, *img, 0, 0, parallel);
+      });
+
+      run(bench, "storeImage", "RCL", f, width, height, [&]()
+      {
+        return rcg::storeImage(prefix, rcg::RCL, *img);
+      });
+    }
+  }
+
+  // lossless compression in memory
+
+  {
+    const uint64_t format[]={Mono8, Mono16, Coord3D_C16, RGB8, BayerRG8, YCbCr411_8};
+
+    for (uint64_t f : format)
+    {
+      std::shared_ptr<const rcg::Image> img;
+
+      if (f == Coord3D_C16)
+      {
+        img=createDisparity(width, height);
+      }
+      else
+      {
+        img=createImage(f, width, height);
+      }
+
+      std::vector<uint8_t> data;
+
+      run(bench, "encodeImage", "", f, width, height, [&]()
+      {
+        data.clear();
+        rcg::encodeImage(data, *img);
+        consume(data.data(), data.size());
+        return std::string();
+      });
+
+      run(bench, "decodeImage", "", f, width, height, [&]()
+      {
+        std::shared_ptr<rcg::Image> dec=rcg::decodeImage(data.data(), data.size());
+        consume(dec->getPixels(), 1);
+        return std::string();
+      });
+    }
+  }
+
+  // recording frames with intensity and disparity image into one file and
+  // reading them back
+
+  {
+    std::vector<rcg::RecordingPart> part(2);
+
+    part[0].component="Intensity";
+    part[0].image=createImage(Mono8, width, height);
+    part[1].component="Disparity";
+    part[1].image=createDisparity(width, height);
+
+    for (int compress=0; compress<2; compress++)
+    {
+      const std::string name=prefix+".rec";
+
+      try
+      {
+        rcg::RecordingWriter recording(name, compress != 0);
+        uint64_t frameid=0;
+
+        run(bench, "RecordingWriter", compress ? "compressed" : "raw", Mono8, width, height, [&]()
+        {
+          recording.write(frameid, frameid, part);
+          frameid++;
+          return std::string();
+        });
+
+        recording.close();
+
+        // reading frames in the order of recording, touching every cache line
+        // of all images
+
+        rcg::RecordingReader reader(name);
+        size_t i=0;
+
+        run(bench, "RecordingReader", compress ? "compressed" : "raw", Mono8, width, height, [&]()
+        {
+          rcg::RecordingFrame frame;
+          reader.read(frame, i%reader.getFrameCount());
+
+          for (size_t k=0; k<frame.part.size(); k++)
+          {
+            const rcg::Image &img=*frame.part[k].image;
+            consume(img.getPixels(), img.getWidth()*img.getHeight());
+          }
+
+          i++;
+          return std::string();
+        });
+      }
+      catch (const std::exception &ex)
+      {
+        std::cerr << "  skipped: " << ex.what() << std::endl;
+      }
+
+      removeFile(name);
+    }
+  }
+
+  // storing disparity images and point clouds
+
+  {
+    std::shared_ptr<const rcg::Image> disp=createDisparity(width, height);
+    std::shared_ptr<const rcg::Image> conf=createConfErr(Confidence8, width, height);
+    std::shared_ptr<const rcg::Image> err=createConfErr(Error8, width, height);
+
+    run(bench, "storeImageAsDisparityPFM", "", Coord3D_C16, width, height, [&]()
+    {
+      return rcg::storeImageAsDisparityPFM(prefix, *disp, 0, 0.0625f, 0);
+    });
+
+    rcg::DepthParameter param;
+    param.f=0.8*width;
+    param.t=0.065;
+    param.scale=0.0625;
+    param.inv=0;
+    param.min_conf=0.5;
+
+    std::vector<float> depth(width*height);
+    std::vector<uint16_t> depth_mm(width*height);
+
+    run(bench, "disparityToDepth", "m", Coord3D_C16, width, height, [&]()
+    {
+      rcg::disparityToDepth(depth.data(), *disp, param);
+      consume(reinterpret_cast<const uint8_t *>(depth.data()), 4*depth.size());
+      return std::string();
+    });
+
+    run(bench, "disparityToDepth", "mm+conf", Coord3D_C16, width, height, [&]()
+    {
+      rcg::disparityToDepth(depth_mm.data(), *disp, param, *conf);
+      consume(reinterpret_cast<const uint8_t *>(depth_mm.data()), 2*depth_mm.size());
+      return std::string();
+    });
+
+    run(bench, "storeImageAsDepth", "PNG", Coord3D_C16, width, height, [&]()
+    {
+      return rcg::storeImageAsDepth(prefix, rcg::PNG, *disp, param);
+    });
+
+    const uint64_t format[]={Mono8, YCbCr411_8};
+
+    for (uint64_t f : format)
+    {
+      std::shared_ptr<const rcg::Image> left=createImage(f, width, height);
+
+      run(bench, "storePointCloud", "disp", f, width, height, [&]()
+      {
+        rcg::storePointCloud(prefix+".ply", 0.8, 0.065, 0.0625, left, disp);
+        return prefix+".ply";
+      });
+
+      run(bench, "storePointCloud", "disp+conf+err", f, width, height, [&]()
+      {
+        rcg::storePointCloud(prefix+".ply", 0.8, 0.065, 0.0625, left, disp, conf, err);
+        return prefix+".ply";
+      });
+
+      run(bench, "storePointCloud", "disp+conf+err PCD", f, width, height, [&]()
+      {
+        rcg::storePointCloud(prefix+".pcd", 0.8, 0.065, 0.0625, left, disp, conf, err,
+                             rcg::PointCloudFilter(), rcg::NormalParameter(), rcg::PCD);
+        return prefix+".pcd";
+      });
+
+      run(bench, "storePointCloud", "disp+conf+err RCP", f, width, height, [&]()
+      {
+        rcg::storePointCloud(prefix+".rcp", 0.8, 0.065, 0.0625, left, disp, conf, err,
+                             rcg::PointCloudFilter(), rcg::NormalParameter(), rcg::RCP);
+        return prefix+".rcp";
+      });
+    }
+  }
+}
+
+/*
+  Print results in JSON format.
+*/
+
+void printJSON(std::ostream &out, const Bench &bench)
+{
+  out << "{" << std::endl;
+  out << "  \"version\": \"" << RC_GENICAM_API_PACKAGE_VERSION << "\"," << std::endl;
+  out << "  \"benchmarks\": [" << std::endl;
+
+  for (size_t i=0; i<bench.result.size(); i++)
+  {
+    const Result &res=bench.result[i];
+
+    out << "    {\"name\": \"" << res.name << "\", \"variant\": \"" << res.variant <<
+      "\", \"format\": \"" << res.format << "\", \"width\": " << res.width <<
+      ", \"height\": " << res.height << ", \"iterations\": " << res.iterations <<
+      ", \"min_ms\": " << res.min_ms << ", \"median_ms\": " << res.median_ms <<
+      ", \"mean_ms\": " << res.mean_ms << ", \"mpixel_per_s\": " << res.mpixel_per_s <<
+      ", \"bytes\": " << res.bytes << "}";
+
+    if (i+1 < bench.result.size())
+    {
+      out << ",";
+    }
+
+    out << std::endl;
+  }
+
+  out << "  ]" << std::endl;
+  out << "}" << std::endl;
+}
+
+/*
+  Print results in CSV format.
+*/
+
+void printCSV(std::ostream &out, const Bench &bench)
+{
+  out << "name,variant,format,width,height,iterations,min_ms,median_ms,mean_ms,mpixel_per_s,bytes" <<
+    std::endl;
+
+  for (size_t i=0; i<bench.result.size(); i++)
+  {
+    const Result &res=bench.result[i];
+
+    out << res.name << "," << res.variant << "," << res.format << "," << res.width << "," <<
+      res.height << "," << res.iterations << "," << res.min_ms << "," << res.median_ms << "," <<
+      res.mean_ms << "," << res.mpixel_per_s << "," << res.bytes << std::endl;
+  }
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  int ret=0;
+
+  try
+  {
+    // optional parameters
+
+    std::string format="json";
+    std::string output;
+    std::string sizes="640x480,1280x960";
+
+    Bench bench;
+    bench.dir=".";
+    bench.min_iterations=3;
+    bench.min_time=0.5;
+
+    int i=1;
+
+    while (i+1 < argc && argv[i][0] == '-' && std::string(argv[i]) != "-h")
+    {
+      std::string p=argv[i++];
+
+      if (p == "-f")
+      {
+        format=argv[i++];
+      }
+      else if (p == "-o")
+      {
+        output=argv[i++];
+      }
+      else if (p == "-d")
+      {
+        bench.dir=argv[i++];
+      }
+      else if (p == "-s")
+      {
+        sizes=argv[i++];
+      }
+      else if (p == "-n")
+      {
+        bench.min_iterations=std::max(1, std::atoi(argv[i++]));
+      }
+      else if (p == "-t")
+      {
+        bench.min_time=std::atof(argv[i++]);
+      }
+      else if (p == "-b")
+      {
+        bench.filter=argv[i++];
+      }
+      else
+      {
+        std::cout << "Unknown parameter: " << p << std::endl;
+        std::cout << std::endl;
+
+        printHelp(argv[0]);
+
+        return 1;
+      }
+    }
+
+    if (i < argc || (format != "json" && format != "csv"))
+    {
+      printHelp(argv[0]);
+      return 1;
+    }
+
+    // run benchmarks for all image sizes
+
+    std::istringstream in(sizes);
+    std::string size;
+
+    while (std::getline(in, size, ','))
+    {
+      size_t width=0, height=0;
+      char x=0;
+
+      std::istringstream ins(size);
+      ins >> width >> x >> height;
+
+      if (ins.fail() || x != 'x' || width < 4 || height < 4 || (width&0x3) != 0 ||
+        (height&0x3) != 0)
+      {
+        std::cerr << "Invalid image size, width and height must be multiples of 4: " << size <<
+          std::endl;
+        return 1;
+      }
+
+      runAll(bench, width, height);
+    }
+
+    // print results
+
+    std::ofstream file;
+
+    if (output.size() > 0)
+    {
+      file.open(output);
+
+      if (!file.is_open())
+      {
+        std::cerr << "Cannot open output file: " << output << std::endl;
+        return 1;
+      }
+    }
+
+    std::ostream &out=(output.size() > 0) ? file : std::cout;
+
+    if (format == "csv")
+    {
+      printCSV(out, bench);
+    }
+    else
+    {
+      printJSON(out, bench);
+    }
+  }
+  catch (const std::exception &ex)
+  {
+    std::cerr << "Exception: " << ex.what() << std::endl;
+    ret=2;
+  }
+  catch (...)
+  {
+    std::cerr << "Unknown exception!" << std::endl;
+    ret=2;
+  }
+
+  return ret;
+}
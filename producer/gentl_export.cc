@@ -0,0 +1,724 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gentl_producer.h"
+
+#include <exception>
+#include <mutex>
+#include <memory>
+
+namespace rcg
+{
+
+namespace
+{
+
+thread_local GenTL::GC_ERROR last_error=GenTL::GC_ERR_SUCCESS;
+thread_local std::string last_error_text;
+
+std::mutex producer_mtx;
+std::unique_ptr<GenTLProducer> producer;
+
+/*
+  Returns the last error of the calling thread. The last error itself must not
+  be changed by this function.
+*/
+
+GenTL::GC_ERROR getLastError(GenTL::GC_ERROR *piErrorCode, char *sErrText, size_t *piSize)
+{
+  if (piErrorCode != 0)
+  {
+    *piErrorCode=last_error;
+  }
+
+  if (piSize == 0)
+  {
+    return GenTL::GC_ERR_INVALID_PARAMETER;
+  }
+
+  if (sErrText != 0)
+  {
+    if (*piSize < last_error_text.size()+1)
+    {
+      *piSize=last_error_text.size()+1;
+      return GenTL::GC_ERR_BUFFER_TOO_SMALL;
+    }
+
+    memcpy(sErrText, last_error_text.c_str(), last_error_text.size()+1);
+  }
+
+  *piSize=last_error_text.size()+1;
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+/*
+  Calls the given function on the producer object, after checking that the
+  library is initialized. Exceptions must not be propagated through the C
+  interface and are converted to an error code.
+*/
+
+template<class F> inline GenTL::GC_ERROR forward(F f)
+{
+  if (!producer)
+  {
+    return setLastError(GenTL::GC_ERR_NOT_INITIALIZED, "GCInitLib() must be called first");
+  }
+
+  try
+  {
+    return f();
+  }
+  catch (const std::bad_alloc &)
+  {
+    return setLastError(GenTL::GC_ERR_OUT_OF_MEMORY, "Out of memory");
+  }
+  catch (const std::exception &ex)
+  {
+    return setLastError(GenTL::GC_ERR_ERROR, ex.what());
+  }
+  catch (...)
+  {
+    return setLastError(GenTL::GC_ERR_ERROR, "Unknown exception");
+  }
+}
+
+}
+
+GenTL::GC_ERROR setLastError(GenTL::GC_ERROR err, const std::string &msg)
+{
+  last_error=err;
+  last_error_text=msg;
+
+  return err;
+}
+
+GenTL::GC_ERROR returnInfoString(GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize,
+  const std::string &value)
+{
+  if (piSize == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Size pointer must not be 0");
+  }
+
+  if (piType != 0)
+  {
+    *piType=GenTL::INFO_DATATYPE_STRING;
+  }
+
+  if (pBuffer != 0)
+  {
+    if (*piSize < value.size()+1)
+    {
+      *piSize=value.size()+1;
+      return setLastError(GenTL::GC_ERR_BUFFER_TOO_SMALL, "Buffer too small");
+    }
+
+    memcpy(pBuffer, value.c_str(), value.size()+1);
+  }
+
+  *piSize=value.size()+1;
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR GenTLProducer::GCGetLastError(GenTL::GC_ERROR *piErrorCode, char *sErrText,
+  size_t *piSize)
+{
+  return getLastError(piErrorCode, sErrText, piSize);
+}
+
+GenTL::GC_ERROR GenTLProducer::GCReadPortStacked(GenTL::PORT_HANDLE hPort,
+  GenTL::PORT_REGISTER_STACK_ENTRY *pEntries, size_t *piNumEntries)
+{
+  if (pEntries == 0 || piNumEntries == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  for (size_t i=0; i<*piNumEntries; i++)
+  {
+    GenTL::GC_ERROR err=GCReadPort(hPort, pEntries[i].Address, pEntries[i].pBuffer,
+      &pEntries[i].Size);
+
+    if (err != GenTL::GC_ERR_SUCCESS)
+    {
+      *piNumEntries=i;
+      return err;
+    }
+  }
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR GenTLProducer::GCWritePortStacked(GenTL::PORT_HANDLE hPort,
+  GenTL::PORT_REGISTER_STACK_ENTRY *pEntries, size_t *piNumEntries)
+{
+  if (pEntries == 0 || piNumEntries == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  for (size_t i=0; i<*piNumEntries; i++)
+  {
+    GenTL::GC_ERROR err=GCWritePort(hPort, pEntries[i].Address, pEntries[i].pBuffer,
+      &pEntries[i].Size);
+
+    if (err != GenTL::GC_ERR_SUCCESS)
+    {
+      *piNumEntries=i;
+      return err;
+    }
+  }
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR GenTLProducer::DSGetBufferChunkData(GenTL::DS_HANDLE, GenTL::BUFFER_HANDLE,
+  GenTL::SINGLE_CHUNK_DATA *, size_t *)
+{
+  return setLastError(GenTL::GC_ERR_NOT_IMPLEMENTED, "DSGetBufferChunkData() is not implemented");
+}
+
+}
+
+// exported C interface of the producer library
+
+namespace GenTL
+{
+
+GC_API GCGetLastError(GC_ERROR *piErrorCode, char *sErrText, size_t *piSize)
+{
+  std::lock_guard<std::mutex> lock(rcg::producer_mtx);
+
+  if (rcg::producer)
+  {
+    return rcg::producer->GCGetLastError(piErrorCode, sErrText, piSize);
+  }
+
+  // report errors that happened before initialization, e.g. in GCInitLib()
+
+  return rcg::getLastError(piErrorCode, sErrText, piSize);
+}
+
+GC_API GCInitLib(void)
+{
+  std::lock_guard<std::mutex> lock(rcg::producer_mtx);
+
+  if (rcg::producer)
+  {
+    return rcg::setLastError(GC_ERR_RESOURCE_IN_USE, "GCInitLib(): Library is already initialized");
+  }
+
+  try
+  {
+    rcg::producer.reset(rcg::createProducer());
+  }
+  catch (const std::exception &ex)
+  {
+    return rcg::setLastError(GC_ERR_ERROR, std::string("GCInitLib(): ")+ex.what());
+  }
+
+  return GC_ERR_SUCCESS;
+}
+
+GC_API GCCloseLib(void)
+{
+  std::lock_guard<std::mutex> lock(rcg::producer_mtx);
+
+  if (!rcg::producer)
+  {
+    return rcg::setLastError(GC_ERR_NOT_INITIALIZED, "GCCloseLib(): Library is not initialized");
+  }
+
+  rcg::producer.reset();
+
+  return GC_ERR_SUCCESS;
+}
+
+GC_API GCGetInfo(TL_INFO_CMD iInfoCmd, INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->GCGetInfo(iInfoCmd, piType, pBuffer, piSize);
+  });
+}
+
+GC_API GCReadPort(PORT_HANDLE hPort, uint64_t iAddress, void *pBuffer, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->GCReadPort(hPort, iAddress, pBuffer, piSize);
+  });
+}
+
+GC_API GCWritePort(PORT_HANDLE hPort, uint64_t iAddress, const void *pBuffer, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->GCWritePort(hPort, iAddress, pBuffer, piSize);
+  });
+}
+
+GC_API GCGetPortURL(PORT_HANDLE hPort, char *sURL, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->GCGetPortURL(hPort, sURL, piSize);
+  });
+}
+
+GC_API GCGetPortInfo(PORT_HANDLE hPort, PORT_INFO_CMD iInfoCmd, INFO_DATATYPE *piType,
+  void *pBuffer, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->GCGetPortInfo(hPort, iInfoCmd, piType, pBuffer, piSize);
+  });
+}
+
+GC_API GCRegisterEvent(EVENTSRC_HANDLE hEventSrc, EVENT_TYPE iEventID, EVENT_HANDLE *phEvent)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->GCRegisterEvent(hEventSrc, iEventID, phEvent);
+  });
+}
+
+GC_API GCUnregisterEvent(EVENTSRC_HANDLE hEventSrc, EVENT_TYPE iEventID)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->GCUnregisterEvent(hEventSrc, iEventID);
+  });
+}
+
+GC_API EventGetData(EVENT_HANDLE hEvent, void *pBuffer, size_t *piSize, uint64_t iTimeout)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->EventGetData(hEvent, pBuffer, piSize, iTimeout);
+  });
+}
+
+GC_API EventGetDataInfo(EVENT_HANDLE hEvent, const void *pInBuffer, size_t iInSize,
+  EVENT_DATA_INFO_CMD iInfoCmd, INFO_DATATYPE *piType, void *pOutBuffer, size_t *piOutSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->EventGetDataInfo(hEvent, pInBuffer, iInSize, iInfoCmd, piType,
+      pOutBuffer, piOutSize);
+  });
+}
+
+GC_API EventGetInfo(EVENT_HANDLE hEvent, EVENT_INFO_CMD iInfoCmd, INFO_DATATYPE *piType,
+  void *pBuffer, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->EventGetInfo(hEvent, iInfoCmd, piType, pBuffer, piSize);
+  });
+}
+
+GC_API EventFlush(EVENT_HANDLE hEvent)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->EventFlush(hEvent);
+  });
+}
+
+GC_API EventKill(EVENT_HANDLE hEvent)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->EventKill(hEvent);
+  });
+}
+
+GC_API TLOpen(TL_HANDLE *phTL)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->TLOpen(phTL);
+  });
+}
+
+GC_API TLClose(TL_HANDLE hTL)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->TLClose(hTL);
+  });
+}
+
+GC_API TLGetInfo(TL_HANDLE hTL, TL_INFO_CMD iInfoCmd, INFO_DATATYPE *piType, void *pBuffer,
+  size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->TLGetInfo(hTL, iInfoCmd, piType, pBuffer, piSize);
+  });
+}
+
+GC_API TLGetNumInterfaces(TL_HANDLE hTL, uint32_t *piNumIfaces)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->TLGetNumInterfaces(hTL, piNumIfaces);
+  });
+}
+
+GC_API TLGetInterfaceID(TL_HANDLE hTL, uint32_t iIndex, char *sID, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->TLGetInterfaceID(hTL, iIndex, sID, piSize);
+  });
+}
+
+GC_API TLGetInterfaceInfo(TL_HANDLE hTL, const char *sIfaceID, INTERFACE_INFO_CMD iInfoCmd,
+  INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->TLGetInterfaceInfo(hTL, sIfaceID, iInfoCmd, piType, pBuffer, piSize);
+  });
+}
+
+GC_API TLOpenInterface(TL_HANDLE hTL, const char *sIfaceID, IF_HANDLE *phIface)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->TLOpenInterface(hTL, sIfaceID, phIface);
+  });
+}
+
+GC_API TLUpdateInterfaceList(TL_HANDLE hTL, bool8_t *pbChanged, uint64_t iTimeout)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->TLUpdateInterfaceList(hTL, pbChanged, iTimeout);
+  });
+}
+
+GC_API IFClose(IF_HANDLE hIface)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->IFClose(hIface);
+  });
+}
+
+GC_API IFGetInfo(IF_HANDLE hIface, INTERFACE_INFO_CMD iInfoCmd, INFO_DATATYPE *piType,
+  void *pBuffer, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->IFGetInfo(hIface, iInfoCmd, piType, pBuffer, piSize);
+  });
+}
+
+GC_API IFGetNumDevices(IF_HANDLE hIface, uint32_t *piNumDevices)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->IFGetNumDevices(hIface, piNumDevices);
+  });
+}
+
+GC_API IFGetDeviceID(IF_HANDLE hIface, uint32_t iIndex, char *sIDeviceID, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->IFGetDeviceID(hIface, iIndex, sIDeviceID, piSize);
+  });
+}
+
+GC_API IFUpdateDeviceList(IF_HANDLE hIface, bool8_t *pbChanged, uint64_t iTimeout)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->IFUpdateDeviceList(hIface, pbChanged, iTimeout);
+  });
+}
+
+GC_API IFGetDeviceInfo(IF_HANDLE hIface, const char *sDeviceID, DEVICE_INFO_CMD iInfoCmd,
+  INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->IFGetDeviceInfo(hIface, sDeviceID, iInfoCmd, piType, pBuffer, piSize);
+  });
+}
+
+GC_API IFOpenDevice(IF_HANDLE hIface, const char *sDeviceID, DEVICE_ACCESS_FLAGS iOpenFlag,
+  DEV_HANDLE *phDevice)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->IFOpenDevice(hIface, sDeviceID, iOpenFlag, phDevice);
+  });
+}
+
+GC_API DevGetPort(DEV_HANDLE hDevice, PORT_HANDLE *phRemoteDevice)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DevGetPort(hDevice, phRemoteDevice);
+  });
+}
+
+GC_API DevGetNumDataStreams(DEV_HANDLE hDevice, uint32_t *piNumDataStreams)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DevGetNumDataStreams(hDevice, piNumDataStreams);
+  });
+}
+
+GC_API DevGetDataStreamID(DEV_HANDLE hDevice, uint32_t iIndex, char *sDataStreamID, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DevGetDataStreamID(hDevice, iIndex, sDataStreamID, piSize);
+  });
+}
+
+GC_API DevOpenDataStream(DEV_HANDLE hDevice, const char *sDataStreamID, DS_HANDLE *phDataStream)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DevOpenDataStream(hDevice, sDataStreamID, phDataStream);
+  });
+}
+
+GC_API DevGetInfo(DEV_HANDLE hDevice, DEVICE_INFO_CMD iInfoCmd, INFO_DATATYPE *piType,
+  void *pBuffer, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DevGetInfo(hDevice, iInfoCmd, piType, pBuffer, piSize);
+  });
+}
+
+GC_API DevClose(DEV_HANDLE hDevice)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DevClose(hDevice);
+  });
+}
+
+GC_API DSAnnounceBuffer(DS_HANDLE hDataStream, void *pBuffer, size_t iSize, void *pPrivate,
+  BUFFER_HANDLE *phBuffer)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DSAnnounceBuffer(hDataStream, pBuffer, iSize, pPrivate, phBuffer);
+  });
+}
+
+GC_API DSAllocAndAnnounceBuffer(DS_HANDLE hDataStream, size_t iSize, void *pPrivate,
+  BUFFER_HANDLE *phBuffer)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DSAllocAndAnnounceBuffer(hDataStream, iSize, pPrivate, phBuffer);
+  });
+}
+
+GC_API DSFlushQueue(DS_HANDLE hDataStream, ACQ_QUEUE_TYPE iOperation)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DSFlushQueue(hDataStream, iOperation);
+  });
+}
+
+GC_API DSStartAcquisition(DS_HANDLE hDataStream, ACQ_START_FLAGS iStartFlags,
+  uint64_t iNumToAcquire)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DSStartAcquisition(hDataStream, iStartFlags, iNumToAcquire);
+  });
+}
+
+GC_API DSStopAcquisition(DS_HANDLE hDataStream, ACQ_STOP_FLAGS iStopFlags)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DSStopAcquisition(hDataStream, iStopFlags);
+  });
+}
+
+GC_API DSGetInfo(DS_HANDLE hDataStream, STREAM_INFO_CMD iInfoCmd, INFO_DATATYPE *piType,
+  void *pBuffer, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DSGetInfo(hDataStream, iInfoCmd, piType, pBuffer, piSize);
+  });
+}
+
+GC_API DSGetBufferID(DS_HANDLE hDataStream, uint32_t iIndex, BUFFER_HANDLE *phBuffer)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DSGetBufferID(hDataStream, iIndex, phBuffer);
+  });
+}
+
+GC_API DSClose(DS_HANDLE hDataStream)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DSClose(hDataStream);
+  });
+}
+
+GC_API DSRevokeBuffer(DS_HANDLE hDataStream, BUFFER_HANDLE hBuffer, void **pBuffer, void **pPrivate)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DSRevokeBuffer(hDataStream, hBuffer, pBuffer, pPrivate);
+  });
+}
+
+GC_API DSQueueBuffer(DS_HANDLE hDataStream, BUFFER_HANDLE hBuffer)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DSQueueBuffer(hDataStream, hBuffer);
+  });
+}
+
+GC_API DSGetBufferInfo(DS_HANDLE hDataStream, BUFFER_HANDLE hBuffer, BUFFER_INFO_CMD iInfoCmd,
+  INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DSGetBufferInfo(hDataStream, hBuffer, iInfoCmd, piType, pBuffer, piSize);
+  });
+}
+
+GC_API GCGetNumPortURLs(PORT_HANDLE hPort, uint32_t *piNumURLs)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->GCGetNumPortURLs(hPort, piNumURLs);
+  });
+}
+
+GC_API GCGetPortURLInfo(PORT_HANDLE hPort, uint32_t iURLIndex, URL_INFO_CMD iInfoCmd,
+  INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->GCGetPortURLInfo(hPort, iURLIndex, iInfoCmd, piType, pBuffer, piSize);
+  });
+}
+
+GC_API GCReadPortStacked(PORT_HANDLE hPort, PORT_REGISTER_STACK_ENTRY *pEntries,
+  size_t *piNumEntries)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->GCReadPortStacked(hPort, pEntries, piNumEntries);
+  });
+}
+
+GC_API GCWritePortStacked(PORT_HANDLE hPort, PORT_REGISTER_STACK_ENTRY *pEntries,
+  size_t *piNumEntries)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->GCWritePortStacked(hPort, pEntries, piNumEntries);
+  });
+}
+
+GC_API DSGetBufferChunkData(DS_HANDLE hDataStream, BUFFER_HANDLE hBuffer,
+  SINGLE_CHUNK_DATA *pChunkData, size_t *piNumChunks)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DSGetBufferChunkData(hDataStream, hBuffer, pChunkData, piNumChunks);
+  });
+}
+
+GC_API IFGetParentTL(IF_HANDLE hIface, TL_HANDLE *phSystem)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->IFGetParentTL(hIface, phSystem);
+  });
+}
+
+GC_API DevGetParentIF(DEV_HANDLE hDevice, IF_HANDLE *phIface)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DevGetParentIF(hDevice, phIface);
+  });
+}
+
+GC_API DSGetParentDev(DS_HANDLE hDataStream, DEV_HANDLE *phDevice)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DSGetParentDev(hDataStream, phDevice);
+  });
+}
+
+GC_API DSGetNumBufferParts(DS_HANDLE hDataStream, BUFFER_HANDLE hBuffer, uint32_t *piNumParts)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DSGetNumBufferParts(hDataStream, hBuffer, piNumParts);
+  });
+}
+
+GC_API DSGetBufferPartInfo(DS_HANDLE hDataStream, BUFFER_HANDLE hBuffer, uint32_t iPartIndex,
+  BUFFER_PART_INFO_CMD iInfoCmd, INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return rcg::forward([&]
+  {
+    return rcg::producer->DSGetBufferPartInfo(hDataStream, hBuffer, iPartIndex, iInfoCmd, piType,
+      pBuffer, piSize);
+  });
+}
+
+}
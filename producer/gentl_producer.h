@@ -0,0 +1,251 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RC_GENICAM_API_GENTL_PRODUCER
+#define RC_GENICAM_API_GENTL_PRODUCER
+
+#include <GenTL/GenTL_v1_6.h>
+
+#include <string>
+#include <cstring>
+
+namespace rcg
+{
+
+/**
+  Interface of a GenTL producer that is implemented inside this package. The
+  exported C functions of a producer library (i.e. file with suffix .cti) are
+  defined in gentl_export.cc and just forward all calls to the object that is
+  returned by createProducer().
+
+  The methods have the same names, parameters and semantic as the GenTL
+  functions. See the GenTL standard for a description.
+*/
+
+class GenTLProducer
+{
+  public:
+
+    virtual ~GenTLProducer() {}
+
+    virtual GenTL::GC_ERROR GCGetInfo(GenTL::TL_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType,
+      void *pBuffer, size_t *piSize)=0;
+    virtual GenTL::GC_ERROR GCGetLastError(GenTL::GC_ERROR *piErrorCode, char *sErrText,
+      size_t *piSize);
+
+    virtual GenTL::GC_ERROR GCReadPort(GenTL::PORT_HANDLE hPort, uint64_t iAddress, void *pBuffer,
+      size_t *piSize)=0;
+    virtual GenTL::GC_ERROR GCWritePort(GenTL::PORT_HANDLE hPort, uint64_t iAddress,
+      const void *pBuffer, size_t *piSize)=0;
+    virtual GenTL::GC_ERROR GCGetPortURL(GenTL::PORT_HANDLE hPort, char *sURL, size_t *piSize)=0;
+    virtual GenTL::GC_ERROR GCGetPortInfo(GenTL::PORT_HANDLE hPort, GenTL::PORT_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)=0;
+
+    virtual GenTL::GC_ERROR GCRegisterEvent(GenTL::EVENTSRC_HANDLE hEventSrc,
+      GenTL::EVENT_TYPE iEventID, GenTL::EVENT_HANDLE *phEvent)=0;
+    virtual GenTL::GC_ERROR GCUnregisterEvent(GenTL::EVENTSRC_HANDLE hEventSrc,
+      GenTL::EVENT_TYPE iEventID)=0;
+
+    virtual GenTL::GC_ERROR EventGetData(GenTL::EVENT_HANDLE hEvent, void *pBuffer, size_t *piSize,
+      uint64_t iTimeout)=0;
+    virtual GenTL::GC_ERROR EventGetDataInfo(GenTL::EVENT_HANDLE hEvent, const void *pInBuffer,
+      size_t iInSize, GenTL::EVENT_DATA_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType,
+      void *pOutBuffer, size_t *piOutSize)=0;
+    virtual GenTL::GC_ERROR EventGetInfo(GenTL::EVENT_HANDLE hEvent, GenTL::EVENT_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)=0;
+    virtual GenTL::GC_ERROR EventFlush(GenTL::EVENT_HANDLE hEvent)=0;
+    virtual GenTL::GC_ERROR EventKill(GenTL::EVENT_HANDLE hEvent)=0;
+
+    virtual GenTL::GC_ERROR TLOpen(GenTL::TL_HANDLE *phTL)=0;
+    virtual GenTL::GC_ERROR TLClose(GenTL::TL_HANDLE hTL)=0;
+    virtual GenTL::GC_ERROR TLGetInfo(GenTL::TL_HANDLE hTL, GenTL::TL_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)=0;
+    virtual GenTL::GC_ERROR TLGetNumInterfaces(GenTL::TL_HANDLE hTL, uint32_t *piNumIfaces)=0;
+    virtual GenTL::GC_ERROR TLGetInterfaceID(GenTL::TL_HANDLE hTL, uint32_t iIndex, char *sID,
+      size_t *piSize)=0;
+    virtual GenTL::GC_ERROR TLGetInterfaceInfo(GenTL::TL_HANDLE hTL, const char *sIfaceID,
+      GenTL::INTERFACE_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer,
+      size_t *piSize)=0;
+    virtual GenTL::GC_ERROR TLOpenInterface(GenTL::TL_HANDLE hTL, const char *sIfaceID,
+      GenTL::IF_HANDLE *phIface)=0;
+    virtual GenTL::GC_ERROR TLUpdateInterfaceList(GenTL::TL_HANDLE hTL, bool8_t *pbChanged,
+      uint64_t iTimeout)=0;
+
+    virtual GenTL::GC_ERROR IFClose(GenTL::IF_HANDLE hIface)=0;
+    virtual GenTL::GC_ERROR IFGetInfo(GenTL::IF_HANDLE hIface, GenTL::INTERFACE_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)=0;
+    virtual GenTL::GC_ERROR IFGetNumDevices(GenTL::IF_HANDLE hIface, uint32_t *piNumDevices)=0;
+    virtual GenTL::GC_ERROR IFGetDeviceID(GenTL::IF_HANDLE hIface, uint32_t iIndex,
+      char *sIDeviceID, size_t *piSize)=0;
+    virtual GenTL::GC_ERROR IFUpdateDeviceList(GenTL::IF_HANDLE hIface, bool8_t *pbChanged,
+      uint64_t iTimeout)=0;
+    virtual GenTL::GC_ERROR IFGetDeviceInfo(GenTL::IF_HANDLE hIface, const char *sDeviceID,
+      GenTL::DEVICE_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer,
+      size_t *piSize)=0;
+    virtual GenTL::GC_ERROR IFOpenDevice(GenTL::IF_HANDLE hIface, const char *sDeviceID,
+      GenTL::DEVICE_ACCESS_FLAGS iOpenFlag, GenTL::DEV_HANDLE *phDevice)=0;
+
+    virtual GenTL::GC_ERROR DevGetPort(GenTL::DEV_HANDLE hDevice,
+      GenTL::PORT_HANDLE *phRemoteDevice)=0;
+    virtual GenTL::GC_ERROR DevGetNumDataStreams(GenTL::DEV_HANDLE hDevice,
+      uint32_t *piNumDataStreams)=0;
+    virtual GenTL::GC_ERROR DevGetDataStreamID(GenTL::DEV_HANDLE hDevice, uint32_t iIndex,
+      char *sDataStreamID, size_t *piSize)=0;
+    virtual GenTL::GC_ERROR DevOpenDataStream(GenTL::DEV_HANDLE hDevice, const char *sDataStreamID,
+      GenTL::DS_HANDLE *phDataStream)=0;
+    virtual GenTL::GC_ERROR DevGetInfo(GenTL::DEV_HANDLE hDevice, GenTL::DEVICE_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)=0;
+    virtual GenTL::GC_ERROR DevClose(GenTL::DEV_HANDLE hDevice)=0;
+
+    virtual GenTL::GC_ERROR DSAnnounceBuffer(GenTL::DS_HANDLE hDataStream, void *pBuffer,
+      size_t iSize, void *pPrivate, GenTL::BUFFER_HANDLE *phBuffer)=0;
+    virtual GenTL::GC_ERROR DSAllocAndAnnounceBuffer(GenTL::DS_HANDLE hDataStream, size_t iSize,
+      void *pPrivate, GenTL::BUFFER_HANDLE *phBuffer)=0;
+    virtual GenTL::GC_ERROR DSFlushQueue(GenTL::DS_HANDLE hDataStream,
+      GenTL::ACQ_QUEUE_TYPE iOperation)=0;
+    virtual GenTL::GC_ERROR DSStartAcquisition(GenTL::DS_HANDLE hDataStream,
+      GenTL::ACQ_START_FLAGS iStartFlags, uint64_t iNumToAcquire)=0;
+    virtual GenTL::GC_ERROR DSStopAcquisition(GenTL::DS_HANDLE hDataStream,
+      GenTL::ACQ_STOP_FLAGS iStopFlags)=0;
+    virtual GenTL::GC_ERROR DSGetInfo(GenTL::DS_HANDLE hDataStream, GenTL::STREAM_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)=0;
+    virtual GenTL::GC_ERROR DSGetBufferID(GenTL::DS_HANDLE hDataStream, uint32_t iIndex,
+      GenTL::BUFFER_HANDLE *phBuffer)=0;
+    virtual GenTL::GC_ERROR DSClose(GenTL::DS_HANDLE hDataStream)=0;
+    virtual GenTL::GC_ERROR DSRevokeBuffer(GenTL::DS_HANDLE hDataStream,
+      GenTL::BUFFER_HANDLE hBuffer, void **pBuffer, void **pPrivate)=0;
+    virtual GenTL::GC_ERROR DSQueueBuffer(GenTL::DS_HANDLE hDataStream,
+      GenTL::BUFFER_HANDLE hBuffer)=0;
+    virtual GenTL::GC_ERROR DSGetBufferInfo(GenTL::DS_HANDLE hDataStream,
+      GenTL::BUFFER_HANDLE hBuffer, GenTL::BUFFER_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType,
+      void *pBuffer, size_t *piSize)=0;
+
+    // GenTL v1.1
+
+    virtual GenTL::GC_ERROR GCGetNumPortURLs(GenTL::PORT_HANDLE hPort, uint32_t *piNumURLs)=0;
+    virtual GenTL::GC_ERROR GCGetPortURLInfo(GenTL::PORT_HANDLE hPort, uint32_t iURLIndex,
+      GenTL::URL_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer,
+      size_t *piSize)=0;
+    virtual GenTL::GC_ERROR GCReadPortStacked(GenTL::PORT_HANDLE hPort,
+      GenTL::PORT_REGISTER_STACK_ENTRY *pEntries, size_t *piNumEntries);
+    virtual GenTL::GC_ERROR GCWritePortStacked(GenTL::PORT_HANDLE hPort,
+      GenTL::PORT_REGISTER_STACK_ENTRY *pEntries, size_t *piNumEntries);
+
+    // GenTL v1.3
+
+    virtual GenTL::GC_ERROR DSGetBufferChunkData(GenTL::DS_HANDLE hDataStream,
+      GenTL::BUFFER_HANDLE hBuffer, GenTL::SINGLE_CHUNK_DATA *pChunkData, size_t *piNumChunks);
+
+    // GenTL v1.4
+
+    virtual GenTL::GC_ERROR IFGetParentTL(GenTL::IF_HANDLE hIface, GenTL::TL_HANDLE *phSystem)=0;
+    virtual GenTL::GC_ERROR DevGetParentIF(GenTL::DEV_HANDLE hDevice, GenTL::IF_HANDLE *phIface)=0;
+    virtual GenTL::GC_ERROR DSGetParentDev(GenTL::DS_HANDLE hDataStream,
+      GenTL::DEV_HANDLE *phDevice)=0;
+
+    // GenTL v1.5
+
+    virtual GenTL::GC_ERROR DSGetNumBufferParts(GenTL::DS_HANDLE hDataStream,
+      GenTL::BUFFER_HANDLE hBuffer, uint32_t *piNumParts)=0;
+    virtual GenTL::GC_ERROR DSGetBufferPartInfo(GenTL::DS_HANDLE hDataStream,
+      GenTL::BUFFER_HANDLE hBuffer, uint32_t iPartIndex, GenTL::BUFFER_PART_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)=0;
+};
+
+/**
+  Must be implemented once by every producer library. It is called by
+  GCInitLib() and the returned object is deleted by GCCloseLib().
+
+  @return Newly allocated producer object.
+*/
+
+GenTLProducer *createProducer();
+
+/**
+  Stores the given error code and message as last error of the calling thread
+  so that it can be retrieved with GCGetLastError().
+
+  @param err Error code.
+  @param msg Error message.
+  @return    Given error code.
+*/
+
+GenTL::GC_ERROR setLastError(GenTL::GC_ERROR err, const std::string &msg);
+
+/**
+  Helper for returning a string as information value according to the GenTL
+  conventions, i.e. only the required size is returned if pBuffer is 0.
+*/
+
+GenTL::GC_ERROR returnInfoString(GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize,
+  const std::string &value);
+
+/**
+  Helper for returning a value of the given type as information value
+  according to the GenTL conventions.
+*/
+
+template<class T> GenTL::GC_ERROR returnInfoValue(GenTL::INFO_DATATYPE *piType, void *pBuffer,
+  size_t *piSize, T value, GenTL::INFO_DATATYPE type)
+{
+  if (piSize == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Size pointer must not be 0");
+  }
+
+  if (piType != 0)
+  {
+    *piType=type;
+  }
+
+  if (pBuffer != 0)
+  {
+    if (*piSize < sizeof(T))
+    {
+      *piSize=sizeof(T);
+      return setLastError(GenTL::GC_ERR_BUFFER_TOO_SMALL, "Buffer too small");
+    }
+
+    memcpy(pBuffer, &value, sizeof(T));
+  }
+
+  *piSize=sizeof(T);
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+}
+
+#endif
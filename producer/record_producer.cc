@@ -0,0 +1,785 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "record_producer.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace rcg
+{
+
+namespace
+{
+
+inline void addInfo(std::vector<RecordedInfo> &list, int32_t cmd, GenTL::INFO_DATATYPE type,
+  const void *value, size_t size)
+{
+  RecordedInfo info;
+
+  info.cmd=cmd;
+  info.type=type;
+  info.value.resize(size);
+
+  if (size > 0)
+  {
+    memcpy(info.value.data(), value, size);
+  }
+
+  list.push_back(info);
+}
+
+}
+
+RecordProducer::RecordProducer(const std::string &producer, const std::string &name)
+{
+  gentl=std::make_shared<GenTLWrapper>(producer);
+
+  if (gentl->GCInitLib() != GenTL::GC_ERR_SUCCESS)
+  {
+    throw std::invalid_argument("Cannot initialize producer: "+producer);
+  }
+
+  writer.reset(new SessionWriter(name));
+  start=std::chrono::steady_clock::now();
+
+  dev=0;
+  port=0;
+  xml_recorded=false;
+  xml_address=0;
+  xml_length=0;
+}
+
+RecordProducer::~RecordProducer()
+{
+  gentl->GCCloseLib();
+}
+
+void RecordProducer::recordXML(GenTL::PORT_HANDLE p, const std::string &url)
+{
+  std::vector<uint8_t> xml;
+
+  if (url.compare(0, 6, "local:") == 0 || url.compare(0, 6, "Local:") == 0)
+  {
+    // XML file is read from registers
+
+    size_t i=6;
+    if (url.compare(i, 3, "///") == 0)
+    {
+      i+=3;
+    }
+
+    std::stringstream in(url.substr(i));
+    std::string name, saddress, slength;
+
+    std::getline(in, name, ';');
+    std::getline(in, saddress, ';');
+    std::getline(in, slength, ';');
+
+    xml_address=std::stoull(saddress, 0, 16);
+    xml_length=static_cast<size_t>(std::stoull(slength, 0, 16));
+
+    xml.resize(xml_length);
+
+    size_t size=xml_length;
+    if (gentl->GCReadPort(p, xml_address, xml.data(), &size) != GenTL::GC_ERR_SUCCESS)
+    {
+      return;
+    }
+
+    xml.resize(size);
+  }
+  else if (url.compare(0, 5, "file:") == 0 || url.compare(0, 5, "File:") == 0)
+  {
+    // XML file is read from the file system
+
+    size_t i=5;
+    if (url.compare(i, 3, "///") == 0)
+    {
+      i+=3;
+    }
+
+    std::ifstream in(url.substr(i), std::ios::binary);
+    xml.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  else
+  {
+    return;
+  }
+
+  RecordData data;
+  data.putString(url);
+  data.putBytes(xml.data(), xml.size());
+
+  writer->write(REC_XML, data);
+
+  xml_recorded=true;
+}
+
+void RecordProducer::recordRegister(RecordType type, uint64_t address, const void *p,
+  size_t size)
+{
+  // reading of the XML file does not need to be recorded, since it is stored
+  // separately
+
+  if (xml_length > 0 && address >= xml_address && address+size <= xml_address+xml_length)
+  {
+    return;
+  }
+
+  RecordData data;
+  data.putUInt64(address);
+  data.putBytes(p, size);
+
+  writer->write(type, data);
+}
+
+void RecordProducer::recordBuffer(GenTL::DS_HANDLE stream, GenTL::BUFFER_HANDLE buffer)
+{
+  RecordedBuffer b;
+
+  b.time=static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now()-start).count());
+
+  // get pointer to data
+
+  GenTL::INFO_DATATYPE type=GenTL::INFO_DATATYPE_UNKNOWN;
+  uint8_t *base=0;
+  size_t size=sizeof(base);
+
+  if (gentl->DSGetBufferInfo(stream, buffer, GenTL::BUFFER_INFO_BASE, &type, &base, &size) !=
+      GenTL::GC_ERR_SUCCESS || base == 0)
+  {
+    return;
+  }
+
+  // record all information about the buffer, except those that depend on
+  // the memory or state of the buffer
+
+  uint8_t tmp[1024];
+
+  for (int32_t cmd=GenTL::BUFFER_INFO_BASE; cmd<=GenTL::BUFFER_INFO_IS_COMPOSITE; cmd++)
+  {
+    if (cmd == GenTL::BUFFER_INFO_BASE || cmd == GenTL::BUFFER_INFO_SIZE ||
+        cmd == GenTL::BUFFER_INFO_USER_PTR || cmd == GenTL::BUFFER_INFO_NEW_DATA ||
+        cmd == GenTL::BUFFER_INFO_IS_QUEUED || cmd == GenTL::BUFFER_INFO_IS_ACQUIRING)
+    {
+      continue;
+    }
+
+    size=sizeof(tmp);
+    if (gentl->DSGetBufferInfo(stream, buffer, cmd, &type, tmp, &size) == GenTL::GC_ERR_SUCCESS)
+    {
+      addInfo(b.info, cmd, type, tmp, size);
+    }
+  }
+
+  // record information about all parts
+
+  uint32_t n=0;
+  if (gentl->DSGetNumBufferParts(stream, buffer, &n) != GenTL::GC_ERR_SUCCESS)
+  {
+    n=0;
+  }
+
+  b.part_offset.resize(n, 0);
+  b.part_info.resize(n);
+
+  for (uint32_t i=0; i<n; i++)
+  {
+    uint8_t *pbase=0;
+    size=sizeof(pbase);
+
+    if (gentl->DSGetBufferPartInfo(stream, buffer, i, GenTL::BUFFER_PART_INFO_BASE, &type, &pbase,
+        &size) == GenTL::GC_ERR_SUCCESS && pbase >= base)
+    {
+      b.part_offset[i]=static_cast<uint64_t>(pbase-base);
+    }
+
+    for (int32_t cmd=GenTL::BUFFER_PART_INFO_DATA_SIZE;
+         cmd<=GenTL::BUFFER_PART_INFO_DATA_PURPOSE_ID; cmd++)
+    {
+      size=sizeof(tmp);
+      if (gentl->DSGetBufferPartInfo(stream, buffer, i, cmd, &type, tmp, &size) ==
+          GenTL::GC_ERR_SUCCESS)
+      {
+        addInfo(b.part_info[i], cmd, type, tmp, size);
+      }
+    }
+  }
+
+  // determine size of data
+
+  size_t filled=0, total=0;
+
+  size=sizeof(filled);
+  gentl->DSGetBufferInfo(stream, buffer, GenTL::BUFFER_INFO_SIZE_FILLED, &type, &filled, &size);
+
+  size=sizeof(total);
+  gentl->DSGetBufferInfo(stream, buffer, GenTL::BUFFER_INFO_SIZE, &type, &total, &size);
+
+  b.data_size=filled;
+  if (filled == 0 || filled > total)
+  {
+    b.data_size=total;
+  }
+
+  writer->writeBuffer(b, base);
+}
+
+GenTL::GC_ERROR RecordProducer::GCGetLastError(GenTL::GC_ERROR *piErrorCode, char *sErrText,
+  size_t *piSize)
+{
+  return gentl->GCGetLastError(piErrorCode, sErrText, piSize);
+}
+
+GenTL::GC_ERROR RecordProducer::GCReadPort(GenTL::PORT_HANDLE hPort, uint64_t iAddress,
+  void *pBuffer, size_t *piSize)
+{
+  GenTL::GC_ERROR err=gentl->GCReadPort(hPort, iAddress, pBuffer, piSize);
+
+  if (err == GenTL::GC_ERR_SUCCESS && hPort == port && port != 0)
+  {
+    recordRegister(REC_READ, iAddress, pBuffer, *piSize);
+  }
+
+  return err;
+}
+
+GenTL::GC_ERROR RecordProducer::GCWritePort(GenTL::PORT_HANDLE hPort, uint64_t iAddress,
+  const void *pBuffer, size_t *piSize)
+{
+  GenTL::GC_ERROR err=gentl->GCWritePort(hPort, iAddress, pBuffer, piSize);
+
+  if (err == GenTL::GC_ERR_SUCCESS && hPort == port && port != 0)
+  {
+    recordRegister(REC_WRITE, iAddress, pBuffer, *piSize);
+  }
+
+  return err;
+}
+
+GenTL::GC_ERROR RecordProducer::GCReadPortStacked(GenTL::PORT_HANDLE hPort,
+  GenTL::PORT_REGISTER_STACK_ENTRY *pEntries, size_t *piNumEntries)
+{
+  GenTL::GC_ERROR err=gentl->GCReadPortStacked(hPort, pEntries, piNumEntries);
+
+  if (err == GenTL::GC_ERR_SUCCESS && hPort == port && port != 0)
+  {
+    for (size_t i=0; i<*piNumEntries; i++)
+    {
+      recordRegister(REC_READ, pEntries[i].Address, pEntries[i].pBuffer, pEntries[i].Size);
+    }
+  }
+
+  return err;
+}
+
+GenTL::GC_ERROR RecordProducer::GCWritePortStacked(GenTL::PORT_HANDLE hPort,
+  GenTL::PORT_REGISTER_STACK_ENTRY *pEntries, size_t *piNumEntries)
+{
+  GenTL::GC_ERROR err=gentl->GCWritePortStacked(hPort, pEntries, piNumEntries);
+
+  if (err == GenTL::GC_ERR_SUCCESS && hPort == port && port != 0)
+  {
+    for (size_t i=0; i<*piNumEntries; i++)
+    {
+      recordRegister(REC_WRITE, pEntries[i].Address, pEntries[i].pBuffer, pEntries[i].Size);
+    }
+  }
+
+  return err;
+}
+
+GenTL::GC_ERROR RecordProducer::GCGetPortURL(GenTL::PORT_HANDLE hPort, char *sURL,
+  size_t *piSize)
+{
+  GenTL::GC_ERROR err=gentl->GCGetPortURL(hPort, sURL, piSize);
+
+  std::lock_guard<std::mutex> lock(mtx);
+
+  if (err == GenTL::GC_ERR_SUCCESS && hPort == port && port != 0 && sURL != 0 && !xml_recorded)
+  {
+    recordXML(hPort, sURL);
+  }
+
+  return err;
+}
+
+GenTL::GC_ERROR RecordProducer::GCGetPortURLInfo(GenTL::PORT_HANDLE hPort, uint32_t iURLIndex,
+  GenTL::URL_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  GenTL::GC_ERROR err=gentl->GCGetPortURLInfo(hPort, iURLIndex, iInfoCmd, piType, pBuffer,
+    piSize);
+
+  std::lock_guard<std::mutex> lock(mtx);
+
+  if (err == GenTL::GC_ERR_SUCCESS && hPort == port && port != 0 && pBuffer != 0 &&
+      iInfoCmd == GenTL::URL_INFO_URL && !xml_recorded)
+  {
+    recordXML(hPort, static_cast<const char *>(pBuffer));
+  }
+
+  return err;
+}
+
+GenTL::GC_ERROR RecordProducer::GCRegisterEvent(GenTL::EVENTSRC_HANDLE hEventSrc,
+  GenTL::EVENT_TYPE iEventID, GenTL::EVENT_HANDLE *phEvent)
+{
+  GenTL::GC_ERROR err=gentl->GCRegisterEvent(hEventSrc, iEventID, phEvent);
+
+  std::lock_guard<std::mutex> lock(mtx);
+
+  if (err == GenTL::GC_ERR_SUCCESS && iEventID == GenTL::EVENT_NEW_BUFFER &&
+      stream_device.find(hEventSrc) != stream_device.end())
+  {
+    event_stream[*phEvent]=hEventSrc;
+  }
+
+  return err;
+}
+
+GenTL::GC_ERROR RecordProducer::GCUnregisterEvent(GenTL::EVENTSRC_HANDLE hEventSrc,
+  GenTL::EVENT_TYPE iEventID)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+
+  if (iEventID == GenTL::EVENT_NEW_BUFFER)
+  {
+    for (auto it=event_stream.begin(); it!=event_stream.end(); ++it)
+    {
+      if (it->second == hEventSrc)
+      {
+        event_stream.erase(it);
+        break;
+      }
+    }
+  }
+
+  return gentl->GCUnregisterEvent(hEventSrc, iEventID);
+}
+
+GenTL::GC_ERROR RecordProducer::EventGetData(GenTL::EVENT_HANDLE hEvent, void *pBuffer,
+  size_t *piSize, uint64_t iTimeout)
+{
+  GenTL::GC_ERROR err=gentl->EventGetData(hEvent, pBuffer, piSize, iTimeout);
+
+  if (err == GenTL::GC_ERR_SUCCESS)
+  {
+    GenTL::DS_HANDLE stream=0;
+
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+
+      auto it=event_stream.find(hEvent);
+      if (it != event_stream.end())
+      {
+        stream=it->second;
+      }
+    }
+
+    if (stream != 0)
+    {
+      recordBuffer(stream, static_cast<GenTL::EVENT_NEW_BUFFER_DATA *>(pBuffer)->BufferHandle);
+    }
+  }
+
+  return err;
+}
+
+GenTL::GC_ERROR RecordProducer::TLOpen(GenTL::TL_HANDLE *phTL)
+{
+  GenTL::GC_ERROR err=gentl->TLOpen(phTL);
+
+  if (err == GenTL::GC_ERR_SUCCESS)
+  {
+    std::vector<RecordedInfo> list;
+
+    for (int32_t cmd=GenTL::TL_INFO_ID; cmd<=GenTL::TL_INFO_DISPLAYNAME; cmd++)
+    {
+      char tmp[1024]="";
+      size_t size=sizeof(tmp);
+      GenTL::INFO_DATATYPE type;
+
+      if (gentl->TLGetInfo(*phTL, cmd, &type, tmp, &size) == GenTL::GC_ERR_SUCCESS)
+      {
+        addInfo(list, cmd, type, tmp, size);
+      }
+    }
+
+    RecordData data;
+    data.putInfo(list);
+    writer->write(REC_SYSTEM, data);
+  }
+
+  return err;
+}
+
+GenTL::GC_ERROR RecordProducer::IFOpenDevice(GenTL::IF_HANDLE hIface, const char *sDeviceID,
+  GenTL::DEVICE_ACCESS_FLAGS iOpenFlag, GenTL::DEV_HANDLE *phDevice)
+{
+  GenTL::GC_ERROR err=gentl->IFOpenDevice(hIface, sDeviceID, iOpenFlag, phDevice);
+
+  std::lock_guard<std::mutex> lock(mtx);
+
+  if (err == GenTL::GC_ERR_SUCCESS && dev == 0)
+  {
+    // only the first device that is opened is recorded
+
+    dev=*phDevice;
+
+    std::vector<RecordedInfo> list;
+
+    for (int32_t cmd=GenTL::DEVICE_INFO_ID; cmd<=GenTL::DEVICE_INFO_TIMESTAMP_FREQUENCY; cmd++)
+    {
+      if (cmd == GenTL::DEVICE_INFO_ACCESS_STATUS)
+      {
+        continue;
+      }
+
+      uint8_t tmp[1024];
+      size_t size=sizeof(tmp);
+      GenTL::INFO_DATATYPE type;
+
+      if (gentl->DevGetInfo(dev, cmd, &type, tmp, &size) == GenTL::GC_ERR_SUCCESS)
+      {
+        addInfo(list, cmd, type, tmp, size);
+      }
+    }
+
+    RecordData data;
+    data.putInfo(list);
+    writer->write(REC_DEVICE, data);
+  }
+
+  return err;
+}
+
+GenTL::GC_ERROR RecordProducer::DevClose(GenTL::DEV_HANDLE hDevice)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+
+  if (hDevice == dev)
+  {
+    port=0;
+  }
+
+  return gentl->DevClose(hDevice);
+}
+
+GenTL::GC_ERROR RecordProducer::DevGetPort(GenTL::DEV_HANDLE hDevice,
+  GenTL::PORT_HANDLE *phRemoteDevice)
+{
+  GenTL::GC_ERROR err=gentl->DevGetPort(hDevice, phRemoteDevice);
+
+  std::lock_guard<std::mutex> lock(mtx);
+
+  if (err == GenTL::GC_ERR_SUCCESS && hDevice == dev)
+  {
+    port=*phRemoteDevice;
+  }
+
+  return err;
+}
+
+GenTL::GC_ERROR RecordProducer::DevOpenDataStream(GenTL::DEV_HANDLE hDevice,
+  const char *sDataStreamID, GenTL::DS_HANDLE *phDataStream)
+{
+  GenTL::GC_ERROR err=gentl->DevOpenDataStream(hDevice, sDataStreamID, phDataStream);
+
+  std::lock_guard<std::mutex> lock(mtx);
+
+  if (err == GenTL::GC_ERR_SUCCESS && hDevice == dev)
+  {
+    stream_device[*phDataStream]=hDevice;
+  }
+
+  return err;
+}
+
+GenTL::GC_ERROR RecordProducer::DSClose(GenTL::DS_HANDLE hDataStream)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+
+  stream_device.erase(hDataStream);
+
+  for (auto it=event_stream.begin(); it!=event_stream.end(); )
+  {
+    if (it->second == hDataStream)
+    {
+      it=event_stream.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  return gentl->DSClose(hDataStream);
+}
+
+// all other functions are just forwarded
+
+GenTL::GC_ERROR RecordProducer::GCGetInfo(GenTL::TL_INFO_CMD iInfoCmd,
+  GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return gentl->GCGetInfo(iInfoCmd, piType, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR RecordProducer::GCGetPortInfo(GenTL::PORT_HANDLE hPort,
+  GenTL::PORT_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return gentl->GCGetPortInfo(hPort, iInfoCmd, piType, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR RecordProducer::EventGetDataInfo(GenTL::EVENT_HANDLE hEvent, const void *pInBuffer,
+  size_t iInSize, GenTL::EVENT_DATA_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType,
+  void *pOutBuffer, size_t *piOutSize)
+{
+  return gentl->EventGetDataInfo(hEvent, pInBuffer, iInSize, iInfoCmd, piType, pOutBuffer,
+    piOutSize);
+}
+
+GenTL::GC_ERROR RecordProducer::EventGetInfo(GenTL::EVENT_HANDLE hEvent,
+  GenTL::EVENT_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return gentl->EventGetInfo(hEvent, iInfoCmd, piType, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR RecordProducer::EventFlush(GenTL::EVENT_HANDLE hEvent)
+{
+  return gentl->EventFlush(hEvent);
+}
+
+GenTL::GC_ERROR RecordProducer::EventKill(GenTL::EVENT_HANDLE hEvent)
+{
+  return gentl->EventKill(hEvent);
+}
+
+GenTL::GC_ERROR RecordProducer::TLClose(GenTL::TL_HANDLE hTL)
+{
+  return gentl->TLClose(hTL);
+}
+
+GenTL::GC_ERROR RecordProducer::TLGetInfo(GenTL::TL_HANDLE hTL, GenTL::TL_INFO_CMD iInfoCmd,
+  GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return gentl->TLGetInfo(hTL, iInfoCmd, piType, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR RecordProducer::TLGetNumInterfaces(GenTL::TL_HANDLE hTL, uint32_t *piNumIfaces)
+{
+  return gentl->TLGetNumInterfaces(hTL, piNumIfaces);
+}
+
+GenTL::GC_ERROR RecordProducer::TLGetInterfaceID(GenTL::TL_HANDLE hTL, uint32_t iIndex, char *sID,
+  size_t *piSize)
+{
+  return gentl->TLGetInterfaceID(hTL, iIndex, sID, piSize);
+}
+
+GenTL::GC_ERROR RecordProducer::TLGetInterfaceInfo(GenTL::TL_HANDLE hTL, const char *sIfaceID,
+  GenTL::INTERFACE_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return gentl->TLGetInterfaceInfo(hTL, sIfaceID, iInfoCmd, piType, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR RecordProducer::TLOpenInterface(GenTL::TL_HANDLE hTL, const char *sIfaceID,
+  GenTL::IF_HANDLE *phIface)
+{
+  return gentl->TLOpenInterface(hTL, sIfaceID, phIface);
+}
+
+GenTL::GC_ERROR RecordProducer::TLUpdateInterfaceList(GenTL::TL_HANDLE hTL, bool8_t *pbChanged,
+  uint64_t iTimeout)
+{
+  return gentl->TLUpdateInterfaceList(hTL, pbChanged, iTimeout);
+}
+
+GenTL::GC_ERROR RecordProducer::IFClose(GenTL::IF_HANDLE hIface)
+{
+  return gentl->IFClose(hIface);
+}
+
+GenTL::GC_ERROR RecordProducer::IFGetInfo(GenTL::IF_HANDLE hIface,
+  GenTL::INTERFACE_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return gentl->IFGetInfo(hIface, iInfoCmd, piType, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR RecordProducer::IFGetNumDevices(GenTL::IF_HANDLE hIface, uint32_t *piNumDevices)
+{
+  return gentl->IFGetNumDevices(hIface, piNumDevices);
+}
+
+GenTL::GC_ERROR RecordProducer::IFGetDeviceID(GenTL::IF_HANDLE hIface, uint32_t iIndex,
+  char *sIDeviceID, size_t *piSize)
+{
+  return gentl->IFGetDeviceID(hIface, iIndex, sIDeviceID, piSize);
+}
+
+GenTL::GC_ERROR RecordProducer::IFUpdateDeviceList(GenTL::IF_HANDLE hIface, bool8_t *pbChanged,
+  uint64_t iTimeout)
+{
+  return gentl->IFUpdateDeviceList(hIface, pbChanged, iTimeout);
+}
+
+GenTL::GC_ERROR RecordProducer::IFGetDeviceInfo(GenTL::IF_HANDLE hIface, const char *sDeviceID,
+  GenTL::DEVICE_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return gentl->IFGetDeviceInfo(hIface, sDeviceID, iInfoCmd, piType, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR RecordProducer::DevGetNumDataStreams(GenTL::DEV_HANDLE hDevice,
+  uint32_t *piNumDataStreams)
+{
+  return gentl->DevGetNumDataStreams(hDevice, piNumDataStreams);
+}
+
+GenTL::GC_ERROR RecordProducer::DevGetDataStreamID(GenTL::DEV_HANDLE hDevice, uint32_t iIndex,
+  char *sDataStreamID, size_t *piSize)
+{
+  return gentl->DevGetDataStreamID(hDevice, iIndex, sDataStreamID, piSize);
+}
+
+GenTL::GC_ERROR RecordProducer::DevGetInfo(GenTL::DEV_HANDLE hDevice,
+  GenTL::DEVICE_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return gentl->DevGetInfo(hDevice, iInfoCmd, piType, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR RecordProducer::DSAnnounceBuffer(GenTL::DS_HANDLE hDataStream, void *pBuffer,
+  size_t iSize, void *pPrivate, GenTL::BUFFER_HANDLE *phBuffer)
+{
+  return gentl->DSAnnounceBuffer(hDataStream, pBuffer, iSize, pPrivate, phBuffer);
+}
+
+GenTL::GC_ERROR RecordProducer::DSAllocAndAnnounceBuffer(GenTL::DS_HANDLE hDataStream,
+  size_t iSize, void *pPrivate, GenTL::BUFFER_HANDLE *phBuffer)
+{
+  return gentl->DSAllocAndAnnounceBuffer(hDataStream, iSize, pPrivate, phBuffer);
+}
+
+GenTL::GC_ERROR RecordProducer::DSFlushQueue(GenTL::DS_HANDLE hDataStream,
+  GenTL::ACQ_QUEUE_TYPE iOperation)
+{
+  return gentl->DSFlushQueue(hDataStream, iOperation);
+}
+
+GenTL::GC_ERROR RecordProducer::DSStartAcquisition(GenTL::DS_HANDLE hDataStream,
+  GenTL::ACQ_START_FLAGS iStartFlags, uint64_t iNumToAcquire)
+{
+  return gentl->DSStartAcquisition(hDataStream, iStartFlags, iNumToAcquire);
+}
+
+GenTL::GC_ERROR RecordProducer::DSStopAcquisition(GenTL::DS_HANDLE hDataStream,
+  GenTL::ACQ_STOP_FLAGS iStopFlags)
+{
+  return gentl->DSStopAcquisition(hDataStream, iStopFlags);
+}
+
+GenTL::GC_ERROR RecordProducer::DSGetInfo(GenTL::DS_HANDLE hDataStream,
+  GenTL::STREAM_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return gentl->DSGetInfo(hDataStream, iInfoCmd, piType, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR RecordProducer::DSGetBufferID(GenTL::DS_HANDLE hDataStream, uint32_t iIndex,
+  GenTL::BUFFER_HANDLE *phBuffer)
+{
+  return gentl->DSGetBufferID(hDataStream, iIndex, phBuffer);
+}
+
+GenTL::GC_ERROR RecordProducer::DSRevokeBuffer(GenTL::DS_HANDLE hDataStream,
+  GenTL::BUFFER_HANDLE hBuffer, void **pBuffer, void **pPrivate)
+{
+  return gentl->DSRevokeBuffer(hDataStream, hBuffer, pBuffer, pPrivate);
+}
+
+GenTL::GC_ERROR RecordProducer::DSQueueBuffer(GenTL::DS_HANDLE hDataStream,
+  GenTL::BUFFER_HANDLE hBuffer)
+{
+  return gentl->DSQueueBuffer(hDataStream, hBuffer);
+}
+
+GenTL::GC_ERROR RecordProducer::DSGetBufferInfo(GenTL::DS_HANDLE hDataStream,
+  GenTL::BUFFER_HANDLE hBuffer, GenTL::BUFFER_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType,
+  void *pBuffer, size_t *piSize)
+{
+  return gentl->DSGetBufferInfo(hDataStream, hBuffer, iInfoCmd, piType, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR RecordProducer::GCGetNumPortURLs(GenTL::PORT_HANDLE hPort, uint32_t *piNumURLs)
+{
+  return gentl->GCGetNumPortURLs(hPort, piNumURLs);
+}
+
+GenTL::GC_ERROR RecordProducer::DSGetBufferChunkData(GenTL::DS_HANDLE hDataStream,
+  GenTL::BUFFER_HANDLE hBuffer, GenTL::SINGLE_CHUNK_DATA *pChunkData, size_t *piNumChunks)
+{
+  return gentl->DSGetBufferChunkData(hDataStream, hBuffer, pChunkData, piNumChunks);
+}
+
+GenTL::GC_ERROR RecordProducer::IFGetParentTL(GenTL::IF_HANDLE hIface, GenTL::TL_HANDLE *phSystem)
+{
+  return gentl->IFGetParentTL(hIface, phSystem);
+}
+
+GenTL::GC_ERROR RecordProducer::DevGetParentIF(GenTL::DEV_HANDLE hDevice, GenTL::IF_HANDLE *phIface)
+{
+  return gentl->DevGetParentIF(hDevice, phIface);
+}
+
+GenTL::GC_ERROR RecordProducer::DSGetParentDev(GenTL::DS_HANDLE hDataStream,
+  GenTL::DEV_HANDLE *phDevice)
+{
+  return gentl->DSGetParentDev(hDataStream, phDevice);
+}
+
+GenTL::GC_ERROR RecordProducer::DSGetNumBufferParts(GenTL::DS_HANDLE hDataStream,
+  GenTL::BUFFER_HANDLE hBuffer, uint32_t *piNumParts)
+{
+  return gentl->DSGetNumBufferParts(hDataStream, hBuffer, piNumParts);
+}
+
+GenTL::GC_ERROR RecordProducer::DSGetBufferPartInfo(GenTL::DS_HANDLE hDataStream,
+  GenTL::BUFFER_HANDLE hBuffer, uint32_t iPartIndex, GenTL::BUFFER_PART_INFO_CMD iInfoCmd,
+  GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  return gentl->DSGetBufferPartInfo(hDataStream, hBuffer, iPartIndex, iInfoCmd, piType, pBuffer,
+    piSize);
+}
+}
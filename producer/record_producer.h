@@ -0,0 +1,246 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RC_GENICAM_API_RECORD_PRODUCER
+#define RC_GENICAM_API_RECORD_PRODUCER
+
+#include "gentl_producer.h"
+#include "session.h"
+
+#include <rc_genicam_api/gentl_wrapper.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace rcg
+{
+
+/**
+  Producer that loads another producer and forwards all calls to it. The
+  GenICam XML file, all register accesses and all delivered buffers of the
+  first device that is opened are stored in a recording, which can later be
+  replayed by the ReplayProducer.
+*/
+
+class RecordProducer : public GenTLProducer
+{
+  public:
+
+    /**
+      Loads the given producer and creates the recording.
+
+      @param producer Path and name of the producer that should be recorded.
+      @param name     Name of recording file.
+    */
+
+    RecordProducer(const std::string &producer, const std::string &name);
+    virtual ~RecordProducer();
+
+    GenTL::GC_ERROR GCGetInfo(GenTL::TL_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType,
+      void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR GCGetLastError(GenTL::GC_ERROR *piErrorCode, char *sErrText, size_t *piSize);
+
+    GenTL::GC_ERROR GCReadPort(GenTL::PORT_HANDLE hPort, uint64_t iAddress, void *pBuffer,
+      size_t *piSize);
+
+    GenTL::GC_ERROR GCWritePort(GenTL::PORT_HANDLE hPort, uint64_t iAddress, const void *pBuffer,
+      size_t *piSize);
+
+    GenTL::GC_ERROR GCGetPortURL(GenTL::PORT_HANDLE hPort, char *sURL, size_t *piSize);
+
+    GenTL::GC_ERROR GCGetPortInfo(GenTL::PORT_HANDLE hPort, GenTL::PORT_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR GCRegisterEvent(GenTL::EVENTSRC_HANDLE hEventSrc, GenTL::EVENT_TYPE iEventID,
+      GenTL::EVENT_HANDLE *phEvent);
+
+    GenTL::GC_ERROR GCUnregisterEvent(GenTL::EVENTSRC_HANDLE hEventSrc, GenTL::EVENT_TYPE iEventID);
+
+    GenTL::GC_ERROR EventGetData(GenTL::EVENT_HANDLE hEvent, void *pBuffer, size_t *piSize,
+      uint64_t iTimeout);
+
+    GenTL::GC_ERROR EventGetDataInfo(GenTL::EVENT_HANDLE hEvent, const void *pInBuffer,
+      size_t iInSize, GenTL::EVENT_DATA_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType,
+      void *pOutBuffer, size_t *piOutSize);
+
+    GenTL::GC_ERROR EventGetInfo(GenTL::EVENT_HANDLE hEvent, GenTL::EVENT_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR EventFlush(GenTL::EVENT_HANDLE hEvent);
+
+    GenTL::GC_ERROR EventKill(GenTL::EVENT_HANDLE hEvent);
+
+    GenTL::GC_ERROR TLOpen(GenTL::TL_HANDLE *phTL);
+
+    GenTL::GC_ERROR TLClose(GenTL::TL_HANDLE hTL);
+
+    GenTL::GC_ERROR TLGetInfo(GenTL::TL_HANDLE hTL, GenTL::TL_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR TLGetNumInterfaces(GenTL::TL_HANDLE hTL, uint32_t *piNumIfaces);
+
+    GenTL::GC_ERROR TLGetInterfaceID(GenTL::TL_HANDLE hTL, uint32_t iIndex, char *sID,
+      size_t *piSize);
+
+    GenTL::GC_ERROR TLGetInterfaceInfo(GenTL::TL_HANDLE hTL, const char *sIfaceID,
+      GenTL::INTERFACE_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer,
+      size_t *piSize);
+
+    GenTL::GC_ERROR TLOpenInterface(GenTL::TL_HANDLE hTL, const char *sIfaceID,
+      GenTL::IF_HANDLE *phIface);
+
+    GenTL::GC_ERROR TLUpdateInterfaceList(GenTL::TL_HANDLE hTL, bool8_t *pbChanged,
+      uint64_t iTimeout);
+
+    GenTL::GC_ERROR IFClose(GenTL::IF_HANDLE hIface);
+
+    GenTL::GC_ERROR IFGetInfo(GenTL::IF_HANDLE hIface, GenTL::INTERFACE_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR IFGetNumDevices(GenTL::IF_HANDLE hIface, uint32_t *piNumDevices);
+
+    GenTL::GC_ERROR IFGetDeviceID(GenTL::IF_HANDLE hIface, uint32_t iIndex, char *sIDeviceID,
+      size_t *piSize);
+
+    GenTL::GC_ERROR IFUpdateDeviceList(GenTL::IF_HANDLE hIface, bool8_t *pbChanged,
+      uint64_t iTimeout);
+
+    GenTL::GC_ERROR IFGetDeviceInfo(GenTL::IF_HANDLE hIface, const char *sDeviceID,
+      GenTL::DEVICE_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR IFOpenDevice(GenTL::IF_HANDLE hIface, const char *sDeviceID,
+      GenTL::DEVICE_ACCESS_FLAGS iOpenFlag, GenTL::DEV_HANDLE *phDevice);
+
+    GenTL::GC_ERROR DevGetPort(GenTL::DEV_HANDLE hDevice, GenTL::PORT_HANDLE *phRemoteDevice);
+
+    GenTL::GC_ERROR DevGetNumDataStreams(GenTL::DEV_HANDLE hDevice, uint32_t *piNumDataStreams);
+
+    GenTL::GC_ERROR DevGetDataStreamID(GenTL::DEV_HANDLE hDevice, uint32_t iIndex,
+      char *sDataStreamID, size_t *piSize);
+
+    GenTL::GC_ERROR DevOpenDataStream(GenTL::DEV_HANDLE hDevice, const char *sDataStreamID,
+      GenTL::DS_HANDLE *phDataStream);
+
+    GenTL::GC_ERROR DevGetInfo(GenTL::DEV_HANDLE hDevice, GenTL::DEVICE_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR DevClose(GenTL::DEV_HANDLE hDevice);
+
+    GenTL::GC_ERROR DSAnnounceBuffer(GenTL::DS_HANDLE hDataStream, void *pBuffer, size_t iSize,
+      void *pPrivate, GenTL::BUFFER_HANDLE *phBuffer);
+
+    GenTL::GC_ERROR DSAllocAndAnnounceBuffer(GenTL::DS_HANDLE hDataStream, size_t iSize,
+      void *pPrivate, GenTL::BUFFER_HANDLE *phBuffer);
+
+    GenTL::GC_ERROR DSFlushQueue(GenTL::DS_HANDLE hDataStream, GenTL::ACQ_QUEUE_TYPE iOperation);
+
+    GenTL::GC_ERROR DSStartAcquisition(GenTL::DS_HANDLE hDataStream,
+      GenTL::ACQ_START_FLAGS iStartFlags, uint64_t iNumToAcquire);
+
+    GenTL::GC_ERROR DSStopAcquisition(GenTL::DS_HANDLE hDataStream,
+      GenTL::ACQ_STOP_FLAGS iStopFlags);
+
+    GenTL::GC_ERROR DSGetInfo(GenTL::DS_HANDLE hDataStream, GenTL::STREAM_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR DSGetBufferID(GenTL::DS_HANDLE hDataStream, uint32_t iIndex,
+      GenTL::BUFFER_HANDLE *phBuffer);
+
+    GenTL::GC_ERROR DSClose(GenTL::DS_HANDLE hDataStream);
+
+    GenTL::GC_ERROR DSRevokeBuffer(GenTL::DS_HANDLE hDataStream, GenTL::BUFFER_HANDLE hBuffer,
+      void **pBuffer, void **pPrivate);
+
+    GenTL::GC_ERROR DSQueueBuffer(GenTL::DS_HANDLE hDataStream, GenTL::BUFFER_HANDLE hBuffer);
+
+    GenTL::GC_ERROR DSGetBufferInfo(GenTL::DS_HANDLE hDataStream, GenTL::BUFFER_HANDLE hBuffer,
+      GenTL::BUFFER_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR GCGetNumPortURLs(GenTL::PORT_HANDLE hPort, uint32_t *piNumURLs);
+
+    GenTL::GC_ERROR GCGetPortURLInfo(GenTL::PORT_HANDLE hPort, uint32_t iURLIndex,
+      GenTL::URL_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR GCReadPortStacked(GenTL::PORT_HANDLE hPort,
+      GenTL::PORT_REGISTER_STACK_ENTRY *pEntries, size_t *piNumEntries);
+
+    GenTL::GC_ERROR GCWritePortStacked(GenTL::PORT_HANDLE hPort,
+      GenTL::PORT_REGISTER_STACK_ENTRY *pEntries, size_t *piNumEntries);
+
+    GenTL::GC_ERROR DSGetBufferChunkData(GenTL::DS_HANDLE hDataStream,
+      GenTL::BUFFER_HANDLE hBuffer, GenTL::SINGLE_CHUNK_DATA *pChunkData, size_t *piNumChunks);
+
+    GenTL::GC_ERROR IFGetParentTL(GenTL::IF_HANDLE hIface, GenTL::TL_HANDLE *phSystem);
+
+    GenTL::GC_ERROR DevGetParentIF(GenTL::DEV_HANDLE hDevice, GenTL::IF_HANDLE *phIface);
+
+    GenTL::GC_ERROR DSGetParentDev(GenTL::DS_HANDLE hDataStream, GenTL::DEV_HANDLE *phDevice);
+
+    GenTL::GC_ERROR DSGetNumBufferParts(GenTL::DS_HANDLE hDataStream, GenTL::BUFFER_HANDLE hBuffer,
+      uint32_t *piNumParts);
+
+    GenTL::GC_ERROR DSGetBufferPartInfo(GenTL::DS_HANDLE hDataStream, GenTL::BUFFER_HANDLE hBuffer,
+      uint32_t iPartIndex, GenTL::BUFFER_PART_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType,
+      void *pBuffer, size_t *piSize);
+
+  private:
+
+    RecordProducer(const RecordProducer &); // forbidden
+    RecordProducer &operator=(const RecordProducer &); // forbidden
+
+    void recordXML(GenTL::PORT_HANDLE port, const std::string &url);
+    void recordRegister(RecordType type, uint64_t address, const void *data, size_t size);
+    void recordBuffer(GenTL::DS_HANDLE stream, GenTL::BUFFER_HANDLE buffer);
+
+    std::shared_ptr<GenTLWrapper> gentl;
+    std::unique_ptr<SessionWriter> writer;
+    std::chrono::steady_clock::time_point start;
+
+    std::mutex mtx;
+    GenTL::DEV_HANDLE dev;
+    GenTL::PORT_HANDLE port;
+    bool xml_recorded;
+    uint64_t xml_address;
+    size_t xml_length;
+    std::map<GenTL::DS_HANDLE, GenTL::DEV_HANDLE> stream_device;
+    std::map<GenTL::EVENT_HANDLE, GenTL::DS_HANDLE> event_stream;
+};
+
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "record_producer.h"
+#include "replay_producer.h"
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace rcg
+{
+
+/*
+  The producer is configured by environment variables. If RC_REPLAY_RECORD is
+  set, then the producer given by RC_REPLAY_PRODUCER is loaded and everything
+  is recorded into the given file. Otherwise, if RC_REPLAY_FILE is set, the
+  recording is replayed. RC_REPLAY_SPEED can be 'original' (default) or
+  'max' and RC_REPLAY_LOOP defines the number of times that the recording is
+  replayed, with 0 for infinite. If nothing is set, then the producer does
+  not offer any devices.
+*/
+
+GenTLProducer *createProducer()
+{
+  const char *record=std::getenv("RC_REPLAY_RECORD");
+
+  if (record != 0 && record[0] != '\0')
+  {
+    const char *producer=std::getenv("RC_REPLAY_PRODUCER");
+
+    if (producer == 0 || producer[0] == '\0')
+    {
+      throw std::invalid_argument("RC_REPLAY_PRODUCER must be set for recording");
+    }
+
+    return new RecordProducer(producer, record);
+  }
+
+  const char *file=std::getenv("RC_REPLAY_FILE");
+
+  if (file != 0 && file[0] != '\0')
+  {
+    bool original=true;
+    uint32_t loops=1;
+
+    const char *speed=std::getenv("RC_REPLAY_SPEED");
+    if (speed != 0 && std::string(speed) == "max")
+    {
+      original=false;
+    }
+
+    const char *loop=std::getenv("RC_REPLAY_LOOP");
+    if (loop != 0 && loop[0] != '\0')
+    {
+      loops=static_cast<uint32_t>(std::stoul(loop));
+    }
+
+    return new ReplayProducer(std::make_shared<SessionReader>(file), original, loops);
+  }
+
+  return new SoftProducer("rc_replay", "Replay", "GEV");
+}
+
+}
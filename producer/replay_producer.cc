@@ -0,0 +1,356 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "replay_producer.h"
+
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+
+namespace rcg
+{
+
+namespace
+{
+
+/*
+  Computes the time that must be added to all buffers for each loop, i.e. the
+  recorded duration plus the mean time between two buffers.
+*/
+
+uint64_t getLoopPeriod(const SessionReader &rec, int32_t cmd)
+{
+  size_t n=rec.getNumBuffers();
+  uint64_t first=0, last=0;
+
+  if (n > 0)
+  {
+    if (cmd < 0)
+    {
+      first=rec.getBuffer(0).time;
+      last=rec.getBuffer(n-1).time;
+    }
+    else
+    {
+      first=getInfoValue<uint64_t>(rec.getBuffer(0).info, cmd, 0);
+      last=getInfoValue<uint64_t>(rec.getBuffer(n-1).info, cmd, 0);
+    }
+  }
+
+  if (last <= first)
+  {
+    return 0;
+  }
+
+  return last-first+(last-first)/(n-1);
+}
+
+}
+
+ReplayDevice::ReplayDevice(const std::shared_ptr<SessionReader> &_recording, bool _original,
+  uint32_t _loops) : recording(_recording), original(_original), loops(_loops)
+{
+  // initialize registers with the state of the device before streaming
+  // started, but also learn registers that were only accessed later
+
+  const std::vector<SessionReader::Register> &access=recording->getRegisterAccess();
+
+  for (size_t i=0; i<access.size(); i++)
+  {
+    setRegister(access[i].address, access[i].data.data(), access[i].data.size(),
+      !access[i].after_first_buffer);
+  }
+
+  // provide GenICam XML file at the original address, if it was read from
+  // registers, or at an address that is hopefully not used otherwise
+
+  std::string name="device.xml";
+  xml_url=recording->getXMLURL();
+  xml_address=0xfff0000000000000ull;
+
+  size_t i=xml_url.find(':');
+  if (i != std::string::npos)
+  {
+    i++;
+    if (xml_url.compare(i, 3, "///") == 0)
+    {
+      i+=3;
+    }
+
+    std::string path=xml_url.substr(i);
+
+    if (xml_url.compare(0, 6, "local:") == 0 || xml_url.compare(0, 6, "Local:") == 0)
+    {
+      std::stringstream in(path);
+      std::string saddress;
+
+      std::getline(in, name, ';');
+      std::getline(in, saddress, ';');
+
+      xml_address=std::stoull(saddress, 0, 16);
+    }
+    else
+    {
+      size_t k=path.find_last_of("/\\");
+      if (k != std::string::npos)
+      {
+        path=path.substr(k+1);
+      }
+
+      name=path;
+    }
+  }
+
+  const std::vector<uint8_t> &xml=recording->getXML();
+
+  if (xml.size() == 0)
+  {
+    throw std::invalid_argument("Recording does not contain a GenICam XML file");
+  }
+
+  setRegister(xml_address, xml.data(), xml.size(), true);
+
+  std::ostringstream out;
+  out << "local:" << name << ';' << std::hex << xml_address << ';' << xml.size();
+  xml_url=out.str();
+
+  // determine maximum size of buffers and periods for looping
+
+  payload_size=1;
+  for (size_t k=0; k<recording->getNumBuffers(); k++)
+  {
+    payload_size=std::max(payload_size, static_cast<size_t>(recording->getBuffer(k).data_size));
+  }
+
+  loop_time=getLoopPeriod(*recording, -1);
+  loop_timestamp=getLoopPeriod(*recording, GenTL::BUFFER_INFO_TIMESTAMP);
+  loop_timestamp_ns=getLoopPeriod(*recording, GenTL::BUFFER_INFO_TIMESTAMP_NS);
+
+  index=current=0;
+  loop=current_loop=0;
+}
+
+std::string ReplayDevice::getInfo(GenTL::DEVICE_INFO_CMD cmd)
+{
+  return getInfoString(recording->getDeviceInfo(), cmd);
+}
+
+uint64_t ReplayDevice::getTimestampFrequency()
+{
+  return getInfoValue<uint64_t>(recording->getDeviceInfo(), GenTL::DEVICE_INFO_TIMESTAMP_FREQUENCY,
+    1000000000ull);
+}
+
+std::string ReplayDevice::getXMLURL()
+{
+  return xml_url;
+}
+
+void ReplayDevice::setRegister(uint64_t address, const uint8_t *data, size_t size,
+  bool overwrite)
+{
+  for (size_t i=0; i<size; i++)
+  {
+    std::unique_ptr<Page> &page=reg[(address+i)>>12];
+
+    if (!page)
+    {
+      page.reset(new Page());
+      memset(page->data, 0, sizeof(page->data));
+      memset(page->known, 0, sizeof(page->known));
+    }
+
+    size_t k=static_cast<size_t>((address+i)&0xfff);
+
+    if (overwrite || !page->known[k])
+    {
+      page->data[k]=data[i];
+      page->known[k]=true;
+    }
+  }
+}
+
+GenTL::GC_ERROR ReplayDevice::readRegister(uint64_t address, void *buffer, size_t *size)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+
+  // registers that have never been accessed during recording are
+  // returned as 0
+
+  uint8_t *p=static_cast<uint8_t *>(buffer);
+
+  for (size_t i=0; i<*size; i++)
+  {
+    p[i]=0;
+
+    std::map<uint64_t, std::unique_ptr<Page> >::const_iterator it=reg.find((address+i)>>12);
+
+    if (it != reg.end())
+    {
+      p[i]=it->second->data[(address+i)&0xfff];
+    }
+  }
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR ReplayDevice::writeRegister(uint64_t address, const void *buffer, size_t *size)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+
+  setRegister(address, static_cast<const uint8_t *>(buffer), *size, true);
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+size_t ReplayDevice::getPayloadSize()
+{
+  return payload_size;
+}
+
+void ReplayDevice::startAcquisition()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+
+  index=0;
+  loop=0;
+  start=std::chrono::steady_clock::now();
+}
+
+bool ReplayDevice::prepareFrame(std::chrono::steady_clock::time_point &t, bool &wait_for_buffer)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+
+  size_t n=recording->getNumBuffers();
+
+  if (n == 0)
+  {
+    return false;
+  }
+
+  if (index >= n)
+  {
+    index=0;
+    loop++;
+  }
+
+  if (loops > 0 && loop >= loops)
+  {
+    return false;
+  }
+
+  current=index++;
+  current_loop=loop;
+
+  if (original)
+  {
+    uint64_t dt=recording->getBuffer(current).time-recording->getBuffer(0).time+
+      current_loop*loop_time;
+
+    t=start+std::chrono::nanoseconds(dt);
+    wait_for_buffer=false;
+  }
+  else
+  {
+    t=std::chrono::steady_clock::now();
+    wait_for_buffer=true;
+  }
+
+  return true;
+}
+
+void ReplayDevice::fillBuffer(SoftBuffer &buffer)
+{
+  const RecordedBuffer &b=recording->getBuffer(current);
+
+  size_t size=recording->readBufferData(current, buffer.getData(), buffer.getSize());
+
+  for (size_t i=0; i<b.info.size(); i++)
+  {
+    buffer.setInfo(b.info[i].cmd, static_cast<GenTL::INFO_DATATYPE>(b.info[i].type),
+      b.info[i].value.data(), b.info[i].value.size());
+  }
+
+  // adapt frame IDs and time stamps if the recording is replayed in a loop
+
+  if (current_loop > 0)
+  {
+    uint64_t v=getInfoValue<uint64_t>(b.info, GenTL::BUFFER_INFO_FRAMEID, 0);
+    buffer.setInfo(GenTL::BUFFER_INFO_FRAMEID, GenTL::INFO_DATATYPE_UINT64,
+      v+current_loop*recording->getNumBuffers());
+
+    v=getInfoValue<uint64_t>(b.info, GenTL::BUFFER_INFO_TIMESTAMP, 0);
+    buffer.setInfo(GenTL::BUFFER_INFO_TIMESTAMP, GenTL::INFO_DATATYPE_UINT64,
+      v+current_loop*loop_timestamp);
+
+    v=getInfoValue<uint64_t>(b.info, GenTL::BUFFER_INFO_TIMESTAMP_NS, 0);
+    buffer.setInfo(GenTL::BUFFER_INFO_TIMESTAMP_NS, GenTL::INFO_DATATYPE_UINT64,
+      v+current_loop*loop_timestamp_ns);
+  }
+
+  // report buffers that are too small
+
+  if (size < b.data_size)
+  {
+    buffer.setInfo(GenTL::BUFFER_INFO_SIZE_FILLED, GenTL::INFO_DATATYPE_SIZET, size);
+    buffer.setInfo(GenTL::BUFFER_INFO_IS_INCOMPLETE, GenTL::INFO_DATATYPE_BOOL8,
+      static_cast<bool8_t>(1));
+    buffer.setInfo(GenTL::BUFFER_INFO_DATA_LARGER_THAN_BUFFER, GenTL::INFO_DATATYPE_BOOL8,
+      static_cast<bool8_t>(1));
+  }
+
+  for (size_t i=0; i<b.part_info.size(); i++)
+  {
+    buffer.setPartOffset(static_cast<uint32_t>(i), static_cast<size_t>(b.part_offset[i]));
+
+    for (size_t k=0; k<b.part_info[i].size(); k++)
+    {
+      const RecordedInfo &info=b.part_info[i][k];
+
+      buffer.setPartInfo(static_cast<uint32_t>(i), info.cmd,
+        static_cast<GenTL::INFO_DATATYPE>(info.type), info.value.data(), info.value.size());
+    }
+  }
+}
+
+ReplayProducer::ReplayProducer(const std::shared_ptr<SessionReader> &recording, bool original,
+  uint32_t loops) :
+  SoftProducer("rc_replay", "Replay of "+getInfoString(recording->getSystemInfo(),
+    GenTL::TL_INFO_MODEL), getInfoString(recording->getSystemInfo(), GenTL::TL_INFO_TLTYPE))
+{
+  addDevice(std::make_shared<ReplayDevice>(recording, original, loops));
+}
+
+}
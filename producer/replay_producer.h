@@ -0,0 +1,136 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RC_GENICAM_API_REPLAY_PRODUCER
+#define RC_GENICAM_API_REPLAY_PRODUCER
+
+#include "soft_producer.h"
+#include "session.h"
+
+namespace rcg
+{
+
+/**
+  Model of a device that replays a recording. The register state of the
+  device is initialized from the register accesses of the recording. The
+  consumer can change it by writing registers, but this has no effect on
+  the replayed buffers.
+*/
+
+class ReplayDevice : public SoftDevice
+{
+  public:
+
+    /**
+      Creates the device.
+
+      @param recording Recording that should be replayed.
+      @param original  True for replaying with the original timing, false
+                       for replaying as fast as the consumer requeues
+                       buffers.
+      @param loops     Number of times that the recording is replayed or 0
+                       for infinite.
+    */
+
+    ReplayDevice(const std::shared_ptr<SessionReader> &recording, bool original,
+      uint32_t loops);
+
+    std::string getInfo(GenTL::DEVICE_INFO_CMD cmd);
+    uint64_t getTimestampFrequency();
+
+    std::string getXMLURL();
+
+    GenTL::GC_ERROR readRegister(uint64_t address, void *buffer, size_t *size);
+    GenTL::GC_ERROR writeRegister(uint64_t address, const void *buffer, size_t *size);
+
+    size_t getPayloadSize();
+
+    void startAcquisition();
+    bool prepareFrame(std::chrono::steady_clock::time_point &t, bool &wait_for_buffer);
+    void fillBuffer(SoftBuffer &buffer);
+
+  private:
+
+    void setRegister(uint64_t address, const uint8_t *data, size_t size, bool overwrite);
+
+    std::shared_ptr<SessionReader> recording;
+    bool original;
+    uint32_t loops;
+
+    std::mutex mtx;
+
+    struct Page
+    {
+      uint8_t data[4096];
+      bool known[4096];
+    };
+
+    std::map<uint64_t, std::unique_ptr<Page> > reg;
+    uint64_t xml_address;
+    std::string xml_url;
+
+    size_t payload_size;
+    uint64_t loop_time, loop_timestamp, loop_timestamp_ns;
+
+    size_t index, current;
+    uint32_t loop, current_loop;
+    std::chrono::steady_clock::time_point start;
+};
+
+/**
+  Producer that offers one device that replays a recording.
+*/
+
+class ReplayProducer : public SoftProducer
+{
+  public:
+
+    /**
+      Creates the producer.
+
+      @param recording Recording that should be replayed.
+      @param original  True for replaying with original timing, false for
+                       replaying as fast as possible.
+      @param loops     Number of times that the recording is replayed or 0
+                       for infinite.
+    */
+
+    ReplayProducer(const std::shared_ptr<SessionReader> &recording, bool original,
+      uint32_t loops);
+};
+
+}
+
+#endif
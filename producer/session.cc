@@ -0,0 +1,389 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "session.h"
+
+#include <stdexcept>
+#include <algorithm>
+
+namespace rcg
+{
+
+void RecordData::putUInt32(uint32_t v)
+{
+  for (int i=0; i<4; i++)
+  {
+    data.push_back(static_cast<uint8_t>(v>>(8*i)));
+  }
+}
+
+void RecordData::putUInt64(uint64_t v)
+{
+  for (int i=0; i<8; i++)
+  {
+    data.push_back(static_cast<uint8_t>(v>>(8*i)));
+  }
+}
+
+void RecordData::putString(const std::string &s)
+{
+  putUInt32(static_cast<uint32_t>(s.size()));
+  putBytes(s.c_str(), s.size());
+}
+
+void RecordData::putBytes(const void *p, size_t n)
+{
+  const uint8_t *b=static_cast<const uint8_t *>(p);
+  data.insert(data.end(), b, b+n);
+}
+
+void RecordData::putInfo(const std::vector<RecordedInfo> &info)
+{
+  putUInt32(static_cast<uint32_t>(info.size()));
+
+  for (size_t i=0; i<info.size(); i++)
+  {
+    putUInt32(static_cast<uint32_t>(info[i].cmd));
+    putUInt32(static_cast<uint32_t>(info[i].type));
+    putUInt32(static_cast<uint32_t>(info[i].value.size()));
+    putBytes(info[i].value.data(), info[i].value.size());
+  }
+}
+
+uint32_t RecordParser::getUInt32()
+{
+  if (remaining() < 4)
+  {
+    throw std::invalid_argument("Recording: Unexpected end of record");
+  }
+
+  uint32_t ret=0;
+  for (int i=0; i<4; i++)
+  {
+    ret|=static_cast<uint32_t>(data[pos++])<<(8*i);
+  }
+
+  return ret;
+}
+
+uint64_t RecordParser::getUInt64()
+{
+  if (remaining() < 8)
+  {
+    throw std::invalid_argument("Recording: Unexpected end of record");
+  }
+
+  uint64_t ret=0;
+  for (int i=0; i<8; i++)
+  {
+    ret|=static_cast<uint64_t>(data[pos++])<<(8*i);
+  }
+
+  return ret;
+}
+
+std::string RecordParser::getString()
+{
+  size_t n=getUInt32();
+
+  if (remaining() < n)
+  {
+    throw std::invalid_argument("Recording: Unexpected end of record");
+  }
+
+  std::string ret(reinterpret_cast<const char *>(data+pos), n);
+  pos+=n;
+
+  return ret;
+}
+
+void RecordParser::getBytes(std::vector<uint8_t> &v, size_t n)
+{
+  if (remaining() < n)
+  {
+    throw std::invalid_argument("Recording: Unexpected end of record");
+  }
+
+  v.assign(data+pos, data+pos+n);
+  pos+=n;
+}
+
+void RecordParser::getInfo(std::vector<RecordedInfo> &info)
+{
+  size_t n=getUInt32();
+
+  info.resize(n);
+  for (size_t i=0; i<n; i++)
+  {
+    info[i].cmd=static_cast<int32_t>(getUInt32());
+    info[i].type=static_cast<int32_t>(getUInt32());
+    getBytes(info[i].value, getUInt32());
+  }
+}
+
+namespace
+{
+
+const char magic[]="RCGREC01";
+
+}
+
+SessionWriter::SessionWriter(const std::string &name)
+{
+  out.open(name, std::ios::binary);
+
+  if (!out.good())
+  {
+    throw std::invalid_argument("Cannot create recording: "+name);
+  }
+
+  out.write(magic, 8);
+}
+
+SessionWriter::~SessionWriter()
+{
+  out.close();
+}
+
+void SessionWriter::writeHeader(RecordType type, uint64_t size)
+{
+  RecordData header;
+
+  header.putUInt32(static_cast<uint32_t>(type));
+  header.putUInt64(size);
+
+  out.write(reinterpret_cast<const char *>(header.getData().data()),
+    static_cast<std::streamsize>(header.getData().size()));
+}
+
+void SessionWriter::write(RecordType type, const RecordData &data)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+
+  writeHeader(type, data.getData().size());
+  out.write(reinterpret_cast<const char *>(data.getData().data()),
+    static_cast<std::streamsize>(data.getData().size()));
+  out.flush();
+}
+
+void SessionWriter::writeBuffer(const RecordedBuffer &buffer, const void *p)
+{
+  RecordData data;
+
+  data.putUInt64(buffer.time);
+  data.putInfo(buffer.info);
+
+  data.putUInt32(static_cast<uint32_t>(buffer.part_info.size()));
+  for (size_t i=0; i<buffer.part_info.size(); i++)
+  {
+    data.putUInt64(buffer.part_offset[i]);
+    data.putInfo(buffer.part_info[i]);
+  }
+
+  data.putUInt64(buffer.data_size);
+
+  // the data of the buffer is written directly for avoiding a copy
+
+  std::lock_guard<std::mutex> lock(mtx);
+
+  writeHeader(REC_BUFFER, data.getData().size()+buffer.data_size);
+  out.write(reinterpret_cast<const char *>(data.getData().data()),
+    static_cast<std::streamsize>(data.getData().size()));
+  out.write(static_cast<const char *>(p), static_cast<std::streamsize>(buffer.data_size));
+}
+
+SessionReader::SessionReader(const std::string &name)
+{
+  in.open(name, std::ios::binary);
+
+  char tmp[8];
+  in.read(tmp, 8);
+
+  if (!in.good() || memcmp(tmp, magic, 8) != 0)
+  {
+    throw std::invalid_argument("Not a recording: "+name);
+  }
+
+  bool first_buffer=false;
+
+  while (true)
+  {
+    uint8_t header[12];
+    in.read(reinterpret_cast<char *>(header), sizeof(header));
+
+    if (in.gcount() == 0)
+    {
+      break;
+    }
+
+    if (in.gcount() != sizeof(header))
+    {
+      throw std::invalid_argument("Truncated recording: "+name);
+    }
+
+    RecordParser hp(header, sizeof(header));
+    RecordType type=static_cast<RecordType>(hp.getUInt32());
+    uint64_t size=hp.getUInt64();
+
+    uint64_t pos=static_cast<uint64_t>(in.tellg());
+
+    // only read meta data of buffers and skip the image data
+
+    std::vector<uint8_t> data(static_cast<size_t>(size));
+
+    if (type == REC_BUFFER)
+    {
+      data.resize(static_cast<size_t>(std::min(size, static_cast<uint64_t>(65536))));
+    }
+
+    in.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+
+    if (static_cast<size_t>(in.gcount()) != data.size())
+    {
+      // ignore incomplete last record, e.g. if the recording process has
+      // been killed
+
+      break;
+    }
+
+    RecordParser p(data.data(), data.size());
+
+    switch (type)
+    {
+      case REC_SYSTEM:
+        p.getInfo(system_info);
+        break;
+
+      case REC_DEVICE:
+        p.getInfo(device_info);
+        break;
+
+      case REC_XML:
+        xml_url=p.getString();
+        p.getBytes(xml, p.remaining());
+        break;
+
+      case REC_READ:
+      case REC_WRITE:
+        {
+          Register r;
+          r.write=(type == REC_WRITE);
+          r.after_first_buffer=first_buffer;
+          r.address=p.getUInt64();
+          p.getBytes(r.data, p.remaining());
+          reg.push_back(r);
+        }
+        break;
+
+      case REC_BUFFER:
+        {
+          RecordedBuffer b;
+
+          b.time=p.getUInt64();
+          p.getInfo(b.info);
+
+          size_t n=p.getUInt32();
+          b.part_offset.resize(n);
+          b.part_info.resize(n);
+
+          for (size_t i=0; i<n; i++)
+          {
+            b.part_offset[i]=p.getUInt64();
+            p.getInfo(b.part_info[i]);
+          }
+
+          b.data_size=p.getUInt64();
+
+          uint64_t data_pos=pos+(data.size()-p.remaining());
+
+          if (data_pos+b.data_size > pos+size)
+          {
+            throw std::invalid_argument("Corrupt buffer record in recording: "+name);
+          }
+
+          buffer.push_back(b);
+          buffer_pos.push_back(data_pos);
+          first_buffer=true;
+        }
+        break;
+
+      default:
+        break; // unknown records are ignored for being extendable
+    }
+
+    in.seekg(static_cast<std::streamoff>(pos+size));
+
+    if (!in.good())
+    {
+      break;
+    }
+  }
+
+  in.clear();
+}
+
+size_t SessionReader::readBufferData(size_t i, void *p, size_t size)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+
+  size=std::min(size, static_cast<size_t>(buffer[i].data_size));
+
+  in.seekg(static_cast<std::streamoff>(buffer_pos[i]));
+  in.read(static_cast<char *>(p), static_cast<std::streamsize>(size));
+
+  return static_cast<size_t>(in.gcount());
+}
+
+std::string getInfoString(const std::vector<RecordedInfo> &info, int32_t cmd)
+{
+  for (size_t i=0; i<info.size(); i++)
+  {
+    if (info[i].cmd == cmd)
+    {
+      std::string ret;
+
+      for (size_t k=0; k<info[i].value.size() && info[i].value[k] != '\0'; k++)
+      {
+        ret.push_back(static_cast<char>(info[i].value[k]));
+      }
+
+      return ret;
+    }
+  }
+
+  return std::string();
+}
+
+}
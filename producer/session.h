@@ -0,0 +1,275 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RC_GENICAM_API_PRODUCER_SESSION
+#define RC_GENICAM_API_PRODUCER_SESSION
+
+#include <GenTL/GenTL_v1_6.h>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <mutex>
+#include <cstring>
+
+namespace rcg
+{
+
+/*
+  A session recording is a single file that starts with the magic string
+  "RCGREC01", which is different from the frame recordings of
+  rcg::RecordingWriter in rc_genicam_api/recording.h. The magic string is
+  followed by a sequence of records. Each record consists of a 32 bit type,
+  a 64 bit size of the payload and the payload itself. All values are stored
+  in little endian byte order.
+
+  The payload of REC_SYSTEM and REC_DEVICE is a list of information values,
+  REC_XML contains the name and content of the GenICam XML file of the remote
+  device, REC_READ and REC_WRITE contain a register address and the read or
+  written bytes and REC_BUFFER contains the time of arrival in nanoseconds
+  since the start of the recording, the buffer information, the part
+  information and the data of the buffer. Information values are stored as
+  raw bytes, as they are reported by the producer. Thus, recordings can only
+  be replayed on systems with the same size of size_t and pointers.
+*/
+
+enum RecordType
+{
+  REC_SYSTEM=1, REC_DEVICE=2, REC_XML=3, REC_READ=4, REC_WRITE=5, REC_BUFFER=6
+};
+
+/**
+  Recorded information value of a GenTL module, buffer or buffer part.
+*/
+
+struct RecordedInfo
+{
+  int32_t cmd;
+  int32_t type;
+  std::vector<uint8_t> value;
+};
+
+/**
+  Recorded buffer without the image data.
+*/
+
+struct RecordedBuffer
+{
+  uint64_t time;
+  std::vector<RecordedInfo> info;
+  std::vector<uint64_t> part_offset;
+  std::vector<std::vector<RecordedInfo> > part_info;
+
+  uint64_t data_size;
+};
+
+/**
+  Helper for creating the payload of a record.
+*/
+
+class RecordData
+{
+  public:
+
+    void putUInt32(uint32_t v);
+    void putUInt64(uint64_t v);
+    void putString(const std::string &s);
+    void putBytes(const void *p, size_t n);
+    void putInfo(const std::vector<RecordedInfo> &info);
+
+    const std::vector<uint8_t> &getData() const { return data; }
+
+  private:
+
+    std::vector<uint8_t> data;
+};
+
+/**
+  Helper for parsing the payload of a record. An exception is thrown if the
+  payload is shorter than expected.
+*/
+
+class RecordParser
+{
+  public:
+
+    RecordParser(const uint8_t *p, size_t n) : data(p), size(n), pos(0) { }
+
+    uint32_t getUInt32();
+    uint64_t getUInt64();
+    std::string getString();
+    void getBytes(std::vector<uint8_t> &v, size_t n);
+    void getInfo(std::vector<RecordedInfo> &info);
+
+    size_t remaining() const { return size-pos; }
+
+  private:
+
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+};
+
+/**
+  Writes a recording. All methods are thread safe.
+*/
+
+class SessionWriter
+{
+  public:
+
+    /**
+      Creates the file. An exception is thrown if this is not possible.
+    */
+
+    SessionWriter(const std::string &name);
+    ~SessionWriter();
+
+    /**
+      Writes a record with the given payload.
+    */
+
+    void write(RecordType type, const RecordData &data);
+
+    /**
+      Writes a buffer record, which consists of the given buffer information
+      and the data of the buffer.
+    */
+
+    void writeBuffer(const RecordedBuffer &buffer, const void *data);
+
+  private:
+
+    SessionWriter(const SessionWriter &); // forbidden
+    SessionWriter &operator=(const SessionWriter &); // forbidden
+
+    void writeHeader(RecordType type, uint64_t size);
+
+    std::mutex mtx;
+    std::ofstream out;
+};
+
+/**
+  Reads a recording. All records, except the data of buffers, are kept in
+  memory.
+*/
+
+class SessionReader
+{
+  public:
+
+    struct Register
+    {
+      bool write;
+      bool after_first_buffer;
+      uint64_t address;
+      std::vector<uint8_t> data;
+    };
+
+    /**
+      Opens and indexes the recording. An exception is thrown if the file
+      cannot be opened or is corrupt.
+    */
+
+    SessionReader(const std::string &name);
+
+    const std::vector<RecordedInfo> &getSystemInfo() const { return system_info; }
+    const std::vector<RecordedInfo> &getDeviceInfo() const { return device_info; }
+
+    const std::string &getXMLURL() const { return xml_url; }
+    const std::vector<uint8_t> &getXML() const { return xml; }
+
+    const std::vector<Register> &getRegisterAccess() const { return reg; }
+
+    size_t getNumBuffers() const { return buffer.size(); }
+    const RecordedBuffer &getBuffer(size_t i) const { return buffer[i]; }
+
+    /**
+      Reads the data of the given buffer. Not more than the given size is read.
+
+      @param i    Index of buffer.
+      @param p    Pointer to memory for storing the data.
+      @param size Maximum size that can be stored.
+      @return     Number of bytes that have been read.
+    */
+
+    size_t readBufferData(size_t i, void *p, size_t size);
+
+  private:
+
+    SessionReader(const SessionReader &); // forbidden
+    SessionReader &operator=(const SessionReader &); // forbidden
+
+    std::mutex mtx;
+    std::ifstream in;
+
+    std::vector<RecordedInfo> system_info;
+    std::vector<RecordedInfo> device_info;
+    std::string xml_url;
+    std::vector<uint8_t> xml;
+    std::vector<Register> reg;
+    std::vector<RecordedBuffer> buffer;
+    std::vector<uint64_t> buffer_pos;
+};
+
+/**
+  Returns the string value of the given command from a list of information
+  values or an empty string if not available.
+*/
+
+std::string getInfoString(const std::vector<RecordedInfo> &info, int32_t cmd);
+
+/**
+  Returns the value of the given command from a list of information values
+  or the given default value, if not available or the size does not match.
+*/
+
+template<class T> T getInfoValue(const std::vector<RecordedInfo> &info, int32_t cmd, T def)
+{
+  for (size_t i=0; i<info.size(); i++)
+  {
+    if (info[i].cmd == cmd && info[i].value.size() == sizeof(T))
+    {
+      memcpy(&def, info[i].value.data(), sizeof(T));
+      break;
+    }
+  }
+
+  return def;
+}
+
+}
+
+#endif
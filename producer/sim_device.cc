@@ -0,0 +1,1226 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim_device.h"
+
+#include <rc_genicam_api/pixel_formats.h>
+
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#ifndef PRODUCER_VERSION
+#define PRODUCER_VERSION "unknown"
+#endif
+
+namespace rcg
+{
+
+namespace
+{
+
+/*
+  Registers of the remote device.
+*/
+
+enum RegisterAddress
+{
+  REG_VENDOR=0x0000,
+  REG_MODEL=0x0020,
+  REG_VERSION=0x0040,
+  REG_SERIAL=0x0060,
+  REG_WIDTH=0x0100,
+  REG_HEIGHT=0x0104,
+  REG_PIXEL_FORMAT=0x0108,
+  REG_COMPONENT_SELECTOR=0x010c,
+  REG_COMPONENT_ENABLE=0x0110,
+  REG_MULTIPART_MODE=0x0120,
+  REG_ACQUISITION_START=0x0124,
+  REG_ACQUISITION_STOP=0x0128,
+  REG_TL_PARAMS_LOCKED=0x012c,
+  REG_PAYLOAD_SIZE=0x0130,
+  REG_CHUNK_MODE_ACTIVE=0x0134,
+  REG_CHUNK_COMPONENT_SELECTOR=0x0138,
+  REG_FRAME_RATE_ENABLE=0x013c,
+  REG_FRAME_RATE=0x0140,
+  REG_EXPOSURE_TIME=0x0148,
+  REG_GAIN=0x0150,
+  REG_FOCAL_LENGTH=0x0158,
+  REG_PRINCIPAL_POINT_U=0x0160,
+  REG_PRINCIPAL_POINT_V=0x0168,
+  REG_FOCAL_LENGTH_FACTOR=0x0170,
+  REG_SIZE=0x0200,
+  REG_XML=0x10000
+};
+
+/*
+  Layout of chunk data. The global values are followed by one block of values
+  for each component.
+*/
+
+enum ChunkAddress
+{
+  CHUNK_TIMESTAMP=0,
+  CHUNK_EXPOSURE_TIME=8,
+  CHUNK_GAIN=16,
+  CHUNK_COMPONENT=32,
+  CHUNK_COMPONENT_STRIDE=96,
+  CHUNK_PART_INDEX=0,
+  CHUNK_WIDTH=4,
+  CHUNK_HEIGHT=8,
+  CHUNK_OFFSET_X=12,
+  CHUNK_OFFSET_Y=16,
+  CHUNK_PIXEL_FORMAT=20,
+  CHUNK_INVALID_DATA_FLAG=24,
+  CHUNK_COORDINATE_SCALE=32,
+  CHUNK_COORDINATE_OFFSET=40,
+  CHUNK_INVALID_DATA_VALUE=48,
+  CHUNK_FOCAL_LENGTH=56,
+  CHUNK_BASELINE=64,
+  CHUNK_PRINCIPAL_POINT_U=72,
+  CHUNK_PRINCIPAL_POINT_V=80,
+  CHUNK_SIZE=CHUNK_COMPONENT+4*CHUNK_COMPONENT_STRIDE
+};
+
+const uint32_t CHUNK_ID=0x5c1000;
+const uint32_t IMAGE_CHUNK_ID=0xa5a5a5a5;
+
+const int NCOMPONENTS=4;
+const char *component_name[NCOMPONENTS]={ "Intensity", "Disparity", "Confidence", "Error" };
+
+const double focal_length_factor=0.8;
+const double baseline=0.065;
+const double disparity_scale=0.0625;
+
+/*
+  Helper functions for creating the GenICam XML file.
+*/
+
+void beginNode(std::ostream &out, const char *type, const std::string &name,
+  const char *tooltip=0)
+{
+  bool standard=(name.size() < 3 || name.compare(name.size()-3, 3, "Reg") != 0);
+
+  out << "  <" << type << " Name=\"" << name << "\" NameSpace=\""
+      << (standard ? "Standard" : "Custom") << "\">\n";
+
+  if (tooltip != 0)
+  {
+    out << "    <ToolTip>" << tooltip << "</ToolTip>\n";
+  }
+
+  if (!standard)
+  {
+    out << "    <Visibility>Invisible</Visibility>\n";
+  }
+}
+
+void endNode(std::ostream &out, const char *type)
+{
+  out << "  </" << type << ">\n";
+}
+
+void addCategory(std::ostream &out, const char *name, const std::vector<std::string> &feature)
+{
+  beginNode(out, "Category", name);
+
+  for (size_t i=0; i<feature.size(); i++)
+  {
+    out << "    <pFeature>" << feature[i] << "</pFeature>\n";
+  }
+
+  endNode(out, "Category");
+}
+
+void addRegister(std::ostream &out, const char *type, const std::string &name,
+  const char *tooltip, uint64_t address, size_t length, const char *access,
+  const char *port="Device", const char *index=0, size_t offset=0)
+{
+  beginNode(out, type, name, tooltip);
+
+  out << "    <Address>0x" << std::hex << address << std::dec << "</Address>\n";
+
+  if (index != 0)
+  {
+    out << "    <pIndex Offset=\"" << offset << "\">" << index << "</pIndex>\n";
+  }
+
+  out << "    <Length>" << length << "</Length>\n";
+  out << "    <AccessMode>" << access << "</AccessMode>\n";
+  out << "    <pPort>" << port << "</pPort>\n";
+
+  if (std::string(access) == "RO")
+  {
+    out << "    <Cachable>NoCache</Cachable>\n";
+  }
+
+  if (std::string(type) != "StringReg")
+  {
+    out << "    <Endianess>LittleEndian</Endianess>\n";
+  }
+
+  endNode(out, type);
+}
+
+void addInteger(std::ostream &out, const char *name, const char *tooltip, const char *value,
+  int64_t vmin, int64_t vmax, int64_t inc=1, const char *locked=0)
+{
+  beginNode(out, "Integer", name, tooltip);
+
+  if (locked != 0)
+  {
+    out << "    <pIsLocked>" << locked << "</pIsLocked>\n";
+  }
+
+  out << "    <pValue>" << value << "</pValue>\n";
+  out << "    <Min>" << vmin << "</Min>\n";
+  out << "    <Max>" << vmax << "</Max>\n";
+  out << "    <Inc>" << inc << "</Inc>\n";
+
+  endNode(out, "Integer");
+}
+
+void addFloat(std::ostream &out, const char *name, const char *tooltip, const char *value,
+  double vmin, double vmax, const char *unit)
+{
+  beginNode(out, "Float", name, tooltip);
+
+  out << "    <pValue>" << value << "</pValue>\n";
+  out << "    <Min>" << vmin << "</Min>\n";
+  out << "    <Max>" << vmax << "</Max>\n";
+  out << "    <Unit>" << unit << "</Unit>\n";
+
+  endNode(out, "Float");
+}
+
+void addConstFloat(std::ostream &out, const char *name, const char *tooltip, double value)
+{
+  beginNode(out, "Float", name, tooltip);
+  out << "    <Value>" << value << "</Value>\n";
+  endNode(out, "Float");
+}
+
+void addBoolean(std::ostream &out, const char *name, const char *tooltip, const char *value,
+  const char *locked=0)
+{
+  beginNode(out, "Boolean", name, tooltip);
+
+  if (locked != 0)
+  {
+    out << "    <pIsLocked>" << locked << "</pIsLocked>\n";
+  }
+
+  out << "    <pValue>" << value << "</pValue>\n";
+  out << "    <OnValue>1</OnValue>\n";
+  out << "    <OffValue>0</OffValue>\n";
+
+  endNode(out, "Boolean");
+}
+
+void addCommand(std::ostream &out, const char *name, const char *tooltip, const char *value)
+{
+  beginNode(out, "Command", name, tooltip);
+
+  out << "    <pValue>" << value << "</pValue>\n";
+  out << "    <CommandValue>1</CommandValue>\n";
+
+  endNode(out, "Command");
+}
+
+void addEnumeration(std::ostream &out, const char *name, const char *tooltip,
+  const std::vector<std::pair<std::string, uint64_t> > &entry, const char *value,
+  const std::vector<std::string> &selected=std::vector<std::string>(), const char *locked=0)
+{
+  beginNode(out, "Enumeration", name, tooltip);
+
+  if (locked != 0)
+  {
+    out << "    <pIsLocked>" << locked << "</pIsLocked>\n";
+  }
+
+  for (size_t i=0; i<entry.size(); i++)
+  {
+    out << "    <EnumEntry Name=\"" << entry[i].first << "\" NameSpace=\"Standard\">\n";
+    out << "      <Value>0x" << std::hex << entry[i].second << std::dec << "</Value>\n";
+    out << "    </EnumEntry>\n";
+  }
+
+  if (value[0] >= '0' && value[0] <= '9')
+  {
+    out << "    <Value>" << value << "</Value>\n";
+  }
+  else
+  {
+    out << "    <pValue>" << value << "</pValue>\n";
+  }
+
+  for (size_t i=0; i<selected.size(); i++)
+  {
+    out << "    <pSelected>" << selected[i] << "</pSelected>\n";
+  }
+
+  endNode(out, "Enumeration");
+}
+
+/*
+  Creates the GenICam XML file of the device.
+*/
+
+std::string createXML()
+{
+  std::ostringstream out;
+
+  std::vector<std::pair<std::string, uint64_t> > components;
+  for (int i=0; i<NCOMPONENTS; i++)
+  {
+    components.push_back(std::make_pair(std::string(component_name[i]),
+      static_cast<uint64_t>(i)));
+  }
+
+  out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+  out << "<RegisterDescription ModelName=\"rc_sim\" VendorName=\"Roboception\"";
+  out << " StandardNameSpace=\"GEV\" SchemaMajorVersion=\"1\" SchemaMinorVersion=\"1\"";
+  out << " SchemaSubMinorVersion=\"0\" MajorVersion=\"1\" MinorVersion=\"0\"";
+  out << " SubMinorVersion=\"0\" ProductGuid=\"a3c1e8f2-5b1d-4c77-9a0e-3f6d2b8c4e10\"";
+  out << " VersionGuid=\"7d2f9b34-0e6a-4f1c-8b53-c9e1a4d07f26\"";
+  out << " xmlns=\"http://www.genicam.org/GenApi/Version_1_1\"";
+  out << " xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\"";
+  out << " xsi:schemaLocation=\"http://www.genicam.org/GenApi/Version_1_1";
+  out << " http://www.genicam.org/GenApi/GenApiSchema_Version_1_1.xsd\">\n";
+
+  // categories
+
+  addCategory(out, "Root", { "DeviceControl", "ImageFormatControl", "AcquisitionControl",
+    "Scan3dControl", "TransportLayerControl", "ChunkDataControl" });
+
+  addCategory(out, "DeviceControl", { "DeviceVendorName", "DeviceModelName", "DeviceVersion",
+    "DeviceSerialNumber" });
+
+  addCategory(out, "ImageFormatControl", { "Width", "Height", "PixelFormat", "ComponentSelector",
+    "ComponentEnable", "ComponentIDValue" });
+
+  addCategory(out, "AcquisitionControl", { "AcquisitionStart", "AcquisitionStop",
+    "AcquisitionFrameRateEnable", "AcquisitionFrameRate", "AcquisitionMultiPartMode",
+    "ExposureTime", "Gain" });
+
+  addCategory(out, "Scan3dControl", { "Scan3dOutputMode", "Scan3dCoordinateScale",
+    "Scan3dCoordinateOffset", "Scan3dInvalidDataFlag", "Scan3dInvalidDataValue",
+    "Scan3dFocalLength", "Scan3dBaseline", "Scan3dPrincipalPointU", "Scan3dPrincipalPointV",
+    "FocalLengthFactor", "Baseline" });
+
+  addCategory(out, "TransportLayerControl", { "PayloadSize", "TLParamsLocked" });
+
+  addCategory(out, "ChunkDataControl", { "ChunkModeActive", "ChunkComponentSelector",
+    "ChunkPartIndex", "ChunkWidth", "ChunkHeight", "ChunkOffsetX", "ChunkOffsetY",
+    "ChunkPixelFormat", "ChunkTimestamp", "ChunkExposureTime", "ChunkGain",
+    "ChunkScan3dCoordinateScale", "ChunkScan3dCoordinateOffset", "ChunkScan3dInvalidDataFlag",
+    "ChunkScan3dInvalidDataValue", "ChunkScan3dFocalLength", "ChunkScan3dBaseline",
+    "ChunkScan3dPrincipalPointU", "ChunkScan3dPrincipalPointV" });
+
+  // device control
+
+  addRegister(out, "StringReg", "DeviceVendorName", "Name of the manufacturer", REG_VENDOR, 32,
+    "RO");
+  addRegister(out, "StringReg", "DeviceModelName", "Model of the device", REG_MODEL, 32, "RO");
+  addRegister(out, "StringReg", "DeviceVersion", "Version of the device", REG_VERSION, 32, "RO");
+  addRegister(out, "StringReg", "DeviceSerialNumber", "Serial number of the device", REG_SERIAL,
+    32, "RO");
+
+  // image format control
+
+  addInteger(out, "Width", "Width of images in pixel", "WidthReg", 64, 8192, 4, "TLParamsLocked");
+  addRegister(out, "IntReg", "WidthReg", 0, REG_WIDTH, 4, "RW");
+
+  addInteger(out, "Height", "Height of images in pixel", "HeightReg", 32, 8192, 1,
+    "TLParamsLocked");
+  addRegister(out, "IntReg", "HeightReg", 0, REG_HEIGHT, 4, "RW");
+
+  addEnumeration(out, "PixelFormat", "Format of the Intensity component",
+    { std::make_pair(std::string("Mono8"), static_cast<uint64_t>(Mono8)),
+      std::make_pair(std::string("YCbCr411_8"), static_cast<uint64_t>(YCbCr411_8)) },
+    "PixelFormatReg", std::vector<std::string>(), "TLParamsLocked");
+  addRegister(out, "IntReg", "PixelFormatReg", 0, REG_PIXEL_FORMAT, 4, "RW");
+
+  addEnumeration(out, "ComponentSelector", "Selects the component for configuration",
+    components, "ComponentSelectorReg", { "ComponentEnable", "ComponentIDValue" });
+  addRegister(out, "IntReg", "ComponentSelectorReg", 0, REG_COMPONENT_SELECTOR, 4, "RW");
+
+  addBoolean(out, "ComponentEnable", "Enables the selected component", "ComponentEnableReg",
+    "TLParamsLocked");
+  addRegister(out, "IntReg", "ComponentEnableReg", 0, REG_COMPONENT_ENABLE, 4, "RW", "Device",
+    "ComponentSelectorReg", 4);
+
+  beginNode(out, "Integer", "ComponentIDValue", "ID of the selected component");
+  out << "    <ImposedAccessMode>RO</ImposedAccessMode>\n";
+  out << "    <pValue>ComponentSelectorReg</pValue>\n";
+  endNode(out, "Integer");
+
+  // acquisition control
+
+  addCommand(out, "AcquisitionStart", "Starts the acquisition", "AcquisitionStartReg");
+  addRegister(out, "IntReg", "AcquisitionStartReg", 0, REG_ACQUISITION_START, 4, "RW");
+
+  addCommand(out, "AcquisitionStop", "Stops the acquisition", "AcquisitionStopReg");
+  addRegister(out, "IntReg", "AcquisitionStopReg", 0, REG_ACQUISITION_STOP, 4, "RW");
+
+  addBoolean(out, "AcquisitionFrameRateEnable",
+    "Limits the frame rate to AcquisitionFrameRate. Otherwise, frames are delivered as fast "
+    "as buffers are available", "AcquisitionFrameRateEnableReg");
+  addRegister(out, "IntReg", "AcquisitionFrameRateEnableReg", 0, REG_FRAME_RATE_ENABLE, 4, "RW");
+
+  addFloat(out, "AcquisitionFrameRate", "Frame rate", "AcquisitionFrameRateReg", 0.1, 10000,
+    "Hz");
+  addRegister(out, "FloatReg", "AcquisitionFrameRateReg", 0, REG_FRAME_RATE, 8, "RW");
+
+  addEnumeration(out, "AcquisitionMultiPartMode",
+    "Sending components in separate buffers or together as multi part buffer",
+    { std::make_pair(std::string("SingleComponent"), static_cast<uint64_t>(0)),
+      std::make_pair(std::string("SynchronizedComponents"), static_cast<uint64_t>(1)) },
+    "AcquisitionMultiPartModeReg", std::vector<std::string>(), "TLParamsLocked");
+  addRegister(out, "IntReg", "AcquisitionMultiPartModeReg", 0, REG_MULTIPART_MODE, 4, "RW");
+
+  addFloat(out, "ExposureTime", "Exposure time, which is only reported in chunk data",
+    "ExposureTimeReg", 10, 100000, "us");
+  addRegister(out, "FloatReg", "ExposureTimeReg", 0, REG_EXPOSURE_TIME, 8, "RW");
+
+  addFloat(out, "Gain", "Gain, which is only reported in chunk data", "GainReg", 0, 18, "dB");
+  addRegister(out, "FloatReg", "GainReg", 0, REG_GAIN, 8, "RW");
+
+  // 3D parameters
+
+  addEnumeration(out, "Scan3dOutputMode", "Mode of the Disparity component",
+    { std::make_pair(std::string("DisparityC"), static_cast<uint64_t>(0)) }, "0");
+
+  addConstFloat(out, "Scan3dCoordinateScale", "Scale factor of disparity values",
+    disparity_scale);
+  addConstFloat(out, "Scan3dCoordinateOffset", "Offset of disparity values", 0);
+
+  beginNode(out, "Boolean", "Scan3dInvalidDataFlag", "Invalid disparities are marked");
+  out << "    <Value>true</Value>\n";
+  endNode(out, "Boolean");
+
+  addConstFloat(out, "Scan3dInvalidDataValue", "Value of invalid disparities", 0);
+
+  addRegister(out, "FloatReg", "Scan3dFocalLength", "Focal length in pixel", REG_FOCAL_LENGTH,
+    8, "RO");
+  addConstFloat(out, "Scan3dBaseline", "Baseline in meter", baseline);
+  addRegister(out, "FloatReg", "Scan3dPrincipalPointU", "Horizontal principal point in pixel",
+    REG_PRINCIPAL_POINT_U, 8, "RO");
+  addRegister(out, "FloatReg", "Scan3dPrincipalPointV", "Vertical principal point in pixel",
+    REG_PRINCIPAL_POINT_V, 8, "RO");
+  addRegister(out, "FloatReg", "FocalLengthFactor", "Focal length divided by image width",
+    REG_FOCAL_LENGTH_FACTOR, 8, "RO");
+
+  beginNode(out, "Float", "Baseline", "Baseline in meter");
+  out << "    <pValue>Scan3dBaseline</pValue>\n";
+  endNode(out, "Float");
+
+  // transport layer control
+
+  addRegister(out, "IntReg", "PayloadSize", "Maximum size of buffers", REG_PAYLOAD_SIZE, 4, "RO");
+
+  addInteger(out, "TLParamsLocked", "Locks parameters that influence the payload size",
+    "TLParamsLockedReg", 0, 1);
+  addRegister(out, "IntReg", "TLParamsLockedReg", 0, REG_TL_PARAMS_LOCKED, 4, "RW");
+
+  // chunk data
+
+  addBoolean(out, "ChunkModeActive", "Adds chunk data to all buffers", "ChunkModeActiveReg",
+    "TLParamsLocked");
+  addRegister(out, "IntReg", "ChunkModeActiveReg", 0, REG_CHUNK_MODE_ACTIVE, 4, "RW");
+
+  addEnumeration(out, "ChunkComponentSelector", "Selects the component of chunk data",
+    components, "ChunkComponentSelectorReg", { "ChunkPartIndex", "ChunkWidth", "ChunkHeight",
+    "ChunkOffsetX", "ChunkOffsetY", "ChunkPixelFormat", "ChunkScan3dCoordinateScale",
+    "ChunkScan3dCoordinateOffset", "ChunkScan3dInvalidDataFlag", "ChunkScan3dInvalidDataValue",
+    "ChunkScan3dFocalLength", "ChunkScan3dBaseline", "ChunkScan3dPrincipalPointU",
+    "ChunkScan3dPrincipalPointV" });
+  addRegister(out, "IntReg", "ChunkComponentSelectorReg", 0, REG_CHUNK_COMPONENT_SELECTOR, 4,
+    "RW");
+
+  const char *sel="ChunkComponentSelectorReg";
+  const size_t stride=CHUNK_COMPONENT_STRIDE;
+
+  addRegister(out, "IntReg", "ChunkPartIndex", "Index of part that contains the component",
+    CHUNK_COMPONENT+CHUNK_PART_INDEX, 4, "RO", "ChunkPort", sel, stride);
+  addRegister(out, "IntReg", "ChunkWidth", "Width of component", CHUNK_COMPONENT+CHUNK_WIDTH, 4,
+    "RO", "ChunkPort", sel, stride);
+  addRegister(out, "IntReg", "ChunkHeight", "Height of component", CHUNK_COMPONENT+CHUNK_HEIGHT,
+    4, "RO", "ChunkPort", sel, stride);
+  addRegister(out, "IntReg", "ChunkOffsetX", "Horizontal offset of component",
+    CHUNK_COMPONENT+CHUNK_OFFSET_X, 4, "RO", "ChunkPort", sel, stride);
+  addRegister(out, "IntReg", "ChunkOffsetY", "Vertical offset of component",
+    CHUNK_COMPONENT+CHUNK_OFFSET_Y, 4, "RO", "ChunkPort", sel, stride);
+  addRegister(out, "IntReg", "ChunkPixelFormat", "Pixel format of component",
+    CHUNK_COMPONENT+CHUNK_PIXEL_FORMAT, 4, "RO", "ChunkPort", sel, stride);
+  addRegister(out, "IntReg", "ChunkTimestamp", "Timestamp of buffer in nanoseconds",
+    CHUNK_TIMESTAMP, 8, "RO", "ChunkPort");
+  addRegister(out, "FloatReg", "ChunkExposureTime", "Exposure time in microseconds",
+    CHUNK_EXPOSURE_TIME, 8, "RO", "ChunkPort");
+  addRegister(out, "FloatReg", "ChunkGain", "Gain in dB", CHUNK_GAIN, 8, "RO", "ChunkPort");
+  addRegister(out, "FloatReg", "ChunkScan3dCoordinateScale", "Scale factor of disparity values",
+    CHUNK_COMPONENT+CHUNK_COORDINATE_SCALE, 8, "RO", "ChunkPort", sel, stride);
+  addRegister(out, "FloatReg", "ChunkScan3dCoordinateOffset", "Offset of disparity values",
+    CHUNK_COMPONENT+CHUNK_COORDINATE_OFFSET, 8, "RO", "ChunkPort", sel, stride);
+
+  addBoolean(out, "ChunkScan3dInvalidDataFlag", "Invalid disparities are marked",
+    "ChunkScan3dInvalidDataFlagReg");
+  addRegister(out, "IntReg", "ChunkScan3dInvalidDataFlagReg", 0,
+    CHUNK_COMPONENT+CHUNK_INVALID_DATA_FLAG, 4, "RO", "ChunkPort", sel, stride);
+
+  addRegister(out, "FloatReg", "ChunkScan3dInvalidDataValue", "Value of invalid disparities",
+    CHUNK_COMPONENT+CHUNK_INVALID_DATA_VALUE, 8, "RO", "ChunkPort", sel, stride);
+  addRegister(out, "FloatReg", "ChunkScan3dFocalLength", "Focal length in pixel",
+    CHUNK_COMPONENT+CHUNK_FOCAL_LENGTH, 8, "RO", "ChunkPort", sel, stride);
+  addRegister(out, "FloatReg", "ChunkScan3dBaseline", "Baseline in meter",
+    CHUNK_COMPONENT+CHUNK_BASELINE, 8, "RO", "ChunkPort", sel, stride);
+  addRegister(out, "FloatReg", "ChunkScan3dPrincipalPointU", "Horizontal principal point",
+    CHUNK_COMPONENT+CHUNK_PRINCIPAL_POINT_U, 8, "RO", "ChunkPort", sel, stride);
+  addRegister(out, "FloatReg", "ChunkScan3dPrincipalPointV", "Vertical principal point",
+    CHUNK_COMPONENT+CHUNK_PRINCIPAL_POINT_V, 8, "RO", "ChunkPort", sel, stride);
+
+  // ports
+
+  beginNode(out, "Port", "Device");
+  endNode(out, "Port");
+
+  beginNode(out, "Port", "ChunkPort");
+  out << "    <ChunkID>" << std::hex << CHUNK_ID << std::dec << "</ChunkID>\n";
+  endNode(out, "Port");
+
+  out << "</RegisterDescription>\n";
+
+  return out.str();
+}
+
+void storeBigEndian(uint8_t *p, uint32_t v)
+{
+  p[0]=static_cast<uint8_t>(v>>24);
+  p[1]=static_cast<uint8_t>(v>>16);
+  p[2]=static_cast<uint8_t>(v>>8);
+  p[3]=static_cast<uint8_t>(v);
+}
+
+inline uint8_t clamp8(double v)
+{
+  return static_cast<uint8_t>(std::max(0.0, std::min(255.0, v+0.5)));
+}
+
+}
+
+SimDevice::SimDevice(const std::string &_id) : id(_id)
+{
+  xml=createXML();
+  reg.resize(REG_SIZE, 0);
+
+  // default settings
+
+  setString(REG_VENDOR, "Roboception GmbH");
+  setString(REG_MODEL, "rc_sim");
+  setString(REG_VERSION, PRODUCER_VERSION);
+  setString(REG_SERIAL, id);
+
+  setUInt32(REG_WIDTH, 640);
+  setUInt32(REG_HEIGHT, 480);
+  setUInt32(REG_PIXEL_FORMAT, Mono8);
+
+  for (int i=0; i<NCOMPONENTS; i++)
+  {
+    setUInt32(REG_COMPONENT_ENABLE+4*i, 1);
+  }
+
+  setUInt32(REG_MULTIPART_MODE, 1);
+  setUInt32(REG_FRAME_RATE_ENABLE, 1);
+  setDouble(REG_FRAME_RATE, 25);
+  setDouble(REG_EXPOSURE_TIME, 5000);
+  setDouble(REG_GAIN, 0);
+
+  updateRegisters();
+
+  config=getConfig();
+  frame=0;
+  component=0;
+  block=0;
+  current_frame=0;
+  current_block=0;
+  current_component=0;
+}
+
+std::string SimDevice::getInfo(GenTL::DEVICE_INFO_CMD cmd)
+{
+  switch (cmd)
+  {
+    case GenTL::DEVICE_INFO_ID:
+    case GenTL::DEVICE_INFO_SERIAL_NUMBER:
+      return id;
+
+    case GenTL::DEVICE_INFO_VENDOR:
+      return "Roboception GmbH";
+
+    case GenTL::DEVICE_INFO_MODEL:
+    case GenTL::DEVICE_INFO_DISPLAYNAME:
+      return "rc_sim";
+
+    case GenTL::DEVICE_INFO_TLTYPE:
+      return "GEV";
+
+    case GenTL::DEVICE_INFO_VERSION:
+      return PRODUCER_VERSION;
+
+    default:
+      break;
+  }
+
+  return std::string();
+}
+
+std::string SimDevice::getXMLURL()
+{
+  std::ostringstream out;
+  out << "local:rc_sim.xml;" << std::hex << REG_XML << ';' << xml.size();
+  return out.str();
+}
+
+GenTL::GC_ERROR SimDevice::readRegister(uint64_t address, void *buffer, size_t *size)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+
+  if (address+*size <= reg.size())
+  {
+    memcpy(buffer, reg.data()+address, *size);
+  }
+  else if (address >= REG_XML && address+*size <= REG_XML+xml.size())
+  {
+    memcpy(buffer, xml.data()+(address-REG_XML), *size);
+  }
+  else
+  {
+    *size=0;
+    return setLastError(GenTL::GC_ERR_INVALID_ADDRESS, "Invalid register address");
+  }
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SimDevice::writeRegister(uint64_t address, const void *buffer, size_t *size)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+
+  if (address < REG_WIDTH || address+*size > reg.size())
+  {
+    *size=0;
+    return setLastError(GenTL::GC_ERR_ACCESS_DENIED, "Register cannot be written");
+  }
+
+  memcpy(reg.data()+address, buffer, *size);
+
+  // commands are done immediately
+
+  setUInt32(REG_ACQUISITION_START, 0);
+  setUInt32(REG_ACQUISITION_STOP, 0);
+
+  updateRegisters();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+size_t SimDevice::getPayloadSize()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return getPayloadSize(getConfig());
+}
+
+void SimDevice::startAcquisition()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+
+  config=getConfig();
+  createImages();
+
+  start=std::chrono::steady_clock::now();
+  system_start=std::chrono::system_clock::now();
+  frame=0;
+  component=0;
+  block=0;
+}
+
+bool SimDevice::prepareFrame(std::chrono::steady_clock::time_point &t, bool &wait_for_buffer)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+
+  // find next enabled component, which is part of the current or next frame
+
+  int k=0;
+
+  if (!config.multipart)
+  {
+    k=component;
+
+    while (k < NCOMPONENTS && !config.enabled[k]) k++;
+
+    if (k >= NCOMPONENTS)
+    {
+      frame++;
+      k=0;
+    }
+  }
+
+  while (k < NCOMPONENTS && !config.enabled[k]) k++;
+
+  if (k >= NCOMPONENTS)
+  {
+    return false;
+  }
+
+  // a new frame starts with every multipart buffer or with the first enabled
+  // component
+
+  bool new_frame=true;
+
+  if (!config.multipart)
+  {
+    for (int i=0; i<k && new_frame; i++)
+    {
+      if (config.enabled[i]) new_frame=false;
+    }
+  }
+
+  current_frame=frame;
+  current_block=++block;
+  current_component=k;
+  component=k+1;
+
+  if (config.multipart)
+  {
+    frame++;
+  }
+
+  // deliver with the configured frame rate or as fast as possible, all
+  // components of one frame get the same time
+
+  if (config.rate > 0)
+  {
+    t=start+std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(current_frame/config.rate));
+    wait_for_buffer=false;
+  }
+  else
+  {
+    if (new_frame)
+    {
+      current_time=std::chrono::steady_clock::now();
+    }
+
+    t=current_time;
+    wait_for_buffer=true;
+  }
+
+  current_time=t;
+
+  return true;
+}
+
+void SimDevice::fillBuffer(SoftBuffer &buffer)
+{
+  // config and images do not change during acquisition
+
+  std::vector<int> comp;
+
+  if (config.multipart)
+  {
+    for (int i=0; i<NCOMPONENTS; i++)
+    {
+      if (config.enabled[i]) comp.push_back(i);
+    }
+  }
+  else
+  {
+    comp.push_back(current_component);
+  }
+
+  uint64_t timestamp=static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    (system_start+std::chrono::duration_cast<std::chrono::system_clock::duration>(
+    current_time-start)).time_since_epoch()).count());
+
+  if (config.multipart)
+  {
+    buffer.setInfo(GenTL::BUFFER_INFO_PAYLOADTYPE, GenTL::INFO_DATATYPE_SIZET,
+      static_cast<size_t>(GenTL::PAYLOAD_TYPE_MULTI_PART));
+  }
+  else
+  {
+    buffer.setInfo(GenTL::BUFFER_INFO_PAYLOADTYPE, GenTL::INFO_DATATYPE_SIZET,
+      static_cast<size_t>(GenTL::PAYLOAD_TYPE_IMAGE));
+  }
+
+  buffer.setInfo(GenTL::BUFFER_INFO_FRAMEID, GenTL::INFO_DATATYPE_UINT64,
+    current_block);
+  buffer.setInfo(GenTL::BUFFER_INFO_TIMESTAMP, GenTL::INFO_DATATYPE_UINT64, timestamp);
+  buffer.setInfo(GenTL::BUFFER_INFO_TIMESTAMP_NS, GenTL::INFO_DATATYPE_UINT64, timestamp);
+  buffer.setInfo(GenTL::BUFFER_INFO_TLTYPE, GenTL::INFO_DATATYPE_STRING, "GEV", 4);
+
+  // check size of buffer
+
+  size_t size=0;
+  for (size_t i=0; i<comp.size(); i++)
+  {
+    size+=getComponentSize(config, comp[i]);
+  }
+
+  size_t image_size=(size+3)&~static_cast<size_t>(3);
+  size_t total_size=image_size;
+
+  if (config.chunks)
+  {
+    total_size+=8+CHUNK_SIZE+8;
+  }
+
+  if (buffer.getSize() < total_size)
+  {
+    buffer.setInfo(GenTL::BUFFER_INFO_SIZE_FILLED, GenTL::INFO_DATATYPE_SIZET,
+      static_cast<size_t>(0));
+    buffer.setInfo(GenTL::BUFFER_INFO_IS_INCOMPLETE, GenTL::INFO_DATATYPE_BOOL8,
+      static_cast<bool8_t>(1));
+    buffer.setInfo(GenTL::BUFFER_INFO_DATA_LARGER_THAN_BUFFER, GenTL::INFO_DATATYPE_BOOL8,
+      static_cast<bool8_t>(1));
+    return;
+  }
+
+  buffer.setInfo(GenTL::BUFFER_INFO_IS_INCOMPLETE, GenTL::INFO_DATATYPE_BOOL8,
+    static_cast<bool8_t>(0));
+  buffer.setInfo(GenTL::BUFFER_INFO_SIZE_FILLED, GenTL::INFO_DATATYPE_SIZET, total_size);
+  buffer.setInfo(GenTL::BUFFER_INFO_DATA_SIZE, GenTL::INFO_DATATYPE_SIZET, total_size);
+  buffer.setInfo(GenTL::BUFFER_INFO_CONTAINS_CHUNKDATA, GenTL::INFO_DATATYPE_BOOL8,
+    static_cast<bool8_t>(config.chunks ? 1 : 0));
+  buffer.setInfo(GenTL::BUFFER_INFO_PIXEL_ENDIANNESS, GenTL::INFO_DATATYPE_INT32,
+    static_cast<int32_t>(GenTL::PIXELENDIANNESS_LITTLE));
+
+  // copy images
+
+  uint8_t *p=buffer.getData();
+  size_t offset=0;
+  int part[NCOMPONENTS]={ -1, -1, -1, -1 };
+
+  for (size_t i=0; i<comp.size(); i++)
+  {
+    const int c=comp[i];
+    const uint32_t n=static_cast<uint32_t>(i);
+    const size_t h=config.height;
+    const size_t w=config.width;
+
+    uint64_t format=Mono8;
+    size_t type=GenTL::PART_DATATYPE_2D_IMAGE;
+
+    switch (c)
+    {
+      case 0:
+        format=config.format;
+        break;
+
+      case 1:
+        format=Coord3D_C16;
+        type=GenTL::PART_DATATYPE_3D_IMAGE;
+        break;
+
+      case 2:
+        format=Confidence8;
+        type=GenTL::PART_DATATYPE_CONFIDENCE_MAP;
+        break;
+
+      case 3:
+        format=Error8;
+        break;
+    }
+
+    memcpy(p+offset, image[c].data(), image[c].size());
+    part[c]=static_cast<int>(i);
+
+    if (config.multipart)
+    {
+      buffer.setPartOffset(n, offset);
+      buffer.setPartInfo(n, GenTL::BUFFER_PART_INFO_DATA_SIZE, GenTL::INFO_DATATYPE_SIZET,
+        image[c].size());
+      buffer.setPartInfo(n, GenTL::BUFFER_PART_INFO_DATA_TYPE, GenTL::INFO_DATATYPE_SIZET, type);
+      buffer.setPartInfo(n, GenTL::BUFFER_PART_INFO_DATA_FORMAT, GenTL::INFO_DATATYPE_UINT64,
+        format);
+      buffer.setPartInfo(n, GenTL::BUFFER_PART_INFO_DATA_FORMAT_NAMESPACE,
+        GenTL::INFO_DATATYPE_UINT64,
+        static_cast<uint64_t>(GenTL::PIXELFORMAT_NAMESPACE_PFNC_32BIT));
+      buffer.setPartInfo(n, GenTL::BUFFER_PART_INFO_WIDTH, GenTL::INFO_DATATYPE_SIZET, w);
+      buffer.setPartInfo(n, GenTL::BUFFER_PART_INFO_HEIGHT, GenTL::INFO_DATATYPE_SIZET, h);
+      buffer.setPartInfo(n, GenTL::BUFFER_PART_INFO_XOFFSET, GenTL::INFO_DATATYPE_SIZET,
+        static_cast<size_t>(0));
+      buffer.setPartInfo(n, GenTL::BUFFER_PART_INFO_YOFFSET, GenTL::INFO_DATATYPE_SIZET,
+        static_cast<size_t>(0));
+      buffer.setPartInfo(n, GenTL::BUFFER_PART_INFO_XPADDING, GenTL::INFO_DATATYPE_SIZET,
+        static_cast<size_t>(0));
+      buffer.setPartInfo(n, GenTL::BUFFER_PART_INFO_SOURCE_ID, GenTL::INFO_DATATYPE_UINT64,
+        static_cast<uint64_t>(0));
+      buffer.setPartInfo(n, GenTL::BUFFER_PART_INFO_DELIVERED_IMAGEHEIGHT,
+        GenTL::INFO_DATATYPE_SIZET, h);
+      buffer.setPartInfo(n, GenTL::BUFFER_PART_INFO_REGION_ID, GenTL::INFO_DATATYPE_UINT64,
+        static_cast<uint64_t>(0));
+      buffer.setPartInfo(n, GenTL::BUFFER_PART_INFO_DATA_PURPOSE_ID, GenTL::INFO_DATATYPE_UINT64,
+        static_cast<uint64_t>(c));
+    }
+    else
+    {
+      buffer.setInfo(GenTL::BUFFER_INFO_IMAGEPRESENT, GenTL::INFO_DATATYPE_BOOL8,
+        static_cast<bool8_t>(1));
+      buffer.setInfo(GenTL::BUFFER_INFO_IMAGEOFFSET, GenTL::INFO_DATATYPE_SIZET,
+        static_cast<size_t>(0));
+      buffer.setInfo(GenTL::BUFFER_INFO_PIXELFORMAT, GenTL::INFO_DATATYPE_UINT64, format);
+      buffer.setInfo(GenTL::BUFFER_INFO_PIXELFORMAT_NAMESPACE, GenTL::INFO_DATATYPE_UINT64,
+        static_cast<uint64_t>(GenTL::PIXELFORMAT_NAMESPACE_PFNC_32BIT));
+      buffer.setInfo(GenTL::BUFFER_INFO_WIDTH, GenTL::INFO_DATATYPE_SIZET, w);
+      buffer.setInfo(GenTL::BUFFER_INFO_HEIGHT, GenTL::INFO_DATATYPE_SIZET, h);
+      buffer.setInfo(GenTL::BUFFER_INFO_XOFFSET, GenTL::INFO_DATATYPE_SIZET,
+        static_cast<size_t>(0));
+      buffer.setInfo(GenTL::BUFFER_INFO_YOFFSET, GenTL::INFO_DATATYPE_SIZET,
+        static_cast<size_t>(0));
+      buffer.setInfo(GenTL::BUFFER_INFO_XPADDING, GenTL::INFO_DATATYPE_SIZET,
+        static_cast<size_t>(0));
+      buffer.setInfo(GenTL::BUFFER_INFO_YPADDING, GenTL::INFO_DATATYPE_SIZET,
+        static_cast<size_t>(0));
+      buffer.setInfo(GenTL::BUFFER_INFO_DELIVERED_IMAGEHEIGHT, GenTL::INFO_DATATYPE_SIZET, h);
+    }
+
+    offset+=image[c].size();
+  }
+
+  // add chunk data in GigE Vision layout, i.e. each chunk is followed by its
+  // ID and length in big endian
+
+  if (config.chunks)
+  {
+    memset(p+offset, 0, image_size-offset);
+    offset=image_size;
+
+    storeBigEndian(p+offset, IMAGE_CHUNK_ID);
+    storeBigEndian(p+offset+4, static_cast<uint32_t>(image_size));
+    offset+=8;
+
+    writeChunkData(p+offset, timestamp, part);
+    offset+=CHUNK_SIZE;
+
+    storeBigEndian(p+offset, CHUNK_ID);
+    storeBigEndian(p+offset+4, CHUNK_SIZE);
+
+    buffer.setInfo(GenTL::BUFFER_INFO_CHUNKLAYOUTID, GenTL::INFO_DATATYPE_UINT64,
+      static_cast<uint64_t>(CHUNK_ID));
+  }
+}
+
+SimDevice::Config SimDevice::getConfig() const
+{
+  Config c;
+
+  c.width=getUInt32(REG_WIDTH);
+  c.height=getUInt32(REG_HEIGHT);
+  c.format=getUInt32(REG_PIXEL_FORMAT);
+
+  for (int i=0; i<NCOMPONENTS; i++)
+  {
+    c.enabled[i]=(getUInt32(REG_COMPONENT_ENABLE+4*i) != 0);
+  }
+
+  c.multipart=(getUInt32(REG_MULTIPART_MODE) != 0);
+  c.chunks=(getUInt32(REG_CHUNK_MODE_ACTIVE) != 0);
+
+  c.rate=0;
+  if (getUInt32(REG_FRAME_RATE_ENABLE) != 0)
+  {
+    c.rate=getDouble(REG_FRAME_RATE);
+  }
+
+  c.exposure=getDouble(REG_EXPOSURE_TIME);
+  c.gain=getDouble(REG_GAIN);
+
+  c.f=focal_length_factor*c.width;
+  c.t=baseline;
+  c.u=c.width/2.0;
+  c.v=c.height/2.0;
+
+  return c;
+}
+
+size_t SimDevice::getComponentSize(const Config &c, int component) const
+{
+  size_t size=static_cast<size_t>(c.width)*c.height;
+
+  if (component == 0 && c.format == YCbCr411_8)
+  {
+    size=size*3/2;
+  }
+  else if (component == 1)
+  {
+    size*=2;
+  }
+
+  return size;
+}
+
+size_t SimDevice::getPayloadSize(const Config &c) const
+{
+  size_t size=0;
+
+  for (int i=0; i<NCOMPONENTS; i++)
+  {
+    if (c.enabled[i])
+    {
+      if (c.multipart)
+      {
+        size+=getComponentSize(c, i);
+      }
+      else
+      {
+        size=std::max(size, getComponentSize(c, i));
+      }
+    }
+  }
+
+  size=(size+3)&~static_cast<size_t>(3);
+
+  if (c.chunks)
+  {
+    size+=8+CHUNK_SIZE+8;
+  }
+
+  return std::max(size, static_cast<size_t>(1));
+}
+
+void SimDevice::createImages()
+{
+  // the scene consists of a plane that is tilted towards the camera and a
+  // sphere in front of it
+
+  const int w=static_cast<int>(config.width);
+  const int h=static_cast<int>(config.height);
+  const double r=0.25*std::min(w, h);
+  const double ft=config.f*config.t;
+
+  std::vector<float> disp(static_cast<size_t>(w)*h);
+
+  float dmax=0;
+  for (int k=0; k<h; k++)
+  {
+    for (int i=0; i<w; i++)
+    {
+      double z=2.0-1.0*k/h;
+
+      double dx=(i-config.u)/r;
+      double dy=(k-config.v)/r;
+      double d2=dx*dx+dy*dy;
+
+      if (d2 < 1)
+      {
+        z=std::min(z, 1.0-0.3*std::sqrt(1-d2));
+      }
+
+      disp[k*w+i]=static_cast<float>(ft/z);
+      dmax=std::max(dmax, disp[k*w+i]);
+    }
+  }
+
+  // the left border is not visible in the right image
+
+  const int border=static_cast<int>(std::ceil(dmax));
+
+  // Intensity with a checker board texture, which is shaded by distance
+
+  image[0].resize(getComponentSize(config, 0));
+
+  uint8_t *p=image[0].data();
+  for (int k=0; k<h; k++)
+  {
+    for (int i=0; i<w; i++)
+    {
+      double y=((((i>>4)+(k>>4))&1) ? 200 : 60)*disp[k*w+i]/(ft/1.5);
+
+      if (config.format == YCbCr411_8)
+      {
+        // pixels are stored in groups of four as Y0 Y1 Cb Y2 Y3 Cr
+
+        int j=i&3;
+
+        if (j == 0)
+        {
+          p[2]=clamp8(128+48*std::cos(6.283*i/w));
+          p[5]=clamp8(128+48*std::sin(6.283*k/h));
+        }
+
+        p[j+(j>>1)]=clamp8(y);
+
+        if (j == 3)
+        {
+          p+=6;
+        }
+      }
+      else
+      {
+        *p++=clamp8(y);
+      }
+    }
+  }
+
+  // Disparity, Confidence and Error
+
+  image[1].resize(getComponentSize(config, 1));
+  image[2].resize(getComponentSize(config, 2));
+  image[3].resize(getComponentSize(config, 3));
+
+  uint8_t *pd=image[1].data();
+  uint8_t *pc=image[2].data();
+  uint8_t *pe=image[3].data();
+
+  for (int k=0; k<h; k++)
+  {
+    for (int i=0; i<w; i++)
+    {
+      uint16_t d=0;
+      uint8_t c=0, e=0;
+
+      if (i >= border)
+      {
+        d=static_cast<uint16_t>(disp[k*w+i]/disparity_scale+0.5);
+        c=255;
+        e=1;
+      }
+
+      *pd++=static_cast<uint8_t>(d);
+      *pd++=static_cast<uint8_t>(d>>8);
+      *pc++=c;
+      *pe++=e;
+    }
+  }
+}
+
+void SimDevice::writeChunkData(uint8_t *p, uint64_t timestamp, const int *part) const
+{
+  memset(p, 0, CHUNK_SIZE);
+
+  memcpy(p+CHUNK_TIMESTAMP, &timestamp, 8);
+  memcpy(p+CHUNK_EXPOSURE_TIME, &config.exposure, 8);
+  memcpy(p+CHUNK_GAIN, &config.gain, 8);
+
+  for (int i=0; i<NCOMPONENTS; i++)
+  {
+    uint8_t *pc=p+CHUNK_COMPONENT+i*CHUNK_COMPONENT_STRIDE;
+
+    uint32_t v[6];
+    v[0]=static_cast<uint32_t>(part[i]);
+    v[1]=config.width;
+    v[2]=config.height;
+    v[3]=0;
+    v[4]=0;
+
+    switch (i)
+    {
+      default:
+      case 0:
+        v[5]=static_cast<uint32_t>(config.format);
+        break;
+
+      case 1:
+        v[5]=Coord3D_C16;
+        break;
+
+      case 2:
+        v[5]=Confidence8;
+        break;
+
+      case 3:
+        v[5]=Error8;
+        break;
+    }
+
+    memcpy(pc+CHUNK_PART_INDEX, v, sizeof(v));
+
+    uint32_t flag=1;
+    memcpy(pc+CHUNK_INVALID_DATA_FLAG, &flag, 4);
+
+    double d[7]={ disparity_scale, 0, 0, config.f, config.t, config.u, config.v };
+    memcpy(pc+CHUNK_COORDINATE_SCALE, d, sizeof(d));
+  }
+}
+
+uint32_t SimDevice::getUInt32(size_t address) const
+{
+  uint32_t ret;
+  memcpy(&ret, reg.data()+address, sizeof(ret));
+  return ret;
+}
+
+double SimDevice::getDouble(size_t address) const
+{
+  double ret;
+  memcpy(&ret, reg.data()+address, sizeof(ret));
+  return ret;
+}
+
+void SimDevice::setUInt32(size_t address, uint32_t value)
+{
+  memcpy(reg.data()+address, &value, sizeof(value));
+}
+
+void SimDevice::setDouble(size_t address, double value)
+{
+  memcpy(reg.data()+address, &value, sizeof(value));
+}
+
+void SimDevice::setString(size_t address, const std::string &value)
+{
+  memset(reg.data()+address, 0, 32);
+  memcpy(reg.data()+address, value.c_str(), std::min(value.size(), static_cast<size_t>(31)));
+}
+
+void SimDevice::updateRegisters()
+{
+  Config c=getConfig();
+
+  setUInt32(REG_PAYLOAD_SIZE, static_cast<uint32_t>(getPayloadSize(c)));
+  setDouble(REG_FOCAL_LENGTH, c.f);
+  setDouble(REG_PRINCIPAL_POINT_U, c.u);
+  setDouble(REG_PRINCIPAL_POINT_V, c.v);
+  setDouble(REG_FOCAL_LENGTH_FACTOR, focal_length_factor);
+}
+
+SimProducer::SimProducer() : SoftProducer("rc_sim", "Simulation", "GEV")
+{
+  addDevice(std::make_shared<SimDevice>("rc_sim"));
+}
+
+}
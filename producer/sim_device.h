@@ -0,0 +1,142 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RC_GENICAM_API_SIM_DEVICE
+#define RC_GENICAM_API_SIM_DEVICE
+
+#include "soft_producer.h"
+
+namespace rcg
+{
+
+/**
+  Model of a software camera that generates a synthetic stereo scene. The
+  camera offers the components Intensity (Mono8 or YCbCr411_8), Disparity
+  (Coord3D_C16), Confidence (Confidence8) and Error (Error8) with
+  configurable resolution and frame rate. Enabled components are either sent
+  as one multi part buffer or as separate buffers per component, depending
+  on AcquisitionMultiPartMode. If ChunkModeActive is set, then all buffers
+  contain chunk data in GigE Vision layout with the ChunkScan3d parameters.
+*/
+
+class SimDevice : public SoftDevice
+{
+  public:
+
+    /**
+      Creates the device.
+
+      @param id Device ID, which is also used as serial number.
+    */
+
+    SimDevice(const std::string &id);
+
+    std::string getInfo(GenTL::DEVICE_INFO_CMD cmd);
+
+    std::string getXMLURL();
+
+    GenTL::GC_ERROR readRegister(uint64_t address, void *buffer, size_t *size);
+    GenTL::GC_ERROR writeRegister(uint64_t address, const void *buffer, size_t *size);
+
+    size_t getPayloadSize();
+
+    void startAcquisition();
+    bool prepareFrame(std::chrono::steady_clock::time_point &t, bool &wait_for_buffer);
+    void fillBuffer(SoftBuffer &buffer);
+
+  private:
+
+    struct Config
+    {
+      uint32_t width, height;
+      uint64_t format;
+      bool enabled[4];
+      bool multipart;
+      bool chunks;
+      double rate;
+      double exposure, gain;
+      double f, t, u, v;
+    };
+
+    Config getConfig() const;
+    size_t getComponentSize(const Config &c, int component) const;
+    size_t getPayloadSize(const Config &c) const;
+    void createImages();
+    void writeChunkData(uint8_t *p, uint64_t timestamp, const int *part) const;
+
+    uint32_t getUInt32(size_t address) const;
+    double getDouble(size_t address) const;
+    void setUInt32(size_t address, uint32_t value);
+    void setDouble(size_t address, double value);
+    void setString(size_t address, const std::string &value);
+    void updateRegisters();
+
+    std::string id;
+
+    std::mutex mtx;
+    std::vector<uint8_t> reg;
+    std::string xml;
+
+    // state of current acquisition
+
+    Config config;
+    std::vector<uint8_t> image[4];
+
+    std::chrono::steady_clock::time_point start;
+    std::chrono::system_clock::time_point system_start;
+    uint64_t frame;
+    int component;
+    uint64_t block;
+
+    uint64_t current_frame;
+    uint64_t current_block;
+    int current_component;
+    std::chrono::steady_clock::time_point current_time;
+};
+
+/**
+  Producer that offers one simulated camera.
+*/
+
+class SimProducer : public SoftProducer
+{
+  public:
+
+    SimProducer();
+};
+
+}
+
+#endif
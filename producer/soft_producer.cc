@@ -0,0 +1,2048 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "soft_producer.h"
+
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <algorithm>
+
+#ifndef PRODUCER_VERSION
+#define PRODUCER_VERSION "unknown"
+#endif
+
+namespace rcg
+{
+
+/*
+  SoftBuffer
+*/
+
+SoftBuffer::SoftBuffer(void *_data, size_t _size, void *_priv)
+{
+  data=static_cast<uint8_t *>(_data);
+  size=_size;
+  priv=_priv;
+  allocated=false;
+  state=ANNOUNCED;
+
+  if (data == 0)
+  {
+    data=new uint8_t [size];
+    allocated=true;
+  }
+}
+
+SoftBuffer::~SoftBuffer()
+{
+  if (allocated)
+  {
+    delete [] data;
+  }
+}
+
+void SoftBuffer::clearInfo()
+{
+  info.clear();
+  part_info.clear();
+  part_offset.clear();
+}
+
+void SoftBuffer::setInfo(int32_t cmd, GenTL::INFO_DATATYPE type, const void *value, size_t size)
+{
+  Value &v=info[cmd];
+
+  v.type=type;
+  v.data.assign(static_cast<const uint8_t *>(value), static_cast<const uint8_t *>(value)+size);
+}
+
+void SoftBuffer::setNumParts(uint32_t n)
+{
+  part_info.resize(n);
+  part_offset.resize(n, 0);
+}
+
+void SoftBuffer::setPartOffset(uint32_t part, size_t offset)
+{
+  if (part >= part_offset.size())
+  {
+    setNumParts(part+1);
+  }
+
+  part_offset[part]=offset;
+}
+
+void SoftBuffer::setPartInfo(uint32_t part, int32_t cmd, GenTL::INFO_DATATYPE type,
+  const void *value, size_t size)
+{
+  if (part >= part_info.size())
+  {
+    setNumParts(part+1);
+  }
+
+  Value &v=part_info[part][cmd];
+
+  v.type=type;
+  v.data.assign(static_cast<const uint8_t *>(value), static_cast<const uint8_t *>(value)+size);
+}
+
+GenTL::GC_ERROR SoftBuffer::getValue(const Value &value, GenTL::INFO_DATATYPE *piType,
+  void *pBuffer, size_t *piSize)
+{
+  if (piSize == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Size pointer must not be 0");
+  }
+
+  if (piType != 0)
+  {
+    *piType=value.type;
+  }
+
+  if (pBuffer != 0)
+  {
+    if (*piSize < value.data.size())
+    {
+      *piSize=value.data.size();
+      return setLastError(GenTL::GC_ERR_BUFFER_TOO_SMALL, "Buffer too small");
+    }
+
+    if (value.data.size() > 0)
+    {
+      memcpy(pBuffer, value.data.data(), value.data.size());
+    }
+  }
+
+  *piSize=value.data.size();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftBuffer::getInfo(GenTL::BUFFER_INFO_CMD cmd, GenTL::INFO_DATATYPE *piType,
+  void *pBuffer, size_t *piSize)
+{
+  switch (cmd)
+  {
+    case GenTL::BUFFER_INFO_BASE:
+      return returnInfoValue(piType, pBuffer, piSize, static_cast<void *>(data),
+        GenTL::INFO_DATATYPE_PTR);
+
+    case GenTL::BUFFER_INFO_SIZE:
+      return returnInfoValue(piType, pBuffer, piSize, size, GenTL::INFO_DATATYPE_SIZET);
+
+    case GenTL::BUFFER_INFO_USER_PTR:
+      return returnInfoValue(piType, pBuffer, piSize, priv, GenTL::INFO_DATATYPE_PTR);
+
+    case GenTL::BUFFER_INFO_NEW_DATA:
+      return returnInfoValue(piType, pBuffer, piSize, static_cast<bool8_t>(state == OUTPUT),
+        GenTL::INFO_DATATYPE_BOOL8);
+
+    case GenTL::BUFFER_INFO_IS_QUEUED:
+      return returnInfoValue(piType, pBuffer, piSize,
+        static_cast<bool8_t>(state == INPUT || state == OUTPUT), GenTL::INFO_DATATYPE_BOOL8);
+
+    case GenTL::BUFFER_INFO_IS_ACQUIRING:
+      return returnInfoValue(piType, pBuffer, piSize, static_cast<bool8_t>(state == FILLING),
+        GenTL::INFO_DATATYPE_BOOL8);
+
+    default:
+      break;
+  }
+
+  std::map<int32_t, Value>::const_iterator it=info.find(cmd);
+
+  if (it == info.end())
+  {
+    return setLastError(GenTL::GC_ERR_NOT_AVAILABLE, "Buffer information not available");
+  }
+
+  return getValue(it->second, piType, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR SoftBuffer::getPartInfo(uint32_t part, GenTL::BUFFER_PART_INFO_CMD cmd,
+  GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  if (part >= part_info.size())
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_INDEX, "Invalid part index");
+  }
+
+  if (cmd == GenTL::BUFFER_PART_INFO_BASE)
+  {
+    return returnInfoValue(piType, pBuffer, piSize, static_cast<void *>(data+part_offset[part]),
+      GenTL::INFO_DATATYPE_PTR);
+  }
+
+  std::map<int32_t, Value>::const_iterator it=part_info[part].find(cmd);
+
+  if (it == part_info[part].end())
+  {
+    return setLastError(GenTL::GC_ERR_NOT_AVAILABLE, "Buffer part information not available");
+  }
+
+  return getValue(it->second, piType, pBuffer, piSize);
+}
+
+/*
+  Internal objects that are given to the consumer as handles.
+*/
+
+namespace
+{
+
+enum HandleKind
+{
+  KIND_SYSTEM, KIND_INTERFACE, KIND_DEVICE, KIND_REMOTE_PORT, KIND_STREAM, KIND_EVENT
+};
+
+const char *port_name[]={ "TLSystem", "TLInterface", "TLDevice", "Device", "TLDataStream",
+  "TLEvent" };
+
+}
+
+struct SoftProducer::Handle
+{
+  Handle(int _kind) : kind(_kind) { }
+  virtual ~Handle() { }
+
+  int kind;
+};
+
+struct SoftProducer::System : public SoftProducer::Handle
+{
+  System() : Handle(KIND_SYSTEM), open(false) { }
+
+  bool open;
+};
+
+struct SoftProducer::Interface : public SoftProducer::Handle
+{
+  Interface() : Handle(KIND_INTERFACE), open(false) { }
+
+  bool open;
+};
+
+struct SoftProducer::RemotePort : public SoftProducer::Handle
+{
+  RemotePort(Device *_device) : Handle(KIND_REMOTE_PORT), device(_device) { }
+
+  Device *device;
+};
+
+struct SoftProducer::Event : public SoftProducer::Handle
+{
+  Event(Stream *_stream) : Handle(KIND_EVENT), stream(_stream), killed(false), fired(0) { }
+
+  Stream *stream;
+  bool killed;
+  uint64_t fired;
+};
+
+struct SoftProducer::Stream : public SoftProducer::Handle
+{
+  Stream(Device *_device) : Handle(KIND_STREAM), device(_device)
+  {
+    acquiring=false;
+    num_to_acquire=0;
+    num_delivered=0;
+    num_underrun=0;
+    num_started=0;
+    closed=false;
+    waiting=0;
+  }
+
+  Device *device;
+
+  std::mutex mtx;
+  std::condition_variable cv;
+
+  // the stream is only destroyed if no thread is waiting in EventGetData()
+
+  bool closed;
+  int waiting;
+
+  std::vector<std::unique_ptr<SoftBuffer> > buffer;
+  std::deque<SoftBuffer *> input;
+  std::deque<SoftBuffer *> output;
+  std::unique_ptr<Event> event;
+
+  std::thread thread;
+  bool acquiring;
+  uint64_t num_to_acquire;
+
+  uint64_t num_delivered;
+  uint64_t num_underrun;
+  uint64_t num_started;
+};
+
+struct SoftProducer::Device : public SoftProducer::Handle
+{
+  Device(const std::shared_ptr<SoftDevice> &_model) : Handle(KIND_DEVICE), model(_model),
+    port(this), open(false)
+  {
+    id=model->getInfo(GenTL::DEVICE_INFO_ID);
+  }
+
+  std::string id;
+  std::shared_ptr<SoftDevice> model;
+  RemotePort port;
+  std::unique_ptr<Stream> stream;
+  bool open;
+};
+
+/*
+  SoftProducer
+*/
+
+SoftProducer::SoftProducer(const std::string &_id, const std::string &_model,
+  const std::string &_tltype) : id(_id), model(_model), tltype(_tltype)
+{
+  system.reset(new System());
+  iface.reset(new Interface());
+}
+
+SoftProducer::~SoftProducer()
+{
+  for (size_t i=0; i<device.size(); i++)
+  {
+    closeDevice(device[i].get());
+  }
+}
+
+void SoftProducer::addDevice(const std::shared_ptr<SoftDevice> &dev)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+  device.push_back(std::unique_ptr<Device>(new Device(dev)));
+}
+
+SoftProducer::Handle *SoftProducer::getHandle(void *h, int kind)
+{
+  Handle *ret=static_cast<Handle *>(h);
+
+  if (ret == 0 || handles.find(ret) == handles.end() || (kind >= 0 && ret->kind != kind))
+  {
+    return 0;
+  }
+
+  return ret;
+}
+
+SoftProducer::Stream *SoftProducer::getStream(void *h)
+{
+  return static_cast<Stream *>(getHandle(h, KIND_STREAM));
+}
+
+SoftBuffer *SoftProducer::getBuffer(Stream *stream, void *h)
+{
+  for (size_t i=0; i<stream->buffer.size(); i++)
+  {
+    if (stream->buffer[i].get() == h)
+    {
+      return stream->buffer[i].get();
+    }
+  }
+
+  return 0;
+}
+
+SoftProducer::Device *SoftProducer::findDevice(const char *did)
+{
+  if (did != 0)
+  {
+    for (size_t i=0; i<device.size(); i++)
+    {
+      if (device[i]->id == did)
+      {
+        return device[i].get();
+      }
+    }
+  }
+
+  return 0;
+}
+
+void SoftProducer::stopStream(Stream *stream, std::unique_lock<std::mutex> &lock)
+{
+  if (stream->thread.joinable())
+  {
+    stream->acquiring=false;
+    stream->cv.notify_all();
+
+    lock.unlock();
+    stream->thread.join();
+    lock.lock();
+  }
+}
+
+void SoftProducer::closeStream(Stream *stream)
+{
+  {
+    std::unique_lock<std::mutex> lock(stream->mtx);
+    stopStream(stream, lock);
+
+    // abort waiting in EventGetData() and wait until all threads have left
+
+    stream->closed=true;
+
+    if (stream->event)
+    {
+      stream->event->killed=true;
+    }
+
+    stream->cv.notify_all();
+    stream->cv.wait(lock, [stream] { return stream->waiting == 0; });
+  }
+
+  if (stream->event)
+  {
+    handles.erase(stream->event.get());
+  }
+
+  handles.erase(stream);
+  stream->device->stream.reset();
+}
+
+void SoftProducer::closeDevice(Device *dev)
+{
+  if (dev->stream)
+  {
+    closeStream(dev->stream.get());
+  }
+
+  handles.erase(&dev->port);
+  handles.erase(dev);
+  dev->open=false;
+}
+
+void SoftProducer::runStream(Stream *stream)
+{
+  SoftDevice *model=stream->device->model.get();
+
+  model->startAcquisition();
+
+  std::unique_lock<std::mutex> lock(stream->mtx);
+
+  uint64_t n=0;
+  while (stream->acquiring && (stream->num_to_acquire == GENTL_INFINITE ||
+    n < stream->num_to_acquire))
+  {
+    // prepare next frame and wait until it can be delivered
+
+    std::chrono::steady_clock::time_point t;
+    bool wait_for_buffer=false;
+
+    lock.unlock();
+    bool ok=model->prepareFrame(t, wait_for_buffer);
+    lock.lock();
+
+    if (!ok)
+    {
+      break;
+    }
+
+    stream->cv.wait_until(lock, t, [stream] { return !stream->acquiring; });
+
+    if (wait_for_buffer)
+    {
+      stream->cv.wait(lock, [stream] { return !stream->acquiring || stream->input.size() > 0; });
+    }
+
+    if (!stream->acquiring)
+    {
+      break;
+    }
+
+    // get free buffer or drop frame
+
+    if (stream->input.size() == 0)
+    {
+      stream->num_underrun++;
+      continue;
+    }
+
+    SoftBuffer *buffer=stream->input.front();
+    stream->input.pop_front();
+    buffer->setState(SoftBuffer::FILLING);
+
+    lock.unlock();
+    buffer->clearInfo();
+    model->fillBuffer(*buffer);
+    lock.lock();
+
+    // deliver buffer
+
+    buffer->setState(SoftBuffer::OUTPUT);
+    stream->output.push_back(buffer);
+    stream->num_delivered++;
+    n++;
+
+    if (stream->event)
+    {
+      stream->event->fired++;
+    }
+
+    stream->cv.notify_all();
+  }
+
+  stream->acquiring=false;
+  lock.unlock();
+
+  model->stopAcquisition();
+}
+
+GenTL::GC_ERROR SoftProducer::GCGetInfo(GenTL::TL_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType,
+  void *pBuffer, size_t *piSize)
+{
+  switch (iInfoCmd)
+  {
+    case GenTL::TL_INFO_ID:
+      return returnInfoString(piType, pBuffer, piSize, id);
+
+    case GenTL::TL_INFO_VENDOR:
+      return returnInfoString(piType, pBuffer, piSize, "Roboception GmbH");
+
+    case GenTL::TL_INFO_MODEL:
+    case GenTL::TL_INFO_DISPLAYNAME:
+      return returnInfoString(piType, pBuffer, piSize, model);
+
+    case GenTL::TL_INFO_VERSION:
+      return returnInfoString(piType, pBuffer, piSize, PRODUCER_VERSION);
+
+    case GenTL::TL_INFO_TLTYPE:
+      return returnInfoString(piType, pBuffer, piSize, tltype);
+
+    case GenTL::TL_INFO_CHAR_ENCODING:
+      return returnInfoValue(piType, pBuffer, piSize,
+        static_cast<int32_t>(GenTL::TL_CHAR_ENCODING_ASCII), GenTL::INFO_DATATYPE_INT32);
+
+    case GenTL::TL_INFO_GENTL_VER_MAJOR:
+      return returnInfoValue(piType, pBuffer, piSize, static_cast<uint32_t>(1),
+        GenTL::INFO_DATATYPE_UINT32);
+
+    case GenTL::TL_INFO_GENTL_VER_MINOR:
+      return returnInfoValue(piType, pBuffer, piSize, static_cast<uint32_t>(5),
+        GenTL::INFO_DATATYPE_UINT32);
+
+    default:
+      break;
+  }
+
+  return setLastError(GenTL::GC_ERR_NOT_AVAILABLE, "Information not available");
+}
+
+GenTL::GC_ERROR SoftProducer::GCReadPort(GenTL::PORT_HANDLE hPort, uint64_t iAddress,
+  void *pBuffer, size_t *piSize)
+{
+  SoftDevice *dev=0;
+
+  {
+    std::lock_guard<std::recursive_mutex> lock(mtx);
+
+    Handle *h=getHandle(hPort, -1);
+
+    if (h == 0)
+    {
+      return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid port handle");
+    }
+
+    if (h->kind != KIND_REMOTE_PORT)
+    {
+      return setLastError(GenTL::GC_ERR_NOT_IMPLEMENTED, "Port does not have registers");
+    }
+
+    dev=static_cast<RemotePort *>(h)->device->model.get();
+  }
+
+  if (pBuffer == 0 || piSize == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  return dev->readRegister(iAddress, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR SoftProducer::GCWritePort(GenTL::PORT_HANDLE hPort, uint64_t iAddress,
+  const void *pBuffer, size_t *piSize)
+{
+  SoftDevice *dev=0;
+
+  {
+    std::lock_guard<std::recursive_mutex> lock(mtx);
+
+    Handle *h=getHandle(hPort, -1);
+
+    if (h == 0)
+    {
+      return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid port handle");
+    }
+
+    if (h->kind != KIND_REMOTE_PORT)
+    {
+      return setLastError(GenTL::GC_ERR_NOT_IMPLEMENTED, "Port does not have registers");
+    }
+
+    dev=static_cast<RemotePort *>(h)->device->model.get();
+  }
+
+  if (pBuffer == 0 || piSize == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  return dev->writeRegister(iAddress, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR SoftProducer::GCGetPortURL(GenTL::PORT_HANDLE hPort, char *sURL, size_t *piSize)
+{
+  GenTL::INFO_DATATYPE type;
+  return GCGetPortURLInfo(hPort, 0, GenTL::URL_INFO_URL, &type, sURL, piSize);
+}
+
+GenTL::GC_ERROR SoftProducer::GCGetPortInfo(GenTL::PORT_HANDLE hPort,
+  GenTL::PORT_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Handle *h=getHandle(hPort, -1);
+
+  if (h == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid port handle");
+  }
+
+  bool remote=(h->kind == KIND_REMOTE_PORT);
+
+  switch (iInfoCmd)
+  {
+    case GenTL::PORT_INFO_ID:
+      if (remote)
+      {
+        return returnInfoString(piType, pBuffer, piSize,
+          static_cast<RemotePort *>(h)->device->id);
+      }
+
+      return returnInfoString(piType, pBuffer, piSize, port_name[h->kind]);
+
+    case GenTL::PORT_INFO_VENDOR:
+      return returnInfoString(piType, pBuffer, piSize, "Roboception GmbH");
+
+    case GenTL::PORT_INFO_MODEL:
+      return returnInfoString(piType, pBuffer, piSize, model);
+
+    case GenTL::PORT_INFO_TLTYPE:
+      return returnInfoString(piType, pBuffer, piSize, tltype);
+
+    case GenTL::PORT_INFO_MODULE:
+      return returnInfoString(piType, pBuffer, piSize, port_name[h->kind]);
+
+    case GenTL::PORT_INFO_LITTLE_ENDIAN:
+    case GenTL::PORT_INFO_ACCESS_READ:
+    case GenTL::PORT_INFO_ACCESS_WRITE:
+      return returnInfoValue(piType, pBuffer, piSize, static_cast<bool8_t>(remote),
+        GenTL::INFO_DATATYPE_BOOL8);
+
+    case GenTL::PORT_INFO_BIG_ENDIAN:
+      return returnInfoValue(piType, pBuffer, piSize, static_cast<bool8_t>(0),
+        GenTL::INFO_DATATYPE_BOOL8);
+
+    case GenTL::PORT_INFO_ACCESS_NA:
+    case GenTL::PORT_INFO_ACCESS_NI:
+      return returnInfoValue(piType, pBuffer, piSize, static_cast<bool8_t>(!remote),
+        GenTL::INFO_DATATYPE_BOOL8);
+
+    case GenTL::PORT_INFO_VERSION:
+      return returnInfoString(piType, pBuffer, piSize, PRODUCER_VERSION);
+
+    case GenTL::PORT_INFO_PORTNAME:
+      if (remote)
+      {
+        return returnInfoString(piType, pBuffer, piSize,
+          static_cast<RemotePort *>(h)->device->model->getPortName());
+      }
+
+      return returnInfoString(piType, pBuffer, piSize, port_name[h->kind]);
+
+    default:
+      break;
+  }
+
+  return setLastError(GenTL::GC_ERR_NOT_AVAILABLE, "Information not available");
+}
+
+GenTL::GC_ERROR SoftProducer::GCRegisterEvent(GenTL::EVENTSRC_HANDLE hEventSrc,
+  GenTL::EVENT_TYPE iEventID, GenTL::EVENT_HANDLE *phEvent)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hEventSrc);
+
+  if (stream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_NOT_IMPLEMENTED, "Events are only supported for streams");
+  }
+
+  if (iEventID != GenTL::EVENT_NEW_BUFFER)
+  {
+    return setLastError(GenTL::GC_ERR_NOT_IMPLEMENTED, "Event type is not supported");
+  }
+
+  if (phEvent == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  std::lock_guard<std::mutex> slock(stream->mtx);
+
+  if (stream->event)
+  {
+    return setLastError(GenTL::GC_ERR_RESOURCE_IN_USE, "Event is already registered");
+  }
+
+  stream->event.reset(new Event(stream));
+  handles.insert(stream->event.get());
+
+  *phEvent=stream->event.get();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::GCUnregisterEvent(GenTL::EVENTSRC_HANDLE hEventSrc,
+  GenTL::EVENT_TYPE iEventID)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hEventSrc);
+
+  if (stream == 0 || iEventID != GenTL::EVENT_NEW_BUFFER)
+  {
+    return setLastError(GenTL::GC_ERR_NOT_IMPLEMENTED, "Event is not supported");
+  }
+
+  std::lock_guard<std::mutex> slock(stream->mtx);
+
+  if (!stream->event)
+  {
+    return setLastError(GenTL::GC_ERR_RESOURCE_IN_USE, "Event is not registered");
+  }
+
+  handles.erase(stream->event.get());
+  stream->event.reset();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::EventGetData(GenTL::EVENT_HANDLE hEvent, void *pBuffer,
+  size_t *piSize, uint64_t iTimeout)
+{
+  Stream *stream=0;
+  std::unique_lock<std::mutex> slock;
+
+  {
+    std::lock_guard<std::recursive_mutex> lock(mtx);
+
+    Event *event=static_cast<Event *>(getHandle(hEvent, KIND_EVENT));
+
+    if (event == 0)
+    {
+      return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid event handle");
+    }
+
+    if (pBuffer == 0 || piSize == 0)
+    {
+      return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+    }
+
+    if (*piSize < sizeof(GenTL::EVENT_NEW_BUFFER_DATA))
+    {
+      *piSize=sizeof(GenTL::EVENT_NEW_BUFFER_DATA);
+      return setLastError(GenTL::GC_ERR_BUFFER_TOO_SMALL, "Buffer too small");
+    }
+
+    // register as waiting thread before releasing the producer lock, so
+    // that closing the stream waits until this thread has left
+
+    stream=event->stream;
+    slock=std::unique_lock<std::mutex>(stream->mtx);
+    stream->waiting++;
+  }
+
+  // wait for a filled buffer
+
+  auto ready=[stream]
+  {
+    return stream->closed || !stream->event || stream->event->killed ||
+      stream->output.size() > 0;
+  };
+
+  if (iTimeout == GENTL_INFINITE)
+  {
+    stream->cv.wait(slock, ready);
+  }
+  else
+  {
+    stream->cv.wait_for(slock, std::chrono::milliseconds(iTimeout), ready);
+  }
+
+  // the stream stays valid until the lock is released
+
+  stream->waiting--;
+
+  if (stream->closed)
+  {
+    stream->cv.notify_all();
+    return setLastError(GenTL::GC_ERR_ABORT, "Waiting for event aborted");
+  }
+
+  if (!stream->event || stream->event->killed)
+  {
+    if (stream->event)
+    {
+      stream->event->killed=false;
+    }
+
+    return setLastError(GenTL::GC_ERR_ABORT, "Waiting for event aborted");
+  }
+
+  if (stream->output.size() == 0)
+  {
+    return setLastError(GenTL::GC_ERR_TIMEOUT, "Timeout while waiting for event");
+  }
+
+  SoftBuffer *buffer=stream->output.front();
+  stream->output.pop_front();
+  buffer->setState(SoftBuffer::ANNOUNCED);
+
+  GenTL::EVENT_NEW_BUFFER_DATA *data=static_cast<GenTL::EVENT_NEW_BUFFER_DATA *>(pBuffer);
+  data->BufferHandle=buffer;
+  data->pUserPointer=buffer->getPrivate();
+
+  *piSize=sizeof(GenTL::EVENT_NEW_BUFFER_DATA);
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::EventGetDataInfo(GenTL::EVENT_HANDLE hEvent, const void *pInBuffer,
+  size_t iInSize, GenTL::EVENT_DATA_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType,
+  void *pOutBuffer, size_t *piOutSize)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hEvent, KIND_EVENT) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid event handle");
+  }
+
+  if (pInBuffer == 0 || iInSize < sizeof(GenTL::EVENT_NEW_BUFFER_DATA))
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid event data");
+  }
+
+  const GenTL::EVENT_NEW_BUFFER_DATA *data=
+    static_cast<const GenTL::EVENT_NEW_BUFFER_DATA *>(pInBuffer);
+
+  if (iInfoCmd == GenTL::EVENT_DATA_ID)
+  {
+    return returnInfoValue(piType, pOutBuffer, piOutSize, data->BufferHandle,
+      GenTL::INFO_DATATYPE_PTR);
+  }
+
+  return setLastError(GenTL::GC_ERR_NOT_AVAILABLE, "Information not available");
+}
+
+GenTL::GC_ERROR SoftProducer::EventGetInfo(GenTL::EVENT_HANDLE hEvent,
+  GenTL::EVENT_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Event *event=static_cast<Event *>(getHandle(hEvent, KIND_EVENT));
+
+  if (event == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid event handle");
+  }
+
+  std::lock_guard<std::mutex> slock(event->stream->mtx);
+
+  switch (iInfoCmd)
+  {
+    case GenTL::EVENT_EVENT_TYPE:
+      return returnInfoValue(piType, pBuffer, piSize,
+        static_cast<int32_t>(GenTL::EVENT_NEW_BUFFER), GenTL::INFO_DATATYPE_INT32);
+
+    case GenTL::EVENT_NUM_IN_QUEUE:
+      return returnInfoValue(piType, pBuffer, piSize, event->stream->output.size(),
+        GenTL::INFO_DATATYPE_SIZET);
+
+    case GenTL::EVENT_NUM_FIRED:
+      return returnInfoValue(piType, pBuffer, piSize, event->fired, GenTL::INFO_DATATYPE_UINT64);
+
+    case GenTL::EVENT_SIZE_MAX:
+      return returnInfoValue(piType, pBuffer, piSize, sizeof(GenTL::EVENT_NEW_BUFFER_DATA),
+        GenTL::INFO_DATATYPE_SIZET);
+
+    case GenTL::EVENT_INFO_DATA_SIZE_MAX:
+      return returnInfoValue(piType, pBuffer, piSize, sizeof(void *), GenTL::INFO_DATATYPE_SIZET);
+
+    default:
+      break;
+  }
+
+  return setLastError(GenTL::GC_ERR_NOT_AVAILABLE, "Information not available");
+}
+
+GenTL::GC_ERROR SoftProducer::EventFlush(GenTL::EVENT_HANDLE hEvent)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Event *event=static_cast<Event *>(getHandle(hEvent, KIND_EVENT));
+
+  if (event == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid event handle");
+  }
+
+  std::lock_guard<std::mutex> slock(event->stream->mtx);
+
+  for (size_t i=0; i<event->stream->output.size(); i++)
+  {
+    event->stream->output[i]->setState(SoftBuffer::ANNOUNCED);
+  }
+
+  event->stream->output.clear();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::EventKill(GenTL::EVENT_HANDLE hEvent)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Event *event=static_cast<Event *>(getHandle(hEvent, KIND_EVENT));
+
+  if (event == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid event handle");
+  }
+
+  std::lock_guard<std::mutex> slock(event->stream->mtx);
+
+  event->killed=true;
+  event->stream->cv.notify_all();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::TLOpen(GenTL::TL_HANDLE *phTL)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (phTL == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  if (system->open)
+  {
+    return setLastError(GenTL::GC_ERR_RESOURCE_IN_USE, "System is already open");
+  }
+
+  system->open=true;
+  handles.insert(system.get());
+
+  *phTL=system.get();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::TLClose(GenTL::TL_HANDLE hTL)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hTL, KIND_SYSTEM) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid system handle");
+  }
+
+  if (iface->open)
+  {
+    IFClose(iface.get());
+  }
+
+  system->open=false;
+  handles.erase(system.get());
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::TLGetInfo(GenTL::TL_HANDLE hTL, GenTL::TL_INFO_CMD iInfoCmd,
+  GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  {
+    std::lock_guard<std::recursive_mutex> lock(mtx);
+
+    if (getHandle(hTL, KIND_SYSTEM) == 0)
+    {
+      return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid system handle");
+    }
+  }
+
+  return GCGetInfo(iInfoCmd, piType, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR SoftProducer::TLGetNumInterfaces(GenTL::TL_HANDLE hTL, uint32_t *piNumIfaces)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hTL, KIND_SYSTEM) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid system handle");
+  }
+
+  if (piNumIfaces == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  *piNumIfaces=1;
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::TLGetInterfaceID(GenTL::TL_HANDLE hTL, uint32_t iIndex, char *sID,
+  size_t *piSize)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hTL, KIND_SYSTEM) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid system handle");
+  }
+
+  if (iIndex != 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_INDEX, "Invalid interface index");
+  }
+
+  GenTL::INFO_DATATYPE type;
+  return returnInfoString(&type, sID, piSize, id+"_if");
+}
+
+GenTL::GC_ERROR SoftProducer::TLGetInterfaceInfo(GenTL::TL_HANDLE hTL, const char *sIfaceID,
+  GenTL::INTERFACE_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer,
+  size_t *piSize)
+{
+  {
+    std::lock_guard<std::recursive_mutex> lock(mtx);
+
+    if (getHandle(hTL, KIND_SYSTEM) == 0)
+    {
+      return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid system handle");
+    }
+
+    if (sIfaceID == 0 || id+"_if" != sIfaceID)
+    {
+      return setLastError(GenTL::GC_ERR_INVALID_ID, "Invalid interface ID");
+    }
+  }
+
+  switch (iInfoCmd)
+  {
+    case GenTL::INTERFACE_INFO_ID:
+      return returnInfoString(piType, pBuffer, piSize, id+"_if");
+
+    case GenTL::INTERFACE_INFO_DISPLAYNAME:
+      return returnInfoString(piType, pBuffer, piSize, model+" interface");
+
+    case GenTL::INTERFACE_INFO_TLTYPE:
+      return returnInfoString(piType, pBuffer, piSize, tltype);
+
+    default:
+      break;
+  }
+
+  return setLastError(GenTL::GC_ERR_NOT_AVAILABLE, "Information not available");
+}
+
+GenTL::GC_ERROR SoftProducer::TLOpenInterface(GenTL::TL_HANDLE hTL, const char *sIfaceID,
+  GenTL::IF_HANDLE *phIface)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hTL, KIND_SYSTEM) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid system handle");
+  }
+
+  if (sIfaceID == 0 || id+"_if" != sIfaceID)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_ID, "Invalid interface ID");
+  }
+
+  if (phIface == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  if (iface->open)
+  {
+    return setLastError(GenTL::GC_ERR_RESOURCE_IN_USE, "Interface is already open");
+  }
+
+  iface->open=true;
+  handles.insert(iface.get());
+
+  *phIface=iface.get();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::TLUpdateInterfaceList(GenTL::TL_HANDLE hTL, bool8_t *pbChanged,
+  uint64_t)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hTL, KIND_SYSTEM) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid system handle");
+  }
+
+  if (pbChanged != 0)
+  {
+    *pbChanged=0;
+  }
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::IFClose(GenTL::IF_HANDLE hIface)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hIface, KIND_INTERFACE) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid interface handle");
+  }
+
+  for (size_t i=0; i<device.size(); i++)
+  {
+    if (device[i]->open)
+    {
+      closeDevice(device[i].get());
+    }
+  }
+
+  iface->open=false;
+  handles.erase(iface.get());
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::IFGetInfo(GenTL::IF_HANDLE hIface,
+  GenTL::INTERFACE_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer,
+  size_t *piSize)
+{
+  {
+    std::lock_guard<std::recursive_mutex> lock(mtx);
+
+    if (getHandle(hIface, KIND_INTERFACE) == 0)
+    {
+      return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid interface handle");
+    }
+  }
+
+  return TLGetInterfaceInfo(system.get(), (id+"_if").c_str(), iInfoCmd, piType, pBuffer,
+    piSize);
+}
+
+GenTL::GC_ERROR SoftProducer::IFGetNumDevices(GenTL::IF_HANDLE hIface, uint32_t *piNumDevices)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hIface, KIND_INTERFACE) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid interface handle");
+  }
+
+  if (piNumDevices == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  *piNumDevices=static_cast<uint32_t>(device.size());
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::IFGetDeviceID(GenTL::IF_HANDLE hIface, uint32_t iIndex,
+  char *sIDeviceID, size_t *piSize)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hIface, KIND_INTERFACE) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid interface handle");
+  }
+
+  if (iIndex >= device.size())
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_INDEX, "Invalid device index");
+  }
+
+  GenTL::INFO_DATATYPE type;
+  return returnInfoString(&type, sIDeviceID, piSize, device[iIndex]->id);
+}
+
+GenTL::GC_ERROR SoftProducer::IFUpdateDeviceList(GenTL::IF_HANDLE hIface, bool8_t *pbChanged,
+  uint64_t)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hIface, KIND_INTERFACE) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid interface handle");
+  }
+
+  if (pbChanged != 0)
+  {
+    *pbChanged=0;
+  }
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::IFGetDeviceInfo(GenTL::IF_HANDLE hIface, const char *sDeviceID,
+  GenTL::DEVICE_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hIface, KIND_INTERFACE) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid interface handle");
+  }
+
+  Device *dev=findDevice(sDeviceID);
+
+  if (dev == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_ID, "Invalid device ID");
+  }
+
+  switch (iInfoCmd)
+  {
+    case GenTL::DEVICE_INFO_ACCESS_STATUS:
+      return returnInfoValue(piType, pBuffer, piSize, static_cast<int32_t>(dev->open ?
+        GenTL::DEVICE_ACCESS_STATUS_OPEN_READWRITE : GenTL::DEVICE_ACCESS_STATUS_READWRITE),
+        GenTL::INFO_DATATYPE_INT32);
+
+    case GenTL::DEVICE_INFO_TIMESTAMP_FREQUENCY:
+      return returnInfoValue(piType, pBuffer, piSize, dev->model->getTimestampFrequency(),
+        GenTL::INFO_DATATYPE_UINT64);
+
+    default:
+      {
+        std::string value=dev->model->getInfo(iInfoCmd);
+
+        if (value.size() > 0)
+        {
+          return returnInfoString(piType, pBuffer, piSize, value);
+        }
+      }
+      break;
+  }
+
+  return setLastError(GenTL::GC_ERR_NOT_AVAILABLE, "Information not available");
+}
+
+GenTL::GC_ERROR SoftProducer::IFOpenDevice(GenTL::IF_HANDLE hIface, const char *sDeviceID,
+  GenTL::DEVICE_ACCESS_FLAGS, GenTL::DEV_HANDLE *phDevice)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hIface, KIND_INTERFACE) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid interface handle");
+  }
+
+  Device *dev=findDevice(sDeviceID);
+
+  if (dev == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_ID, "Invalid device ID");
+  }
+
+  if (phDevice == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  if (dev->open)
+  {
+    return setLastError(GenTL::GC_ERR_RESOURCE_IN_USE, "Device is already open");
+  }
+
+  dev->open=true;
+  handles.insert(dev);
+  handles.insert(&dev->port);
+
+  *phDevice=dev;
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DevGetPort(GenTL::DEV_HANDLE hDevice,
+  GenTL::PORT_HANDLE *phRemoteDevice)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Device *dev=static_cast<Device *>(getHandle(hDevice, KIND_DEVICE));
+
+  if (dev == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid device handle");
+  }
+
+  if (phRemoteDevice == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  *phRemoteDevice=&dev->port;
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DevGetNumDataStreams(GenTL::DEV_HANDLE hDevice,
+  uint32_t *piNumDataStreams)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hDevice, KIND_DEVICE) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid device handle");
+  }
+
+  if (piNumDataStreams == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  *piNumDataStreams=1;
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DevGetDataStreamID(GenTL::DEV_HANDLE hDevice, uint32_t iIndex,
+  char *sDataStreamID, size_t *piSize)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hDevice, KIND_DEVICE) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid device handle");
+  }
+
+  if (iIndex != 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_INDEX, "Invalid stream index");
+  }
+
+  GenTL::INFO_DATATYPE type;
+  return returnInfoString(&type, sDataStreamID, piSize, "Stream0");
+}
+
+GenTL::GC_ERROR SoftProducer::DevOpenDataStream(GenTL::DEV_HANDLE hDevice,
+  const char *sDataStreamID, GenTL::DS_HANDLE *phDataStream)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Device *dev=static_cast<Device *>(getHandle(hDevice, KIND_DEVICE));
+
+  if (dev == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid device handle");
+  }
+
+  if (sDataStreamID == 0 || std::string("Stream0") != sDataStreamID)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_ID, "Invalid stream ID");
+  }
+
+  if (phDataStream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  if (dev->stream)
+  {
+    return setLastError(GenTL::GC_ERR_RESOURCE_IN_USE, "Stream is already open");
+  }
+
+  dev->stream.reset(new Stream(dev));
+  handles.insert(dev->stream.get());
+
+  *phDataStream=dev->stream.get();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DevGetInfo(GenTL::DEV_HANDLE hDevice,
+  GenTL::DEVICE_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Device *dev=static_cast<Device *>(getHandle(hDevice, KIND_DEVICE));
+
+  if (dev == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid device handle");
+  }
+
+  return IFGetDeviceInfo(iface.get(), dev->id.c_str(), iInfoCmd, piType, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR SoftProducer::DevClose(GenTL::DEV_HANDLE hDevice)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Device *dev=static_cast<Device *>(getHandle(hDevice, KIND_DEVICE));
+
+  if (dev == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid device handle");
+  }
+
+  closeDevice(dev);
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DSAnnounceBuffer(GenTL::DS_HANDLE hDataStream, void *pBuffer,
+  size_t iSize, void *pPrivate, GenTL::BUFFER_HANDLE *phBuffer)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hDataStream);
+
+  if (stream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid stream handle");
+  }
+
+  if (pBuffer == 0 || iSize == 0 || phBuffer == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  std::lock_guard<std::mutex> slock(stream->mtx);
+
+  stream->buffer.push_back(std::unique_ptr<SoftBuffer>(new SoftBuffer(pBuffer, iSize,
+    pPrivate)));
+
+  *phBuffer=stream->buffer.back().get();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DSAllocAndAnnounceBuffer(GenTL::DS_HANDLE hDataStream,
+  size_t iSize, void *pPrivate, GenTL::BUFFER_HANDLE *phBuffer)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hDataStream);
+
+  if (stream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid stream handle");
+  }
+
+  if (iSize == 0 || phBuffer == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  std::lock_guard<std::mutex> slock(stream->mtx);
+
+  stream->buffer.push_back(std::unique_ptr<SoftBuffer>(new SoftBuffer(0, iSize, pPrivate)));
+
+  *phBuffer=stream->buffer.back().get();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DSFlushQueue(GenTL::DS_HANDLE hDataStream,
+  GenTL::ACQ_QUEUE_TYPE iOperation)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hDataStream);
+
+  if (stream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid stream handle");
+  }
+
+  std::lock_guard<std::mutex> slock(stream->mtx);
+
+  switch (iOperation)
+  {
+    case GenTL::ACQ_QUEUE_INPUT_TO_OUTPUT:
+      while (stream->input.size() > 0)
+      {
+        SoftBuffer *buffer=stream->input.front();
+        stream->input.pop_front();
+
+        buffer->clearInfo();
+        buffer->setState(SoftBuffer::OUTPUT);
+        stream->output.push_back(buffer);
+      }
+      break;
+
+    case GenTL::ACQ_QUEUE_OUTPUT_DISCARD:
+      for (size_t i=0; i<stream->output.size(); i++)
+      {
+        stream->output[i]->setState(SoftBuffer::ANNOUNCED);
+      }
+
+      stream->output.clear();
+      break;
+
+    case GenTL::ACQ_QUEUE_ALL_TO_INPUT:
+    case GenTL::ACQ_QUEUE_UNQUEUED_TO_INPUT:
+      if (iOperation == GenTL::ACQ_QUEUE_ALL_TO_INPUT)
+      {
+        for (size_t i=0; i<stream->output.size(); i++)
+        {
+          stream->output[i]->setState(SoftBuffer::ANNOUNCED);
+        }
+
+        stream->output.clear();
+      }
+
+      for (size_t i=0; i<stream->buffer.size(); i++)
+      {
+        if (stream->buffer[i]->getState() == SoftBuffer::ANNOUNCED)
+        {
+          stream->buffer[i]->setState(SoftBuffer::INPUT);
+          stream->input.push_back(stream->buffer[i].get());
+        }
+      }
+      break;
+
+    case GenTL::ACQ_QUEUE_ALL_DISCARD:
+      for (size_t i=0; i<stream->input.size(); i++)
+      {
+        stream->input[i]->setState(SoftBuffer::ANNOUNCED);
+      }
+
+      for (size_t i=0; i<stream->output.size(); i++)
+      {
+        stream->output[i]->setState(SoftBuffer::ANNOUNCED);
+      }
+
+      stream->input.clear();
+      stream->output.clear();
+      break;
+
+    default:
+      return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Unknown flush operation");
+  }
+
+  stream->cv.notify_all();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DSStartAcquisition(GenTL::DS_HANDLE hDataStream,
+  GenTL::ACQ_START_FLAGS, uint64_t iNumToAcquire)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hDataStream);
+
+  if (stream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid stream handle");
+  }
+
+  std::unique_lock<std::mutex> slock(stream->mtx);
+
+  if (stream->acquiring)
+  {
+    return setLastError(GenTL::GC_ERR_RESOURCE_IN_USE, "Acquisition is already running");
+  }
+
+  // join thread that may have ended since there are no more frames
+
+  if (stream->thread.joinable())
+  {
+    slock.unlock();
+    stream->thread.join();
+    slock.lock();
+  }
+
+  stream->acquiring=true;
+  stream->num_to_acquire=iNumToAcquire;
+  stream->num_started++;
+
+  stream->thread=std::thread(&SoftProducer::runStream, this, stream);
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DSStopAcquisition(GenTL::DS_HANDLE hDataStream,
+  GenTL::ACQ_STOP_FLAGS)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hDataStream);
+
+  if (stream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid stream handle");
+  }
+
+  std::unique_lock<std::mutex> slock(stream->mtx);
+
+  if (!stream->acquiring && !stream->thread.joinable())
+  {
+    return setLastError(GenTL::GC_ERR_RESOURCE_IN_USE, "Acquisition is not running");
+  }
+
+  stopStream(stream, slock);
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DSGetInfo(GenTL::DS_HANDLE hDataStream,
+  GenTL::STREAM_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hDataStream);
+
+  if (stream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid stream handle");
+  }
+
+  if (iInfoCmd == GenTL::STREAM_INFO_PAYLOAD_SIZE)
+  {
+    // must not be called while holding the stream lock, since the device
+    // may need to synchronize with filling a buffer
+
+    return returnInfoValue(piType, pBuffer, piSize, stream->device->model->getPayloadSize(),
+      GenTL::INFO_DATATYPE_SIZET);
+  }
+
+  std::lock_guard<std::mutex> slock(stream->mtx);
+
+  switch (iInfoCmd)
+  {
+    case GenTL::STREAM_INFO_ID:
+      return returnInfoString(piType, pBuffer, piSize, "Stream0");
+
+    case GenTL::STREAM_INFO_NUM_DELIVERED:
+      return returnInfoValue(piType, pBuffer, piSize, stream->num_delivered,
+        GenTL::INFO_DATATYPE_UINT64);
+
+    case GenTL::STREAM_INFO_NUM_UNDERRUN:
+      return returnInfoValue(piType, pBuffer, piSize, stream->num_underrun,
+        GenTL::INFO_DATATYPE_UINT64);
+
+    case GenTL::STREAM_INFO_NUM_ANNOUNCED:
+      return returnInfoValue(piType, pBuffer, piSize, stream->buffer.size(),
+        GenTL::INFO_DATATYPE_SIZET);
+
+    case GenTL::STREAM_INFO_NUM_QUEUED:
+      return returnInfoValue(piType, pBuffer, piSize, stream->input.size(),
+        GenTL::INFO_DATATYPE_SIZET);
+
+    case GenTL::STREAM_INFO_NUM_AWAIT_DELIVERY:
+      return returnInfoValue(piType, pBuffer, piSize, stream->output.size(),
+        GenTL::INFO_DATATYPE_SIZET);
+
+    case GenTL::STREAM_INFO_NUM_STARTED:
+      return returnInfoValue(piType, pBuffer, piSize, stream->num_started,
+        GenTL::INFO_DATATYPE_UINT64);
+
+    case GenTL::STREAM_INFO_IS_GRABBING:
+      return returnInfoValue(piType, pBuffer, piSize, static_cast<bool8_t>(stream->acquiring),
+        GenTL::INFO_DATATYPE_BOOL8);
+
+    case GenTL::STREAM_INFO_DEFINES_PAYLOADSIZE:
+      return returnInfoValue(piType, pBuffer, piSize, static_cast<bool8_t>(1),
+        GenTL::INFO_DATATYPE_BOOL8);
+
+    case GenTL::STREAM_INFO_TLTYPE:
+      return returnInfoString(piType, pBuffer, piSize, tltype);
+
+    case GenTL::STREAM_INFO_BUF_ANNOUNCE_MIN:
+      return returnInfoValue(piType, pBuffer, piSize, static_cast<size_t>(1),
+        GenTL::INFO_DATATYPE_SIZET);
+
+    case GenTL::STREAM_INFO_BUF_ALIGNMENT:
+      return returnInfoValue(piType, pBuffer, piSize, static_cast<size_t>(1),
+        GenTL::INFO_DATATYPE_SIZET);
+
+    default:
+      break;
+  }
+
+  return setLastError(GenTL::GC_ERR_NOT_AVAILABLE, "Information not available");
+}
+
+GenTL::GC_ERROR SoftProducer::DSGetBufferID(GenTL::DS_HANDLE hDataStream, uint32_t iIndex,
+  GenTL::BUFFER_HANDLE *phBuffer)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hDataStream);
+
+  if (stream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid stream handle");
+  }
+
+  if (phBuffer == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  std::lock_guard<std::mutex> slock(stream->mtx);
+
+  if (iIndex >= stream->buffer.size())
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_INDEX, "Invalid buffer index");
+  }
+
+  *phBuffer=stream->buffer[iIndex].get();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DSClose(GenTL::DS_HANDLE hDataStream)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hDataStream);
+
+  if (stream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid stream handle");
+  }
+
+  closeStream(stream);
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DSRevokeBuffer(GenTL::DS_HANDLE hDataStream,
+  GenTL::BUFFER_HANDLE hBuffer, void **pBuffer, void **pPrivate)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hDataStream);
+
+  if (stream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid stream handle");
+  }
+
+  std::lock_guard<std::mutex> slock(stream->mtx);
+
+  for (size_t i=0; i<stream->buffer.size(); i++)
+  {
+    SoftBuffer *buffer=stream->buffer[i].get();
+
+    if (buffer == hBuffer)
+    {
+      if (buffer->getState() != SoftBuffer::ANNOUNCED)
+      {
+        return setLastError(GenTL::GC_ERR_BUSY, "Buffer is still queued");
+      }
+
+      if (pBuffer != 0)
+      {
+        *pBuffer=0;
+
+        if (!buffer->isAllocated())
+        {
+          *pBuffer=buffer->getData();
+        }
+      }
+
+      if (pPrivate != 0)
+      {
+        *pPrivate=buffer->getPrivate();
+      }
+
+      stream->buffer.erase(stream->buffer.begin()+i);
+
+      return GenTL::GC_ERR_SUCCESS;
+    }
+  }
+
+  return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid buffer handle");
+}
+
+GenTL::GC_ERROR SoftProducer::DSQueueBuffer(GenTL::DS_HANDLE hDataStream,
+  GenTL::BUFFER_HANDLE hBuffer)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hDataStream);
+
+  if (stream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid stream handle");
+  }
+
+  std::lock_guard<std::mutex> slock(stream->mtx);
+
+  SoftBuffer *buffer=getBuffer(stream, hBuffer);
+
+  if (buffer == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid buffer handle");
+  }
+
+  if (buffer->getState() != SoftBuffer::ANNOUNCED)
+  {
+    return setLastError(GenTL::GC_ERR_RESOURCE_IN_USE, "Buffer is already queued");
+  }
+
+  buffer->setState(SoftBuffer::INPUT);
+  stream->input.push_back(buffer);
+  stream->cv.notify_all();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DSGetBufferInfo(GenTL::DS_HANDLE hDataStream,
+  GenTL::BUFFER_HANDLE hBuffer, GenTL::BUFFER_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType,
+  void *pBuffer, size_t *piSize)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hDataStream);
+
+  if (stream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid stream handle");
+  }
+
+  std::lock_guard<std::mutex> slock(stream->mtx);
+
+  SoftBuffer *buffer=getBuffer(stream, hBuffer);
+
+  if (buffer == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid buffer handle");
+  }
+
+  return buffer->getInfo(iInfoCmd, piType, pBuffer, piSize);
+}
+
+GenTL::GC_ERROR SoftProducer::GCGetNumPortURLs(GenTL::PORT_HANDLE hPort, uint32_t *piNumURLs)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Handle *h=getHandle(hPort, -1);
+
+  if (h == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid port handle");
+  }
+
+  if (piNumURLs == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  // only the remote device provides a GenICam XML file
+
+  *piNumURLs=0;
+  if (h->kind == KIND_REMOTE_PORT)
+  {
+    *piNumURLs=1;
+  }
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::GCGetPortURLInfo(GenTL::PORT_HANDLE hPort, uint32_t iURLIndex,
+  GenTL::URL_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Handle *h=getHandle(hPort, -1);
+
+  if (h == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid port handle");
+  }
+
+  if (h->kind != KIND_REMOTE_PORT || iURLIndex != 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_INDEX, "Invalid URL index");
+  }
+
+  if (iInfoCmd == GenTL::URL_INFO_URL)
+  {
+    return returnInfoString(piType, pBuffer, piSize,
+      static_cast<RemotePort *>(h)->device->model->getXMLURL());
+  }
+
+  return setLastError(GenTL::GC_ERR_NOT_AVAILABLE, "Information not available");
+}
+
+GenTL::GC_ERROR SoftProducer::IFGetParentTL(GenTL::IF_HANDLE hIface, GenTL::TL_HANDLE *phSystem)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hIface, KIND_INTERFACE) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid interface handle");
+  }
+
+  if (phSystem == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  *phSystem=system.get();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DevGetParentIF(GenTL::DEV_HANDLE hDevice, GenTL::IF_HANDLE *phIface)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  if (getHandle(hDevice, KIND_DEVICE) == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid device handle");
+  }
+
+  if (phIface == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  *phIface=iface.get();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DSGetParentDev(GenTL::DS_HANDLE hDataStream,
+  GenTL::DEV_HANDLE *phDevice)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hDataStream);
+
+  if (stream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid stream handle");
+  }
+
+  if (phDevice == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  *phDevice=stream->device;
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DSGetNumBufferParts(GenTL::DS_HANDLE hDataStream,
+  GenTL::BUFFER_HANDLE hBuffer, uint32_t *piNumParts)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hDataStream);
+
+  if (stream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid stream handle");
+  }
+
+  if (piNumParts == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_PARAMETER, "Invalid parameter");
+  }
+
+  std::lock_guard<std::mutex> slock(stream->mtx);
+
+  SoftBuffer *buffer=getBuffer(stream, hBuffer);
+
+  if (buffer == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid buffer handle");
+  }
+
+  *piNumParts=buffer->getNumParts();
+
+  return GenTL::GC_ERR_SUCCESS;
+}
+
+GenTL::GC_ERROR SoftProducer::DSGetBufferPartInfo(GenTL::DS_HANDLE hDataStream,
+  GenTL::BUFFER_HANDLE hBuffer, uint32_t iPartIndex, GenTL::BUFFER_PART_INFO_CMD iInfoCmd,
+  GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize)
+{
+  std::lock_guard<std::recursive_mutex> lock(mtx);
+
+  Stream *stream=getStream(hDataStream);
+
+  if (stream == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid stream handle");
+  }
+
+  std::lock_guard<std::mutex> slock(stream->mtx);
+
+  SoftBuffer *buffer=getBuffer(stream, hBuffer);
+
+  if (buffer == 0)
+  {
+    return setLastError(GenTL::GC_ERR_INVALID_HANDLE, "Invalid buffer handle");
+  }
+
+  return buffer->getPartInfo(iPartIndex, iInfoCmd, piType, pBuffer, piSize);
+}
+
+}
@@ -0,0 +1,476 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RC_GENICAM_API_SOFT_PRODUCER
+#define RC_GENICAM_API_SOFT_PRODUCER
+
+#include "gentl_producer.h"
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace rcg
+{
+
+/**
+  Buffer of a software producer. The information about the buffer and its
+  parts is stored generically as a map from info command to typed value, so
+  that a device model can provide any information that the consumer may ask
+  for. BASE, SIZE, USER_PTR and the state of the buffer are managed
+  internally.
+*/
+
+class SoftBuffer
+{
+  public:
+
+    /**
+      Creates a buffer.
+
+      @param data    Pointer to memory that is provided by the consumer or 0
+                     for allocating memory internally.
+      @param size    Size of the buffer.
+      @param priv    Private pointer of the consumer.
+    */
+
+    SoftBuffer(void *data, size_t size, void *priv);
+    ~SoftBuffer();
+
+    uint8_t *getData() { return data; }
+    size_t getSize() const { return size; }
+    void *getPrivate() const { return priv; }
+    bool isAllocated() const { return allocated; }
+
+    /**
+      Removes all information and parts. This is called before the buffer is
+      filled by the device model.
+    */
+
+    void clearInfo();
+
+    /**
+      Sets information about the buffer.
+
+      @param cmd   GenTL::BUFFER_INFO_CMD.
+      @param type  Data type of the value.
+      @param value Pointer to value.
+      @param size  Size of the value in bytes.
+    */
+
+    void setInfo(int32_t cmd, GenTL::INFO_DATATYPE type, const void *value, size_t size);
+
+    template<class T> void setInfo(int32_t cmd, GenTL::INFO_DATATYPE type, T value)
+    {
+      setInfo(cmd, type, &value, sizeof(T));
+    }
+
+    /**
+      Sets the number of parts of a multi part buffer.
+    */
+
+    void setNumParts(uint32_t n);
+    uint32_t getNumParts() const { return static_cast<uint32_t>(part_info.size()); }
+
+    /**
+      Sets the offset of the given part with respect to the beginning of the
+      buffer. It is reported as BUFFER_PART_INFO_BASE.
+    */
+
+    void setPartOffset(uint32_t part, size_t offset);
+
+    /**
+      Sets information about the given part.
+
+      @param part  Part index.
+      @param cmd   GenTL::BUFFER_PART_INFO_CMD.
+      @param type  Data type of the value.
+      @param value Pointer to value.
+      @param size  Size of the value in bytes.
+    */
+
+    void setPartInfo(uint32_t part, int32_t cmd, GenTL::INFO_DATATYPE type, const void *value,
+      size_t size);
+
+    template<class T> void setPartInfo(uint32_t part, int32_t cmd, GenTL::INFO_DATATYPE type,
+      T value)
+    {
+      setPartInfo(part, cmd, type, &value, sizeof(T));
+    }
+
+    GenTL::GC_ERROR getInfo(GenTL::BUFFER_INFO_CMD cmd, GenTL::INFO_DATATYPE *piType,
+      void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR getPartInfo(uint32_t part, GenTL::BUFFER_PART_INFO_CMD cmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    enum State { ANNOUNCED, INPUT, FILLING, OUTPUT };
+
+    State getState() const { return state; }
+    void setState(State s) { state=s; }
+
+  private:
+
+    SoftBuffer(const SoftBuffer &); // forbidden
+    SoftBuffer &operator=(const SoftBuffer &); // forbidden
+
+    struct Value
+    {
+      GenTL::INFO_DATATYPE type;
+      std::vector<uint8_t> data;
+    };
+
+    GenTL::GC_ERROR getValue(const Value &value, GenTL::INFO_DATATYPE *piType, void *pBuffer,
+      size_t *piSize);
+
+    uint8_t *data;
+    size_t size;
+    void *priv;
+    bool allocated;
+    State state;
+
+    std::map<int32_t, Value> info;
+    std::vector<std::map<int32_t, Value> > part_info;
+    std::vector<size_t> part_offset;
+};
+
+/**
+  Model of a device that is provided by a software producer. The model
+  provides the remote port with the GenICam XML file and registers and fills
+  buffers on request.
+
+  All methods may be called from different threads. Implementations must take
+  care of synchronization between register access and filling buffers.
+*/
+
+class SoftDevice
+{
+  public:
+
+    virtual ~SoftDevice() {}
+
+    /**
+      Returns device information as string, e.g. DEVICE_INFO_ID,
+      DEVICE_INFO_VENDOR, DEVICE_INFO_MODEL, DEVICE_INFO_TLTYPE, etc. An empty
+      string is interpreted as not available. DEVICE_INFO_ID must be
+      provided.
+    */
+
+    virtual std::string getInfo(GenTL::DEVICE_INFO_CMD cmd)=0;
+
+    /**
+      Returns the frequency of time stamps.
+    */
+
+    virtual uint64_t getTimestampFrequency() { return 1000000000ull; }
+
+    /**
+      Returns the name of the remote port, which must match the port name in
+      the GenICam XML file.
+    */
+
+    virtual std::string getPortName() { return "Device"; }
+
+    /**
+      Returns the URL of the GenICam XML file, e.g.
+      "local:device.xml;f0000000;1234".
+    */
+
+    virtual std::string getXMLURL()=0;
+
+    /**
+      Reads from the remote port. The size must be set to the number of read
+      bytes.
+    */
+
+    virtual GenTL::GC_ERROR readRegister(uint64_t address, void *buffer, size_t *size)=0;
+
+    /**
+      Writes to the remote port. The size must be set to the number of
+      written bytes.
+    */
+
+    virtual GenTL::GC_ERROR writeRegister(uint64_t address, const void *buffer, size_t *size)=0;
+
+    /**
+      Returns the minimum size of buffers.
+    */
+
+    virtual size_t getPayloadSize()=0;
+
+    /**
+      Called before the first and after the last frame of an acquisition.
+    */
+
+    virtual void startAcquisition() {}
+    virtual void stopAcquisition() {}
+
+    /**
+      Prepares the next frame. The frame will be delivered at the given time
+      into the next free buffer. If there is no free buffer at this time, the
+      frame is dropped and counted as underrun, unless wait_for_buffer is
+      true.
+
+      @param t               Point in time for delivering the frame.
+      @param wait_for_buffer Wait for free buffer instead of dropping the frame.
+      @return                False if there are no more frames.
+    */
+
+    virtual bool prepareFrame(std::chrono::steady_clock::time_point &t, bool &wait_for_buffer)=0;
+
+    /**
+      Fills the given buffer with the prepared frame. The buffer information
+      has already been cleared.
+    */
+
+    virtual void fillBuffer(SoftBuffer &buffer)=0;
+};
+
+/**
+  Generic implementation of a GenTL producer with one system and one
+  interface that offers the devices that are added by derived classes. Each
+  device provides one data stream. Buffers are filled by an acquisition
+  thread per stream, which asks the device model for frames.
+*/
+
+class SoftProducer : public GenTLProducer
+{
+  public:
+
+    /**
+      Creates the producer.
+
+      @param id     ID of the system and interface.
+      @param model  Model name of the system.
+      @param tltype Transport layer type, e.g. "GEV". The transport layer type
+                    is used by the consumer for deciding how to parse chunk
+                    data.
+    */
+
+    SoftProducer(const std::string &id, const std::string &model, const std::string &tltype);
+    virtual ~SoftProducer();
+
+    GenTL::GC_ERROR GCGetInfo(GenTL::TL_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType,
+      void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR GCReadPort(GenTL::PORT_HANDLE hPort, uint64_t iAddress, void *pBuffer,
+      size_t *piSize);
+
+    GenTL::GC_ERROR GCWritePort(GenTL::PORT_HANDLE hPort, uint64_t iAddress,
+      const void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR GCGetPortURL(GenTL::PORT_HANDLE hPort, char *sURL, size_t *piSize);
+
+    GenTL::GC_ERROR GCGetPortInfo(GenTL::PORT_HANDLE hPort, GenTL::PORT_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR GCRegisterEvent(GenTL::EVENTSRC_HANDLE hEventSrc, GenTL::EVENT_TYPE iEventID,
+      GenTL::EVENT_HANDLE *phEvent);
+
+    GenTL::GC_ERROR GCUnregisterEvent(GenTL::EVENTSRC_HANDLE hEventSrc,
+      GenTL::EVENT_TYPE iEventID);
+
+    GenTL::GC_ERROR EventGetData(GenTL::EVENT_HANDLE hEvent, void *pBuffer, size_t *piSize,
+      uint64_t iTimeout);
+
+    GenTL::GC_ERROR EventGetDataInfo(GenTL::EVENT_HANDLE hEvent, const void *pInBuffer,
+      size_t iInSize, GenTL::EVENT_DATA_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType,
+      void *pOutBuffer, size_t *piOutSize);
+
+    GenTL::GC_ERROR EventGetInfo(GenTL::EVENT_HANDLE hEvent, GenTL::EVENT_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR EventFlush(GenTL::EVENT_HANDLE hEvent);
+    GenTL::GC_ERROR EventKill(GenTL::EVENT_HANDLE hEvent);
+
+    GenTL::GC_ERROR TLOpen(GenTL::TL_HANDLE *phTL);
+    GenTL::GC_ERROR TLClose(GenTL::TL_HANDLE hTL);
+
+    GenTL::GC_ERROR TLGetInfo(GenTL::TL_HANDLE hTL, GenTL::TL_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR TLGetNumInterfaces(GenTL::TL_HANDLE hTL, uint32_t *piNumIfaces);
+
+    GenTL::GC_ERROR TLGetInterfaceID(GenTL::TL_HANDLE hTL, uint32_t iIndex, char *sID,
+      size_t *piSize);
+
+    GenTL::GC_ERROR TLGetInterfaceInfo(GenTL::TL_HANDLE hTL, const char *sIfaceID,
+      GenTL::INTERFACE_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer,
+      size_t *piSize);
+
+    GenTL::GC_ERROR TLOpenInterface(GenTL::TL_HANDLE hTL, const char *sIfaceID,
+      GenTL::IF_HANDLE *phIface);
+
+    GenTL::GC_ERROR TLUpdateInterfaceList(GenTL::TL_HANDLE hTL, bool8_t *pbChanged,
+      uint64_t iTimeout);
+
+    GenTL::GC_ERROR IFClose(GenTL::IF_HANDLE hIface);
+
+    GenTL::GC_ERROR IFGetInfo(GenTL::IF_HANDLE hIface, GenTL::INTERFACE_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR IFGetNumDevices(GenTL::IF_HANDLE hIface, uint32_t *piNumDevices);
+
+    GenTL::GC_ERROR IFGetDeviceID(GenTL::IF_HANDLE hIface, uint32_t iIndex, char *sIDeviceID,
+      size_t *piSize);
+
+    GenTL::GC_ERROR IFUpdateDeviceList(GenTL::IF_HANDLE hIface, bool8_t *pbChanged,
+      uint64_t iTimeout);
+
+    GenTL::GC_ERROR IFGetDeviceInfo(GenTL::IF_HANDLE hIface, const char *sDeviceID,
+      GenTL::DEVICE_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer,
+      size_t *piSize);
+
+    GenTL::GC_ERROR IFOpenDevice(GenTL::IF_HANDLE hIface, const char *sDeviceID,
+      GenTL::DEVICE_ACCESS_FLAGS iOpenFlag, GenTL::DEV_HANDLE *phDevice);
+
+    GenTL::GC_ERROR DevGetPort(GenTL::DEV_HANDLE hDevice,
+      GenTL::PORT_HANDLE *phRemoteDevice);
+
+    GenTL::GC_ERROR DevGetNumDataStreams(GenTL::DEV_HANDLE hDevice,
+      uint32_t *piNumDataStreams);
+
+    GenTL::GC_ERROR DevGetDataStreamID(GenTL::DEV_HANDLE hDevice, uint32_t iIndex,
+      char *sDataStreamID, size_t *piSize);
+
+    GenTL::GC_ERROR DevOpenDataStream(GenTL::DEV_HANDLE hDevice, const char *sDataStreamID,
+      GenTL::DS_HANDLE *phDataStream);
+
+    GenTL::GC_ERROR DevGetInfo(GenTL::DEV_HANDLE hDevice, GenTL::DEVICE_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR DevClose(GenTL::DEV_HANDLE hDevice);
+
+    GenTL::GC_ERROR DSAnnounceBuffer(GenTL::DS_HANDLE hDataStream, void *pBuffer, size_t iSize,
+      void *pPrivate, GenTL::BUFFER_HANDLE *phBuffer);
+
+    GenTL::GC_ERROR DSAllocAndAnnounceBuffer(GenTL::DS_HANDLE hDataStream, size_t iSize,
+      void *pPrivate, GenTL::BUFFER_HANDLE *phBuffer);
+
+    GenTL::GC_ERROR DSFlushQueue(GenTL::DS_HANDLE hDataStream,
+      GenTL::ACQ_QUEUE_TYPE iOperation);
+
+    GenTL::GC_ERROR DSStartAcquisition(GenTL::DS_HANDLE hDataStream,
+      GenTL::ACQ_START_FLAGS iStartFlags, uint64_t iNumToAcquire);
+
+    GenTL::GC_ERROR DSStopAcquisition(GenTL::DS_HANDLE hDataStream,
+      GenTL::ACQ_STOP_FLAGS iStopFlags);
+
+    GenTL::GC_ERROR DSGetInfo(GenTL::DS_HANDLE hDataStream, GenTL::STREAM_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+    GenTL::GC_ERROR DSGetBufferID(GenTL::DS_HANDLE hDataStream, uint32_t iIndex,
+      GenTL::BUFFER_HANDLE *phBuffer);
+
+    GenTL::GC_ERROR DSClose(GenTL::DS_HANDLE hDataStream);
+
+    GenTL::GC_ERROR DSRevokeBuffer(GenTL::DS_HANDLE hDataStream, GenTL::BUFFER_HANDLE hBuffer,
+      void **pBuffer, void **pPrivate);
+
+    GenTL::GC_ERROR DSQueueBuffer(GenTL::DS_HANDLE hDataStream,
+      GenTL::BUFFER_HANDLE hBuffer);
+
+    GenTL::GC_ERROR DSGetBufferInfo(GenTL::DS_HANDLE hDataStream, GenTL::BUFFER_HANDLE hBuffer,
+      GenTL::BUFFER_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer,
+      size_t *piSize);
+
+    GenTL::GC_ERROR GCGetNumPortURLs(GenTL::PORT_HANDLE hPort, uint32_t *piNumURLs);
+
+    GenTL::GC_ERROR GCGetPortURLInfo(GenTL::PORT_HANDLE hPort, uint32_t iURLIndex,
+      GenTL::URL_INFO_CMD iInfoCmd, GenTL::INFO_DATATYPE *piType, void *pBuffer,
+      size_t *piSize);
+
+    GenTL::GC_ERROR IFGetParentTL(GenTL::IF_HANDLE hIface, GenTL::TL_HANDLE *phSystem);
+
+    GenTL::GC_ERROR DevGetParentIF(GenTL::DEV_HANDLE hDevice, GenTL::IF_HANDLE *phIface);
+
+    GenTL::GC_ERROR DSGetParentDev(GenTL::DS_HANDLE hDataStream,
+      GenTL::DEV_HANDLE *phDevice);
+
+    GenTL::GC_ERROR DSGetNumBufferParts(GenTL::DS_HANDLE hDataStream,
+      GenTL::BUFFER_HANDLE hBuffer, uint32_t *piNumParts);
+
+    GenTL::GC_ERROR DSGetBufferPartInfo(GenTL::DS_HANDLE hDataStream,
+      GenTL::BUFFER_HANDLE hBuffer, uint32_t iPartIndex, GenTL::BUFFER_PART_INFO_CMD iInfoCmd,
+      GenTL::INFO_DATATYPE *piType, void *pBuffer, size_t *piSize);
+
+  protected:
+
+    /**
+      Adds a device model. This must be done by the derived class before the
+      consumer opens the system, i.e. typically in the constructor.
+    */
+
+    void addDevice(const std::shared_ptr<SoftDevice> &device);
+
+  private:
+
+    SoftProducer(const SoftProducer &); // forbidden
+    SoftProducer &operator=(const SoftProducer &); // forbidden
+
+    struct Handle;
+    struct System;
+    struct Interface;
+    struct Device;
+    struct RemotePort;
+    struct Stream;
+    struct Event;
+
+    Handle *getHandle(void *h, int kind);
+    Stream *getStream(void *h);
+    SoftBuffer *getBuffer(Stream *stream, void *h);
+    Device *findDevice(const char *id);
+    void stopStream(Stream *stream, std::unique_lock<std::mutex> &lock);
+    void closeStream(Stream *stream);
+    void closeDevice(Device *device);
+
+    void runStream(Stream *stream);
+
+    std::string id, model, tltype;
+
+    std::recursive_mutex mtx;
+    std::set<Handle *> handles;
+
+    std::unique_ptr<System> system;
+    std::unique_ptr<Interface> iface;
+    std::vector<std::unique_ptr<Device> > device;
+};
+
+}
+
+#endif
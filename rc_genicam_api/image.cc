@@ -37,8 +37,21 @@
 
 #include "exception.h"
 #include "pixel_formats.h"
+#include "pixel_traits.h"
 
+#include <algorithm>
 #include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
 
 #ifdef _WIN32
 #undef min
@@ -66,9 +79,10 @@ Image::Image(const Buffer *buffer, std::uint32_t part)
 
     const size_t size=std::min(buffer->getSize(part), buffer->getSizeFilled());
 
-    pixel.reset(new uint8_t [size]);
+    uint8_t *p=new uint8_t [size];
+    pixel.reset(p, std::default_delete<uint8_t []>());
 
-    memcpy(pixel.get(), reinterpret_cast<uint8_t *>(buffer->getBase(part)), size);
+    memcpy(p, reinterpret_cast<uint8_t *>(buffer->getBase(part)), size);
   }
   else
   {
@@ -76,6 +90,272 @@ Image::Image(const Buffer *buffer, std::uint32_t part)
   }
 }
 
+Image::Image(const Buffer *buffer, std::uint32_t part, const std::shared_ptr<const uint8_t> &block,
+  size_t size)
+{
+  if (buffer->getImagePresent(part))
+  {
+    timestamp=buffer->getTimestampNS();
+
+    width=buffer->getWidth(part);
+    height=buffer->getHeight(part);
+    xoffset=buffer->getXOffset(part);
+    yoffset=buffer->getYOffset(part);
+    xpadding=buffer->getXPadding(part);
+    ypadding=buffer->getYPadding();
+    frameid=buffer->getFrameID();
+    pixelformat=buffer->getPixelFormat(part);
+    bigendian=buffer->isBigEndian();
+
+    const uint8_t *base=reinterpret_cast<const uint8_t *>(buffer->getGlobalBase());
+    const uint8_t *p=reinterpret_cast<const uint8_t *>(buffer->getBase(part));
+
+    if (p < base || static_cast<size_t>(p-base) >= size)
+    {
+      throw GenTLException("Image::Image(): Part is not inside of buffer memory.");
+    }
+
+    // aliasing shared pointer that keeps the whole block alive
+
+    pixel=std::shared_ptr<const uint8_t>(block, block.get()+(p-base));
+  }
+  else
+  {
+    throw GenTLException("Image::Image(): No image available.");
+  }
+}
+
+Image::Image(const uint8_t *pixels, size_t _width, size_t _height, size_t _xpadding,
+  uint64_t _pixelformat, bool _bigendian, uint64_t _timestamp, uint64_t _frameid)
+{
+  timestamp=_timestamp;
+
+  width=_width;
+  height=_height;
+  xoffset=0;
+  yoffset=0;
+  xpadding=_xpadding;
+  ypadding=0;
+  frameid=_frameid;
+  pixelformat=_pixelformat;
+  bigendian=_bigendian;
+
+  // number of bits per pixel is encoded in the pixel format
+
+  const size_t bits=static_cast<size_t>((pixelformat>>16)&0xff);
+  const size_t size=((width*bits+7)/8+xpadding)*height;
+
+  uint8_t *p=new uint8_t [size];
+  pixel.reset(p, std::default_delete<uint8_t []>());
+
+  memcpy(p, pixels, size);
+}
+
+Image::Image(const std::shared_ptr<const uint8_t> &pixels, size_t _width, size_t _height,
+  size_t _xpadding, uint64_t _pixelformat, bool _bigendian, uint64_t _timestamp,
+  uint64_t _frameid) : pixel(pixels)
+{
+  timestamp=_timestamp;
+
+  width=_width;
+  height=_height;
+  xoffset=0;
+  yoffset=0;
+  xpadding=_xpadding;
+  ypadding=0;
+  frameid=_frameid;
+  pixelformat=_pixelformat;
+  bigendian=_bigendian;
+}
+
+std::vector<std::shared_ptr<const Image> > createImages(const Buffer *buffer)
+{
+  const uint32_t npart=buffer->getNumberOfParts();
+  std::vector<std::shared_ptr<const Image> > ret(npart);
+
+  // determine the part of the buffer memory that contains all images, which
+  // is limited to the filled part of the buffer
+
+  const uint8_t *base=reinterpret_cast<const uint8_t *>(buffer->getGlobalBase());
+  const size_t global_size=std::min(buffer->getGlobalSize(), buffer->getSizeFilled());
+  size_t size=0;
+
+  std::vector<bool> inside(npart, false);
+
+  for (uint32_t part=0; part<npart; part++)
+  {
+    if (buffer->getImagePresent(part))
+    {
+      const uint8_t *p=reinterpret_cast<const uint8_t *>(buffer->getBase(part));
+
+      if (base != 0 && p >= base && static_cast<size_t>(p-base) < global_size)
+      {
+        size=std::max(size, std::min(global_size, static_cast<size_t>(p-base)+
+          buffer->getSize(part)));
+        inside[part]=true;
+      }
+    }
+  }
+
+  // copy all images at once
+
+  std::shared_ptr<const uint8_t> block;
+
+  if (size > 0)
+  {
+    uint8_t *p=new uint8_t [size];
+    block.reset(p, std::default_delete<uint8_t []>());
+
+    memcpy(p, base, size);
+  }
+
+  for (uint32_t part=0; part<npart; part++)
+  {
+    if (inside[part])
+    {
+      ret[part]=std::make_shared<Image>(buffer, part, block, size);
+    }
+    else if (buffer->getImagePresent(part))
+    {
+      ret[part]=std::make_shared<Image>(buffer, part);
+    }
+  }
+
+  return ret;
+}
+
+namespace
+{
+
+/*
+  Returns the number of bytes of a row of pixels without padding.
+*/
+
+inline size_t getRowSize(uint64_t pixelformat, size_t width)
+{
+  return (width*static_cast<size_t>((pixelformat>>16)&0xff)+7)/8;
+}
+
+/*
+  Bayer formats in the order RG, GR, GB and BG, so that the index of the
+  format changes by 1 for moving one column and by 2 for moving one row.
+*/
+
+const uint64_t bayer_format[][4]=
+{
+  { BayerRG8, BayerGR8, BayerGB8, BayerBG8 },
+  { BayerRG10, BayerGR10, BayerGB10, BayerBG10 },
+  { BayerRG10p, BayerGR10p, BayerGB10p, BayerBG10p },
+  { BayerRG10Packed, BayerGR10Packed, BayerGB10Packed, BayerBG10Packed },
+  { BayerRG12, BayerGR12, BayerGB12, BayerBG12 },
+  { BayerRG12p, BayerGR12p, BayerGB12p, BayerBG12p },
+  { BayerRG12Packed, BayerGR12Packed, BayerGB12Packed, BayerBG12Packed },
+  { BayerRG16, BayerGR16, BayerGB16, BayerBG16 }
+};
+
+uint64_t shiftBayerFormat(uint64_t pixelformat, size_t x, size_t y)
+{
+  for (size_t i=0; i<sizeof(bayer_format)/sizeof(bayer_format[0]); i++)
+  {
+    for (size_t j=0; j<4; j++)
+    {
+      if (bayer_format[i][j] == pixelformat)
+      {
+        return bayer_format[i][j^(x&1)^((y&1)<<1)];
+      }
+    }
+  }
+
+  return pixelformat;
+}
+
+}
+
+ImageView::ImageView()
+{
+  pixel=0;
+  timestamp=0;
+  width=0;
+  height=0;
+  stride=0;
+  frameid=0;
+  pixelformat=0;
+  bigendian=false;
+}
+
+ImageView::ImageView(const uint8_t *pixels, size_t _width, size_t _height, size_t _stride,
+  uint64_t _pixelformat, bool _bigendian, uint64_t _timestamp, uint64_t _frameid)
+{
+  pixel=pixels;
+  timestamp=_timestamp;
+  width=_width;
+  height=_height;
+  stride=_stride;
+  frameid=_frameid;
+  pixelformat=_pixelformat;
+  bigendian=_bigendian;
+}
+
+ImageView::ImageView(const Image &image)
+{
+  pixel=image.getPixels();
+  timestamp=image.getTimestampNS();
+  width=image.getWidth();
+  height=image.getHeight();
+  stride=getRowSize(image.getPixelFormat(), width)+image.getXPadding();
+  frameid=image.getFrameID();
+  pixelformat=image.getPixelFormat();
+  bigendian=image.isBigEndian();
+}
+
+ImageView::ImageView(const Buffer *buffer, std::uint32_t part)
+{
+  if (!buffer->getImagePresent(part))
+  {
+    throw GenTLException("ImageView::ImageView(): No image available.");
+  }
+
+  pixel=reinterpret_cast<const uint8_t *>(buffer->getBase(part));
+  timestamp=buffer->getTimestampNS();
+  width=buffer->getWidth(part);
+  height=buffer->getHeight(part);
+  pixelformat=buffer->getPixelFormat(part);
+  stride=getRowSize(pixelformat, width)+buffer->getXPadding(part);
+  frameid=buffer->getFrameID();
+  bigendian=buffer->isBigEndian();
+}
+
+ImageView ImageView::getROI(size_t x, size_t y, size_t w, size_t h) const
+{
+  if (x > width || w > width-x || y > height || h > height-y)
+  {
+    throw std::invalid_argument("ImageView::getROI(): Region exceeds image");
+  }
+
+  // the region must start at a full byte and a full group of pixels
+
+  const size_t bits=static_cast<size_t>((pixelformat>>16)&0xff);
+  size_t group=1;
+
+  if (pixelformat == YCbCr411_8 || pixelformat == YCbCr422_8 || pixelformat == YUV422_8)
+  {
+    group=4;
+  }
+
+  if ((x*bits)%8 != 0 || x%group != 0)
+  {
+    throw std::invalid_argument("ImageView::getROI(): Region must start at full pixel group");
+  }
+
+  return ImageView(pixel+y*stride+x*bits/8, w, h, stride, shiftBayerFormat(pixelformat, x, y),
+    bigendian, timestamp, frameid);
+}
+
+size_t ImageView::getXPadding() const
+{
+  return stride-getRowSize(pixelformat, width);
+}
+
 namespace
 {
 
@@ -128,90 +408,655 @@ void convYCbCr411toQuadRGB(uint8_t rgb[12], const uint8_t *row, int i)
   const int gc=((-22*Cb-46*Cr+16384+32)>>6)-256;
   const int bc=((113*Cb+16384+32)>>6)-256;
 
-  for (int j=0; j<4; j++)
-  {
-    *rgb++=clamp8(Y[j]+rc);
-    *rgb++=clamp8(Y[j]+gc);
-    *rgb++=clamp8(Y[j]+bc);
+  for (int j=0; j<4; j++)
+  {
+    *rgb++=clamp8(Y[j]+rc);
+    *rgb++=clamp8(Y[j]+gc);
+    *rgb++=clamp8(Y[j]+bc);
+  }
+}
+
+void convYCbCr422toRGB(uint8_t rgb[3], const uint8_t *row, int i)
+{
+  const uint32_t j=static_cast<uint32_t>((i>>1)*4);
+  const uint32_t js=static_cast<uint32_t>(i&0x1)*2;
+
+  const int Y=row[j+js];
+  const int Cb=static_cast<int>(row[j+1])-128;
+  const int Cr=static_cast<int>(row[j+3])-128;
+
+  // conversion of YCbCr into RGB with correct rounding
+  const int rc=((90*Cr+16384+32)>>6)-256;
+  const int gc=((-22*Cb-46*Cr+16384+32)>>6)-256;
+  const int bc=((113*Cb+16384+32)>>6)-256;
+
+  rgb[0]=clamp8(Y+rc);
+  rgb[1]=clamp8(Y+gc);
+  rgb[2]=clamp8(Y+bc);
+}
+
+void convYCbCr422toQuadRGB(uint8_t rgb[12], const uint8_t *row, int i)
+{
+  i=(i>>2)*8;
+
+  for (int k=0; k<8; k+=4)
+  {
+    const int Y[2]={row[i+k], row[i+2+k]};
+    const int Cb=static_cast<int>(row[i+1+k])-128;
+    const int Cr=static_cast<int>(row[i+3+k])-128;
+
+    // conversion of YCbCr into RGB with correct rounding
+    const int rc=((90*Cr+16384+32)>>6)-256;
+    const int gc=((-22*Cb-46*Cr+16384+32)>>6)-256;
+    const int bc=((113*Cb+16384+32)>>6)-256;
+
+    for (int j=0; j<2; j++)
+    {
+      *rgb++=clamp8(Y[j]+rc);
+      *rgb++=clamp8(Y[j]+gc);
+      *rgb++=clamp8(Y[j]+bc);
+    }
+  }
+}
+
+namespace
+{
+
+/*
+  Returns the corresponding 8 bit format of monochrome or bayer formats with
+  more than 8 bit or 0 if the format is not supported.
+*/
+
+uint64_t getFormat8(uint64_t pixelformat)
+{
+  switch (pixelformat)
+  {
+    case Mono10:
+    case Mono10p:
+    case Mono10Packed:
+    case Mono12:
+    case Mono12p:
+    case Mono12Packed:
+    case Mono16:
+      return Mono8;
+
+    case BayerRG10:
+    case BayerRG10p:
+    case BayerRG10Packed:
+    case BayerRG12:
+    case BayerRG12p:
+    case BayerRG12Packed:
+    case BayerRG16:
+      return BayerRG8;
+
+    case BayerBG10:
+    case BayerBG10p:
+    case BayerBG10Packed:
+    case BayerBG12:
+    case BayerBG12p:
+    case BayerBG12Packed:
+    case BayerBG16:
+      return BayerBG8;
+
+    case BayerGR10:
+    case BayerGR10p:
+    case BayerGR10Packed:
+    case BayerGR12:
+    case BayerGR12p:
+    case BayerGR12Packed:
+    case BayerGR16:
+      return BayerGR8;
+
+    case BayerGB10:
+    case BayerGB10p:
+    case BayerGB10Packed:
+    case BayerGB12:
+    case BayerGB12p:
+    case BayerGB12Packed:
+    case BayerGB16:
+      return BayerGB8;
+
+    default:
+      return 0;
+  }
+}
+
+/*
+  Returns the index of the red pixel in a 2x2 bayer cell, i.e. x+2*y, or -1
+  if the format is not an 8 bit bayer format.
+*/
+
+int getBayerRedIndex(uint64_t format8)
+{
+  switch (format8)
+  {
+    case BayerRG8:
+      return 0;
+
+    case BayerGR8:
+      return 1;
+
+    case BayerGB8:
+      return 2;
+
+    case BayerBG8:
+      return 3;
+
+    default:
+      return -1;
+  }
+}
+
+/*
+  Unpacks the first pixels of a row with SIMD instructions, if available, and
+  returns the index of the first pixel that has not been processed. The
+  overloads are selected by the base class of the pixel traits. By default,
+  nothing is done and the compiler may vectorize the loop over get().
+*/
+
+template<int channels> inline size_t unpackSIMD(uint16_t *, const uint8_t *, size_t,
+  const PixelTraits8<channels> &)
+{
+  return 0;
+}
+
+/*
+  Unpacked 16 bit values only need swapping of bytes if they are big endian.
+*/
+
+template<int bits, bool bigendian> inline size_t unpackSIMD(uint16_t *target,
+  const uint8_t *source, size_t width, const PixelTraits16<bits, bigendian> &)
+{
+  if (!bigendian)
+  {
+    std::memcpy(target, source, width*sizeof(uint16_t));
+    return width;
+  }
+
+  size_t i=0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  for (; i+8 <= width; i+=8)
+  {
+    __m128i v=_mm_loadu_si128(reinterpret_cast<const __m128i *>(source+2*i));
+    v=_mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(target+i), v);
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  for (; i+8 <= width; i+=8)
+  {
+    vst1q_u16(target+i, vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(source+2*i))));
+  }
+#endif
+
+  return i;
+}
+
+/*
+  PFNC packed values with 10 or 12 bit. With SSSE3, eight pixels are shuffled
+  into 16 bit words that contain the pixel at a variable bit offset. The
+  offset is removed by a multiplication, i.e. left shift, and a common right
+  shift. Otherwise, groups of four pixels are extracted from 64 bit values on
+  x86.
+*/
+
+template<int bits> inline size_t unpackSIMD(uint16_t *target, const uint8_t *source,
+  size_t width, const PixelTraitsPFNC<bits> &)
+{
+  size_t i=0;
+
+#ifdef __SSSE3__
+  if (bits == 12)
+  {
+    const __m128i shuffle=_mm_setr_epi8(0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11);
+    const __m128i mul=_mm_setr_epi16(16, 1, 16, 1, 16, 1, 16, 1);
+
+    // 8 pixels are stored in 12 bytes, but 16 bytes are loaded
+
+    for (; i+11 <= width; i+=8)
+    {
+      __m128i v=_mm_loadu_si128(reinterpret_cast<const __m128i *>(source+3*i/2));
+      v=_mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(v, shuffle), mul), 4);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(target+i), v);
+    }
+  }
+  else
+  {
+    const __m128i shuffle=_mm_setr_epi8(0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9);
+    const __m128i mul=_mm_setr_epi16(64, 16, 4, 1, 64, 16, 4, 1);
+
+    // 8 pixels are stored in 10 bytes, but 16 bytes are loaded
+
+    for (; i+13 <= width; i+=8)
+    {
+      __m128i v=_mm_loadu_si128(reinterpret_cast<const __m128i *>(source+5*i/4));
+      v=_mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(v, shuffle), mul), 6);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(target+i), v);
+    }
+  }
+#elif defined(__SSE2__) || defined(_M_X64)
+  // 4 pixels are stored in 5 or 6 bytes, but 8 bytes are loaded as little
+  // endian 64 bit value
+
+  const size_t gsize=bits/2;
+  const uint64_t mask=(1<<bits)-1;
+
+  for (; i/4*gsize+8 <= width*bits/8; i+=4)
+  {
+    uint64_t v;
+    std::memcpy(&v, source+i/4*gsize, sizeof(v));
+
+    target[i]=static_cast<uint16_t>(v&mask);
+    target[i+1]=static_cast<uint16_t>((v>>bits)&mask);
+    target[i+2]=static_cast<uint16_t>((v>>(2*bits))&mask);
+    target[i+3]=static_cast<uint16_t>((v>>(3*bits))&mask);
+  }
+#else
+  (void) target;
+  (void) source;
+  (void) width;
+#endif
+
+  return i;
+}
+
+/*
+  GigE Vision packed values with 10 or 12 bit. With SSSE3, the most
+  significant bits and the shared byte of eight pixels are shuffled into
+  separate 16 bit words and combined. Otherwise, pairs of pixels are unpacked.
+*/
+
+template<int bits> inline size_t unpackSIMD(uint16_t *target, const uint8_t *source,
+  size_t width, const PixelTraitsGVSP<bits> &)
+{
+  const int low=bits-8;
+  const int mask=(1<<low)-1;
+
+  size_t i=0;
+
+#ifdef __SSSE3__
+  const __m128i shuffle_high=_mm_setr_epi8(0, -1, 2, -1, 3, -1, 5, -1, 6, -1, 8, -1, 9, -1,
+    11, -1);
+  const __m128i shuffle_low=_mm_setr_epi8(1, -1, 1, -1, 4, -1, 4, -1, 7, -1, 7, -1, 10, -1,
+    10, -1);
+  const __m128i mul=_mm_setr_epi16(16, 1, 16, 1, 16, 1, 16, 1);
+  const __m128i vmask=_mm_set1_epi16(static_cast<short>(mask));
+
+  // 8 pixels are stored in 12 bytes, but 16 bytes are loaded
+
+  for (; i+11 <= width; i+=8)
+  {
+    __m128i v=_mm_loadu_si128(reinterpret_cast<const __m128i *>(source+3*i/2));
+    __m128i h=_mm_slli_epi16(_mm_shuffle_epi8(v, shuffle_high), low);
+    __m128i l=_mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(v, shuffle_low), mul), 4);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(target+i), _mm_or_si128(h,
+      _mm_and_si128(l, vmask)));
+  }
+#endif
+
+  for (; i+2 <= width; i+=2)
+  {
+    const uint8_t *p=source+3*i/2;
+    target[i]=static_cast<uint16_t>((p[0]<<low)|(p[1]&mask));
+    target[i+1]=static_cast<uint16_t>((p[2]<<low)|((p[1]>>4)&mask));
+  }
+
+  return i;
+}
+
+/*
+  Unpacks a row of pixels with the given pixel traits into 16 bit values.
+*/
+
+template<class P> void unpackRow(uint16_t *target, const uint8_t *source, size_t width)
+{
+  size_t i=unpackSIMD(target, source, width, P());
+
+  for (; i<width; i++)
+  {
+    target[i]=P::get(source, i);
+  }
+}
+
+/*
+  Maps a row of 16 bit values to 8 bit by shifting right with saturation or
+  by a lookup table.
+*/
+
+void toneMapRow(uint8_t *target, const uint16_t *source, size_t width, int shift,
+  const std::vector<uint8_t> &lut)
+{
+  if (lut.size() > 0)
+  {
+    const size_t last=lut.size()-1;
+
+    for (size_t i=0; i<width; i++)
+    {
+      target[i]=lut[std::min(static_cast<size_t>(source[i]), last)];
+    }
+
+    return;
+  }
+
+  shift=std::max(0, std::min(15, shift));
+
+  size_t i=0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128i s=_mm_cvtsi32_si128(shift);
+  const __m128i c255=_mm_set1_epi16(255);
+
+  for (; i+16 <= width; i+=16)
+  {
+    __m128i a=_mm_srl_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(source+i)), s);
+    __m128i b=_mm_srl_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(source+i+8)), s);
+
+    // unsigned minimum with 255, since packing saturates signed values
+
+    a=_mm_sub_epi16(a, _mm_subs_epu16(a, c255));
+    b=_mm_sub_epi16(b, _mm_subs_epu16(b, c255));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(target+i), _mm_packus_epi16(a, b));
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const int16x8_t s=vdupq_n_s16(static_cast<int16_t>(-shift));
+
+  for (; i+8 <= width; i+=8)
+  {
+    vst1_u8(target+i, vqmovn_u16(vshlq_u16(vld1q_u16(source+i), s)));
+  }
+#endif
+
+  for (; i<width; i++)
+  {
+    target[i]=static_cast<uint8_t>(std::min(source[i]>>shift, 255));
+  }
+}
+
+/*
+  Operation for dispatchPixelFormat() that unpacks one row.
+*/
+
+struct UnpackOp
+{
+  uint16_t *target;
+  const uint8_t *source;
+  size_t width;
+  int bits;
+
+  template<class P> void run()
+  {
+    unpackRow<P>(target, source, width);
+    bits=P::bits;
+  }
+};
+
+/*
+  Operation for dispatchPixelFormat() that converts a monochrome or bayer
+  image with more than 8 bit into RGB and / or monochrome with 8 bit.
+*/
+
+struct ConvertOp
+{
+  uint8_t *rgb_out;
+  uint8_t *mono_out;
+  const uint8_t *raw;
+  uint64_t format8;
+  size_t width, height, xpadding;
+  const ToneMapping *tone;
+
+  template<class P> void run()
+  {
+    const size_t lstep=P::getRowSize(width)+xpadding;
+    const int shift=tone->shift < 0 ? P::bits-8 : tone->shift;
+
+    std::unique_ptr<uint16_t []> tmp(new uint16_t [width]);
+
+    if (format8 == Mono8)
+    {
+      // convert row by row
+
+      std::unique_ptr<uint8_t []> row;
+      if (mono_out == 0) row.reset(new uint8_t [width]);
+
+      for (size_t k=0; k<height; k++)
+      {
+        uint8_t *t=mono_out ? mono_out : row.get();
+
+        unpackRow<P>(tmp.get(), raw, width);
+        toneMapRow(t, tmp.get(), width, shift, tone->lut);
+
+        if (rgb_out)
+        {
+          for (size_t i=0; i<width; i++)
+          {
+            uint8_t v=t[i];
+            *rgb_out++ = v;
+            *rgb_out++ = v;
+            *rgb_out++ = v;
+          }
+        }
+
+        if (mono_out) mono_out+=width;
+        raw+=lstep;
+      }
+    }
+    else
+    {
+      // bayer pattern conversion needs neighboring rows, therefore the whole
+      // image is mapped to 8 bit first
+
+      std::unique_ptr<uint8_t []> image8(new uint8_t [width*height]);
+
+      for (size_t k=0; k<height; k++)
+      {
+        unpackRow<P>(tmp.get(), raw, width);
+        toneMapRow(image8.get()+k*width, tmp.get(), width, shift, tone->lut);
+        raw+=lstep;
+      }
+
+      convertImage(rgb_out, mono_out, image8.get(), format8, width, height, 0);
+    }
+  }
+};
+
+/*
+  Operation for dispatchPixelFormat() that computes the average color of
+  ds x ds pixels of monochrome images, reduced to 8 bit. The colors of w x h
+  pixels, starting at pixel i, k of the downscaled image, are stored row by
+  row in rgb.
+*/
+
+struct GetColorOp
+{
+  uint8_t *rgb;
+  const ImageView *img;
+  uint32_t ds, i, k, w, h;
+
+  template<class P> void run()
+  {
+    size_t lstep=img->getStride();
+    const uint32_t n=ds*ds;
+
+    for (uint32_t y=k; y<k+h; y++)
+    {
+      for (uint32_t x=i; x<i+w; x++)
+      {
+        const uint8_t *p=img->getPixels()+y*ds*lstep;
+
+        uint32_t g=0;
+
+        for (uint32_t kk=0; kk<ds; kk++)
+        {
+          for (uint32_t ii=0; ii<ds; ii++)
+          {
+            g+=P::get(p, x*ds+ii);
+          }
+
+          p+=lstep;
+        }
+
+        rgb[2]=rgb[1]=rgb[0]=static_cast<uint8_t>(std::min(static_cast<uint32_t>(255),
+          (g/n)>>(P::bits-8)));
+
+        rgb+=3;
+      }
+    }
+  }
+};
+
+/*
+  Operation for dispatchPixelFormat() that computes the average color of
+  bayer images without interpolation, reduced to 8 bit. The area of ds x ds
+  pixels is extended to complete 2x2 bayer cells. The colors of w x h pixels,
+  starting at pixel i, k of the downscaled image, are stored row by row in
+  rgb.
+*/
+
+struct GetBayerColorOp
+{
+  uint8_t *rgb;
+  const ImageView *img;
+  int red;
+  uint32_t ds, i, k, w, h;
+
+  template<class P> void run()
+  {
+    const size_t n=std::max(static_cast<size_t>(2), static_cast<size_t>((ds+1)&~1u));
+    const size_t xmax=(img->getWidth()-n)&~static_cast<size_t>(1);
+    const size_t ymax=(img->getHeight()-n)&~static_cast<size_t>(1);
+    const uint32_t c=static_cast<uint32_t>(n*n/4);
+
+    for (uint32_t y=k; y<k+h; y++)
+    {
+      for (uint32_t x=i; x<i+w; x++)
+      {
+        // align area to bayer cells and keep it inside the image
+
+        const size_t x0=std::min(static_cast<size_t>((x*ds)&~1u), xmax);
+        const size_t y0=std::min(static_cast<size_t>((y*ds)&~1u), ymax);
+
+        uint32_t s[4]={0, 0, 0, 0};
+
+        const uint8_t *p=img->getPixels()+y0*img->getStride();
+
+        for (size_t kk=0; kk<n; kk++)
+        {
+          uint32_t *sk=s+2*(kk&1);
+
+          for (size_t ii=0; ii<n; ii+=2)
+          {
+            sk[0]+=P::get(p, x0+ii);
+            sk[1]+=P::get(p, x0+ii+1);
+          }
+
+          p+=img->getStride();
+        }
+
+        rgb[0]=static_cast<uint8_t>(std::min(static_cast<uint32_t>(255),
+          (s[red]/c)>>(P::bits-8)));
+        rgb[1]=static_cast<uint8_t>(std::min(static_cast<uint32_t>(255),
+          ((s[red^1]+s[red^2])/(2*c))>>(P::bits-8)));
+        rgb[2]=static_cast<uint8_t>(std::min(static_cast<uint32_t>(255),
+          (s[red^3]/c)>>(P::bits-8)));
+
+        rgb+=3;
+      }
+    }
   }
-}
+};
 
-void convYCbCr422toRGB(uint8_t rgb[3], const uint8_t *row, int i)
-{
-  const uint32_t j=static_cast<uint32_t>((i>>1)*4);
-  const uint32_t js=static_cast<uint32_t>(i&0x1)*2;
+/*
+  Adds the colors of ds x ds pixels of a row of RGB values to the sums of
+  w target pixels.
+*/
 
-  const int Y=row[j+js];
-  const int Cb=static_cast<int>(row[j+1])-128;
-  const int Cr=static_cast<int>(row[j+3])-128;
+inline void addRGBRow(uint32_t *sum, const uint8_t *rgb, size_t w, uint32_t ds)
+{
+  for (size_t i=0; i<w; i++)
+  {
+    for (uint32_t ii=0; ii<ds; ii++)
+    {
+      sum[0]+=*rgb++;
+      sum[1]+=*rgb++;
+      sum[2]+=*rgb++;
+    }
 
-  // conversion of YCbCr into RGB with correct rounding
-  const int rc=((90*Cr+16384+32)>>6)-256;
-  const int gc=((-22*Cb-46*Cr+16384+32)>>6)-256;
-  const int bc=((113*Cb+16384+32)>>6)-256;
+    sum+=3;
+  }
+}
 
-  rgb[0]=clamp8(Y+rc);
-  rgb[1]=clamp8(Y+gc);
-  rgb[2]=clamp8(Y+bc);
 }
 
-void convYCbCr422toQuadRGB(uint8_t rgb[12], const uint8_t *row, int i)
+int unpackPixels(uint16_t *target, const uint8_t *source, uint64_t pixelformat, size_t width,
+  bool bigendian)
 {
-  i=(i>>2)*8;
+  UnpackOp op;
+  op.target=target;
+  op.source=source;
+  op.width=width;
+  op.bits=0;
 
-  for (int k=0; k<8; k+=4)
-  {
-    const int Y[2]={row[i+k], row[i+2+k]};
-    const int Cb=static_cast<int>(row[i+1+k])-128;
-    const int Cr=static_cast<int>(row[i+3+k])-128;
-
-    // conversion of YCbCr into RGB with correct rounding
-    const int rc=((90*Cr+16384+32)>>6)-256;
-    const int gc=((-22*Cb-46*Cr+16384+32)>>6)-256;
-    const int bc=((113*Cb+16384+32)>>6)-256;
+  dispatchPixelFormat(pixelformat, bigendian, op);
 
-    for (int j=0; j<2; j++)
-    {
-      *rgb++=clamp8(Y[j]+rc);
-      *rgb++=clamp8(Y[j]+gc);
-      *rgb++=clamp8(Y[j]+bc);
-    }
-  }
+  return op.bits;
 }
 
 void getColor(uint8_t rgb[3], const std::shared_ptr<const Image> &img,
               uint32_t ds, uint32_t i, uint32_t k)
+{
+  getColor(rgb, ImageView(*img), ds, i, k);
+}
+
+void getColor(uint8_t rgb[3], const ImageView &img, uint32_t ds, uint32_t i, uint32_t k)
 {
   if (ds < 1)
     ds = 1;
 
-  i*=ds;
-  k*=ds;
+  const uint64_t format=img.getPixelFormat();
 
-  if (img->getPixelFormat() == Mono8) // convert from monochrome
-  {
-    size_t lstep=img->getWidth()+img->getXPadding();
-    const uint8_t *p=img->getPixels()+k*lstep+i;
+  uint64_t format8=getFormat8(format);
+  if (format8 == 0) format8=format;
 
-    uint32_t g=0, n=0;
+  if (format8 == Mono8) // convert from monochrome
+  {
+    GetColorOp op;
+    op.rgb=rgb;
+    op.img=&img;
+    op.ds=ds;
+    op.i=i;
+    op.k=k;
+    op.w=1;
+    op.h=1;
+
+    dispatchPixelFormat(format, img.isBigEndian(), op);
+    return;
+  }
 
-    for (uint32_t kk=0; kk<ds; kk++)
-    {
-      for (uint32_t ii=0; ii<ds; ii++)
-      {
-        g+=p[ii];
-        n++;
-      }
+  if (getBayerRedIndex(format8) >= 0 && img.getWidth() >= 2 &&
+    img.getHeight() >= 2) // convert from bayer pattern
+  {
+    GetBayerColorOp op;
+    op.rgb=rgb;
+    op.img=&img;
+    op.red=getBayerRedIndex(format8);
+    op.ds=ds;
+    op.i=i;
+    op.k=k;
+    op.w=1;
+    op.h=1;
+
+    dispatchPixelFormat(format, img.isBigEndian(), op);
+    return;
+  }
 
-      p+=lstep;
-    }
+  i*=ds;
+  k*=ds;
 
-    rgb[2]=rgb[1]=rgb[0]=static_cast<uint8_t>(g/n);
-  }
-  else if (img->getPixelFormat() == RGB8) // convert from RGB8
+  if (format == RGB8) // convert from RGB8
   {
-    size_t lstep=3*img->getWidth()+img->getXPadding();
-    const uint8_t *p=img->getPixels()+k*lstep+3*i;
+    size_t lstep=img.getStride();
+    const uint8_t *p=img.getPixels()+k*lstep+3*i;
 
     uint32_t r=0;
     uint32_t g=0;
@@ -236,10 +1081,10 @@ void getColor(uint8_t rgb[3], const std::shared_ptr<const Image> &img,
     rgb[1]=static_cast<uint8_t>(g/n);
     rgb[2]=static_cast<uint8_t>(b/n);
   }
-  else if (img->getPixelFormat() == YCbCr411_8) // convert from YUV411
+  else if (format == YCbCr411_8) // convert from YUV411
   {
-    size_t lstep=(img->getWidth()>>2)*6+img->getXPadding();
-    const uint8_t *p=img->getPixels()+k*lstep;
+    size_t lstep=img.getStride();
+    const uint8_t *p=img.getPixels()+k*lstep;
 
     uint32_t r=0;
     uint32_t g=0;
@@ -266,10 +1111,10 @@ void getColor(uint8_t rgb[3], const std::shared_ptr<const Image> &img,
     rgb[1]=static_cast<uint8_t>(g/n);
     rgb[2]=static_cast<uint8_t>(b/n);
   }
-  else if (img->getPixelFormat() == YCbCr422_8 || img->getPixelFormat() == YUV422_8) // convert from YUV422
+  else if (format == YCbCr422_8 || format == YUV422_8) // convert from YUV422
   {
-    size_t lstep=(img->getWidth()>>2)*8+img->getXPadding();
-    const uint8_t *p=img->getPixels()+k*lstep;
+    size_t lstep=img.getStride();
+    const uint8_t *p=img.getPixels()+k*lstep;
 
     uint32_t r=0;
     uint32_t g=0;
@@ -476,11 +1321,199 @@ void convertBayerGB(uint8_t *rgb_out, uint8_t *mono_out,
   }
 }
 
+/*
+  Adds the even pixels of a row to even and the odd pixels to odd. The number
+  of pixel pairs is given by n.
+*/
+
+void addPixelPairs(uint16_t *even, uint16_t *odd, const uint8_t *row, size_t n)
+{
+  size_t c=0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128i mask=_mm_set1_epi16(0xff);
+
+  for (; c+8 <= n; c+=8)
+  {
+    __m128i v=_mm_loadu_si128(reinterpret_cast<const __m128i *>(row+2*c));
+    __m128i *e=reinterpret_cast<__m128i *>(even+c);
+    __m128i *o=reinterpret_cast<__m128i *>(odd+c);
+
+    _mm_storeu_si128(e, _mm_add_epi16(_mm_loadu_si128(e), _mm_and_si128(v, mask)));
+    _mm_storeu_si128(o, _mm_add_epi16(_mm_loadu_si128(o), _mm_srli_epi16(v, 8)));
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  for (; c+8 <= n; c+=8)
+  {
+    uint8x8x2_t v=vld2_u8(row+2*c);
+
+    vst1q_u16(even+c, vaddw_u8(vld1q_u16(even+c), v.val[0]));
+    vst1q_u16(odd+c, vaddw_u8(vld1q_u16(odd+c), v.val[1]));
+  }
+#endif
+
+  for (; c<n; c++)
+  {
+    even[c]+=row[2*c];
+    odd[c]+=row[2*c+1];
+  }
+}
+
+/*
+  Operation for dispatchPixelFormat() that converts a bayer image into an
+  image that is downscaled by an even factor ds without interpolation. Each
+  2x2 bayer cell is a superpixel with the red value, the mean of both green
+  values and the blue value of the cell. The superpixels of ds/2 x ds/2 cells
+  are averaged.
+*/
+
+struct SuperpixelOp
+{
+  uint8_t *rgb_out;
+  uint8_t *mono_out;
+  const ImageView *image;
+  int red;
+  uint32_t ds;
+  const ToneMapping *tone;
+
+  template<class P> void run()
+  {
+    const size_t width=image->getWidth();
+    const size_t wout=width/ds;
+    const size_t hout=image->getHeight()/ds;
+    const size_t m=ds/2;
+    const size_t cells=wout*m;
+    const uint32_t n=static_cast<uint32_t>(m*m);
+    const int shift=tone->shift < 0 ? P::bits-8 : tone->shift;
+
+    // sums of the four pixels of the cells over m rows of cells
+
+    std::vector<uint16_t> sum(4*cells);
+    uint16_t *s[4]={&sum[0], &sum[cells], &sum[2*cells], &sum[3*cells]};
+
+    std::unique_ptr<uint16_t []> tmp;
+    std::unique_ptr<uint8_t []> row8;
+
+    if (P::bits > 8)
+    {
+      tmp.reset(new uint16_t [width]);
+      row8.reset(new uint8_t [width]);
+    }
+
+    const uint8_t *raw=image->getPixels();
+
+    for (size_t k=0; k<hout; k++)
+    {
+      std::fill(sum.begin(), sum.end(), static_cast<uint16_t>(0));
+
+      for (size_t kk=0; kk<ds; kk++)
+      {
+        const uint8_t *row=raw;
+
+        if (P::bits > 8)
+        {
+          unpackRow<P>(tmp.get(), raw, 2*cells);
+          toneMapRow(row8.get(), tmp.get(), 2*cells, shift, tone->lut);
+          row=row8.get();
+        }
+
+        addPixelPairs(s[2*(kk&1)], s[2*(kk&1)+1], row, cells);
+
+        raw+=image->getStride();
+      }
+
+      // average the cells of each target pixel
+
+      const uint16_t *sr=s[red], *sg0=s[red^1], *sg1=s[red^2], *sb=s[red^3];
+
+      if (m == 1)
+      {
+        // no division needed for half resolution
+
+        for (size_t i=0; i<wout; i++)
+        {
+          storeRGBMono(rgb_out, mono_out, static_cast<uint8_t>(sr[i]),
+            static_cast<uint8_t>((sg0[i]+sg1[i]+1)>>1), static_cast<uint8_t>(sb[i]));
+        }
+
+        continue;
+      }
+
+      for (size_t i=0; i<wout; i++)
+      {
+        uint32_t r=0, g=0, b=0;
+
+        for (size_t j=0; j<m; j++)
+        {
+          r+=*sr++;
+          g+=static_cast<uint32_t>(*sg0++)+*sg1++;
+          b+=*sb++;
+        }
+
+        storeRGBMono(rgb_out, mono_out, static_cast<uint8_t>((r+n/2)/n),
+          static_cast<uint8_t>((g+n)/(2*n)), static_cast<uint8_t>((b+n/2)/n));
+      }
+    }
+  }
+};
+
+/*
+  Averages ds x ds pixels of an RGB image with the given width and ds rows
+  and stores one row of the result.
+*/
+
+void averageRGBRows(uint8_t *&rgb_out, uint8_t *&mono_out, const uint8_t *rgb, size_t width,
+  uint32_t ds)
+{
+  const size_t wout=width/ds;
+  const uint32_t n=ds*ds;
+
+  for (size_t i=0; i<wout; i++)
+  {
+    uint32_t r=0, g=0, b=0;
+
+    for (uint32_t kk=0; kk<ds; kk++)
+    {
+      const uint8_t *p=rgb+3*(kk*width+i*ds);
+
+      for (uint32_t ii=0; ii<ds; ii++)
+      {
+        r+=*p++;
+        g+=*p++;
+        b+=*p++;
+      }
+    }
+
+    storeRGBMono(rgb_out, mono_out, static_cast<uint8_t>((r+n/2)/n),
+      static_cast<uint8_t>((g+n/2)/n), static_cast<uint8_t>((b+n/2)/n));
+  }
+}
+
 }
 
 bool convertImage(uint8_t *rgb_out, uint8_t *mono_out, const uint8_t *raw, uint64_t pixelformat,
-  size_t width, size_t height, size_t xpadding)
+  size_t width, size_t height, size_t xpadding, bool bigendian, const ToneMapping &tone)
 {
+  // pixel formats with more than 8 bit are mapped to the corresponding 8 bit
+  // format
+
+  const uint64_t format8=getFormat8(pixelformat);
+
+  if (format8 != 0)
+  {
+    ConvertOp op;
+    op.rgb_out=rgb_out;
+    op.mono_out=mono_out;
+    op.raw=raw;
+    op.format8=format8;
+    op.width=width;
+    op.height=height;
+    op.xpadding=xpadding;
+    op.tone=&tone;
+
+    return dispatchPixelFormat(pixelformat, bigendian, op);
+  }
+
   bool ret=true;
 
   switch (pixelformat)
@@ -682,6 +1715,214 @@ bool convertImage(uint8_t *rgb_out, uint8_t *mono_out, const uint8_t *raw, uint6
   return ret;
 }
 
+bool convertImage(uint8_t *rgb_out, uint8_t *mono_out, const ImageView &image,
+  const ToneMapping &tone)
+{
+  return convertImage(rgb_out, mono_out, image.getPixels(), image.getPixelFormat(),
+    image.getWidth(), image.getHeight(), image.getXPadding(), image.isBigEndian(), tone);
+}
+
+bool getColorImage(uint8_t *rgb_out, const ImageView &img, uint32_t ds)
+{
+  if (ds < 1)
+    ds = 1;
+
+  const uint32_t w=static_cast<uint32_t>(img.getWidth()/ds);
+  const uint32_t h=static_cast<uint32_t>(img.getHeight()/ds);
+  const uint64_t format=img.getPixelFormat();
+
+  uint64_t format8=getFormat8(format);
+  if (format8 == 0) format8=format;
+
+  if (format8 == Mono8) // convert from monochrome
+  {
+    GetColorOp op;
+    op.rgb=rgb_out;
+    op.img=&img;
+    op.ds=ds;
+    op.i=0;
+    op.k=0;
+    op.w=w;
+    op.h=h;
+
+    return dispatchPixelFormat(format, img.isBigEndian(), op);
+  }
+
+  if (getBayerRedIndex(format8) >= 0) // convert from bayer pattern
+  {
+    if (img.getWidth() < 2 || img.getHeight() < 2)
+    {
+      std::fill(rgb_out, rgb_out+3*w*h, static_cast<uint8_t>(0));
+      return false;
+    }
+
+    GetBayerColorOp op;
+    op.rgb=rgb_out;
+    op.img=&img;
+    op.red=getBayerRedIndex(format8);
+    op.ds=ds;
+    op.i=0;
+    op.k=0;
+    op.w=w;
+    op.h=h;
+
+    return dispatchPixelFormat(format, img.isBigEndian(), op);
+  }
+
+  if (format != RGB8 && format != YCbCr411_8 && format != YCbCr422_8 && format != YUV422_8)
+  {
+    std::fill(rgb_out, rgb_out+3*w*h, static_cast<uint8_t>(0));
+    return false;
+  }
+
+  // color formats are decoded once per row and averaged
+
+  const size_t width=static_cast<size_t>(w)*ds;
+  const uint32_t n=ds*ds;
+
+  std::vector<uint8_t> row(3*width+12);
+  std::vector<uint32_t> sum(3*w);
+
+  const uint8_t *p=img.getPixels();
+
+  for (uint32_t k=0; k<h; k++)
+  {
+    std::fill(sum.begin(), sum.end(), 0);
+
+    for (uint32_t kk=0; kk<ds; kk++)
+    {
+      const uint8_t *rgb=p;
+
+      if (format == YCbCr411_8)
+      {
+        size_t i=0;
+        for (; i+4 <= width; i+=4)
+        {
+          convYCbCr411toQuadRGB(&row[3*i], p, static_cast<int>(i));
+        }
+
+        for (; i<width; i++)
+        {
+          convYCbCr411toRGB(&row[3*i], p, static_cast<int>(i));
+        }
+
+        rgb=row.data();
+      }
+      else if (format == YCbCr422_8 || format == YUV422_8)
+      {
+        size_t i=0;
+        for (; i+4 <= width; i+=4)
+        {
+          convYCbCr422toQuadRGB(&row[3*i], p, static_cast<int>(i));
+        }
+
+        for (; i<width; i++)
+        {
+          convYCbCr422toRGB(&row[3*i], p, static_cast<int>(i));
+        }
+
+        rgb=row.data();
+      }
+
+      addRGBRow(sum.data(), rgb, w, ds);
+
+      p+=img.getStride();
+    }
+
+    if (n == 1)
+    {
+      for (size_t i=0; i<3*static_cast<size_t>(w); i++)
+      {
+        *rgb_out++=static_cast<uint8_t>(sum[i]);
+      }
+    }
+    else
+    {
+      for (size_t i=0; i<3*static_cast<size_t>(w); i++)
+      {
+        *rgb_out++=static_cast<uint8_t>(sum[i]/n);
+      }
+    }
+  }
+
+  return true;
+}
+
+bool convertImageDownscaled(uint8_t *rgb_out, uint8_t *mono_out, const ImageView &image,
+  uint32_t ds, const ToneMapping &tone)
+{
+  if (ds < 1)
+    ds=1;
+
+  if (ds == 1)
+  {
+    return convertImage(rgb_out, mono_out, image, tone);
+  }
+
+  if (!isFormatSupported(image.getPixelFormat(), false))
+  {
+    return false;
+  }
+
+  const size_t width=image.getWidth();
+  const size_t hout=image.getHeight()/ds;
+
+  if (width/ds == 0 || hout == 0)
+  {
+    return true;
+  }
+
+  // bayer formats with even downscale factor are converted without
+  // interpolation
+
+  uint64_t format8=getFormat8(image.getPixelFormat());
+  if (format8 == 0) format8=image.getPixelFormat();
+
+  const int red=getBayerRedIndex(format8);
+
+  if (red >= 0 && (ds&1) == 0)
+  {
+    SuperpixelOp op;
+    op.rgb_out=rgb_out;
+    op.mono_out=mono_out;
+    op.image=&image;
+    op.red=red;
+    op.ds=ds;
+    op.tone=&tone;
+
+    return dispatchPixelFormat(image.getPixelFormat(), image.isBigEndian(), op);
+  }
+
+  // otherwise, convert in full resolution and average
+
+  if (red >= 0)
+  {
+    // bayer conversion needs neighboring rows
+
+    std::vector<uint8_t> rgb(3*width*image.getHeight());
+    convertImage(&rgb[0], 0, image, tone);
+
+    for (size_t k=0; k<hout; k++)
+    {
+      averageRGBRows(rgb_out, mono_out, &rgb[3*k*ds*width], width, ds);
+    }
+  }
+  else
+  {
+    // all other formats can be converted band by band
+
+    std::vector<uint8_t> rgb(3*width*ds);
+
+    for (size_t k=0; k<hout; k++)
+    {
+      convertImage(&rgb[0], 0, image.getROI(0, k*ds, width, ds), tone);
+      averageRGBRows(rgb_out, mono_out, &rgb[0], width, ds);
+    }
+  }
+
+  return true;
+}
+
 bool isFormatSupported(uint64_t pixelformat, bool only_color)
 {
   if (pixelformat == YCbCr411_8 || pixelformat == YCbCr422_8 || pixelformat == YUV422_8 ||
@@ -697,6 +1938,13 @@ bool isFormatSupported(uint64_t pixelformat, bool only_color)
     return true;
   }
 
+  const uint64_t format8=getFormat8(pixelformat);
+
+  if (format8 != 0 && (!only_color || format8 != Mono8))
+  {
+    return true;
+  }
+
   return false;
 }
 
@@ -39,6 +39,7 @@
 #include "buffer.h"
 
 #include <memory>
+#include <vector>
 
 namespace rcg
 {
@@ -65,6 +66,57 @@ class Image
 
     Image(const Buffer *buffer, std::uint32_t part);
 
+    /**
+      Creates the image of a buffer part from a copy of the whole buffer
+      memory, which is shared without copying, see createImages().
+
+      @param buffer Buffer from which the copy has been made.
+      @param part   Part number from which the image should be created.
+      @param block  Copy of the buffer memory, starting at getGlobalBase().
+      @param size   Number of bytes in block.
+    */
+
+    Image(const Buffer *buffer, std::uint32_t part, const std::shared_ptr<const uint8_t> &block,
+      size_t size);
+
+    /**
+      Copies the given pixels, e.g. for creating images that do not stem from
+      a camera. The number of bytes per row is computed from the width, the
+      number of bits per pixel as encoded in the pixel format and the padding.
+
+      @param pixels      Pointer to height rows of pixels.
+      @param width       Width of image.
+      @param height      Height of image.
+      @param xpadding    Number of padding bytes at the end of each row.
+      @param pixelformat Pixel format of the given pixels.
+      @param bigendian   True if multi byte pixels are stored as big endian.
+      @param timestamp   Timestamp in nanoseconds.
+      @param frameid     Frame ID.
+    */
+
+    Image(const uint8_t *pixels, size_t width, size_t height, size_t xpadding,
+      uint64_t pixelformat, bool bigendian=false, uint64_t timestamp=0, uint64_t frameid=0);
+
+    /**
+      Shares the given pixels without copying, e.g. for creating images that
+      point into memory mapped files. The memory is kept alive as long as the
+      image exists. An aliasing shared pointer can be used for referencing
+      pixels inside a larger block of memory.
+
+      @param pixels      Pointer to height rows of pixels.
+      @param width       Width of image.
+      @param height      Height of image.
+      @param xpadding    Number of padding bytes at the end of each row.
+      @param pixelformat Pixel format of the given pixels.
+      @param bigendian   True if multi byte pixels are stored as big endian.
+      @param timestamp   Timestamp in nanoseconds.
+      @param frameid     Frame ID.
+    */
+
+    Image(const std::shared_ptr<const uint8_t> &pixels, size_t width, size_t height,
+      size_t xpadding, uint64_t pixelformat, bool bigendian=false, uint64_t timestamp=0,
+      uint64_t frameid=0);
+
     /**
       Pointer to pixel information of the image.
 
@@ -90,7 +142,7 @@ class Image
     Image(class Image &); // forbidden
     Image &operator=(const Image &); // forbidden
 
-    std::unique_ptr<uint8_t []> pixel;
+    std::shared_ptr<const uint8_t> pixel;
 
     uint64_t timestamp;
     size_t width;
@@ -104,6 +156,117 @@ class Image
     bool bigendian;
 };
 
+/**
+  Creates images of all parts of a multi part buffer with one allocation and
+  one copy of the buffer memory. All images share the memory through aliasing
+  shared pointers, i.e. the memory is released when the last image is
+  destroyed. Parts that are not inside the global buffer memory are copied
+  individually.
+
+  NOTE: A GenTLException is thrown in case of a severe error.
+
+  @param buffer Buffer with one or more parts.
+  @return       One image per part. Parts without image are returned as null
+                pointers.
+*/
+
+std::vector<std::shared_ptr<const Image> > createImages(const Buffer *buffer);
+
+/**
+  Lightweight view onto the pixels of an image, a buffer part or any other
+  memory, which can be restricted to a region of interest without copying,
+  e.g. for splitting the combined left and right images of the component
+  IntensityCombined of the rc_visard. The view does not own the pixels, i.e.
+  the image or buffer must stay valid while the view is used.
+*/
+
+class ImageView
+{
+  public:
+
+    /**
+      Creates an empty view.
+    */
+
+    ImageView();
+
+    /**
+      Creates a view onto the given pixels.
+
+      @param pixels      Pointer to the first pixel of the first row.
+      @param width       Width of image.
+      @param height      Height of image.
+      @param stride      Number of bytes from one row to the next, including
+                         padding.
+      @param pixelformat Pixel format of the given pixels.
+      @param bigendian   True if multi byte pixels are stored as big endian.
+      @param timestamp   Timestamp in nanoseconds.
+      @param frameid     Frame ID.
+    */
+
+    ImageView(const uint8_t *pixels, size_t width, size_t height, size_t stride,
+      uint64_t pixelformat, bool bigendian=false, uint64_t timestamp=0, uint64_t frameid=0);
+
+    /**
+      Creates a view onto all pixels of the given image.
+
+      @param image Image that must exist while the view is used.
+    */
+
+    ImageView(const Image &image);
+
+    /**
+      Creates a view onto the image of the given buffer part.
+
+      NOTE: A GenTLException is thrown if the part does not contain an image.
+
+      @param buffer Buffer that must not be requeued while the view is used.
+      @param part   Part number.
+    */
+
+    ImageView(const Buffer *buffer, std::uint32_t part);
+
+    /**
+      Returns a view onto a region of interest of this view. The pixel format
+      of bayer pattern images is adapted if the region starts at an odd row
+      or column.
+
+      NOTE: std::invalid_argument is thrown if the region exceeds the view or
+      if x does not start at a full byte or pixel group, e.g. at a multiple
+      of 4 for Mono10p, YCbCr411_8 and YCbCr422_8.
+
+      @param x, y   Upper left corner of region.
+      @param w, h   Size of region.
+      @return       View onto the region.
+    */
+
+    ImageView getROI(size_t x, size_t y, size_t w, size_t h) const;
+
+    const uint8_t *getPixels() const { return pixel; }
+
+    uint64_t getTimestampNS() const { return timestamp; }
+
+    size_t getWidth() const { return width; }
+    size_t getHeight() const { return height; }
+    size_t getStride() const { return stride; }
+    size_t getXPadding() const;
+    uint64_t getFrameID() const { return frameid; }
+    uint64_t getPixelFormat() const { return pixelformat; }
+    bool isBigEndian() const { return bigendian; }
+
+  private:
+
+    const uint8_t *pixel;
+
+    uint64_t timestamp;
+    size_t width;
+    size_t height;
+    size_t stride;
+    uint64_t frameid;
+    uint64_t pixelformat;
+    bool bigendian;
+};
+
 /**
   Conversion of one pixel from YCbCr411 format (6 bytes for four pixels) to
   RGB.
@@ -153,11 +316,13 @@ void convYCbCr422toRGB(uint8_t rgb[3], const uint8_t *row, int i);
 void convYCbCr422toQuadRGB(uint8_t rgb[12], const uint8_t *row, int i);
 
 /**
-  Expects an image in Mono8, RGB8, YCbCr411_8, YCbCr422_8 or YUV422_8 format
-  and returns the color as RGB value at the given pixel location. The downscale
-  factor ds can be greater than one. In this case, the given pixel location
-  refers to the downscaled image and the returned color is averaged over
-  ds x ds pixels.
+  Expects an image in Mono8, Mono10, Mono10p, Mono10Packed, Mono12, Mono12p,
+  Mono12Packed, Mono16, RGB8, YCbCr411_8, YCbCr422_8, YUV422_8 or bayer
+  format and returns the color as RGB value at the given pixel location. The
+  downscale factor ds can be greater than one. In this case, the given pixel
+  location refers to the downscaled image and the returned color is averaged
+  over ds x ds pixels. Bayer images are not interpolated. Instead, the area is
+  extended to complete 2x2 bayer cells, which are averaged.
 
   @param rgb  Array of size 3 for returning the color.
   @param img  Pointer to image.
@@ -168,6 +333,70 @@ void convYCbCr422toQuadRGB(uint8_t rgb[12], const uint8_t *row, int i);
 void getColor(uint8_t rgb[3], const std::shared_ptr<const Image> &img,
               uint32_t ds, uint32_t i, uint32_t k);
 
+/**
+  Same as above, but for a view onto an image.
+
+  @param rgb  Array of size 3 for returning the color.
+  @param img  View onto image.
+  @param ds   Downscale factor, i.e. >= 1
+  @param i, k Pixel location in downscaled coordinates.
+*/
+
+void getColor(uint8_t rgb[3], const ImageView &img, uint32_t ds, uint32_t i, uint32_t k);
+
+/**
+  Computes the colors of all pixels of the image that is downscaled by the
+  factor ds at once. The colors are the same as returned by getColor() for
+  each pixel, but the pixel format is only evaluated once and YCbCr formats
+  are decoded only once per row.
+
+  @param rgb_out Target array of size 3*(width/ds)*(height/ds) for the RGB
+                 values.
+  @param img     View onto image.
+  @param ds      Downscale factor, i.e. >= 1
+  @return        False, if the pixel format is not supported. In this case,
+                 the target array is set to 0.
+*/
+
+bool getColorImage(uint8_t *rgb_out, const ImageView &img, uint32_t ds);
+
+/**
+  Mapping of pixel values with more than 8 bit to 8 bit, which is used by
+  convertImage(). By default, the values are shifted right by the number of
+  significant bits of the pixel format minus 8, so that the most significant
+  8 bits remain. A smaller shift can be given for brightening dark images, in
+  which case the values are saturated at 255. If a lookup table is given, it
+  is used instead of the shift. Values beyond the end of the lookup table are
+  mapped to its last entry.
+*/
+
+struct ToneMapping
+{
+  ToneMapping() : shift(-1) { }
+
+  int shift;
+  std::vector<uint8_t> lut;
+};
+
+/**
+  Unpacks one row of a monochrome or bayer pattern image with 10, 12 or 16 bit
+  per pixel into 16 bit values in host byte order. Packed formats of PFNC
+  (e.g. Mono12p) and GigE Vision (e.g. Mono12Packed) as well as unpacked
+  formats (e.g. Mono12) are supported.
+
+  @param target      Target array of width values.
+  @param source      Pointer to the first byte of the row.
+  @param pixelformat Pixel format of the row.
+  @param width       Number of pixels in the row.
+  @param bigendian   True if unpacked 16 bit values are big endian.
+  @return            Number of significant bits per pixel, or 0 if the pixel
+                     format is not supported. In this case, nothing is written
+                     to target.
+*/
+
+int unpackPixels(uint16_t *target, const uint8_t *source, uint64_t pixelformat, size_t width,
+  bool bigendian=false);
+
 /**
   Converts image to RGB and monochrome format. Supported formats can be checked
   with isFormatSupported().
@@ -181,21 +410,66 @@ void getColor(uint8_t rgb[3], const std::shared_ptr<const Image> &img,
   @param width       Width of image.
   @param height      Height of image.
   @param xpadding    Padding of input image.
+  @param bigendian   True if pixels with more than 8 bit are big endian.
+  @param tone        Mapping of pixels with more than 8 bit to 8 bit.
   @return            False, if pixelformat is not supported. In this case,
                      nothing is written to the target pointers.
 */
 
 bool convertImage(uint8_t *rgb_out, uint8_t *mono_out, const uint8_t *raw, uint64_t pixelformat,
-  size_t width, size_t height, size_t xpadding);
+  size_t width, size_t height, size_t xpadding, bool bigendian=false,
+  const ToneMapping &tone=ToneMapping());
+
+/**
+  Converts a view onto an image to RGB and monochrome format, like above.
+
+  @param rgb_out  Pointer to target array for rgb image of size
+                  3*width*height. The pointer can be 0.
+  @param mono_out Pointer to target array for monochrome image of size
+                  width*height. The pointer can be 0.
+  @param image    View onto image.
+  @param tone     Mapping of pixels with more than 8 bit to 8 bit.
+  @return         False, if the pixel format is not supported.
+*/
+
+bool convertImage(uint8_t *rgb_out, uint8_t *mono_out, const ImageView &image,
+  const ToneMapping &tone=ToneMapping());
+
+/**
+  Converts a view onto an image to RGB and monochrome format with a resolution
+  that is reduced by the downscale factor ds. Each target pixel is the average
+  of ds x ds pixels. Remaining columns and rows at the right and bottom border
+  are ignored. Bayer pattern images are not interpolated if ds is even.
+  Instead, each 2x2 bayer cell is taken as one pixel with the red value, the
+  mean of both green values and the blue value of the cell, which is much
+  faster than demosaicing in full resolution.
+
+  @param rgb_out  Pointer to target array for rgb image of size
+                  3*(width/ds)*(height/ds). The pointer can be 0.
+  @param mono_out Pointer to target array for monochrome image of size
+                  (width/ds)*(height/ds). The pointer can be 0.
+  @param image    View onto image.
+  @param ds       Downscale factor, i.e. >= 1. A value of 2 gives a half
+                  resolution preview of bayer images.
+  @param tone     Mapping of pixels with more than 8 bit to 8 bit.
+  @return         False, if the pixel format is not supported.
+*/
+
+bool convertImageDownscaled(uint8_t *rgb_out, uint8_t *mono_out, const ImageView &image,
+  uint32_t ds, const ToneMapping &tone=ToneMapping());
 
 /**
   Returns true if the given pixel format is supported by the convertImage()
   function.
 
   Currently supported color formats are: RGB8, BayerRG8, BayerBG8, BayerGR8,
-  BayerGB8, YCbCr411_8, YCbCr422_8 and YUV422_8
+  BayerGB8, YCbCr411_8, YCbCr422_8 and YUV422_8 as well as the bayer formats
+  with 10, 12 and 16 bit, i.e. BayerXX10, BayerXX10p, BayerXX10Packed,
+  BayerXX12, BayerXX12p, BayerXX12Packed and BayerXX16 with XX being RG, BG,
+  GR or GB.
 
-  Currently supported monochrome formats: Mono8, Confidence8, Error8
+  Currently supported monochrome formats: Mono8, Confidence8, Error8, Mono10,
+  Mono10p, Mono10Packed, Mono12, Mono12p, Mono12Packed and Mono16
 
   @param only_color If true, the true is returned only for supported color
                     formats.
@@ -0,0 +1,807 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "image_codec.h"
+#include "pixel_formats.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#ifdef _WIN32
+#undef min
+#undef max
+#endif
+
+namespace rcg
+{
+
+namespace
+{
+
+/**
+  Layout of samples, i.e. number of bytes per sample and the distance of the
+  left and upper neighbor of the same color channel in samples and rows.
+*/
+
+struct SampleLayout
+{
+  size_t ssize;
+  size_t dx;
+  size_t dy;
+};
+
+bool getSampleLayout(SampleLayout &layout, uint64_t format)
+{
+  layout.ssize=1;
+  layout.dx=1;
+  layout.dy=1;
+
+  switch (format)
+  {
+    case Mono8:
+    case Confidence8:
+    case Error8:
+      break;
+
+    case Mono16:
+    case Coord3D_C16:
+      layout.ssize=2;
+      break;
+
+    case RGB8:
+      layout.dx=3;
+      break;
+
+    case BayerRG8:
+    case BayerBG8:
+    case BayerGR8:
+    case BayerGB8:
+      layout.dx=2;
+      layout.dy=2;
+      break;
+
+    case YCbCr411_8: // 6 bytes for 4 pixels
+      layout.dx=6;
+      break;
+
+    case YCbCr422_8: // 4 bytes for 2 pixels
+    case YUV422_8:
+      layout.dx=4;
+      break;
+
+    default:
+      return false;
+  }
+
+  return true;
+}
+
+const uint8_t magic[4]={'R', 'C', 'L', 1};
+const size_t header_size=36;
+const size_t block_size=16;
+
+inline void put32(uint8_t *p, uint32_t v)
+{
+  p[0]=static_cast<uint8_t>(v);
+  p[1]=static_cast<uint8_t>(v>>8);
+  p[2]=static_cast<uint8_t>(v>>16);
+  p[3]=static_cast<uint8_t>(v>>24);
+}
+
+inline void put64(uint8_t *p, uint64_t v)
+{
+  put32(p, static_cast<uint32_t>(v));
+  put32(p+4, static_cast<uint32_t>(v>>32));
+}
+
+inline uint32_t get32(const uint8_t *p)
+{
+  return static_cast<uint32_t>(p[0])|(static_cast<uint32_t>(p[1])<<8)|
+    (static_cast<uint32_t>(p[2])<<16)|(static_cast<uint32_t>(p[3])<<24);
+}
+
+inline uint64_t get64(const uint8_t *p)
+{
+  return static_cast<uint64_t>(get32(p))|(static_cast<uint64_t>(get32(p+4))<<32);
+}
+
+/**
+  Maps the residual, interpreted as signed value, to an unsigned value with
+  small magnitude, i.e. 0, -1, 1, -2, 2, ... to 0, 1, 2, 3, 4, ...
+*/
+
+template<class T> inline T zigzag(T r)
+{
+  return static_cast<T>((r<<1)^(0-(r>>(8*sizeof(T)-1))));
+}
+
+template<class T> inline T unzigzag(T z)
+{
+  return static_cast<T>((z>>1)^(0-(z&1)));
+}
+
+/**
+  Median edge detector of JPEG-LS, which predicts a value from the left (a),
+  upper (b) and upper left (c) neighbor by clamping a+b-c to the range of a
+  and b. It is computed as min(a,b)+min(max(max(a,b)-c, 0), max(a,b)-min(a,b)),
+  which does not need more bits than the values and maps to saturating
+  SIMD instructions.
+*/
+
+template<class T> inline T predictMED(T a, T b, T c)
+{
+  T mn=std::min(a, b);
+  T mx=std::max(a, b);
+  T d=mx > c ? static_cast<T>(mx-c) : 0;
+
+  return static_cast<T>(mn+std::min(d, static_cast<T>(mx-mn)));
+}
+
+#if defined(__SSE2__) || defined(_M_X64)
+
+inline __m128i predictMED8(__m128i a, __m128i b, __m128i c)
+{
+  __m128i mn=_mm_min_epu8(a, b);
+  __m128i mx=_mm_max_epu8(a, b);
+
+  return _mm_add_epi8(mn, _mm_min_epu8(_mm_subs_epu8(mx, c), _mm_sub_epi8(mx, mn)));
+}
+
+inline __m128i predictMED16(__m128i a, __m128i b, __m128i c)
+{
+  // SSE2 has no unsigned 16 bit min and max, i.e. use saturating subtraction
+
+  __m128i s=_mm_subs_epu16(a, b);
+  __m128i mn=_mm_sub_epi16(a, s);
+  __m128i mx=_mm_add_epi16(b, s);
+  __m128i d=_mm_subs_epu16(mx, c);
+  __m128i r=_mm_sub_epi16(mx, mn);
+
+  return _mm_add_epi16(mn, _mm_sub_epi16(d, _mm_subs_epu16(d, r)));
+}
+
+inline __m128i zigzag8(__m128i r)
+{
+  return _mm_xor_si128(_mm_add_epi8(r, r), _mm_cmpgt_epi8(_mm_setzero_si128(), r));
+}
+
+inline __m128i zigzag16(__m128i r)
+{
+  return _mm_xor_si128(_mm_slli_epi16(r, 1), _mm_srai_epi16(r, 15));
+}
+
+#endif
+
+/**
+  Computes residuals for i >= dx with SIMD instructions, if available, and
+  returns the index of the first sample that has not been processed.
+*/
+
+inline size_t computeResidualsSIMD(uint8_t *z, const uint8_t *row, const uint8_t *up, size_t i,
+  size_t n, size_t dx)
+{
+#if defined(__SSE2__) || defined(_M_X64)
+  if (up)
+  {
+    for (; i+16 <= n; i+=16)
+    {
+      __m128i x=_mm_loadu_si128(reinterpret_cast<const __m128i *>(row+i));
+      __m128i a=_mm_loadu_si128(reinterpret_cast<const __m128i *>(row+i-dx));
+      __m128i b=_mm_loadu_si128(reinterpret_cast<const __m128i *>(up+i));
+      __m128i c=_mm_loadu_si128(reinterpret_cast<const __m128i *>(up+i-dx));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(z+i),
+        zigzag8(_mm_sub_epi8(x, predictMED8(a, b, c))));
+    }
+  }
+  else
+  {
+    for (; i+16 <= n; i+=16)
+    {
+      __m128i x=_mm_loadu_si128(reinterpret_cast<const __m128i *>(row+i));
+      __m128i a=_mm_loadu_si128(reinterpret_cast<const __m128i *>(row+i-dx));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(z+i), zigzag8(_mm_sub_epi8(x, a)));
+    }
+  }
+#endif
+
+  return i;
+}
+
+inline size_t computeResidualsSIMD(uint16_t *z, const uint16_t *row, const uint16_t *up,
+  size_t i, size_t n, size_t dx)
+{
+#if defined(__SSE2__) || defined(_M_X64)
+  if (up)
+  {
+    for (; i+8 <= n; i+=8)
+    {
+      __m128i x=_mm_loadu_si128(reinterpret_cast<const __m128i *>(row+i));
+      __m128i a=_mm_loadu_si128(reinterpret_cast<const __m128i *>(row+i-dx));
+      __m128i b=_mm_loadu_si128(reinterpret_cast<const __m128i *>(up+i));
+      __m128i c=_mm_loadu_si128(reinterpret_cast<const __m128i *>(up+i-dx));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(z+i),
+        zigzag16(_mm_sub_epi16(x, predictMED16(a, b, c))));
+    }
+  }
+  else
+  {
+    for (; i+8 <= n; i+=8)
+    {
+      __m128i x=_mm_loadu_si128(reinterpret_cast<const __m128i *>(row+i));
+      __m128i a=_mm_loadu_si128(reinterpret_cast<const __m128i *>(row+i-dx));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(z+i), zigzag16(_mm_sub_epi16(x, a)));
+    }
+  }
+#endif
+
+  return i;
+}
+
+/**
+  Computes the zigzag coded prediction residuals of one row. up is 0 for rows
+  without upper neighbor.
+*/
+
+template<class T> void computeResiduals(T *z, const T *row, const T *up, size_t n,
+  size_t dx)
+{
+  size_t i=0;
+
+  if (up)
+  {
+    for (; i<dx && i<n; i++)
+    {
+      z[i]=zigzag(static_cast<T>(row[i]-up[i]));
+    }
+
+    i=computeResidualsSIMD(z, row, up, i, n, dx);
+
+    for (; i<n; i++)
+    {
+      z[i]=zigzag(static_cast<T>(row[i]-predictMED(row[i-dx], up[i], up[i-dx])));
+    }
+  }
+  else
+  {
+    for (; i<dx && i<n; i++)
+    {
+      z[i]=zigzag(row[i]);
+    }
+
+    i=computeResidualsSIMD(z, row, up, i, n, dx);
+
+    for (; i<n; i++)
+    {
+      z[i]=zigzag(static_cast<T>(row[i]-row[i-dx]));
+    }
+  }
+}
+
+/**
+  Reverses computeResiduals() and stores the result in row.
+*/
+
+template<class T> void reconstructRow(T *row, const T *z, const T *up, size_t n, size_t dx)
+{
+  size_t i=0;
+
+  if (up)
+  {
+    for (; i<dx && i<n; i++)
+    {
+      row[i]=static_cast<T>(up[i]+unzigzag(z[i]));
+    }
+
+    for (; i<n; i++)
+    {
+      row[i]=static_cast<T>(predictMED(row[i-dx], up[i], up[i-dx])+unzigzag(z[i]));
+    }
+  }
+  else
+  {
+    for (; i<dx && i<n; i++)
+    {
+      row[i]=unzigzag(z[i]);
+    }
+
+    for (; i<n; i++)
+    {
+      row[i]=static_cast<T>(row[i-dx]+unzigzag(z[i]));
+    }
+  }
+}
+
+/**
+  Returns the number of bits that are needed for storing the given 16 bit
+  value.
+*/
+
+inline int getBitLength(uint32_t m)
+{
+#if defined(__GNUC__)
+  return m ? 32-__builtin_clz(m) : 0;
+#elif defined(_MSC_VER)
+  unsigned long i;
+  return _BitScanReverse(&i, m) ? static_cast<int>(i)+1 : 0;
+#else
+  int w=0;
+
+  if (m >= (1u<<8)) { w+=8; m>>=8; }
+  if (m >= (1u<<4)) { w+=4; m>>=4; }
+  if (m >= (1u<<2)) { w+=2; m>>=2; }
+  if (m >= (1u<<1)) { w+=1; m>>=1; }
+
+  return w+static_cast<int>(m);
+#endif
+}
+
+/**
+  Stores a block of 16 residuals with the number of bits of the largest
+  residual. The first byte contains the number of bits w, followed by w bit
+  planes, starting with the least significant bit. Each bit plane is stored in
+  two bytes, with bit j of the plane belonging to residual j.
+*/
+
+template<class T> inline uint8_t *packBlockScalar(uint8_t *out, const T *z)
+{
+  uint32_t m=0;
+  for (size_t j=0; j<block_size; j++)
+  {
+    m|=z[j];
+  }
+
+  int w=getBitLength(m);
+  *out++=static_cast<uint8_t>(w);
+
+  for (int b=0; b<w; b++)
+  {
+    uint32_t plane=0;
+    for (size_t j=0; j<block_size; j++)
+    {
+      plane|=static_cast<uint32_t>((z[j]>>b)&1)<<j;
+    }
+
+    out[0]=static_cast<uint8_t>(plane);
+    out[1]=static_cast<uint8_t>(plane>>8);
+    out+=2;
+  }
+
+  return out;
+}
+
+inline uint8_t *packBlock(uint8_t *out, const uint8_t *z)
+{
+#if defined(__SSE2__) || defined(_M_X64)
+  __m128i v=_mm_loadu_si128(reinterpret_cast<const __m128i *>(z));
+
+  __m128i m=_mm_or_si128(v, _mm_srli_si128(v, 8));
+  m=_mm_or_si128(m, _mm_srli_si128(m, 4));
+  m=_mm_or_si128(m, _mm_srli_si128(m, 2));
+  m=_mm_or_si128(m, _mm_srli_si128(m, 1));
+
+  int w=getBitLength(static_cast<uint32_t>(_mm_cvtsi128_si32(m))&0xff);
+  *out++=static_cast<uint8_t>(w);
+
+  // extract all bit planes from the most significant one downwards by moving
+  // the bit into the sign bit of each byte, which avoids branches, but
+  // requires space for 8 planes after out
+
+  for (int b=7; b>=0; b--)
+  {
+    int plane=_mm_movemask_epi8(v);
+    out[2*b]=static_cast<uint8_t>(plane);
+    out[2*b+1]=static_cast<uint8_t>(plane>>8);
+
+    v=_mm_slli_epi16(v, 1);
+  }
+
+  return out+2*w;
+#else
+  return packBlockScalar(out, z);
+#endif
+}
+
+inline uint8_t *packBlock(uint8_t *out, const uint16_t *z)
+{
+#if defined(__SSE2__) || defined(_M_X64)
+  __m128i v0=_mm_loadu_si128(reinterpret_cast<const __m128i *>(z));
+  __m128i v1=_mm_loadu_si128(reinterpret_cast<const __m128i *>(z+8));
+
+  __m128i m=_mm_or_si128(v0, v1);
+  m=_mm_or_si128(m, _mm_srli_si128(m, 8));
+  m=_mm_or_si128(m, _mm_srli_si128(m, 4));
+  m=_mm_or_si128(m, _mm_srli_si128(m, 2));
+
+  int w=getBitLength(static_cast<uint32_t>(_mm_cvtsi128_si32(m))&0xffff);
+  *out++=static_cast<uint8_t>(w);
+
+  // extract all bit planes from the most significant one downwards by moving
+  // the bit into the sign bit of each value and packing to bytes with signed
+  // saturation, which keeps the sign, but requires space for 16 planes after
+  // out
+
+  for (int b=15; b>=0; b--)
+  {
+    int plane=_mm_movemask_epi8(_mm_packs_epi16(v0, v1));
+    out[2*b]=static_cast<uint8_t>(plane);
+    out[2*b+1]=static_cast<uint8_t>(plane>>8);
+
+    v0=_mm_slli_epi16(v0, 1);
+    v1=_mm_slli_epi16(v1, 1);
+  }
+
+  return out+2*w;
+#else
+  return packBlockScalar(out, z);
+#endif
+}
+
+/**
+  Reverses packBlock(). 0 is returned if the data ends before the block.
+*/
+
+template<class T> inline const uint8_t *unpackBlockScalar(T *z, const uint8_t *in, int w)
+{
+  memset(z, 0, block_size*sizeof(T));
+
+  for (int b=0; b<w; b++)
+  {
+    uint32_t plane=static_cast<uint32_t>(in[0])|(static_cast<uint32_t>(in[1])<<8);
+    in+=2;
+
+    for (size_t j=0; j<block_size; j++)
+    {
+      z[j]|=static_cast<T>(((plane>>j)&1)<<b);
+    }
+  }
+
+  return in;
+}
+
+inline const uint8_t *unpackBlock(uint8_t *z, const uint8_t *in, const uint8_t *end)
+{
+  if (in >= end) return 0;
+
+  int w=*in++;
+  if (w > 8 || end-in < 2*w) return 0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128i sel=_mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+  __m128i v=_mm_setzero_si128();
+
+  for (int b=0; b<w; b++)
+  {
+    // spread low byte of the plane to the first and high byte to the last 8
+    // bytes and expand every bit to a byte
+
+    __m128i x=_mm_cvtsi32_si128(in[0]|(in[1]<<8));
+    x=_mm_unpacklo_epi8(x, x);
+    x=_mm_unpacklo_epi16(x, x);
+    x=_mm_unpacklo_epi32(x, x);
+    x=_mm_cmpeq_epi8(_mm_and_si128(x, sel), sel);
+
+    v=_mm_or_si128(v, _mm_and_si128(x, _mm_set1_epi8(static_cast<char>(1<<b))));
+    in+=2;
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(z), v);
+
+  return in;
+#else
+  return unpackBlockScalar(z, in, w);
+#endif
+}
+
+inline const uint8_t *unpackBlock(uint16_t *z, const uint8_t *in, const uint8_t *end)
+{
+  if (in >= end) return 0;
+
+  int w=*in++;
+  if (w > 16 || end-in < 2*w) return 0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128i sel0=_mm_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128);
+  const __m128i sel1=_mm_setr_epi16(256, 512, 1024, 2048, 4096, 8192, 16384, -32768);
+  __m128i v0=_mm_setzero_si128();
+  __m128i v1=_mm_setzero_si128();
+
+  for (int b=0; b<w; b++)
+  {
+    __m128i x=_mm_set1_epi16(static_cast<short>(in[0]|(in[1]<<8)));
+    __m128i bit=_mm_set1_epi16(static_cast<short>(1<<b));
+
+    v0=_mm_or_si128(v0, _mm_and_si128(_mm_cmpeq_epi16(_mm_and_si128(x, sel0), sel0), bit));
+    v1=_mm_or_si128(v1, _mm_and_si128(_mm_cmpeq_epi16(_mm_and_si128(x, sel1), sel1), bit));
+    in+=2;
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(z), v0);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(z+8), v1);
+
+  return in;
+#else
+  return unpackBlockScalar(z, in, w);
+#endif
+}
+
+/**
+  Loads a row of samples, converting 16 bit values to host byte order.
+*/
+
+inline void loadRow(uint8_t *row, const uint8_t *p, size_t n, bool)
+{
+  memcpy(row, p, n);
+}
+
+inline void loadRow(uint16_t *row, const uint8_t *p, size_t n, bool bigendian)
+{
+  if (bigendian)
+  {
+    for (size_t i=0; i<n; i++)
+    {
+      row[i]=static_cast<uint16_t>((p[2*i]<<8)|p[2*i+1]);
+    }
+  }
+  else
+  {
+    for (size_t i=0; i<n; i++)
+    {
+      row[i]=static_cast<uint16_t>(p[2*i]|(p[2*i+1]<<8));
+    }
+  }
+}
+
+/**
+  Stores a row of samples, with 16 bit values in little endian byte order.
+*/
+
+inline void storeRow(uint8_t *p, const uint8_t *row, size_t n)
+{
+  memcpy(p, row, n);
+}
+
+inline void storeRow(uint8_t *p, const uint16_t *row, size_t n)
+{
+  for (size_t i=0; i<n; i++)
+  {
+    p[2*i]=static_cast<uint8_t>(row[i]);
+    p[2*i+1]=static_cast<uint8_t>(row[i]>>8);
+  }
+}
+
+template<class T> void encodeRows(std::vector<uint8_t> &data, const uint8_t *p, size_t lstep,
+  size_t n, size_t height, const SampleLayout &layout, bool bigendian)
+{
+  const size_t nblocks=(n+block_size-1)/block_size;
+
+  // keep the last dy+1 rows for prediction and compress every row into a
+  // buffer that is large enough for the worst case
+
+  std::vector<T> rows((layout.dy+1)*n);
+  std::vector<T> z(nblocks*block_size, 0);
+  std::vector<uint8_t> buffer(nblocks*(1+block_size*sizeof(T)));
+
+  for (size_t k=0; k<height; k++)
+  {
+    T *row=rows.data()+(k%(layout.dy+1))*n;
+    const T *up=0;
+
+    if (k >= layout.dy)
+    {
+      up=rows.data()+((k-layout.dy)%(layout.dy+1))*n;
+    }
+
+    loadRow(row, p, n, bigendian);
+    computeResiduals(z.data(), row, up, n, layout.dx);
+
+    uint8_t *out=buffer.data();
+    for (size_t j=0; j<nblocks; j++)
+    {
+      out=packBlock(out, z.data()+j*block_size);
+    }
+
+    data.insert(data.end(), buffer.data(), out);
+
+    p+=lstep;
+  }
+}
+
+template<class T> bool decodeRows(uint8_t *p, const uint8_t *in, const uint8_t *end, size_t n,
+  size_t height, const SampleLayout &layout)
+{
+  const size_t nblocks=(n+block_size-1)/block_size;
+
+  std::vector<T> rows((layout.dy+1)*n);
+  std::vector<T> z(nblocks*block_size);
+
+  for (size_t k=0; k<height; k++)
+  {
+    T *row=rows.data()+(k%(layout.dy+1))*n;
+    const T *up=0;
+
+    if (k >= layout.dy)
+    {
+      up=rows.data()+((k-layout.dy)%(layout.dy+1))*n;
+    }
+
+    for (size_t j=0; j<nblocks && in; j++)
+    {
+      in=unpackBlock(z.data()+j*block_size, in, end);
+    }
+
+    if (!in) return false;
+
+    reconstructRow(row, z.data(), up, n, layout.dx);
+    storeRow(p, row, n);
+
+    p+=n*sizeof(T);
+  }
+
+  return true;
+}
+
+}
+
+bool isEncodingSupported(uint64_t pixelformat)
+{
+  SampleLayout layout;
+  return getSampleLayout(layout, pixelformat);
+}
+
+void encodeImage(std::vector<uint8_t> &data, const Image &image, size_t yoffset, size_t height)
+{
+  size_t real_height=image.getHeight();
+
+  if (height == 0) height=real_height;
+
+  yoffset=std::min(yoffset, real_height);
+  height=std::min(height, real_height-yoffset);
+
+  encodeImage(data, ImageView(image).getROI(0, yoffset, image.getWidth(), height));
+}
+
+void encodeImage(std::vector<uint8_t> &data, const ImageView &image)
+{
+  SampleLayout layout;
+  uint64_t format=image.getPixelFormat();
+
+  if (!getSampleLayout(layout, format))
+  {
+    throw std::invalid_argument(std::string("encodeImage(): Unsupported pixel format: ")+
+      GetPixelFormatName(static_cast<PfncFormat>(format)));
+  }
+
+  const size_t width=image.getWidth();
+  const size_t height=image.getHeight();
+
+  const size_t bits=static_cast<size_t>((format>>16)&0xff);
+  const size_t rsize=(width*bits+7)/8;
+  const size_t lstep=image.getStride();
+  const size_t n=rsize/layout.ssize;
+
+  // write header, followed by the compressed rows
+
+  size_t start=data.size();
+  data.resize(start+header_size);
+
+  uint8_t *out=data.data()+start;
+  memcpy(out, magic, 4);
+  put32(out+4, static_cast<uint32_t>(width));
+  put32(out+8, static_cast<uint32_t>(height));
+  put64(out+12, format);
+  put64(out+20, image.getTimestampNS());
+  put64(out+28, image.getFrameID());
+
+  const uint8_t *p=image.getPixels();
+
+  if (layout.ssize == 2)
+  {
+    encodeRows<uint16_t>(data, p, lstep, n, height, layout, image.isBigEndian());
+  }
+  else
+  {
+    encodeRows<uint8_t>(data, p, lstep, n, height, layout, false);
+  }
+}
+
+std::shared_ptr<Image> decodeImage(const uint8_t *data, size_t size)
+{
+  if (size < header_size || memcmp(data, magic, 4) != 0)
+  {
+    throw std::invalid_argument("decodeImage(): Invalid header");
+  }
+
+  size_t width=get32(data+4);
+  size_t height=get32(data+8);
+  uint64_t format=get64(data+12);
+  uint64_t timestamp=get64(data+20);
+  uint64_t frameid=get64(data+28);
+
+  SampleLayout layout;
+  if (!getSampleLayout(layout, format))
+  {
+    throw std::invalid_argument("decodeImage(): Unsupported pixel format");
+  }
+
+  const size_t bits=static_cast<size_t>((format>>16)&0xff);
+  const size_t rsize=(width*bits+7)/8;
+  const size_t n=rsize/layout.ssize;
+
+  // every block needs at least one byte, which limits the size of the image
+  // before allocating memory
+
+  const size_t nblocks=(n+block_size-1)/block_size;
+  if (nblocks > 0 && height > (size-header_size)/nblocks)
+  {
+    throw std::invalid_argument("decodeImage(): Data too short");
+  }
+
+  std::shared_ptr<uint8_t> pixel(new uint8_t [rsize*height+1], std::default_delete<uint8_t []>());
+
+  bool ok;
+  if (layout.ssize == 2)
+  {
+    ok=decodeRows<uint16_t>(pixel.get(), data+header_size, data+size, n, height, layout);
+  }
+  else
+  {
+    ok=decodeRows<uint8_t>(pixel.get(), data+header_size, data+size, n, height, layout);
+  }
+
+  if (!ok)
+  {
+    throw std::invalid_argument("decodeImage(): Data too short");
+  }
+
+  // the decoded pixels are passed to the image without copying
+
+  return std::make_shared<Image>(std::shared_ptr<const uint8_t>(pixel), width, height, 0,
+    format, false, timestamp, frameid);
+}
+
+}
@@ -0,0 +1,109 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RC_GENICAM_API_IMAGE_CODEC
+#define RC_GENICAM_API_IMAGE_CODEC
+
+#include "image.h"
+
+#include <vector>
+#include <memory>
+
+namespace rcg
+{
+
+/**
+  Checks if images with the given pixel format can be compressed with
+  encodeImage(). Supported formats are Mono8, Confidence8, Error8, Mono16,
+  Coord3D_C16, RGB8, BayerRG8, BayerBG8, BayerGR8, BayerGB8, YCbCr411_8,
+  YCbCr422_8 and YUV422_8.
+
+  @param pixelformat Pixel format.
+  @return            True if the pixel format is supported.
+*/
+
+bool isEncodingSupported(uint64_t pixelformat);
+
+/**
+  Compresses the given rows of the image losslessly and appends the result to
+  the given vector. The compressed data starts with a header that contains
+  size, pixel format, timestamp and frame ID of the image.
+
+  Every sample is predicted from its left, upper and upper left neighbor of the
+  same color channel with the median edge detector of JPEG-LS. The residuals
+  are stored in blocks of 16 values with the number of bits that is needed for
+  the largest residual of the block. This is several times faster than PNG
+  and compresses camera images with noise about as well, while PNG is better
+  on images with large uniform areas or invalid regions, like disparity
+  images.
+
+  NOTE: An exception that is based on std::exception is thrown in case of an
+  error, e.g. if the pixel format is not supported.
+
+  @param data    Vector to which the compressed image is appended.
+  @param image   Image to be compressed.
+  @param yoffset First image row to be compressed.
+  @param height  Number of image rows to be compressed. 0 means all rows.
+*/
+
+void encodeImage(std::vector<uint8_t> &data, const Image &image, size_t yoffset=0,
+  size_t height=0);
+
+/**
+  Compresses a view onto an image, like above.
+
+  @param data  Vector to which the compressed image is appended.
+  @param image View onto the image or a part of it.
+*/
+
+void encodeImage(std::vector<uint8_t> &data, const ImageView &image);
+
+/**
+  Decompresses an image that has been compressed by encodeImage(). Images with
+  16 bit per pixel are always returned in little endian byte order.
+
+  NOTE: An exception that is based on std::exception is thrown if the data is
+  invalid.
+
+  @param data Pointer to compressed data.
+  @param size Number of bytes of compressed data.
+  @return     Decompressed image.
+*/
+
+std::shared_ptr<Image> decodeImage(const uint8_t *data, size_t size);
+
+}
+
+#endif
@@ -0,0 +1,610 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "image_pyramid.h"
+#include "pixel_formats.h"
+
+#include <stdexcept>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#ifdef _WIN32
+#undef min
+#undef max
+#endif
+
+namespace rcg
+{
+
+namespace
+{
+
+/*
+  Allocates memory for the pixels of a downscaled image.
+*/
+
+std::shared_ptr<uint8_t> allocatePixels(size_t size)
+{
+  return std::shared_ptr<uint8_t>(new uint8_t [std::max(size, static_cast<size_t>(1))],
+    std::default_delete<uint8_t []>());
+}
+
+/*
+  Returns the index clamped to the range 0 to n-1.
+*/
+
+inline size_t clampIndex(long i, size_t n)
+{
+  if (i < 0) return 0;
+  if (static_cast<size_t>(i) >= n) return n-1;
+  return static_cast<size_t>(i);
+}
+
+/*
+  Adds n values with 8 bit to n sums with 16 bit.
+*/
+
+void addRow8(uint16_t *sum, const uint8_t *row, size_t n)
+{
+  size_t i=0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128i zero=_mm_setzero_si128();
+
+  for (; i+16 <= n; i+=16)
+  {
+    __m128i v=_mm_loadu_si128(reinterpret_cast<const __m128i *>(row+i));
+    __m128i *s0=reinterpret_cast<__m128i *>(sum+i);
+    __m128i *s1=reinterpret_cast<__m128i *>(sum+i+8);
+
+    _mm_storeu_si128(s0, _mm_add_epi16(_mm_loadu_si128(s0), _mm_unpacklo_epi8(v, zero)));
+    _mm_storeu_si128(s1, _mm_add_epi16(_mm_loadu_si128(s1), _mm_unpackhi_epi8(v, zero)));
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  for (; i+16 <= n; i+=16)
+  {
+    uint8x16_t v=vld1q_u8(row+i);
+
+    vst1q_u16(sum+i, vaddw_u8(vld1q_u16(sum+i), vget_low_u8(v)));
+    vst1q_u16(sum+i+8, vaddw_u8(vld1q_u16(sum+i+8), vget_high_u8(v)));
+  }
+#endif
+
+  for (; i<n; i++)
+  {
+    sum[i]+=row[i];
+  }
+}
+
+/*
+  Averages 2x2 pixels of two rows of a monochrome image with 8 bit and stores
+  w target pixels.
+*/
+
+void halfRow8(uint8_t *target, const uint8_t *row0, const uint8_t *row1, size_t w)
+{
+  size_t i=0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128i mask=_mm_set1_epi16(0xff);
+  const __m128i two=_mm_set1_epi16(2);
+
+  for (; i+8 <= w; i+=8)
+  {
+    __m128i a=_mm_loadu_si128(reinterpret_cast<const __m128i *>(row0+2*i));
+    __m128i b=_mm_loadu_si128(reinterpret_cast<const __m128i *>(row1+2*i));
+
+    __m128i s=_mm_add_epi16(_mm_add_epi16(_mm_and_si128(a, mask), _mm_srli_epi16(a, 8)),
+      _mm_add_epi16(_mm_and_si128(b, mask), _mm_srli_epi16(b, 8)));
+
+    s=_mm_srli_epi16(_mm_add_epi16(s, two), 2);
+
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(target+i), _mm_packus_epi16(s, s));
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  for (; i+8 <= w; i+=8)
+  {
+    uint16x8_t s=vpaddlq_u8(vld1q_u8(row0+2*i));
+    s=vpadalq_u8(s, vld1q_u8(row1+2*i));
+
+    vst1_u8(target+i, vrshrn_n_u16(s, 2));
+  }
+#endif
+
+  for (; i<w; i++)
+  {
+    target[i]=static_cast<uint8_t>((row0[2*i]+row0[2*i+1]+row1[2*i]+row1[2*i+1]+2)>>2);
+  }
+}
+
+/*
+  Averages f x f pixels of an image with c channels of 8 bit.
+*/
+
+void box8(uint8_t *target, const ImageView &image, size_t c, uint32_t f)
+{
+  const size_t w=image.getWidth()/f;
+  const size_t h=image.getHeight()/f;
+  const size_t stride=image.getStride();
+  const uint8_t *p=image.getPixels();
+
+  if (c == 1 && f == 2)
+  {
+    for (size_t k=0; k<h; k++)
+    {
+      halfRow8(target, p, p+stride, w);
+
+      target+=w;
+      p+=2*stride;
+    }
+
+    return;
+  }
+
+  // sum f rows and then f pixels in each row
+
+  const size_t n=w*f*c;
+  const uint32_t nn=f*f;
+
+  // division by shifting if possible
+
+  int shift=-1;
+  if ((nn&(nn-1)) == 0)
+  {
+    shift=0;
+    while ((1u<<shift) < nn) shift++;
+  }
+
+  std::vector<uint16_t> sum(n);
+
+  for (size_t k=0; k<h; k++)
+  {
+    std::fill(sum.begin(), sum.end(), static_cast<uint16_t>(0));
+
+    for (uint32_t kk=0; kk<f; kk++)
+    {
+      addRow8(sum.data(), p, n);
+      p+=stride;
+    }
+
+    const uint16_t *s=sum.data();
+
+    if (f == 2)
+    {
+      for (size_t i=0; i<w; i++)
+      {
+        for (size_t j=0; j<c; j++)
+        {
+          *target++=static_cast<uint8_t>((s[j]+s[c+j]+2)>>2);
+        }
+
+        s+=2*c;
+      }
+
+      continue;
+    }
+
+    for (size_t i=0; i<w; i++)
+    {
+      for (size_t j=0; j<c; j++)
+      {
+        uint32_t v=0;
+
+        for (uint32_t ii=0; ii<f; ii++)
+        {
+          v+=s[ii*c+j];
+        }
+
+        if (shift >= 0)
+        {
+          *target++=static_cast<uint8_t>((v+nn/2)>>shift);
+        }
+        else
+        {
+          *target++=static_cast<uint8_t>((v+nn/2)/nn);
+        }
+      }
+
+      s+=f*c;
+    }
+  }
+}
+
+/*
+  Filters n values of five rows with the kernel 1 4 6 4 1.
+*/
+
+void gaussColumn8(uint16_t *target, const uint8_t * const row[5], size_t n)
+{
+  size_t i=0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128i zero=_mm_setzero_si128();
+
+  for (; i+16 <= n; i+=16)
+  {
+    __m128i v[5];
+    for (int j=0; j<5; j++)
+    {
+      v[j]=_mm_loadu_si128(reinterpret_cast<const __m128i *>(row[j]+i));
+    }
+
+    for (int h=0; h<2; h++)
+    {
+      __m128i r[5];
+      for (int j=0; j<5; j++)
+      {
+        r[j]=h == 0 ? _mm_unpacklo_epi8(v[j], zero) : _mm_unpackhi_epi8(v[j], zero);
+      }
+
+      __m128i s=_mm_add_epi16(r[0], r[4]);
+      s=_mm_add_epi16(s, _mm_slli_epi16(_mm_add_epi16(r[1], r[3]), 2));
+      s=_mm_add_epi16(s, _mm_add_epi16(_mm_slli_epi16(r[2], 2), _mm_slli_epi16(r[2], 1)));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(target+i+8*h), s);
+    }
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  for (; i+8 <= n; i+=8)
+  {
+    uint16x8_t s=vaddl_u8(vld1_u8(row[0]+i), vld1_u8(row[4]+i));
+    s=vmlaq_n_u16(s, vaddl_u8(vld1_u8(row[1]+i), vld1_u8(row[3]+i)), 4);
+    s=vmlaq_n_u16(s, vmovl_u8(vld1_u8(row[2]+i)), 6);
+
+    vst1q_u16(target+i, s);
+  }
+#endif
+
+  for (; i<n; i++)
+  {
+    target[i]=static_cast<uint16_t>(row[0][i]+4*(row[1][i]+row[3][i])+6*row[2][i]+row[4][i]);
+  }
+}
+
+/*
+  Smoothes an image with c channels of 8 bit with the 5x5 binomial kernel and
+  reduces it by a factor of 2. Pixels outside the image are replaced by the
+  closest border pixel.
+*/
+
+void gauss8(uint8_t *target, const ImageView &image, size_t c)
+{
+  const size_t width=image.getWidth();
+  const size_t height=image.getHeight();
+  const size_t w=width/2;
+  const size_t h=height/2;
+
+  std::vector<uint16_t> col(width*c);
+
+  for (size_t k=0; k<h; k++)
+  {
+    const uint8_t *row[5];
+    for (int j=0; j<5; j++)
+    {
+      row[j]=image.getPixels()+clampIndex(static_cast<long>(2*k)+j-2, height)*image.getStride();
+    }
+
+    gaussColumn8(col.data(), row, width*c);
+
+    for (size_t i=0; i<w; i++)
+    {
+      const size_t x=2*i;
+
+      if (x >= 2 && x+2 < width)
+      {
+        const uint16_t *q=&col[(x-2)*c];
+
+        for (size_t j=0; j<c; j++)
+        {
+          uint32_t s=q[j]+4*(q[c+j]+q[3*c+j])+6*q[2*c+j]+q[4*c+j];
+          *target++=static_cast<uint8_t>((s+128)>>8);
+        }
+      }
+      else
+      {
+        const uint32_t weight[5]={1, 4, 6, 4, 1};
+
+        for (size_t j=0; j<c; j++)
+        {
+          uint32_t s=0;
+          for (int jj=0; jj<5; jj++)
+          {
+            s+=weight[jj]*col[clampIndex(static_cast<long>(x)+jj-2, width)*c+j];
+          }
+
+          *target++=static_cast<uint8_t>((s+128)>>8);
+        }
+      }
+    }
+  }
+}
+
+/*
+  Stores a 16 bit value in little endian.
+*/
+
+inline void storeLE16(uint8_t *&target, uint32_t v)
+{
+  *target++=static_cast<uint8_t>(v&0xff);
+  *target++=static_cast<uint8_t>(v>>8);
+}
+
+/*
+  Averages the valid disparities of f x f pixels and divides them by f.
+*/
+
+void boxDisparity(uint8_t *target, const ImageView &image, uint32_t f, bool ignore_invalid)
+{
+  const size_t width=image.getWidth();
+  const size_t w=width/f;
+  const size_t h=image.getHeight()/f;
+  const uint32_t nn=f*f;
+  const uint8_t *p=image.getPixels();
+
+  std::vector<uint16_t> row(width);
+  std::vector<uint32_t> sum(w), cnt(w);
+
+  for (size_t k=0; k<h; k++)
+  {
+    std::fill(sum.begin(), sum.end(), 0);
+    std::fill(cnt.begin(), cnt.end(), 0);
+
+    for (uint32_t kk=0; kk<f; kk++)
+    {
+      unpackPixels(row.data(), p, Coord3D_C16, width, image.isBigEndian());
+
+      const uint16_t *r=row.data();
+
+      for (size_t i=0; i<w; i++)
+      {
+        for (uint32_t ii=0; ii<f; ii++)
+        {
+          const uint32_t v=*r++;
+
+          sum[i]+=v;
+          cnt[i]+=(v != 0);
+        }
+      }
+
+      p+=image.getStride();
+    }
+
+    for (size_t i=0; i<w; i++)
+    {
+      uint32_t d=0;
+
+      if (cnt[i] > 0 && (ignore_invalid || cnt[i] == nn))
+      {
+        d=(sum[i]+cnt[i]*f/2)/(cnt[i]*f);
+      }
+
+      storeLE16(target, d);
+    }
+  }
+}
+
+/*
+  Smoothes the valid disparities with the 5x5 binomial kernel, reduces the
+  image by a factor of 2 and divides the disparities by 2.
+*/
+
+void gaussDisparity(uint8_t *target, const ImageView &image, bool ignore_invalid)
+{
+  const size_t width=image.getWidth();
+  const size_t height=image.getHeight();
+  const size_t w=width/2;
+  const size_t h=height/2;
+  const uint32_t weight[5]={1, 4, 6, 4, 1};
+
+  std::vector<uint16_t> row(width);
+  std::vector<uint32_t> col(width), colw(width);
+
+  for (size_t k=0; k<h; k++)
+  {
+    // weighted sum of valid disparities and of their weights in columns
+
+    std::fill(col.begin(), col.end(), 0);
+    std::fill(colw.begin(), colw.end(), 0);
+
+    for (int j=0; j<5; j++)
+    {
+      const uint8_t *p=image.getPixels()+
+        clampIndex(static_cast<long>(2*k)+j-2, height)*image.getStride();
+
+      unpackPixels(row.data(), p, Coord3D_C16, width, image.isBigEndian());
+
+      for (size_t i=0; i<width; i++)
+      {
+        const uint32_t v=row[i];
+
+        col[i]+=weight[j]*v;
+        colw[i]+=(v != 0 ? weight[j] : 0);
+      }
+    }
+
+    // weighted sum in rows
+
+    for (size_t i=0; i<w; i++)
+    {
+      uint32_t s=0, sw=0;
+
+      for (int jj=0; jj<5; jj++)
+      {
+        const size_t x=clampIndex(static_cast<long>(2*i)+jj-2, width);
+
+        s+=weight[jj]*col[x];
+        sw+=weight[jj]*colw[x];
+      }
+
+      uint32_t d=0;
+
+      if (sw > 0 && (ignore_invalid || sw == 256))
+      {
+        d=(s+sw)/(2*sw);
+      }
+
+      storeLE16(target, d);
+    }
+  }
+}
+
+}
+
+std::shared_ptr<const Image> downscale(const ImageView &image, uint32_t factor,
+  DownscaleFilter filter, bool ignore_invalid)
+{
+  if (factor < 1 || factor > 256)
+  {
+    throw std::invalid_argument("downscale(): Factor must be between 1 and 256");
+  }
+
+  if (filter == DOWNSCALE_GAUSS && (factor&(factor-1)) != 0)
+  {
+    throw std::invalid_argument("downscale(): Factor must be a power of 2 for gauss filter");
+  }
+
+  const uint64_t format=image.getPixelFormat();
+
+  // YCbCr formats are converted to RGB first
+
+  if (format == YCbCr411_8 || format == YCbCr422_8 || format == YUV422_8)
+  {
+    const size_t width=image.getWidth();
+    const size_t height=image.getHeight();
+
+    std::shared_ptr<uint8_t> rgb=allocatePixels(3*width*height);
+    convertImage(rgb.get(), 0, image);
+
+    std::shared_ptr<const Image> ret=std::make_shared<Image>(rgb, width, height, 0, RGB8, false,
+      image.getTimestampNS(), image.getFrameID());
+
+    if (factor > 1)
+    {
+      ret=downscale(ImageView(*ret), factor, filter, ignore_invalid);
+    }
+
+    return ret;
+  }
+
+  // the gauss filter reduces by a factor of 2 in each step
+
+  if (filter == DOWNSCALE_GAUSS && factor > 2)
+  {
+    std::shared_ptr<const Image> ret=downscale(image, 2, filter, ignore_invalid);
+
+    for (factor/=2; factor > 1; factor/=2)
+    {
+      ret=downscale(ImageView(*ret), 2, filter, ignore_invalid);
+    }
+
+    return ret;
+  }
+
+  if (filter == DOWNSCALE_GAUSS && factor == 1)
+  {
+    filter=DOWNSCALE_BOX;
+  }
+
+  const size_t w=image.getWidth()/factor;
+  const size_t h=image.getHeight()/factor;
+
+  std::shared_ptr<uint8_t> pixels;
+
+  switch (format)
+  {
+    case Mono8:
+    case Confidence8:
+    case Error8:
+    case RGB8:
+      {
+        const size_t c=(format == RGB8 ? 3 : 1);
+
+        pixels=allocatePixels(c*w*h);
+
+        if (filter == DOWNSCALE_GAUSS)
+        {
+          gauss8(pixels.get(), image, c);
+        }
+        else
+        {
+          box8(pixels.get(), image, c, factor);
+        }
+      }
+      break;
+
+    case Coord3D_C16:
+      pixels=allocatePixels(2*w*h);
+
+      if (filter == DOWNSCALE_GAUSS)
+      {
+        gaussDisparity(pixels.get(), image, ignore_invalid);
+      }
+      else
+      {
+        boxDisparity(pixels.get(), image, factor, ignore_invalid);
+      }
+      break;
+
+    default:
+      throw std::invalid_argument("downscale(): Pixel format not supported: "+
+        std::string(GetPixelFormatName(static_cast<PfncFormat>(format))));
+  }
+
+  return std::make_shared<Image>(pixels, w, h, 0, format, false, image.getTimestampNS(),
+    image.getFrameID());
+}
+
+std::vector<std::shared_ptr<const Image> > createImagePyramid(const ImageView &image,
+  size_t levels, DownscaleFilter filter, bool ignore_invalid)
+{
+  std::vector<std::shared_ptr<const Image> > ret;
+
+  ImageView view=image;
+
+  for (size_t i=0; i<levels && view.getWidth() >= 2 && view.getHeight() >= 2; i++)
+  {
+    ret.push_back(downscale(view, 2, filter, ignore_invalid));
+    view=ImageView(*ret.back());
+  }
+
+  return ret;
+}
+
+}
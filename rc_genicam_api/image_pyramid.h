@@ -0,0 +1,106 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RC_GENICAM_API_IMAGE_PYRAMID
+#define RC_GENICAM_API_IMAGE_PYRAMID
+
+#include "image.h"
+
+#include <vector>
+#include <memory>
+
+namespace rcg
+{
+
+/**
+  Filter that is used for downscaling images. The box filter averages
+  factor x factor pixels. The gauss filter smoothes with the 5x5 binomial
+  kernel (1 4 6 4 1)/16 before every reduction by a factor of 2, which gives
+  less aliasing.
+*/
+
+enum DownscaleFilter {DOWNSCALE_BOX, DOWNSCALE_GAUSS};
+
+/**
+  Downscales the image by the given factor. The downscaled image has a size of
+  (width/factor) x (height/factor) pixels. Remaining columns and rows at the
+  right and bottom border are ignored.
+
+  Supported formats are Mono8, Confidence8, Error8, RGB8 and Coord3D_C16.
+  YCbCr411_8, YCbCr422_8 and YUV422_8 are converted to RGB8. Coord3D_C16 is
+  treated as disparity image with 0 as invalid value. The returned disparity
+  image is always little endian and its values are divided by the factor, so
+  that they fit to the reduced resolution.
+
+  NOTE: An exception that is based on std::exception is thrown if the pixel
+  format is not supported or if the factor is not valid.
+
+  @param image          Image to be downscaled.
+  @param factor         Downscale factor, i.e. >= 1. It must be a power of 2
+                        for the gauss filter.
+  @param filter         Filter for downscaling.
+  @param ignore_invalid Only used for disparity images. If true, invalid
+                        disparities are ignored when averaging, so that a
+                        pixel is only invalid if all contributing pixels are
+                        invalid. Otherwise, a pixel is invalid as soon as one
+                        of the contributing pixels is invalid.
+  @return               Downscaled image.
+*/
+
+std::shared_ptr<const Image> downscale(const ImageView &image, uint32_t factor,
+  DownscaleFilter filter=DOWNSCALE_BOX, bool ignore_invalid=true);
+
+/**
+  Creates an image pyramid by repeatedly downscaling the image by a factor of
+  2 with downscale(). Level i of the pyramid has the resolution of the image
+  downscaled by 2^(i+1). Less levels are returned if the size of the image
+  gets too small.
+
+  NOTE: An exception that is based on std::exception is thrown if the pixel
+  format is not supported.
+
+  @param image          Image at full resolution.
+  @param levels         Number of pyramid levels.
+  @param filter         Filter for downscaling.
+  @param ignore_invalid See downscale().
+  @return               Downscaled images, starting with half resolution.
+*/
+
+std::vector<std::shared_ptr<const Image> > createImagePyramid(const ImageView &image,
+  size_t levels, DownscaleFilter filter=DOWNSCALE_GAUSS, bool ignore_invalid=true);
+
+}
+
+#endif
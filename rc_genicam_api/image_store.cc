@@ -34,7 +34,9 @@
  */
 
 #include "image_store.h"
+#include "image_codec.h"
 #include "pixel_formats.h"
+#include "pixel_traits.h"
 
 #include <exception>
 
@@ -45,8 +47,35 @@
 #include <limits>
 #include <algorithm>
 
+#include <vector>
+#include <thread>
+#include <system_error>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
 #ifdef INCLUDE_PNG
 #include <png.h>
+#include <zlib.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
 #endif
 
 #ifdef _WIN32
@@ -57,8 +86,68 @@
 namespace rcg
 {
 
-std::string ensureNewFileName(std::string name)
+namespace
+{
+
+class IOException : public std::exception
+{
+  public:
+
+    IOException(const std::string &_msg) { msg=_msg; }
+    virtual const char *what() const noexcept { return msg.c_str(); }
+
+  private:
+
+    std::string msg;
+};
+
+/*
+  Creates the given directory if it does not exist yet.
+*/
+
+void createDirectory(const std::string &name)
+{
+#ifdef _WIN32
+  int ret=_mkdir(name.c_str());
+#else
+  int ret=mkdir(name.c_str(), 0777);
+#endif
+
+  if (ret != 0 && errno != EEXIST)
+  {
+    throw IOException("Cannot create directory: "+name);
+  }
+}
+
+}
+
+std::string ensureNewFileName(std::string name, FileNaming naming)
 {
+  if (naming == NAME_UNIQUE)
+  {
+    return name;
+  }
+
+  if (naming == NAME_EXCLUSIVE)
+  {
+    // create the file if it does not exist in one atomic operation
+
+#ifdef _WIN32
+    int fd=_open(name.c_str(), _O_CREAT | _O_EXCL | _O_WRONLY, _S_IREAD | _S_IWRITE);
+    if (fd >= 0) _close(fd);
+#else
+    int fd=open(name.c_str(), O_CREAT | O_EXCL | O_WRONLY, 0666);
+    if (fd >= 0) close(fd);
+#endif
+
+    if (fd < 0)
+    {
+      throw IOException("Cannot create file exclusively: "+name);
+    }
+
+    return name;
+  }
+
   // check if given name is already used
 
   std::ifstream file(name);
@@ -101,31 +190,366 @@ std::string ensureNewFileName(std::string name)
   return name;
 }
 
+FileNameGenerator::FileNameGenerator(const std::string &_dir, size_t _files_per_dir,
+  uint64_t _seconds_per_dir) : dir(_dir), files_per_dir(_files_per_dir),
+  seconds_per_dir(_seconds_per_dir), counter(0)
+{
+  if (dir.size() == 0)
+  {
+    dir=".";
+  }
+
+  createDirectory(dir);
+
+  // session ID from random device, mixed with the current time in case that
+  // the random device is deterministic on some platforms
+
+  std::random_device rd;
+  uint32_t id=rd()^static_cast<uint32_t>(
+    std::chrono::high_resolution_clock::now().time_since_epoch().count());
+
+  std::ostringstream out;
+  out << std::hex << std::setfill('0') << std::setw(8) << id;
+  session=out.str();
+}
+
+std::string FileNameGenerator::getName(const std::string &base, uint64_t timestamp)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+
+  std::ostringstream name;
+  name << dir << '/';
+
+  // determine subdirectory and create it if it changes
+
+  std::string sd;
+
+  if (files_per_dir > 0)
+  {
+    std::ostringstream out;
+    out << std::setfill('0') << std::setw(6) << counter/files_per_dir;
+    sd=out.str();
+  }
+  else if (seconds_per_dir > 0)
+  {
+    if (timestamp == 0)
+    {
+      timestamp=static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    uint64_t t=timestamp/1000000000;
+    sd=std::to_string(t-t%seconds_per_dir);
+  }
+
+  if (sd.size() > 0)
+  {
+    if (sd != subdir)
+    {
+      createDirectory(dir+"/"+sd);
+      subdir=sd;
+    }
+
+    name << sd << '/';
+  }
+
+  name << session << '-' << std::setfill('0') << std::setw(8) << counter << '_' << base;
+
+  counter++;
+
+  return name.str();
+}
+
 namespace
 {
 
-class IOException : public std::exception
+/**
+  Adds the duration of its lifetime to the conversion time of the given
+  timing, if a timing is given.
+*/
+
+class ConvertTimer
 {
   public:
 
-    IOException(const std::string &_msg) { msg=_msg; }
-    virtual const char *what() const noexcept { return msg.c_str(); }
+    ConvertTimer(StoreTiming *_timing) : timing(_timing)
+    {
+      if (timing) t0=std::chrono::steady_clock::now();
+    }
+
+    ~ConvertTimer()
+    {
+      if (timing)
+      {
+        timing->convert_ms+=std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now()-t0).count();
+      }
+    }
 
   private:
 
-    std::string msg;
+    ConvertTimer(const ConvertTimer &); // forbidden
+    ConvertTimer &operator=(const ConvertTimer &); // forbidden
+
+    StoreTiming *timing;
+    std::chrono::steady_clock::time_point t0;
+};
+
+/**
+  Copies the given number of 16 bit values and swaps the bytes of each value.
+*/
+
+void swapBytes16(uint8_t *target, const uint8_t *source, size_t n)
+{
+  size_t i=0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  for (; i+8 <= n; i+=8)
+  {
+    __m128i v=_mm_loadu_si128(reinterpret_cast<const __m128i *>(source+2*i));
+    v=_mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(target+2*i), v);
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  for (; i+8 <= n; i+=8)
+  {
+    vst1q_u8(target+2*i, vrev16q_u8(vld1q_u8(source+2*i)));
+  }
+#endif
+
+  for (; i<n; i++)
+  {
+    target[2*i]=source[2*i+1];
+    target[2*i+1]=source[2*i];
+  }
+}
+
+/**
+  Operation for dispatchPixelFormat() that returns the number of significant
+  bits per pixel.
+*/
+
+struct SignificantBitsOp
+{
+  int bits;
+
+  template<class P> void run()
+  {
+    bits=P::bits;
+  }
 };
 
-std::string storeImagePNM(const std::string &name, const Image &image, size_t yoffset,
-  size_t height)
+inline int getSignificantBits(uint64_t format)
 {
-  size_t width=image.getWidth();
-  size_t real_height=image.getHeight();
+  SignificantBitsOp op;
+  op.bits=0;
 
-  if (height == 0) height=real_height;
+  dispatchPixelFormat(format, false, op);
 
-  yoffset=std::min(yoffset, real_height);
-  height=std::min(height, real_height-yoffset);
+  return op.bits;
+}
+
+/**
+  Unpacks a row of a monochrome image with 10 or 12 bit into big endian 16
+  bit values. If scale is true, the values are scaled to 16 bit by left bit
+  replication, which is reversible by a right shift.
+
+  @param target    Target row of 2*width bytes.
+  @param tmp       Temporary row of width values.
+  @param source    Source row.
+  @param format    Pixel format of source row.
+  @param width     Number of pixels.
+  @param bigendian True if the source row is stored big endian.
+  @param scale     True for scaling to 16 bit.
+*/
+
+void unpackMonoRowBE(uint8_t *target, uint16_t *tmp, const uint8_t *source, uint64_t format,
+  size_t width, bool bigendian, bool scale)
+{
+  int bits=unpackPixels(tmp, source, format, width, bigendian);
+
+  int ls=0, rs=0;
+  if (scale)
+  {
+    ls=16-bits;
+    rs=2*bits-16;
+  }
+
+  for (size_t i=0; i<width; i++)
+  {
+    uint16_t v=static_cast<uint16_t>((tmp[i]<<ls)|(tmp[i]>>rs));
+    *target++=static_cast<uint8_t>(v>>8);
+    *target++=static_cast<uint8_t>(v&0xff);
+  }
+}
+
+/**
+  Converts a row of 16 bit disparity values into float values. Invalid values
+  are set to infinity and valid values are scaled and offset.
+
+  @param target    Target row of width float values, which is not aligned.
+  @param source    Source row of width 16 bit values.
+  @param width     Number of values.
+  @param bigendian True if source values are big endian.
+  @param swap      True for swapping the bytes of the float values.
+  @param inv       Value of invalid disparities. No disparity is invalid if
+                   the value is outside the range of 16 bit values.
+  @param scale     Scale factor.
+  @param offset    Offset.
+*/
+
+void convertDisparityRow(uint8_t *target, const uint8_t *source, size_t width, bool bigendian,
+  bool swap, int inv, float scale, float offset)
+{
+  const float infinity=std::numeric_limits<float>::infinity();
+  const bool has_inv=(inv >= 0 && inv <= 0xffff);
+
+  size_t i=0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128i vinv=_mm_set1_epi16(static_cast<short>(inv));
+  const __m128i vzero=_mm_setzero_si128();
+  const __m128i vmask8=_mm_set1_epi32(0x0000ff00);
+  const __m128 vscale=_mm_set1_ps(scale);
+  const __m128 voffset=_mm_set1_ps(offset);
+  const __m128 vinf=_mm_set1_ps(infinity);
+
+  for (; i+8 <= width; i+=8)
+  {
+    __m128i v=_mm_loadu_si128(reinterpret_cast<const __m128i *>(source+2*i));
+
+    if (bigendian)
+    {
+      v=_mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    }
+
+    __m128i m=has_inv ? _mm_cmpeq_epi16(v, vinv) : vzero;
+
+    __m128 d[2], dm[2];
+
+    d[0]=_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, vzero));
+    d[1]=_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, vzero));
+    dm[0]=_mm_castsi128_ps(_mm_unpacklo_epi16(m, m));
+    dm[1]=_mm_castsi128_ps(_mm_unpackhi_epi16(m, m));
+
+    for (int j=0; j<2; j++)
+    {
+      d[j]=_mm_add_ps(_mm_mul_ps(d[j], vscale), voffset);
+      d[j]=_mm_or_ps(_mm_andnot_ps(dm[j], d[j]), _mm_and_ps(dm[j], vinf));
+
+      __m128i w=_mm_castps_si128(d[j]);
+
+      if (swap)
+      {
+        w=_mm_or_si128(_mm_or_si128(_mm_slli_epi32(w, 24), _mm_srli_epi32(w, 24)),
+          _mm_or_si128(_mm_and_si128(_mm_slli_epi32(w, 8), _mm_slli_epi32(vmask8, 8)),
+          _mm_and_si128(_mm_srli_epi32(w, 8), vmask8)));
+      }
+
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(target+4*(i+4*j)), w);
+    }
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const uint16x8_t vinv=vdupq_n_u16(static_cast<uint16_t>(inv));
+  const float32x4_t vscale=vdupq_n_f32(scale);
+  const float32x4_t voffset=vdupq_n_f32(offset);
+  const float32x4_t vinf=vdupq_n_f32(infinity);
+
+  for (; i+8 <= width; i+=8)
+  {
+    uint8x16_t b=vld1q_u8(source+2*i);
+
+    if (bigendian)
+    {
+      b=vrev16q_u8(b);
+    }
+
+    uint16x8_t v=vreinterpretq_u16_u8(b);
+    uint16x8_t m=has_inv ? vceqq_u16(v, vinv) : vdupq_n_u16(0);
+
+    float32x4_t d[2];
+    uint32x4_t dm[2];
+
+    d[0]=vcvtq_f32_u32(vmovl_u16(vget_low_u16(v)));
+    d[1]=vcvtq_f32_u32(vmovl_u16(vget_high_u16(v)));
+    dm[0]=vreinterpretq_u32_s32(vmovl_s16(vreinterpret_s16_u16(vget_low_u16(m))));
+    dm[1]=vreinterpretq_u32_s32(vmovl_s16(vreinterpret_s16_u16(vget_high_u16(m))));
+
+    for (int j=0; j<2; j++)
+    {
+      d[j]=vaddq_f32(vmulq_f32(d[j], vscale), voffset);
+      d[j]=vbslq_f32(dm[j], vinf, d[j]);
+
+      uint8x16_t w=vreinterpretq_u8_f32(d[j]);
+
+      if (swap)
+      {
+        w=vrev32q_u8(w);
+      }
+
+      vst1q_u8(target+4*(i+4*j), w);
+    }
+  }
+#endif
+
+  for (; i<width; i++)
+  {
+    int val;
+    if (bigendian)
+    {
+      val=(static_cast<int>(source[2*i])<<8)|source[2*i+1];
+    }
+    else
+    {
+      val=(static_cast<int>(source[2*i+1])<<8)|source[2*i];
+    }
+
+    float d=infinity;
+    if (val != inv)
+    {
+      d=static_cast<float>(val*scale+offset);
+    }
+
+    const uint8_t *c=reinterpret_cast<const uint8_t *>(&d);
+    uint8_t *t=target+4*i;
+
+    if (swap)
+    {
+      t[0]=c[3]; t[1]=c[2]; t[2]=c[1]; t[3]=c[0];
+    }
+    else
+    {
+      t[0]=c[0]; t[1]=c[1]; t[2]=c[2]; t[3]=c[3];
+    }
+  }
+}
+
+/**
+  Writes the given rows of size rsize bytes. The rows are lstep bytes apart.
+  All rows are written at once if there is no padding.
+*/
+
+void writeRows(std::ostream &out, const uint8_t *p, size_t rsize, size_t lstep, size_t height)
+{
+  if (rsize == lstep)
+  {
+    out.write(reinterpret_cast<const char *>(p), static_cast<std::streamsize>(rsize*height));
+  }
+  else
+  {
+    for (size_t k=0; k<height && out.good(); k++)
+    {
+      out.write(reinterpret_cast<const char *>(p), static_cast<std::streamsize>(rsize));
+      p+=lstep;
+    }
+  }
+}
+
+std::string storeImagePNM(const std::string &name, const ImageView &image, FileNaming naming,
+  StoreTiming *timing)
+{
+  size_t width=image.getWidth();
+  size_t height=image.getHeight();
 
   const unsigned char *p=static_cast<const unsigned char *>(image.getPixels());
 
@@ -140,25 +564,14 @@ std::string storeImagePNM(const std::string &name, const Image &image, size_t yo
     case Confidence8:
     case Error8:
       {
-        full_name=ensureNewFileName(name+".pgm");
+        full_name=ensureNewFileName(name+".pgm", naming);
         std::ofstream out(full_name, std::ios::binary);
 
         out << "P5" << std::endl;
         out << width << " " << height << std::endl;
         out << 255 << "\n";
 
-        std::streambuf *sb=out.rdbuf();
-
-        p+=(width+px)*yoffset;
-        for (size_t k=0; k<height && out.good(); k++)
-        {
-          for (size_t i=0; i<width; i++)
-          {
-            sb->sputc(static_cast<char>(*p++));
-          }
-
-          p+=px;
-        }
+        writeRows(out, p, width, width+px, height);
 
         out.close();
       }
@@ -167,44 +580,70 @@ std::string storeImagePNM(const std::string &name, const Image &image, size_t yo
     case Mono16:
     case Coord3D_C16: // store 16 bit monochrome image
       {
-        full_name=ensureNewFileName(name+".pgm");
+        full_name=ensureNewFileName(name+".pgm", naming);
         std::ofstream out(full_name, std::ios::binary);
 
         out << "P5" << std::endl;
         out << width << " " << height << std::endl;
         out << 65535 << "\n";
 
-        std::streambuf *sb=out.rdbuf();
-
         // copy image data, pgm is always big endian
 
-        p+=(2*width+px)*yoffset;
         if (image.isBigEndian())
         {
+          writeRows(out, p, 2*width, 2*width+px, height);
+        }
+        else
+        {
+          std::unique_ptr<uint8_t []> row(new uint8_t [2*width]);
+
           for (size_t k=0; k<height && out.good(); k++)
           {
-            for (size_t i=0; i<width; i++)
             {
-              sb->sputc(static_cast<char>(*p++));
-              sb->sputc(static_cast<char>(*p++));
+              ConvertTimer ct(timing);
+              swapBytes16(row.get(), p, width);
             }
 
-            p+=px;
+            out.write(reinterpret_cast<const char *>(row.get()),
+              static_cast<std::streamsize>(2*width));
+
+            p+=2*width+px;
           }
         }
-        else
+
+        out.close();
+      }
+      break;
+
+    case Mono10: // store 10 or 12 bit monochrome image as 16 bit without scaling
+    case Mono10p:
+    case Mono10Packed:
+    case Mono12:
+    case Mono12p:
+    case Mono12Packed:
+      {
+        full_name=ensureNewFileName(name+".pgm", naming);
+        std::ofstream out(full_name, std::ios::binary);
+
+        out << "P5" << std::endl;
+        out << width << " " << height << std::endl;
+        out << ((1<<getSignificantBits(format))-1) << "\n";
+
+        size_t lstep=(width*((format>>16)&0xff)+7)/8+px;
+        std::unique_ptr<uint16_t []> tmp(new uint16_t [width]);
+        std::unique_ptr<uint8_t []> row(new uint8_t [2*width]);
+
+        for (size_t k=0; k<height && out.good(); k++)
         {
-          for (size_t k=0; k<height && out.good(); k++)
           {
-            for (size_t i=0; i<width; i++)
-            {
-              sb->sputc(static_cast<char>(p[1]));
-              sb->sputc(static_cast<char>(p[0]));
-              p+=2;
-            }
-
-            p+=px;
+            ConvertTimer ct(timing);
+            unpackMonoRowBE(row.get(), tmp.get(), p, format, width, image.isBigEndian(), false);
           }
+
+          out.write(reinterpret_cast<const char *>(row.get()),
+            static_cast<std::streamsize>(2*width));
+
+          p+=lstep;
         }
 
         out.close();
@@ -215,15 +654,13 @@ std::string storeImagePNM(const std::string &name, const Image &image, size_t yo
     case YCbCr422_8:
     case YUV422_8:
       {
-        full_name=ensureNewFileName(name+".ppm");
+        full_name=ensureNewFileName(name+".ppm", naming);
         std::ofstream out(full_name, std::ios::binary);
 
         out << "P6" << std::endl;
         out << width << " " << height << std::endl;
         out << 255 << "\n";
 
-        std::streambuf *sb=out.rdbuf();
-
         size_t pstep;
         if (format == YCbCr411_8)
         {
@@ -234,28 +671,35 @@ std::string storeImagePNM(const std::string &name, const Image &image, size_t yo
           pstep=(width>>2)*8+px;
         }
 
-        p+=pstep*yoffset;
+        // convert and write row by row, the row buffer is padded to a multiple
+        // of 4 pixels, since groups of 4 pixels are converted at once
+
+        std::unique_ptr<uint8_t []> row(new uint8_t [3*((width+3)&~static_cast<size_t>(3))]);
+
         for (size_t k=0; k<height && out.good(); k++)
         {
-          for (size_t i=0; i<width; i+=4)
           {
-            uint8_t rgb[12];
+            ConvertTimer ct(timing);
 
             if (format == YCbCr411_8)
             {
-              convYCbCr411toQuadRGB(rgb, p, static_cast<int>(i));
+              for (size_t i=0; i<width; i+=4)
+              {
+                convYCbCr411toQuadRGB(row.get()+3*i, p, static_cast<int>(i));
+              }
             }
             else
             {
-              convYCbCr422toQuadRGB(rgb, p, static_cast<int>(i));
-            }
-
-            for (int j=0; j<12; j++)
-            {
-              sb->sputc(static_cast<char>(rgb[j]));
+              for (size_t i=0; i<width; i+=4)
+              {
+                convYCbCr422toQuadRGB(row.get()+3*i, p, static_cast<int>(i));
+              }
             }
           }
 
+          out.write(reinterpret_cast<const char *>(row.get()),
+            static_cast<std::streamsize>(3*width));
+
           p+=pstep;
         }
 
@@ -263,41 +707,46 @@ std::string storeImagePNM(const std::string &name, const Image &image, size_t yo
       }
       break;
 
+    case RGB8: // store color image directly
+      {
+        full_name=ensureNewFileName(name+".ppm", naming);
+        std::ofstream out(full_name, std::ios::binary);
+
+        out << "P6" << std::endl;
+        out << width << " " << height << std::endl;
+        out << 255 << "\n";
+
+        writeRows(out, p, 3*width, 3*width+px, height);
+
+        out.close();
+      }
+      break;
+
     default: // try to store as color image
       {
+        // conversion of e.g. bayer pattern needs neighboring rows, therefore
+        // the whole image is converted at once
+
         std::unique_ptr<uint8_t []> rgb_pixel(new uint8_t [3*width*height]);
 
-        if (format == RGB8)
+        bool converted;
+
         {
-          p+=(3*width+px)*yoffset;
+          ConvertTimer ct(timing);
+          converted=convertImage(rgb_pixel.get(), 0, p, format, width, height, px,
+            image.isBigEndian());
         }
-        else
+
+        if (converted)
         {
-          p+=(width+px)*yoffset;
-        }
-
-        if (convertImage(rgb_pixel.get(), 0, p, format, width, height, px))
-        {
-          p=rgb_pixel.get();
-
-          full_name=ensureNewFileName(name+".ppm");
+          full_name=ensureNewFileName(name+".ppm", naming);
           std::ofstream out(full_name, std::ios::binary);
 
           out << "P6" << std::endl;
           out << width << " " << height << std::endl;
           out << 255 << "\n";
 
-          std::streambuf *sb=out.rdbuf();
-
-          for (size_t k=0; k<height && out.good(); k++)
-          {
-            for (size_t i=0; i<width; i++)
-            {
-              sb->sputc(static_cast<char>(*p++));
-              sb->sputc(static_cast<char>(*p++));
-              sb->sputc(static_cast<char>(*p++));
-            }
-          }
+          writeRows(out, rgb_pixel.get(), 3*width, 3*width, height);
 
           out.close();
         }
@@ -315,113 +764,97 @@ std::string storeImagePNM(const std::string &name, const Image &image, size_t yo
 
 #ifdef INCLUDE_PNG
 
-std::string storeImagePNG(const std::string &name, const Image &image, size_t yoffset,
-  size_t height)
-{
-  size_t width=image.getWidth();
-  size_t real_height=image.getHeight();
-
-  if (height == 0) height=real_height;
+/**
+  Image rows in the form that is stored in PNG files, i.e. 16 bit values are
+  big endian. The rows point either into the given image or into the internal
+  buffer if a conversion was necessary.
+*/
 
-  yoffset=std::min(yoffset, real_height);
-  height=std::min(height, real_height-yoffset);
+struct PNGRows
+{
+  int depth;
+  int color;
+  size_t bpp;
+  size_t rsize;
+  size_t lstep;
+  const uint8_t *p;
+  std::unique_ptr<uint8_t []> buffer;
+};
 
-  const unsigned char *p=static_cast<const unsigned char *>(image.getPixels());
+/**
+  Prepares the given rows of the image for storing as PNG. False is returned
+  if the pixel format is not supported.
+*/
 
+bool getPNGRows(PNGRows &rows, const ImageView &image)
+{
+  size_t width=image.getWidth();
+  size_t height=image.getHeight();
   size_t px=image.getXPadding();
-
   uint64_t format=image.getPixelFormat();
-  std::string full_name;
+
+  const uint8_t *p=static_cast<const uint8_t *>(image.getPixels());
 
   switch (format)
   {
     case Mono8: // store 8 bit monochrome image
     case Confidence8:
     case Error8:
-      {
-        // open file and init
-
-        full_name=ensureNewFileName(name+".png");
-        FILE *out=fopen(full_name.c_str(), "wb");
-
-        if (!out)
-        {
-          throw new IOException("Cannot store file: "+full_name);
-        }
-
-        png_structp png=png_create_write_struct(PNG_LIBPNG_VER_STRING, 0, 0, 0);
-        png_infop info=png_create_info_struct(png);
-        setjmp(png_jmpbuf(png));
-
-        // write header
-
-        png_init_io(png, out);
-        png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_GRAY,
-          PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
-          PNG_FILTER_TYPE_DEFAULT);
-        png_write_info(png, info);
-
-        // write image body
-
-        p+=(width+px)*yoffset;
-        for (size_t k=0; k<height; k++)
-        {
-          png_write_row(png, const_cast<png_bytep>(p));
-          p+=width+px;
-        }
-
-        // close file
-
-        png_write_end(png, info);
-        fclose(out);
-        png_destroy_write_struct(&png, &info);
-      }
+      rows.depth=8;
+      rows.color=PNG_COLOR_TYPE_GRAY;
+      rows.bpp=1;
+      rows.rsize=width;
+      rows.lstep=width+px;
+      rows.p=p;
       break;
 
     case Mono16:
     case Coord3D_C16: // store 16 bit monochrome image
+      rows.depth=16;
+      rows.color=PNG_COLOR_TYPE_GRAY;
+      rows.bpp=2;
+      rows.rsize=2*width;
+      rows.lstep=2*width+px;
+      rows.p=p;
+
+      if (!image.isBigEndian())
       {
-        // open file and init
-
-        full_name=ensureNewFileName(name+".png");
-        FILE *out=fopen(full_name.c_str(), "wb");
+        rows.buffer.reset(new uint8_t [rows.rsize*height]);
 
-        if (!out)
+        for (size_t k=0; k<height; k++)
         {
-          throw new IOException("Cannot store file: "+full_name);
+          swapBytes16(rows.buffer.get()+k*rows.rsize, rows.p+k*rows.lstep, width);
         }
 
-        png_structp png=png_create_write_struct(PNG_LIBPNG_VER_STRING, 0, 0, 0);
-        png_infop info=png_create_info_struct(png);
-        setjmp(png_jmpbuf(png));
-
-        // write header
-
-        png_init_io(png, out);
-        png_set_IHDR(png, info, width, height, 16, PNG_COLOR_TYPE_GRAY,
-          PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
-          PNG_FILTER_TYPE_DEFAULT);
-        png_write_info(png, info);
+        rows.lstep=rows.rsize;
+        rows.p=rows.buffer.get();
+      }
+      break;
 
-        // write image body
+    case Mono10: // store 10 or 12 bit monochrome image scaled to 16 bit
+    case Mono10p:
+    case Mono10Packed:
+    case Mono12:
+    case Mono12p:
+    case Mono12Packed:
+      {
+        rows.depth=16;
+        rows.color=PNG_COLOR_TYPE_GRAY;
+        rows.bpp=2;
+        rows.rsize=2*width;
+        rows.lstep=rows.rsize;
+        rows.buffer.reset(new uint8_t [rows.rsize*height]);
+        rows.p=rows.buffer.get();
 
-        if (!image.isBigEndian())
-        {
-          png_set_swap(png);
-        }
+        size_t lstep=(width*((format>>16)&0xff)+7)/8+px;
+        std::unique_ptr<uint16_t []> tmp(new uint16_t [width]);
 
-        p+=(2*width+px)*yoffset;
         for (size_t k=0; k<height; k++)
         {
-          png_write_row(png, const_cast<png_bytep>(p));
-          p+=2*width+px;
+          unpackMonoRowBE(rows.buffer.get()+k*rows.rsize, tmp.get(), p, format, width,
+            image.isBigEndian(), true);
+          p+=lstep;
         }
-
-        // close file
-
-        png_write_end(png, info);
-        fclose(out);
-        png_destroy_write_struct(&png, &info);
       }
       break;
 
@@ -429,31 +862,18 @@ std::string storeImagePNG(const std::string &name, const Image &image, size_t yo
     case YCbCr422_8:
     case YUV422_8:
       {
-        // open file and init
-
-        full_name=ensureNewFileName(name+".png");
-        FILE *out=fopen(full_name.c_str(), "wb");
-
-        if (!out)
-        {
-          throw new IOException("Cannot store file: "+full_name);
-        }
-
-        png_structp png=png_create_write_struct(PNG_LIBPNG_VER_STRING, 0, 0, 0);
-        png_infop info=png_create_info_struct(png);
-        setjmp(png_jmpbuf(png));
-
-        // write header
+        rows.depth=8;
+        rows.color=PNG_COLOR_TYPE_RGB;
+        rows.bpp=3;
+        rows.rsize=3*width;
+        rows.lstep=rows.rsize;
 
-        png_init_io(png, out);
-        png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_RGB,
-          PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
-          PNG_FILTER_TYPE_DEFAULT);
-        png_write_info(png, info);
+        // groups of 4 pixels are converted at once, which writes beyond the
+        // last row if the width is not a multiple of 4
 
-        // write image body
-
-        uint8_t *tmp=new uint8_t [3*width];
+        rows.buffer.reset(new uint8_t [rows.rsize*height+
+          3*(((width+3)&~static_cast<size_t>(3))-width)]);
+        rows.p=rows.buffer.get();
 
         size_t pstep;
         if (format == YCbCr411_8)
@@ -465,96 +885,571 @@ std::string storeImagePNG(const std::string &name, const Image &image, size_t yo
           pstep=(width>>2)*8+px;
         }
 
-        p+=pstep*yoffset;
         for (size_t k=0; k<height; k++)
         {
+          uint8_t *t=rows.buffer.get()+k*rows.rsize;
+
           if (format == YCbCr411_8)
           {
             for (size_t i=0; i<width; i+=4)
             {
-              convYCbCr411toQuadRGB(tmp+3*i, p, static_cast<int>(i));
+              convYCbCr411toQuadRGB(t+3*i, p, static_cast<int>(i));
             }
           }
           else
           {
             for (size_t i=0; i<width; i+=4)
             {
-              convYCbCr422toQuadRGB(tmp+3*i, p, static_cast<int>(i));
+              convYCbCr422toQuadRGB(t+3*i, p, static_cast<int>(i));
             }
           }
 
-          png_write_row(png, tmp);
           p+=pstep;
         }
+      }
+      break;
 
-        // close file
+    case RGB8: // store color image directly
+      rows.depth=8;
+      rows.color=PNG_COLOR_TYPE_RGB;
+      rows.bpp=3;
+      rows.rsize=3*width;
+      rows.lstep=3*width+px;
+      rows.p=p;
+      break;
 
-        png_write_end(png, info);
-        fclose(out);
-        png_destroy_write_struct(&png, &info);
+    default: // try to store as color image
+      rows.depth=8;
+      rows.color=PNG_COLOR_TYPE_RGB;
+      rows.bpp=3;
+      rows.rsize=3*width;
+      rows.lstep=rows.rsize;
+      rows.buffer.reset(new uint8_t [rows.rsize*height]);
+      rows.p=rows.buffer.get();
+
+      if (!convertImage(rows.buffer.get(), 0, p, format, width, height, px,
+        image.isBigEndian()))
+      {
+        return false;
       }
       break;
+  }
 
-    default: // try to store as color image
+  return true;
+}
+
+/**
+  Returns the zlib compression level of the given parameters.
+*/
+
+int getPNGLevel(const PNGParameter &param)
+{
+  if (param.level < 0) return Z_DEFAULT_COMPRESSION;
+
+  return std::min(param.level, 9);
+}
+
+/**
+  Writes the rows as PNG with libpng. False is returned in case of an error.
+*/
+
+bool writePNGRows(FILE *out, const PNGRows &rows, size_t width, size_t height,
+  const PNGParameter &param)
+{
+  std::vector<png_bytep> rowp(height);
+  for (size_t k=0; k<height; k++)
+  {
+    rowp[k]=const_cast<png_bytep>(rows.p+k*rows.lstep);
+  }
+
+  int filter=PNG_ALL_FILTERS;
+  switch (param.filter)
+  {
+    case PNG_NONE:
+      filter=PNG_FILTER_NONE;
+      break;
+
+    case PNG_SUB:
+      filter=PNG_FILTER_SUB;
+      break;
+
+    case PNG_UP:
+      filter=PNG_FILTER_UP;
+      break;
+
+    case PNG_AVG:
+      filter=PNG_FILTER_AVG;
+      break;
+
+    case PNG_PAETH:
+      filter=PNG_FILTER_PAETH;
+      break;
+
+    default:
+    case PNG_ADAPTIVE:
+      break;
+  }
+
+  png_structp png=png_create_write_struct(PNG_LIBPNG_VER_STRING, 0, 0, 0);
+  png_infop info=png_create_info_struct(png);
+
+  if (setjmp(png_jmpbuf(png)))
+  {
+    png_destroy_write_struct(&png, &info);
+    return false;
+  }
+
+  // write header
+
+  png_init_io(png, out);
+  png_set_IHDR(png, info, static_cast<png_uint_32>(width), static_cast<png_uint_32>(height),
+    rows.depth, rows.color, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
+    PNG_FILTER_TYPE_DEFAULT);
+  png_set_compression_level(png, getPNGLevel(param));
+  png_set_filter(png, PNG_FILTER_TYPE_BASE, filter);
+  png_write_info(png, info);
+
+  // write image body and close
+
+  png_write_image(png, rowp.data());
+  png_write_end(png, info);
+  png_destroy_write_struct(&png, &info);
+
+  return true;
+}
+
+inline uint8_t paethPredictor(int a, int b, int c)
+{
+  int p=a+b-c;
+  int pa=std::abs(p-a);
+  int pb=std::abs(p-b);
+  int pc=std::abs(p-c);
+
+  if (pa <= pb && pa <= pc) return static_cast<uint8_t>(a);
+  if (pb <= pc) return static_cast<uint8_t>(b);
+
+  return static_cast<uint8_t>(c);
+}
+
+/**
+  Applies the PNG filter of the given type (0 to 4) to one row. The filtered
+  row starts with the type and has rsize+1 bytes. prev must point to a row of
+  zeros for the first image row.
+*/
+
+void filterPNGRow(uint8_t *target, int type, const uint8_t *row, const uint8_t *prev,
+  size_t rsize, size_t bpp)
+{
+  *target++=static_cast<uint8_t>(type);
+
+  switch (type)
+  {
+    default:
+    case 0: // none
+      memcpy(target, row, rsize);
+      break;
+
+    case 1: // sub
+      memcpy(target, row, bpp);
+      for (size_t i=bpp; i<rsize; i++)
       {
-        std::unique_ptr<uint8_t []> rgb_pixel(new uint8_t [3*width*height]);
+        target[i]=static_cast<uint8_t>(row[i]-row[i-bpp]);
+      }
+      break;
 
-        if (format == RGB8)
-        {
-          p+=(3*width+px)*yoffset;
-        }
-        else
-        {
-          p+=(width+px)*yoffset;
-        }
+    case 2: // up
+      for (size_t i=0; i<rsize; i++)
+      {
+        target[i]=static_cast<uint8_t>(row[i]-prev[i]);
+      }
+      break;
 
-        if (convertImage(rgb_pixel.get(), 0, p, format, width, height, px))
-        {
-          p=rgb_pixel.get();
+    case 3: // average
+      for (size_t i=0; i<bpp; i++)
+      {
+        target[i]=static_cast<uint8_t>(row[i]-(prev[i]>>1));
+      }
 
-          // open file and init
+      for (size_t i=bpp; i<rsize; i++)
+      {
+        target[i]=static_cast<uint8_t>(row[i]-((row[i-bpp]+prev[i])>>1));
+      }
+      break;
 
-          full_name=ensureNewFileName(name+".png");
-          FILE *out=fopen(full_name.c_str(), "wb");
+    case 4: // paeth
+      for (size_t i=0; i<bpp; i++)
+      {
+        target[i]=static_cast<uint8_t>(row[i]-prev[i]);
+      }
 
-          if (!out)
-          {
-            throw new IOException("Cannot store file: "+full_name);
-          }
+      for (size_t i=bpp; i<rsize; i++)
+      {
+        target[i]=static_cast<uint8_t>(row[i]-paethPredictor(row[i-bpp], prev[i],
+          prev[i-bpp]));
+      }
+      break;
+  }
+}
 
-          png_structp png=png_create_write_struct(PNG_LIBPNG_VER_STRING, 0, 0, 0);
-          png_infop info=png_create_info_struct(png);
-          setjmp(png_jmpbuf(png));
+/**
+  Filters the image rows k0 to k1-1. Adaptive filtering chooses the filter
+  with the minimum sum of absolute values as signed bytes, like libpng.
+*/
 
-          // write header
+void filterPNGRows(uint8_t *target, const PNGRows &rows, size_t k0, size_t k1,
+  PNGFilter filter)
+{
+  const size_t fsize=rows.rsize+1;
 
-          png_init_io(png, out);
-          png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_RGB,
-            PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
-            PNG_FILTER_TYPE_DEFAULT);
-          png_write_info(png, info);
+  std::vector<uint8_t> zero(rows.rsize, 0);
+  std::vector<uint8_t> tmp;
 
-          // write image body
+  if (filter == PNG_ADAPTIVE)
+  {
+    tmp.resize(fsize);
+  }
 
-          for (size_t k=0; k<height; k++)
-          {
-            png_write_row(png, p);
-            p+=3*width;
-          }
+  for (size_t k=k0; k<k1; k++)
+  {
+    const uint8_t *row=rows.p+k*rows.lstep;
+    const uint8_t *prev=zero.data();
+    uint8_t *t=target+k*fsize;
 
-          // close file
+    if (k > 0)
+    {
+      prev=row-rows.lstep;
+    }
+
+    if (filter == PNG_ADAPTIVE)
+    {
+      uint64_t best=std::numeric_limits<uint64_t>::max();
+      for (int type=0; type<5; type++)
+      {
+        filterPNGRow(tmp.data(), type, row, prev, rows.rsize, rows.bpp);
 
-          png_write_end(png, info);
-          fclose(out);
-          png_destroy_write_struct(&png, &info);
+        uint64_t sum=0;
+        for (size_t i=1; i<fsize; i++)
+        {
+          sum+=tmp[i] < 128 ? tmp[i] : 256-tmp[i];
         }
-        else
+
+        if (sum < best)
         {
-          throw IOException(std::string("storeImage(): Unsupported pixel format: ")+
-            GetPixelFormatName(static_cast<PfncFormat>(image.getPixelFormat())));
+          best=sum;
+          memcpy(t, tmp.data(), fsize);
         }
       }
+    }
+    else
+    {
+      filterPNGRow(t, static_cast<int>(filter), row, prev, rows.rsize, rows.bpp);
+    }
+  }
+}
+
+/**
+  Horizontal strip of an image that is compressed independently.
+*/
+
+struct PNGStrip
+{
+  PNGStrip() : k0(0), k1(0), adler(0), ok(false) { }
+
+  size_t k0, k1;
+  std::vector<uint8_t> data;
+  uLong adler;
+  bool ok;
+};
+
+/**
+  Compresses the filtered rows of the strip as raw deflate stream. The end of
+  the preceding strip is used as dictionary so that the compression ratio is
+  about the same as for compressing the whole image at once. All strips except
+  the last one end with a sync flush, which aligns the output to bytes and
+  leaves the stream open, so that the compressed strips can be concatenated.
+*/
+
+void deflatePNGStrip(PNGStrip &strip, const uint8_t *filtered, size_t fsize, int level,
+  int strategy, bool last)
+{
+  const uint8_t *p=filtered+strip.k0*fsize;
+  size_t n=(strip.k1-strip.k0)*fsize;
+
+  z_stream strm;
+  strm.zalloc=Z_NULL;
+  strm.zfree=Z_NULL;
+  strm.opaque=Z_NULL;
+
+  if (deflateInit2(&strm, level, Z_DEFLATED, -15, 8, strategy) != Z_OK)
+  {
+    return;
+  }
+
+  size_t dict=std::min(strip.k0*fsize, static_cast<size_t>(32768));
+  if (dict > 0)
+  {
+    deflateSetDictionary(&strm, p-dict, static_cast<uInt>(dict));
+  }
+
+  strip.data.resize(deflateBound(&strm, static_cast<uLong>(n))+16);
+
+  strm.next_in=const_cast<Bytef *>(p);
+  strm.avail_in=static_cast<uInt>(n);
+  strm.next_out=strip.data.data();
+  strm.avail_out=static_cast<uInt>(strip.data.size());
+
+  int flush=last ? Z_FINISH : Z_SYNC_FLUSH;
+
+  strip.ok=true;
+  while (strip.ok)
+  {
+    if (strm.avail_out == 0)
+    {
+      size_t used=strip.data.size();
+      strip.data.resize(2*used);
+      strm.next_out=strip.data.data()+used;
+      strm.avail_out=static_cast<uInt>(used);
+    }
+
+    int ret=deflate(&strm, flush);
+
+    if (ret == Z_STREAM_ERROR)
+    {
+      strip.ok=false;
+    }
+    else if ((last && ret == Z_STREAM_END) || (!last && strm.avail_out != 0))
+    {
       break;
+    }
+  }
+
+  strip.data.resize(strip.data.size()-strm.avail_out);
+  deflateEnd(&strm);
+
+  strip.adler=adler32(adler32(0, Z_NULL, 0), p, static_cast<uInt>(n));
+}
+
+/**
+  Calls fn(i) for i from 0 to n-1 in parallel. Index 0 is processed by the
+  calling thread. fn must not throw.
+*/
+
+template<class F> void runParallel(size_t n, F fn)
+{
+  std::vector<std::thread> thread;
+  thread.reserve(n);
+
+  for (size_t i=1; i<n; i++)
+  {
+    try
+    {
+      thread.push_back(std::thread(fn, i));
+    }
+    catch (const std::system_error &)
+    {
+      fn(i);
+    }
+  }
+
+  fn(0);
+
+  for (size_t i=0; i<thread.size(); i++)
+  {
+    thread[i].join();
+  }
+}
+
+inline void putUInt32BE(uint8_t *p, uint32_t v)
+{
+  p[0]=static_cast<uint8_t>(v>>24);
+  p[1]=static_cast<uint8_t>(v>>16);
+  p[2]=static_cast<uint8_t>(v>>8);
+  p[3]=static_cast<uint8_t>(v);
+}
+
+void writePNGChunk(std::ostream &out, const char *type, const uint8_t *data, size_t n)
+{
+  uint8_t tmp[4];
+  putUInt32BE(tmp, static_cast<uint32_t>(n));
+  out.write(reinterpret_cast<const char *>(tmp), 4);
+  out.write(type, 4);
+  out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(n));
+
+  uLong crc=crc32(0, Z_NULL, 0);
+  crc=crc32(crc, reinterpret_cast<const Bytef *>(type), 4);
+
+  if (n > 0)
+  {
+    crc=crc32(crc, data, static_cast<uInt>(n));
+  }
+
+  putUInt32BE(tmp, static_cast<uint32_t>(crc));
+  out.write(reinterpret_cast<const char *>(tmp), 4);
+}
+
+/**
+  Writes the rows as PNG by filtering and compressing horizontal strips in
+  parallel, similar to pigz. The compressed strips are stitched together into
+  one zlib stream, which is stored in one IDAT chunk per strip. False is
+  returned in case of an error.
+*/
+
+bool writePNGRowsParallel(std::ostream &out, const PNGRows &rows, size_t width,
+  size_t height, const PNGParameter &param)
+{
+  const size_t fsize=rows.rsize+1;
+  std::unique_ptr<uint8_t []> filtered(new uint8_t [fsize*height]);
+
+  std::vector<PNGStrip> strip(std::min(static_cast<size_t>(param.threads), height));
+  for (size_t i=0; i<strip.size(); i++)
+  {
+    strip[i].k0=height*i/strip.size();
+    strip[i].k1=height*(i+1)/strip.size();
+  }
+
+  // filter all strips before compression, since compression of each strip
+  // needs the end of the preceding strip
+
+  runParallel(strip.size(), [&](size_t i)
+  {
+    try
+    {
+      filterPNGRows(filtered.get(), rows, strip[i].k0, strip[i].k1, param.filter);
+      strip[i].ok=true;
+    }
+    catch (...)
+    {
+      strip[i].ok=false;
+    }
+  });
+
+  for (size_t i=0; i<strip.size(); i++)
+  {
+    if (!strip[i].ok) return false;
+  }
+
+  int level=getPNGLevel(param);
+  int strategy=param.filter == PNG_NONE ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+
+  runParallel(strip.size(), [&](size_t i)
+  {
+    try
+    {
+      deflatePNGStrip(strip[i], filtered.get(), fsize, level, strategy, i+1 == strip.size());
+    }
+    catch (...)
+    {
+      strip[i].ok=false;
+    }
+  });
+
+  uLong adler=strip[0].adler;
+  for (size_t i=0; i<strip.size(); i++)
+  {
+    if (!strip[i].ok) return false;
+
+    if (i > 0)
+    {
+      adler=adler32_combine(adler, strip[i].adler,
+        static_cast<z_off_t>((strip[i].k1-strip[i].k0)*fsize));
+    }
+  }
+
+  // write signature and header
+
+  static const uint8_t signature[8]={137, 80, 78, 71, 13, 10, 26, 10};
+  out.write(reinterpret_cast<const char *>(signature), 8);
+
+  uint8_t ihdr[13];
+  putUInt32BE(ihdr, static_cast<uint32_t>(width));
+  putUInt32BE(ihdr+4, static_cast<uint32_t>(height));
+  ihdr[8]=static_cast<uint8_t>(rows.depth);
+  ihdr[9]=static_cast<uint8_t>(rows.color);
+  ihdr[10]=0;
+  ihdr[11]=0;
+  ihdr[12]=0;
+  writePNGChunk(out, "IHDR", ihdr, sizeof(ihdr));
+
+  // write zlib header with 32K window and compression level hint, the
+  // compressed strips and the adler32 checksum of the uncompressed data
+
+  uint8_t zhdr[2];
+  zhdr[0]=0x78;
+  zhdr[1]=0;
+
+  if (level == Z_DEFAULT_COMPRESSION || level == 6) zhdr[1]=2<<6;
+  else if (level >= 7) zhdr[1]=3<<6;
+  else if (level >= 2) zhdr[1]=1<<6;
+
+  zhdr[1]|=static_cast<uint8_t>(31-((zhdr[0]*256+zhdr[1])%31));
+
+  writePNGChunk(out, "IDAT", zhdr, sizeof(zhdr));
+
+  for (size_t i=0; i<strip.size(); i++)
+  {
+    writePNGChunk(out, "IDAT", strip[i].data.data(), strip[i].data.size());
+  }
+
+  uint8_t ztrl[4];
+  putUInt32BE(ztrl, static_cast<uint32_t>(adler));
+  writePNGChunk(out, "IDAT", ztrl, sizeof(ztrl));
+
+  writePNGChunk(out, "IEND", 0, 0);
+
+  return out.good();
+}
+
+std::string storeImagePNG(const std::string &name, const ImageView &image,
+  const PNGParameter &param, FileNaming naming, StoreTiming *timing)
+{
+  size_t width=image.getWidth();
+  size_t height=image.getHeight();
+
+  PNGRows rows;
+  bool supported;
+
+  {
+    ConvertTimer ct(timing);
+    supported=getPNGRows(rows, image);
+  }
+
+  if (!supported)
+  {
+    throw IOException(std::string("storeImage(): Unsupported pixel format: ")+
+      GetPixelFormatName(static_cast<PfncFormat>(image.getPixelFormat())));
+  }
+
+  std::string full_name=ensureNewFileName(name+".png", naming);
+  bool ok;
+
+  if (param.threads > 1 && height > 1)
+  {
+    std::ofstream out(full_name, std::ios::binary);
+
+    if (!out.is_open())
+    {
+      throw IOException("Cannot store file: "+full_name);
+    }
+
+    ok=writePNGRowsParallel(out, rows, width, height, param);
+    out.close();
+  }
+  else
+  {
+    FILE *out=fopen(full_name.c_str(), "wb");
+
+    if (!out)
+    {
+      throw IOException("Cannot store file: "+full_name);
+    }
+
+    ok=writePNGRows(out, rows, width, height, param);
+    ok=(fclose(out) == 0) && ok;
+  }
+
+  if (!ok)
+  {
+    throw IOException("Cannot store file: "+full_name);
   }
 
   return full_name;
@@ -565,7 +1460,21 @@ std::string storeImagePNG(const std::string &name, const Image &image, size_t yo
 }
 
 std::string storeImage(const std::string &name, ImgFmt fmt, const Image &image,
-  size_t yoffset, size_t height)
+  size_t yoffset, size_t height, const PNGParameter &png_param, FileNaming naming)
+{
+  size_t real_height=image.getHeight();
+
+  if (height == 0) height=real_height;
+
+  yoffset=std::min(yoffset, real_height);
+  height=std::min(height, real_height-yoffset);
+
+  return storeImage(name, fmt, ImageView(image).getROI(0, yoffset, image.getWidth(), height),
+    png_param, naming);
+}
+
+std::string storeImage(const std::string &name, ImgFmt fmt, const ImageView &image,
+  const PNGParameter &png_param, FileNaming naming, StoreTiming *timing)
 {
   std::string ret;
 
@@ -573,23 +1482,64 @@ std::string storeImage(const std::string &name, ImgFmt fmt, const Image &image,
   {
     case PNG:
 #ifdef INCLUDE_PNG
-      ret=storeImagePNG(name, image, yoffset, height);
+      ret=storeImagePNG(name, image, png_param, naming, timing);
 #else
       throw IOException("storeImage(): Support for PNG image file format is not compiled in!");
 #endif
       break;
 
+    case RCL:
+      {
+        std::vector<uint8_t> data;
+        encodeImage(data, image);
+
+        ret=ensureNewFileName(name+".rcl", naming);
+        std::ofstream out(ret, std::ios::binary);
+
+        out.write(reinterpret_cast<const char *>(data.data()),
+          static_cast<std::streamsize>(data.size()));
+        out.close();
+
+        if (!out)
+        {
+          throw IOException("Cannot store file: "+ret);
+        }
+      }
+      break;
+
     default:
     case PNM:
-      ret=storeImagePNM(name, image, yoffset, height);
+      ret=storeImagePNM(name, image, naming, timing);
       break;
   }
 
   return ret;
 }
 
+std::shared_ptr<Image> loadImage(const std::string &name)
+{
+  std::ifstream in(name, std::ios::binary);
+
+  if (!in)
+  {
+    throw IOException("Cannot load file: "+name);
+  }
+
+  in.seekg(0, std::ios::end);
+  std::vector<uint8_t> data(static_cast<size_t>(in.tellg()));
+  in.seekg(0, std::ios::beg);
+  in.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+
+  if (!in)
+  {
+    throw IOException("Cannot load file: "+name);
+  }
+
+  return decodeImage(data.data(), data.size());
+}
+
 std::string storeImageAsDisparityPFM(const std::string &name, const Image &image, int inv,
-  float scale, float offset)
+  float scale, float offset, FileNaming naming, StoreTiming *timing)
 {
   if (image.getPixelFormat() != Coord3D_C16)
   {
@@ -607,19 +1557,17 @@ std::string storeImageAsDisparityPFM(const std::string &name, const Image &image
   size_t px=image.getXPadding();
   size_t width=image.getWidth();
   size_t height=image.getHeight();
-  const unsigned char *p=static_cast<const unsigned char *>(image.getPixels())+
-    2*(width+px)*(height+1);
+  size_t lstep=2*width+px;
 
-  std::string full_name=ensureNewFileName(name+".pfm");
+  std::string full_name=ensureNewFileName(name+".pfm", naming);
   std::ofstream out(full_name, std::ios::binary);
 
   out << "Pf" << std::endl;
   out << width << " " << height << std::endl;
   out << 1 << "\n";
 
-  std::streambuf *sb=out.rdbuf();
-
-  // get 16 bit data, scale and add offset and store as big endian
+  // get 16 bit data, scale and add offset and store as big endian, starting
+  // with the last row
 
   bool msbfirst=true;
 
@@ -629,53 +1577,81 @@ std::string storeImageAsDisparityPFM(const std::string &name, const Image &image
     msbfirst=(cc[0] != 1);
   }
 
+  std::unique_ptr<uint8_t []> row(new uint8_t [4*width]);
+
   for (size_t k=0; k<height && out.good(); k++)
   {
-    p-=(width+px)<<2;
-    for (size_t i=0; i<width; i++)
+    const uint8_t *p=image.getPixels()+lstep*(height-1-k);
+
     {
-      int val;
-      if (image.isBigEndian())
-      {
-        val=(static_cast<int>(p[0])<<8)|p[1];
-      }
-      else
-      {
-        val=(static_cast<int>(p[1])<<8)|p[0];
-      }
+      ConvertTimer ct(timing);
+      convertDisparityRow(row.get(), p, width, image.isBigEndian(), !msbfirst, inv, scale, offset);
+    }
 
-      p+=2;
+    out.write(reinterpret_cast<const char *>(row.get()), static_cast<std::streamsize>(4*width));
+  }
 
-      float d=std::numeric_limits<float>::infinity();
-      if (val != inv)
-      {
-        d=static_cast<float>(val*scale+offset);
-      }
+  out.close();
 
-      char *c=reinterpret_cast<char *>(&d);
+  return full_name;
+}
 
-      if (msbfirst)
-      {
-        sb->sputc(c[0]);
-        sb->sputc(c[1]);
-        sb->sputc(c[2]);
-        sb->sputc(c[3]);
-      }
-      else
-      {
-        sb->sputc(c[3]);
-        sb->sputc(c[2]);
-        sb->sputc(c[1]);
-        sb->sputc(c[0]);
-      }
+std::string storeImageAsDepth(const std::string &name, ImgFmt fmt, const ImageView &disp,
+  const DepthParameter &param, const ImageView &conf, const PNGParameter &png_param,
+  FileNaming naming, StoreTiming *timing)
+{
+  const size_t width=disp.getWidth();
+  const size_t height=disp.getHeight();
+
+  bool msbfirst=true;
 
-      p+=px;
+  {
+    int pp=1;
+    char *cc=reinterpret_cast<char *>(&pp);
+    msbfirst=(cc[0] != 1);
+  }
+
+  if (fmt == PNM)
+  {
+    std::vector<float> depth(width*height);
+
+    {
+      ConvertTimer ct(timing);
+      disparityToDepth(depth.data(), disp, param, conf);
     }
+
+    // store in host byte order, which is given by the sign of the scale,
+    // starting with the last row
+
+    std::string full_name=ensureNewFileName(name+".pfm", naming);
+    std::ofstream out(full_name, std::ios::binary);
+
+    out << "Pf" << std::endl;
+    out << width << " " << height << std::endl;
+    out << (msbfirst ? 1 : -1) << "\n";
+
+    for (size_t k=0; k<height && out.good(); k++)
+    {
+      out.write(reinterpret_cast<const char *>(depth.data()+(height-1-k)*width),
+        static_cast<std::streamsize>(4*width));
+    }
+
+    out.close();
+
+    return full_name;
   }
 
-  out.close();
+  std::vector<uint16_t> depth(width*height);
 
-  return full_name;
+  {
+    ConvertTimer ct(timing);
+    disparityToDepth(depth.data(), disp, param, conf);
+  }
+
+  ImageView view(reinterpret_cast<const uint8_t *>(depth.data()), width, height, 2*width, Mono16,
+    msbfirst, disp.getTimestampNS(), disp.getFrameID());
+
+  return storeImage(name, fmt, view, png_param, naming, timing);
 }
 
 }
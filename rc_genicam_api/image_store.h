@@ -37,20 +37,153 @@
 #define RC_GENICAM_API_IMAGE_STORE
 
 #include "image.h"
+#include "pointcloud.h"
 
 #include <string>
+#include <memory>
+#include <mutex>
 
 namespace rcg
 {
 
-enum ImgFmt { PNM, PNG };
+/**
+  Image file formats. RCL is a fast lossless compression of the image with
+  encodeImage() of image_codec.h, which can be loaded with loadImage().
+*/
+
+enum ImgFmt { PNM, PNG, RCL };
+
+/**
+  Row filter that is applied before compressing images in PNG format. The
+  values PNG_NONE to PNG_PAETH correspond to the filter types of the PNG
+  specification. PNG_ADAPTIVE chooses the best filter for every row.
+*/
+
+enum PNGFilter { PNG_NONE, PNG_SUB, PNG_UP, PNG_AVG, PNG_PAETH, PNG_ADAPTIVE };
+
+/**
+  Parameters for storing images in PNG format. The defaults correspond to the
+  defaults of libpng.
+*/
+
+struct PNGParameter
+{
+  PNGParameter() : level(-1), filter(PNG_ADAPTIVE), threads(1) { }
+
+  int level;        // zlib compression level from 0 (none) to 9 (best), -1 for default
+  PNGFilter filter; // row filter
+  int threads;      // number of threads for compressing horizontal strips in parallel
+};
+
+/**
+  Strategies for ensuring that no existing file is overwritten. NAME_PROBE
+  checks if the file exists and appends a number to the name until an unused
+  name is found. NAME_UNIQUE does not check anything, because the name is
+  known to be unique, e.g. if it is created by FileNameGenerator.
+  NAME_EXCLUSIVE atomically creates the file if it does not exist and fails
+  otherwise.
+*/
+
+enum FileNaming { NAME_PROBE, NAME_UNIQUE, NAME_EXCLUSIVE };
+
+/**
+  Optional timing of storing an image, e.g. for benchmarking. The time for
+  converting pixels into the layout of the file format is added to
+  convert_ms. For conversions that are done row by row while writing, the
+  time is summed over all rows. Compression and writing are not included.
+*/
+
+struct StoreTiming
+{
+  StoreTiming() : convert_ms(0) { }
+
+  double convert_ms; // time for converting pixels in milliseconds
+};
 
 /**
   This method checks if the given file name already exists and produces a new
   file name if this happens.
+
+  NOTE: An exception that is based on std::exception is thrown if the file
+  cannot be created in mode NAME_EXCLUSIVE.
+
+  @param name   Name of file including suffix.
+  @param naming Strategy for ensuring that no existing file is overwritten.
+  @return       Name of file that can be used for storing.
 */
 
-std::string ensureNewFileName(std::string name);
+std::string ensureNewFileName(std::string name, FileNaming naming=NAME_PROBE);
+
+/**
+  Creates unique file names for storing many files at high rates without
+  checking for existing files. All names of one generator start with a
+  session ID that is randomly chosen on construction, followed by a counter,
+  i.e. <dir>/[<subdir>/]<session>-<counter>_<base>. The names can be used
+  with NAME_UNIQUE or NAME_EXCLUSIVE if uniqueness should be guaranteed.
+
+  Files can be distributed into subdirectories, because lookups in
+  directories with a large number of files become slow on many file systems.
+  Subdirectories are either numbered with a fixed number of files per
+  subdirectory or named by the timestamp in seconds with a fixed time span
+  per subdirectory.
+
+  The generator is thread safe.
+*/
+
+class FileNameGenerator
+{
+  public:
+
+    /**
+      Creates the given directory if it does not exist.
+
+      NOTE: An exception that is based on std::exception is thrown if the
+      directory cannot be created.
+
+      @param dir             Directory for all files.
+      @param files_per_dir   Number of files per subdirectory or 0.
+      @param seconds_per_dir Time span in seconds per subdirectory or 0. This
+                             is only used if files_per_dir is 0.
+    */
+
+    FileNameGenerator(const std::string &dir, size_t files_per_dir=0,
+      uint64_t seconds_per_dir=0);
+
+    /**
+      Returns a new unique file name and creates the subdirectory if needed.
+
+      NOTE: An exception that is based on std::exception is thrown if the
+      subdirectory cannot be created.
+
+      @param base      Base name, e.g. without suffix.
+      @param timestamp Timestamp in nanoseconds, which is used for time based
+                       subdirectories. The current time is used if it is 0.
+      @return          File name.
+    */
+
+    std::string getName(const std::string &base, uint64_t timestamp=0);
+
+    /**
+      Returns the session ID.
+
+      @return Session ID.
+    */
+
+    const std::string &getSession() const { return session; }
+
+  private:
+
+    FileNameGenerator(const FileNameGenerator &); // forbidden
+    FileNameGenerator &operator=(const FileNameGenerator &); // forbidden
+
+    std::mutex mtx;
+    std::string dir;
+    size_t files_per_dir;
+    uint64_t seconds_per_dir;
+    std::string session;
+    uint64_t counter;
+    std::string subdir;
+};
 
 /**
   Stores the given image.
@@ -63,10 +196,49 @@ std::string ensureNewFileName(std::string name);
   @param image   Image to be stored.
   @param yoffset First image row to be stored.
   @param height  Number of image rows to be stored. 0 means all rows.
+  @param png_param Compression parameters, which are only used for PNG. With
+                 more than one thread, the image is split into horizontal
+                 strips that are filtered and compressed in parallel and
+                 stitched together into one valid PNG file.
+  @param naming  Strategy for ensuring that no existing file is overwritten.
+  @return        Name of stored file.
 */
 
 std::string storeImage(const std::string &name, ImgFmt fmt, const Image &image,
-  size_t yoffset=0, size_t height=0);
+  size_t yoffset=0, size_t height=0, const PNGParameter &png_param=PNGParameter(),
+  FileNaming naming=NAME_PROBE);
+
+/**
+  Stores a view onto an image, e.g. a region of interest, without copying
+  the image before.
+
+  NOTE: An exception that is based on std::exception is thrown in case of an
+  error, e.g. if input or output format is not supported.
+
+  @param name      Name of output file without suffix.
+  @param fmt       Image file format.
+  @param image     View onto the image to be stored.
+  @param png_param Compression parameters, which are only used for PNG.
+  @param naming    Strategy for ensuring that no existing file is overwritten.
+  @param timing    Optional timing, to which the conversion time is added.
+  @return          Name of stored file.
+*/
+
+std::string storeImage(const std::string &name, ImgFmt fmt, const ImageView &image,
+  const PNGParameter &png_param=PNGParameter(), FileNaming naming=NAME_PROBE,
+  StoreTiming *timing=0);
+
+/**
+  Loads an image that has been stored in RCL format.
+
+  NOTE: An exception that is based on std::exception is thrown in case of an
+  error, e.g. if the file cannot be read or has a different format.
+
+  @param name Name of input file including suffix.
+  @return     Loaded image.
+*/
+
+std::shared_ptr<Image> loadImage(const std::string &name);
 
 /**
   Stores the given image as disparity. The image format must be Coord3D_C16.
@@ -79,10 +251,39 @@ std::string storeImage(const std::string &name, ImgFmt fmt, const Image &image,
   @param inv    Value to mark invalid pixels.
   @param scale  Scale factor for valid values.
   @param offset Offset for valid values.
+  @param naming Strategy for ensuring that no existing file is overwritten.
+  @param timing Optional timing, to which the conversion time is added.
+  @return       Name of stored file.
 */
 
 std::string storeImageAsDisparityPFM(const std::string &name, const Image &image,
-  int inv, float scale, float offset);
+  int inv, float scale, float offset, FileNaming naming=NAME_PROBE, StoreTiming *timing=0);
+
+/**
+  Converts the given disparity image into depth with disparityToDepth() and
+  stores it. The depth is stored in meters as PFM for the format PNM, with
+  NaN for invalid pixels. For the formats PNG and RCL, the depth is stored in
+  millimeters as Mono16 image, with 0 for invalid pixels.
+
+  NOTE: An exception that is based on std::exception is thrown in case of an
+  error, e.g. if the disparity image is not in format Coord3D_C16.
+
+  @param name      Name of output file without suffix.
+  @param fmt       Image file format.
+  @param disp      Disparity image in format Coord3D_C16.
+  @param param     Parameters for computing depth.
+  @param conf      Optional confidence image in format Confidence8.
+  @param png_param Compression parameters, which are only used for PNG.
+  @param naming    Strategy for ensuring that no existing file is overwritten.
+  @param timing    Optional timing, to which the time for computing depth and
+                   converting it is added.
+  @return          Name of stored file.
+*/
+
+std::string storeImageAsDepth(const std::string &name, ImgFmt fmt, const ImageView &disp,
+  const DepthParameter &param, const ImageView &conf=ImageView(),
+  const PNGParameter &png_param=PNGParameter(), FileNaming naming=NAME_PROBE,
+  StoreTiming *timing=0);
 
 }
 
@@ -0,0 +1,344 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RC_GENICAM_API_PIXEL_TRAITS
+#define RC_GENICAM_API_PIXEL_TRAITS
+
+#include "pixel_formats.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rcg
+{
+
+/**
+  Packing of pixels with more than 8 bit.
+*/
+
+enum PixelPacking
+{
+  PIXEL_UNPACKED, // one or two bytes per value
+  PIXEL_PACKED_PFNC, // little endian bit stream, e.g. Mono12p
+  PIXEL_PACKED_GVSP // 8 most significant bits of two pixels in first and
+                    // third byte and remaining bits in second byte, e.g.
+                    // Mono12Packed
+};
+
+/**
+  Compile time properties of pixel formats with one value per pixel, i.e.
+  monochrome, bayer pattern and 3D formats. Kernels that are templated on
+  the traits are dispatched once per image with dispatchPixelFormat(), so
+  that their inner loops are free of branches for the pixel format or the
+  endianness.
+
+  All traits provide:
+
+  value_type     uint8_t or uint16_t.
+  bits_per_pixel Number of bits that a pixel occupies in the row.
+  bits           Number of significant bits of a pixel.
+  channels       Number of values per pixel.
+  packing        PixelPacking.
+  bigendian      True if unpacked 16 bit values are big endian.
+  getRowSize()   Number of bytes of a row without padding.
+  get()          Value of the i-th pixel of a row in host byte order.
+
+  The template is only defined for supported pixel formats.
+*/
+
+template<uint64_t format, bool bigendian=false> struct PixelTraits;
+
+/**
+  Traits of formats with 8 bit per value.
+*/
+
+template<int _channels> struct PixelTraits8
+{
+  typedef uint8_t value_type;
+
+  static const int bits_per_pixel=8*_channels;
+  static const int bits=8;
+  static const int channels=_channels;
+  static const PixelPacking packing=PIXEL_UNPACKED;
+  static const bool bigendian=false;
+
+  static size_t getRowSize(size_t width)
+  {
+    return width*_channels;
+  }
+
+  static uint8_t get(const uint8_t *row, size_t i)
+  {
+    return row[i];
+  }
+};
+
+/**
+  Traits of unpacked formats with 16 bit per value, of which _bits are
+  significant.
+*/
+
+template<int _bits, bool _bigendian> struct PixelTraits16
+{
+  typedef uint16_t value_type;
+
+  static const int bits_per_pixel=16;
+  static const int bits=_bits;
+  static const int channels=1;
+  static const PixelPacking packing=PIXEL_UNPACKED;
+  static const bool bigendian=_bigendian;
+
+  static size_t getRowSize(size_t width)
+  {
+    return 2*width;
+  }
+
+  static uint16_t get(const uint8_t *row, size_t i)
+  {
+    row+=2*i;
+
+    if (_bigendian)
+    {
+      return static_cast<uint16_t>((row[0]<<8)|row[1]);
+    }
+
+    return static_cast<uint16_t>((row[1]<<8)|row[0]);
+  }
+};
+
+/**
+  Traits of PFNC packed formats with 10 or 12 bit, which are a little endian
+  bit stream.
+*/
+
+template<int _bits> struct PixelTraitsPFNC
+{
+  typedef uint16_t value_type;
+
+  static const int bits_per_pixel=_bits;
+  static const int bits=_bits;
+  static const int channels=1;
+  static const PixelPacking packing=PIXEL_PACKED_PFNC;
+  static const bool bigendian=false;
+
+  static size_t getRowSize(size_t width)
+  {
+    return (width*_bits+7)/8;
+  }
+
+  static uint16_t get(const uint8_t *row, size_t i)
+  {
+    // a pixel with 10 or 12 bit is always contained in two bytes
+
+    const size_t b=i*_bits;
+    row+=b>>3;
+
+    return static_cast<uint16_t>((((row[1]<<8)|row[0])>>(b&7))&((1<<_bits)-1));
+  }
+};
+
+/**
+  Traits of GigE Vision packed formats with 10 or 12 bit, which store two
+  pixels in three bytes.
+*/
+
+template<int _bits> struct PixelTraitsGVSP
+{
+  typedef uint16_t value_type;
+
+  static const int bits_per_pixel=12;
+  static const int bits=_bits;
+  static const int channels=1;
+  static const PixelPacking packing=PIXEL_PACKED_GVSP;
+  static const bool bigendian=false;
+
+  static size_t getRowSize(size_t width)
+  {
+    return (width*12+7)/8;
+  }
+
+  static uint16_t get(const uint8_t *row, size_t i)
+  {
+    const int low=_bits-8;
+    row+=3*(i>>1);
+
+    if (i & 1)
+    {
+      return static_cast<uint16_t>((row[2]<<low)|((row[1]>>4)&((1<<low)-1)));
+    }
+
+    return static_cast<uint16_t>((row[0]<<low)|(row[1]&((1<<low)-1)));
+  }
+};
+
+template<bool e> struct PixelTraits<Mono8, e> : PixelTraits8<1> { };
+template<bool e> struct PixelTraits<Confidence8, e> : PixelTraits8<1> { };
+template<bool e> struct PixelTraits<Error8, e> : PixelTraits8<1> { };
+template<bool e> struct PixelTraits<BayerRG8, e> : PixelTraits8<1> { };
+template<bool e> struct PixelTraits<BayerBG8, e> : PixelTraits8<1> { };
+template<bool e> struct PixelTraits<BayerGR8, e> : PixelTraits8<1> { };
+template<bool e> struct PixelTraits<BayerGB8, e> : PixelTraits8<1> { };
+template<bool e> struct PixelTraits<RGB8, e> : PixelTraits8<3> { };
+
+template<bool e> struct PixelTraits<Mono10, e> : PixelTraits16<10, e> { };
+template<bool e> struct PixelTraits<Mono12, e> : PixelTraits16<12, e> { };
+template<bool e> struct PixelTraits<Mono16, e> : PixelTraits16<16, e> { };
+template<bool e> struct PixelTraits<Coord3D_C16, e> : PixelTraits16<16, e> { };
+template<bool e> struct PixelTraits<BayerRG10, e> : PixelTraits16<10, e> { };
+template<bool e> struct PixelTraits<BayerBG10, e> : PixelTraits16<10, e> { };
+template<bool e> struct PixelTraits<BayerGR10, e> : PixelTraits16<10, e> { };
+template<bool e> struct PixelTraits<BayerGB10, e> : PixelTraits16<10, e> { };
+template<bool e> struct PixelTraits<BayerRG12, e> : PixelTraits16<12, e> { };
+template<bool e> struct PixelTraits<BayerBG12, e> : PixelTraits16<12, e> { };
+template<bool e> struct PixelTraits<BayerGR12, e> : PixelTraits16<12, e> { };
+template<bool e> struct PixelTraits<BayerGB12, e> : PixelTraits16<12, e> { };
+template<bool e> struct PixelTraits<BayerRG16, e> : PixelTraits16<16, e> { };
+template<bool e> struct PixelTraits<BayerBG16, e> : PixelTraits16<16, e> { };
+template<bool e> struct PixelTraits<BayerGR16, e> : PixelTraits16<16, e> { };
+template<bool e> struct PixelTraits<BayerGB16, e> : PixelTraits16<16, e> { };
+
+template<bool e> struct PixelTraits<Mono10p, e> : PixelTraitsPFNC<10> { };
+template<bool e> struct PixelTraits<Mono12p, e> : PixelTraitsPFNC<12> { };
+template<bool e> struct PixelTraits<BayerRG10p, e> : PixelTraitsPFNC<10> { };
+template<bool e> struct PixelTraits<BayerBG10p, e> : PixelTraitsPFNC<10> { };
+template<bool e> struct PixelTraits<BayerGR10p, e> : PixelTraitsPFNC<10> { };
+template<bool e> struct PixelTraits<BayerGB10p, e> : PixelTraitsPFNC<10> { };
+template<bool e> struct PixelTraits<BayerRG12p, e> : PixelTraitsPFNC<12> { };
+template<bool e> struct PixelTraits<BayerBG12p, e> : PixelTraitsPFNC<12> { };
+template<bool e> struct PixelTraits<BayerGR12p, e> : PixelTraitsPFNC<12> { };
+template<bool e> struct PixelTraits<BayerGB12p, e> : PixelTraitsPFNC<12> { };
+
+template<bool e> struct PixelTraits<Mono10Packed, e> : PixelTraitsGVSP<10> { };
+template<bool e> struct PixelTraits<Mono12Packed, e> : PixelTraitsGVSP<12> { };
+template<bool e> struct PixelTraits<BayerRG10Packed, e> : PixelTraitsGVSP<10> { };
+template<bool e> struct PixelTraits<BayerBG10Packed, e> : PixelTraitsGVSP<10> { };
+template<bool e> struct PixelTraits<BayerGR10Packed, e> : PixelTraitsGVSP<10> { };
+template<bool e> struct PixelTraits<BayerGB10Packed, e> : PixelTraitsGVSP<10> { };
+template<bool e> struct PixelTraits<BayerRG12Packed, e> : PixelTraitsGVSP<12> { };
+template<bool e> struct PixelTraits<BayerBG12Packed, e> : PixelTraitsGVSP<12> { };
+template<bool e> struct PixelTraits<BayerGR12Packed, e> : PixelTraitsGVSP<12> { };
+template<bool e> struct PixelTraits<BayerGB12Packed, e> : PixelTraitsGVSP<12> { };
+
+/**
+  Calls op.run<P>() with P being PixelTraits of the given format and byte
+  order. Only the byte order of unpacked 16 bit formats is considered, since
+  it does not matter for the other formats.
+*/
+
+template<uint64_t format, class Op> inline void runWithByteOrder(bool bigendian, Op &op)
+{
+  if (bigendian)
+  {
+    op.template run<PixelTraits<format, true> >();
+  }
+  else
+  {
+    op.template run<PixelTraits<format, false> >();
+  }
+}
+
+/**
+  Dispatches the given pixel format once, by calling the templated member
+  function run<P>() of op with the PixelTraits P of the given format. Formats
+  with more than one channel, like RGB8, are not dispatched.
+
+  @param format    Pixel format.
+  @param bigendian True if 16 bit values are big endian.
+  @param op        Object with templated member function run<P>().
+  @return          False if the format is not supported. In this case, op is
+                   not called.
+*/
+
+template<class Op> bool dispatchPixelFormat(uint64_t format, bool bigendian, Op &op)
+{
+  switch (format)
+  {
+    case Mono8: op.template run<PixelTraits<Mono8> >(); break;
+    case Confidence8: op.template run<PixelTraits<Confidence8> >(); break;
+    case Error8: op.template run<PixelTraits<Error8> >(); break;
+    case BayerRG8: op.template run<PixelTraits<BayerRG8> >(); break;
+    case BayerBG8: op.template run<PixelTraits<BayerBG8> >(); break;
+    case BayerGR8: op.template run<PixelTraits<BayerGR8> >(); break;
+    case BayerGB8: op.template run<PixelTraits<BayerGB8> >(); break;
+
+    case Mono10: runWithByteOrder<Mono10>(bigendian, op); break;
+    case Mono12: runWithByteOrder<Mono12>(bigendian, op); break;
+    case Mono16: runWithByteOrder<Mono16>(bigendian, op); break;
+    case Coord3D_C16: runWithByteOrder<Coord3D_C16>(bigendian, op); break;
+    case BayerRG10: runWithByteOrder<BayerRG10>(bigendian, op); break;
+    case BayerBG10: runWithByteOrder<BayerBG10>(bigendian, op); break;
+    case BayerGR10: runWithByteOrder<BayerGR10>(bigendian, op); break;
+    case BayerGB10: runWithByteOrder<BayerGB10>(bigendian, op); break;
+    case BayerRG12: runWithByteOrder<BayerRG12>(bigendian, op); break;
+    case BayerBG12: runWithByteOrder<BayerBG12>(bigendian, op); break;
+    case BayerGR12: runWithByteOrder<BayerGR12>(bigendian, op); break;
+    case BayerGB12: runWithByteOrder<BayerGB12>(bigendian, op); break;
+    case BayerRG16: runWithByteOrder<BayerRG16>(bigendian, op); break;
+    case BayerBG16: runWithByteOrder<BayerBG16>(bigendian, op); break;
+    case BayerGR16: runWithByteOrder<BayerGR16>(bigendian, op); break;
+    case BayerGB16: runWithByteOrder<BayerGB16>(bigendian, op); break;
+
+    case Mono10p: op.template run<PixelTraits<Mono10p> >(); break;
+    case Mono12p: op.template run<PixelTraits<Mono12p> >(); break;
+    case BayerRG10p: op.template run<PixelTraits<BayerRG10p> >(); break;
+    case BayerBG10p: op.template run<PixelTraits<BayerBG10p> >(); break;
+    case BayerGR10p: op.template run<PixelTraits<BayerGR10p> >(); break;
+    case BayerGB10p: op.template run<PixelTraits<BayerGB10p> >(); break;
+    case BayerRG12p: op.template run<PixelTraits<BayerRG12p> >(); break;
+    case BayerBG12p: op.template run<PixelTraits<BayerBG12p> >(); break;
+    case BayerGR12p: op.template run<PixelTraits<BayerGR12p> >(); break;
+    case BayerGB12p: op.template run<PixelTraits<BayerGB12p> >(); break;
+
+    case Mono10Packed: op.template run<PixelTraits<Mono10Packed> >(); break;
+    case Mono12Packed: op.template run<PixelTraits<Mono12Packed> >(); break;
+    case BayerRG10Packed: op.template run<PixelTraits<BayerRG10Packed> >(); break;
+    case BayerBG10Packed: op.template run<PixelTraits<BayerBG10Packed> >(); break;
+    case BayerGR10Packed: op.template run<PixelTraits<BayerGR10Packed> >(); break;
+    case BayerGB10Packed: op.template run<PixelTraits<BayerGB10Packed> >(); break;
+    case BayerRG12Packed: op.template run<PixelTraits<BayerRG12Packed> >(); break;
+    case BayerBG12Packed: op.template run<PixelTraits<BayerBG12Packed> >(); break;
+    case BayerGR12Packed: op.template run<PixelTraits<BayerGR12Packed> >(); break;
+    case BayerGB12Packed: op.template run<PixelTraits<BayerGB12Packed> >(); break;
+
+    default:
+      return false;
+  }
+
+  return true;
+}
+
+}
+
+#endif
@@ -34,14 +34,28 @@
  */
 
 #include "pointcloud.h"
+#include "pixel_traits.h"
+#include "image_codec.h"
 
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <vector>
+#include <unordered_map>
 #include <cmath>
+#include <limits>
 #include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <thread>
+#include <system_error>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
 
 #ifdef _WIN32
 #undef min
@@ -54,150 +68,423 @@ namespace rcg
 namespace
 {
 
-/*
-  Get the i-th 16 bit value.
+class IOException : public std::exception
+{
+  public:
+
+    IOException(const std::string &_msg) { msg=_msg; }
+    virtual const char *what() const noexcept { return msg.c_str(); }
 
-  @param p         Pointer to first byte of array of 16 bit values.
-  @param bigendian True if values are given as big endian. Otherwise, litte
-                   endian is assumed.
-  @param i         Index of 16 bit inside the given array.
+  private:
+
+    std::string msg;
+};
+
+/*
+  Index of a voxel and hash function for looking up voxels.
 */
 
-inline uint16_t getUint16(const uint8_t *p, bool bigendian, size_t i)
+struct VoxelKey
 {
-  uint16_t ret;
+  int32_t x, y, z;
 
-  if (bigendian)
+  bool operator==(const VoxelKey &key) const
   {
-    size_t j=i<<1;
-    ret=static_cast<uint16_t>(((p[j]<<8)|p[j+1]));
+    return x == key.x && y == key.y && z == key.z;
   }
-  else
+};
+
+struct VoxelKeyHash
+{
+  size_t operator()(const VoxelKey &key) const
   {
-    size_t j=i<<1;
-    ret=static_cast<uint16_t>(((p[j+1]<<8)|p[j]));
+    return static_cast<size_t>(static_cast<uint32_t>(key.x)*73856093u ^
+                               static_cast<uint32_t>(key.y)*19349663u ^
+                               static_cast<uint32_t>(key.z)*83492791u);
   }
+};
 
-  return ret;
-}
+/*
+  Sums of all points of an occupied voxel.
+*/
+
+struct Voxel
+{
+  Voxel() : x(0), y(0), z(0), conf(0), error(0), n(0)
+  {
+    normal[0]=normal[1]=normal[2]=0;
+    rgb[0]=rgb[1]=rgb[2]=0;
+  }
+
+  double x, y, z, conf, error;
+  double normal[3];
+  uint32_t rgb[3];
+  uint32_t n;
+};
+
+/*
+  Calls fn(i) for i from 0 to n-1 in parallel. Index 0 is processed by the
+  calling thread. fn must not throw.
+*/
+
+template<class F> void runParallel(size_t n, F fn)
+{
+  std::vector<std::thread> thread;
+  thread.reserve(n);
+
+  for (size_t i=1; i<n; i++)
+  {
+    try
+    {
+      thread.push_back(std::thread(fn, i));
+    }
+    catch (const std::system_error &)
+    {
+      fn(i);
+    }
+  }
+
+  fn(0);
 
+  for (size_t i=0; i<thread.size(); i++)
+  {
+    thread[i].join();
+  }
 }
 
-void storePointCloud(std::string name, double f, double t, double scale,
-                     std::shared_ptr<const Image> left,
-                     std::shared_ptr<const Image> disp,
-                     std::shared_ptr<const Image> conf,
-                     std::shared_ptr<const Image> error)
+/*
+  Computes the normalized eigenvector of the smallest eigenvalue of the
+  symmetric 3x3 matrix with the elements xx, xy, xz, yy, yz and zz. False is
+  returned if the eigenvector is not unique.
+*/
+
+bool getSmallestEigenvector(double v[3], const double a[6])
 {
-  // get size and scale factor between left image and disparity image
+  // eigenvalues of symmetric 3x3 matrix in closed form
 
-  size_t width=disp->getWidth();
-  size_t height=disp->getHeight();
-  bool bigendian=disp->isBigEndian();
-  size_t ds=(left->getWidth()+disp->getWidth()-1)/disp->getWidth();
+  double p1=a[1]*a[1]+a[2]*a[2]+a[4]*a[4];
+  double q=(a[0]+a[3]+a[5])/3;
+  double p2=(a[0]-q)*(a[0]-q)+(a[3]-q)*(a[3]-q)+(a[5]-q)*(a[5]-q)+2*p1;
+  double p=std::sqrt(p2/6);
 
-  // convert focal length factor into focal length in (disparity) pixels
+  if (p <= 0)
+  {
+    return false;
+  }
 
-  f*=width;
+  double b[6]={(a[0]-q)/p, a[1]/p, a[2]/p, (a[3]-q)/p, a[4]/p, (a[5]-q)/p};
+  double r=(b[0]*(b[3]*b[5]-b[4]*b[4])-b[1]*(b[1]*b[5]-b[4]*b[2])+
+            b[2]*(b[1]*b[4]-b[3]*b[2]))/2;
 
-  // get pointer to disparity data and size of row in bytes
+  r=std::max(-1.0, std::min(1.0, r));
 
-  const uint8_t *dps=disp->getPixels();
-  size_t dstep=disp->getWidth()*sizeof(uint16_t)+disp->getXPadding();
+  const double pi=3.14159265358979323846;
+  double lambda=q+2*p*std::cos(std::acos(r)/3+2*pi/3);
 
-  // count number of valid disparities and store vertice index in a temporary
-  // index image
+  // the eigenvector is orthogonal to all rows of a-lambda*I, the cross
+  // product of the two most independent rows is taken
 
-  size_t vi=0;
-  const uint32_t vinvalid=0xffffffff;
-  std::vector<uint32_t> vindex(width*height);
+  double m[3][3]={{a[0]-lambda, a[1], a[2]}, {a[1], a[3]-lambda, a[4]},
+                  {a[2], a[4], a[5]-lambda}};
 
-  uint32_t n=0;
-  for (size_t k=0; k<height; k++)
+  double best=0;
+  v[0]=v[1]=v[2]=0;
+
+  for (int j=0; j<3; j++)
   {
-    int j=0;
-    for (size_t i=0; i<width; i++)
-    {
-      vindex[vi]=vinvalid;
-      if ((dps[j]|dps[j+1]) != 0) vindex[vi]=n++;
+    const double *r0=m[j];
+    const double *r1=m[(j+1)%3];
 
-      j+=2;
-      vi++;
+    double c[3]={r0[1]*r1[2]-r0[2]*r1[1], r0[2]*r1[0]-r0[0]*r1[2], r0[0]*r1[1]-r0[1]*r1[0]};
+    double len=c[0]*c[0]+c[1]*c[1]+c[2]*c[2];
+
+    if (len > best)
+    {
+      best=len;
+      v[0]=c[0];
+      v[1]=c[1];
+      v[2]=c[2];
     }
+  }
 
-    dps+=dstep;
+  if (best <= 1e-12*p2*p2)
+  {
+    return false;
   }
 
-  dps=disp->getPixels();
+  best=std::sqrt(best);
+  v[0]/=best;
+  v[1]/=best;
+  v[2]/=best;
 
-  // count number of triangles
+  return true;
+}
 
-  const uint16_t vstep=static_cast<uint16_t>(std::ceil(2/scale));
+/*
+  Computes normals of the organized point cloud p with 3 values per pixel.
+  Invalid points have z=0. The normals of each horizontal band are computed
+  from integral images of the number of points, the sums of the coordinates
+  and the sums of their products, which cover the rows of the band plus the
+  radius of the window.
+*/
 
-  int tn=0;
-  for (size_t k=1; k<height; k++)
+void computeNormals(float *normal, const float *p, size_t width, size_t height, int radius,
+                    int threads)
+{
+  const size_t r=static_cast<size_t>(std::max(1, radius));
+  const size_t nbands=std::max(static_cast<size_t>(1), std::min(static_cast<size_t>(threads),
+                               height));
+
+  runParallel(nbands, [&](size_t b)
   {
-    for (size_t i=1; i<width; i++)
-    {
-      uint16_t v[4];
-      v[0]=getUint16(dps, bigendian, i-1);
-      v[1]=getUint16(dps, bigendian, i);
-      v[2]=getUint16(dps+dstep, bigendian, i-1);
-      v[3]=getUint16(dps+dstep, bigendian, i);
+    const size_t k0=b*height/nbands;
+    const size_t k1=(b+1)*height/nbands;
+
+    // integral images of the rows w0 to w1-1 with an additional row and
+    // column of zeros, all 10 sums are stored per pixel
+
+    const size_t w0=(k0 > r ? k0-r : 0);
+    const size_t w1=std::min(height, k1+r+1);
+    const size_t istep=10*(width+1);
+
+    std::vector<double> sum((w1-w0+1)*istep, 0);
 
-      uint16_t vmin=65535;
-      uint16_t vmax=0;
-      int valid=0;
+    for (size_t k=w0; k<w1; k++)
+    {
+      double row[10]={0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+      const double *prev=&sum[(k-w0)*istep+10];
+      double *s=&sum[(k-w0+1)*istep+10];
+      const float *ps=p+3*k*width;
 
-      for (int jj=0; jj<4; jj++)
+      for (size_t i=0; i<width; i++)
       {
-        if (v[jj])
+        if (ps[2] > 0)
+        {
+          double x=ps[0], y=ps[1], z=ps[2];
+
+          row[0]+=1;
+          row[1]+=x;
+          row[2]+=y;
+          row[3]+=z;
+          row[4]+=x*x;
+          row[5]+=x*y;
+          row[6]+=x*z;
+          row[7]+=y*y;
+          row[8]+=y*z;
+          row[9]+=z*z;
+        }
+
+        for (int j=0; j<10; j++)
         {
-          vmin=std::min(vmin, v[jj]);
-          vmax=std::max(vmax, v[jj]);
-          valid++;
+          s[j]=prev[j]+row[j];
         }
+
+        ps+=3;
+        prev+=10;
+        s+=10;
       }
+    }
+
+    // compute normal of each valid point from the sums in its window
+
+    for (size_t k=k0; k<k1; k++)
+    {
+      const size_t ka=(k > r ? k-r : 0)-w0;
+      const size_t kb=std::min(height, k+r+1)-w0;
+
+      const float *ps=p+3*k*width;
+      float *ns=normal+3*k*width;
 
-      if (valid >= 3 && vmax-vmin <= vstep)
+      for (size_t i=0; i<width; i++)
       {
-        tn+=valid-2;
+        ns[0]=ns[1]=ns[2]=0;
+
+        if (ps[2] > 0)
+        {
+          const size_t ia=10*(i > r ? i-r : 0);
+          const size_t ib=10*std::min(width, i+r+1);
+
+          const double *s00=&sum[ka*istep+ia];
+          const double *s01=&sum[ka*istep+ib];
+          const double *s10=&sum[kb*istep+ia];
+          const double *s11=&sum[kb*istep+ib];
+
+          double s[10];
+          for (int j=0; j<10; j++)
+          {
+            s[j]=s11[j]-s10[j]-s01[j]+s00[j];
+          }
+
+          if (s[0] >= 3)
+          {
+            // covariance matrix of all points in the window
+
+            double n=s[0];
+            double mx=s[1]/n, my=s[2]/n, mz=s[3]/n;
+            double cov[6]={s[4]/n-mx*mx, s[5]/n-mx*my, s[6]/n-mx*mz, s[7]/n-my*my,
+                           s[8]/n-my*mz, s[9]/n-mz*mz};
+
+            double v[3];
+            if (getSmallestEigenvector(v, cov))
+            {
+              // let normal point towards the camera
+
+              if (v[0]*ps[0]+v[1]*ps[1]+v[2]*ps[2] > 0)
+              {
+                v[0]=-v[0];
+                v[1]=-v[1];
+                v[2]=-v[2];
+              }
+
+              ns[0]=static_cast<float>(v[0]);
+              ns[1]=static_cast<float>(v[1]);
+              ns[2]=static_cast<float>(v[2]);
+            }
+          }
+        }
+
+        ps+=3;
+        ns+=3;
       }
     }
+  });
+}
 
-    dps+=dstep;
-  }
+/*
+  Sets the index of each vertex, i.e. of each valid disparity that passes the
+  filter, in the index image or vinvalid if there is no vertex. The number of
+  vertices is returned. The focal length f is given in pixels.
+*/
 
-  dps=disp->getPixels();
+const uint32_t vinvalid=0xffffffff;
 
-  // get pointer to optional confidence and error data and size of row in bytes
+template<class D> uint32_t computeVertexIndex(std::vector<uint32_t> &vindex, double f, double t,
+                                              double scale, const ImageView &disp,
+                                              const ImageView &conf, const ImageView &error,
+                                              const PointCloudFilter &filter)
+{
+  const size_t width=disp.getWidth();
+  const size_t height=disp.getHeight();
 
-  const uint8_t *cps=0, *eps=0;
-  size_t cstep=0, estep=0;
+  const uint8_t *dps=disp.getPixels();
+  const uint8_t *cps=conf.getPixels();
+  const uint8_t *eps=error.getPixels();
 
-  if (conf)
+  // thresholds of the filter, expressed in disparities where possible
+
+  const int cmin=(cps != 0 ? static_cast<int>(std::ceil(255*filter.min_conf)) : 0);
+  const double emax=(eps != 0 && filter.max_error > 0 ? filter.max_error/(scale*f*t) : 0);
+  const double dmin=(filter.max_z > 0 ? f*t/filter.max_z : 0);
+  const double dmax=(filter.min_z > 0 ? f*t/filter.min_z : 0);
+
+  size_t vi=0;
+  vindex.resize(width*height);
+
+  uint32_t n=0;
+  for (size_t k=0; k<height; k++)
   {
-    cps=conf->getPixels();
-    cstep=conf->getWidth()*sizeof(uint8_t)+conf->getXPadding();
+    for (size_t i=0; i<width; i++)
+    {
+      const double d=scale*D::get(dps, i);
+
+      vindex[vi]=vinvalid;
+
+      if (d > 0 && (cps == 0 || cps[i] >= cmin) && (emax <= 0 || eps[i] <= emax*d*d) &&
+          d >= dmin && (dmax <= 0 || d <= dmax))
+      {
+        vindex[vi]=n++;
+      }
+
+      vi++;
+    }
+
+    dps+=disp.getStride();
+    if (cps) cps+=conf.getStride();
+    if (eps) eps+=error.getStride();
   }
 
-  if (error)
+  return n;
+}
+
+/*
+  Values of a point that are stored.
+*/
+
+struct PointValues
+{
+  PointValues() : x(0), y(0), z(0), size(0), conf(0), error(0)
   {
-    eps=error->getPixels();
-    estep=error->getWidth()*sizeof(uint8_t)+error->getXPadding();
+    normal[0]=normal[1]=normal[2]=0;
+    rgb[0]=rgb[1]=rgb[2]=0;
   }
 
-  // open output file and write ASCII PLY header
+  double x, y, z;
+  double normal[3];
+  double size, conf, error;
+  uint8_t rgb[3];
+};
 
-  if (name.size() == 0)
+/*
+  Writes the header of an ASCII PLY or binary PCD file with the given number
+  of points and triangles and the given optional properties.
+*/
+
+void writeHeader(std::ostream &out, PointCloudFmt fmt, uint32_t n, int tn, bool normal,
+                 bool conf, bool error)
+{
+  if (fmt == PCD)
   {
-    std::ostringstream os;
-    double timestamp=left->getTimestampNS()/1000000000.0;
-    os << "rc_visard_" << std::setprecision(16) << timestamp << ".ply";
-    name=os.str();
-  }
+    std::string fields="x y z";
+    std::string size="4 4 4";
+    std::string type="F F F";
+
+    if (normal)
+    {
+      fields+=" normal_x normal_y normal_z";
+      size+=" 4 4 4";
+      type+=" F F F";
+    }
+
+    fields+=" rgb"; // packed as 0x00rrggbb like in PCL
+    size+=" 4";
+    type+=" F";
+
+    if (conf)
+    {
+      fields+=" confidence";
+      size+=" 4";
+      type+=" F";
+    }
+
+    if (error)
+    {
+      fields+=" error";
+      size+=" 4";
+      type+=" F";
+    }
+
+    out << "# .PCD v0.7 - Point Cloud Data file format" << std::endl;
+    out << "VERSION 0.7" << std::endl;
+    out << "FIELDS " << fields << std::endl;
+    out << "SIZE " << size << std::endl;
+    out << "TYPE " << type << std::endl;
+    out << "COUNT";
+
+    size_t nfields=static_cast<size_t>(std::count(fields.begin(), fields.end(), ' '))+1;
+    for (size_t i=0; i<nfields; i++)
+    {
+      out << " 1";
+    }
+
+    out << std::endl;
+    out << "WIDTH " << n << std::endl;
+    out << "HEIGHT 1" << std::endl;
+    out << "VIEWPOINT 0 0 0 1 0 0 0" << std::endl;
+    out << "POINTS " << n << std::endl;
+    out << "DATA binary" << std::endl;
 
-  std::ofstream out(name);
+    return;
+  }
 
   out << "ply" << std::endl;
   out << "format ascii 1.0" << std::endl;
@@ -207,14 +494,22 @@ void storePointCloud(std::string name, double f, double t, double scale,
   out << "property float32 x" << std::endl;
   out << "property float32 y" << std::endl;
   out << "property float32 z" << std::endl;
+
+  if (normal)
+  {
+    out << "property float32 nx" << std::endl; // optional normal
+    out << "property float32 ny" << std::endl;
+    out << "property float32 nz" << std::endl;
+  }
+
   out << "property float32 scan_size" << std::endl; // i.e. size of 3D point
 
-  if (cps != 0)
+  if (conf)
   {
     out << "property float32 scan_conf" << std::endl; // optional confidence
   }
 
-  if (eps != 0)
+  if (error)
   {
     out << "property float32 scan_error" << std::endl; // optional error in 3D along line of sight
   }
@@ -225,131 +520,1023 @@ void storePointCloud(std::string name, double f, double t, double scale,
   out << "element face " << tn << std::endl;
   out << "property list uint8 uint32 vertex_indices" << std::endl;
   out << "end_header" << std::endl;
+}
 
-  // create colored point cloud
+/*
+  Writes one point with the given optional properties in ASCII PLY or binary
+  PCD format. Binary values are stored in host byte order, as expected by
+  PCL.
+*/
 
-  for (size_t k=0; k<height; k++)
+void writePoint(std::ostream &out, PointCloudFmt fmt, const PointValues &p, bool normal,
+                bool conf, bool error)
+{
+  if (fmt == PCD)
   {
-    for (size_t i=0; i<width; i++)
+    float v[9];
+    int j=0;
+
+    v[j++]=static_cast<float>(p.x);
+    v[j++]=static_cast<float>(p.y);
+    v[j++]=static_cast<float>(p.z);
+
+    if (normal)
+    {
+      v[j++]=static_cast<float>(p.normal[0]);
+      v[j++]=static_cast<float>(p.normal[1]);
+      v[j++]=static_cast<float>(p.normal[2]);
+    }
+
+    uint32_t rgb=(static_cast<uint32_t>(p.rgb[0])<<16)|(static_cast<uint32_t>(p.rgb[1])<<8)|
+      p.rgb[2];
+    memcpy(&v[j++], &rgb, sizeof(float));
+
+    if (conf)
+    {
+      v[j++]=static_cast<float>(p.conf);
+    }
+
+    if (error)
     {
-      // convert disparity from fixed comma 16 bit integer into float value
+      v[j++]=static_cast<float>(p.error);
+    }
 
-      double d=scale*getUint16(dps, bigendian, i);
+    out.write(reinterpret_cast<const char *>(v), static_cast<std::streamsize>(j*sizeof(float)));
 
-      // if disparity is valid and color can be obtained
+    return;
+  }
 
-      if (d)
-      {
-        // reconstruct 3D point from disparity value
+  out << p.x << " " << p.y << " " << p.z << " ";
+
+  if (normal)
+  {
+    out << p.normal[0] << " " << p.normal[1] << " " << p.normal[2] << " ";
+  }
+
+  out << p.size << " ";
+
+  if (conf)
+  {
+    out << p.conf << " ";
+  }
 
-        double x=(i+0.5-0.5*width)*t/d;
-        double y=(k+0.5-0.5*height)*t/d;
-        double z=f*t/d;
+  if (error)
+  {
+    out << p.error << " ";
+  }
+
+  out << static_cast<int>(p.rgb[0]) << " ";
+  out << static_cast<int>(p.rgb[1]) << " ";
+  out << static_cast<int>(p.rgb[2]) << std::endl;
+}
+
+/*
+  Computes and stores the point cloud with the pixel traits D of the disparity
+  image, i.e. Coord3D_C16 in little or big endian.
+*/
 
-        // compute size of reconstructed point
+template<class D> void storePointCloudT(std::string name, double f, double t, double scale,
+                                        const ImageView &left, const ImageView &disp,
+                                        const ImageView &conf, const ImageView &error,
+                                        const PointCloudFilter &filter,
+                                        const NormalParameter &nparam, PointCloudFmt fmt)
+{
+  // get size and scale factor between left image and disparity image
 
-        double x2=(i-0.5*width)*t/d;
-        double size=2*1.4*std::abs(x2-x);
+  size_t width=disp.getWidth();
+  size_t height=disp.getHeight();
+  size_t ds=(left.getWidth()+disp.getWidth()-1)/disp.getWidth();
 
-        // get corresponding color value
+  // convert focal length factor into focal length in (disparity) pixels
 
-        uint8_t rgb[3];
-        getColor(rgb, left, static_cast<uint32_t>(ds), static_cast<uint32_t>(i),
-                 static_cast<uint32_t>(k));
+  f*=width;
 
-        // store colored point, optionally with confidence and error
+  // get pointer to disparity data and size of row in bytes
 
-        out << x << " " << y << " " << z << " " << size << " ";
+  const uint8_t *dps=disp.getPixels();
+  size_t dstep=disp.getStride();
 
-        if (cps != 0)
-        {
-          out << cps[i]/255.0 << " ";
-        }
+  // get pointer to optional confidence and error data and size of row in bytes
 
-        if (eps != 0)
+  const uint8_t *cps=0, *eps=0;
+  size_t cstep=0, estep=0;
+
+  if (conf.getPixels())
+  {
+    cps=conf.getPixels();
+    cstep=conf.getStride();
+  }
+
+  if (error.getPixels())
+  {
+    eps=error.getPixels();
+    estep=error.getStride();
+  }
+
+  // count number of valid disparities that pass the filter and store vertice
+  // index in a temporary index image
+
+  std::vector<uint32_t> vindex;
+  uint32_t n=computeVertexIndex<D>(vindex, f, t, scale, disp, conf, error, filter);
+
+  // get the colors of all pixels at once
+
+  const size_t cwidth=left.getWidth()/ds;
+  const size_t cheight=left.getHeight()/ds;
+
+  std::vector<uint8_t> color(3*cwidth*cheight);
+  getColorImage(color.data(), left, static_cast<uint32_t>(ds));
+
+  // optionally compute normals of all points that pass the filter
+
+  std::vector<float> normal;
+
+  if (nparam.radius > 0)
+  {
+    std::vector<float> p(3*width*height, 0);
+
+    for (size_t k=0; k<height; k++)
+    {
+      for (size_t i=0; i<width; i++)
+      {
+        if (vindex[k*width+i] != vinvalid)
         {
-          out << eps[i]*scale*f*t/(d*d) << " ";
-        }
+          double d=scale*D::get(dps, i);
+          float *pp=&p[3*(k*width+i)];
 
-        out << static_cast<int>(rgb[0]) << " ";
-        out << static_cast<int>(rgb[1]) << " ";
-        out << static_cast<int>(rgb[2]) << std::endl;
+          pp[0]=static_cast<float>((i+0.5-0.5*width)*t/d);
+          pp[1]=static_cast<float>((k+0.5-0.5*height)*t/d);
+          pp[2]=static_cast<float>(f*t/d);
+        }
       }
+
+      dps+=dstep;
     }
 
-    dps+=dstep;
-    cps+=cstep;
-    eps+=estep;
+    dps=disp.getPixels();
+
+    normal.resize(3*width*height);
+    computeNormals(normal.data(), p.data(), width, height, nparam.radius, nparam.threads);
   }
 
-  dps=disp->getPixels();
+  // optionally accumulate the points in a voxel grid, in which case only the
+  // occupied voxels are stored without triangles
 
-  // create triangles
+  std::vector<Voxel> voxel;
 
-  uint32_t *ips=vindex.data();
-  for (size_t k=1; k<height; k++)
+  if (filter.voxel_size > 0)
   {
-    for (size_t i=1; i<width; i++)
-    {
-      uint16_t v[4];
-      v[0]=getUint16(dps, bigendian, i-1);
-      v[1]=getUint16(dps, bigendian, i);
-      v[2]=getUint16(dps+dstep, bigendian, i-1);
-      v[3]=getUint16(dps+dstep, bigendian, i);
-
-      uint16_t vmin=65535;
-      uint16_t vmax=0;
-      int valid=0;
+    const double vsize=filter.voxel_size;
+    std::unordered_map<VoxelKey, uint32_t, VoxelKeyHash> vmap;
 
-      for (int jj=0; jj<4; jj++)
+    for (size_t k=0; k<height; k++)
+    {
+      for (size_t i=0; i<width; i++)
       {
-        if (v[jj])
+        if (vindex[k*width+i] != vinvalid)
         {
-          vmin=std::min(vmin, v[jj]);
-          vmax=std::max(vmax, v[jj]);
-          valid++;
+          double d=scale*D::get(dps, i);
+
+          double x=(i+0.5-0.5*width)*t/d;
+          double y=(k+0.5-0.5*height)*t/d;
+          double z=f*t/d;
+
+          uint8_t tmp[3];
+          const uint8_t *rgb=tmp;
+
+          if (i < cwidth && k < cheight)
+          {
+            rgb=&color[3*(k*cwidth+i)];
+          }
+          else
+          {
+            getColor(tmp, left, static_cast<uint32_t>(ds), static_cast<uint32_t>(i),
+                     static_cast<uint32_t>(k));
+          }
+
+          // look up voxel or create it if it is not yet occupied
+
+          VoxelKey key;
+          key.x=static_cast<int32_t>(std::floor(x/vsize));
+          key.y=static_cast<int32_t>(std::floor(y/vsize));
+          key.z=static_cast<int32_t>(std::floor(z/vsize));
+
+          std::pair<std::unordered_map<VoxelKey, uint32_t, VoxelKeyHash>::iterator, bool> ret=
+            vmap.insert(std::make_pair(key, static_cast<uint32_t>(voxel.size())));
+
+          if (ret.second)
+          {
+            voxel.push_back(Voxel());
+          }
+
+          Voxel &v=voxel[ret.first->second];
+
+          v.x+=x;
+          v.y+=y;
+          v.z+=z;
+
+          if (normal.size() > 0)
+          {
+            const float *nv=&normal[3*(k*width+i)];
+            v.normal[0]+=nv[0];
+            v.normal[1]+=nv[1];
+            v.normal[2]+=nv[2];
+          }
+
+          if (cps != 0)
+          {
+            v.conf+=cps[i]/255.0;
+          }
+
+          if (eps != 0)
+          {
+            v.error+=eps[i]*scale*f*t/(d*d);
+          }
+
+          v.rgb[0]+=rgb[0];
+          v.rgb[1]+=rgb[1];
+          v.rgb[2]+=rgb[2];
+          v.n++;
         }
       }
 
-      if (valid >= 3 && vmax-vmin <= vstep)
-      {
-        int j=0;
-        uint32_t fc[4];
+      dps+=dstep;
+      if (cps) cps+=cstep;
+      if (eps) eps+=estep;
+    }
 
-        if (ips[i-1] != vinvalid)
-        {
-          fc[j++]=ips[i-1];
-        }
+    dps=disp.getPixels();
+    cps=conf.getPixels();
+    eps=error.getPixels();
 
-        if (ips[width+i-1] != vinvalid)
-        {
-          fc[j++]=ips[width+i-1];
-        }
+    n=static_cast<uint32_t>(voxel.size());
+  }
 
-        if (ips[width+i] != vinvalid)
-        {
-          fc[j++]=ips[width+i];
-        }
+  // count number of triangles
+
+  const uint16_t vstep=static_cast<uint16_t>(std::ceil(2/scale));
+
+  int tn=0;
+  const uint32_t *ips=vindex.data();
+
+  if (fmt == PLY && filter.voxel_size <= 0)
+  {
+    for (size_t k=1; k<height; k++)
+    {
+      for (size_t i=1; i<width; i++)
+      {
+        // disparities that have been filtered are treated as invalid
+
+        uint16_t v[4];
+        v[0]=(ips[i-1] != vinvalid ? D::get(dps, i-1) : 0);
+        v[1]=(ips[i] != vinvalid ? D::get(dps, i) : 0);
+        v[2]=(ips[width+i-1] != vinvalid ? D::get(dps+dstep, i-1) : 0);
+        v[3]=(ips[width+i] != vinvalid ? D::get(dps+dstep, i) : 0);
 
-        if (ips[i] != vinvalid)
+        uint16_t vmin=65535;
+        uint16_t vmax=0;
+        int valid=0;
+
+        for (int jj=0; jj<4; jj++)
         {
-          fc[j++]=ips[i];
+          if (v[jj])
+          {
+            vmin=std::min(vmin, v[jj]);
+            vmax=std::max(vmax, v[jj]);
+            valid++;
+          }
         }
 
-        out << "3 " << fc[0] << ' ' << fc[1] << ' ' << fc[2] << std::endl;
-
-        if (j == 4)
+        if (valid >= 3 && vmax-vmin <= vstep)
         {
-          out << "3 " << fc[2] << ' ' << fc[3] << ' ' << fc[0] << std::endl;
+          tn+=valid-2;
         }
       }
+
+      ips+=width;
+      dps+=dstep;
     }
 
-    ips+=width;
-    dps+=dstep;
+    dps=disp.getPixels();
   }
 
-  out.close();
+  // open output file and write header
+
+  if (name.size() == 0)
+  {
+    std::ostringstream os;
+    double timestamp=left.getTimestampNS()/1000000000.0;
+    os << "rc_visard_" << std::setprecision(16) << timestamp << (fmt == PCD ? ".pcd" : ".ply");
+    name=os.str();
+  }
+
+  std::ofstream out(name, fmt == PCD ? std::ios::out | std::ios::binary : std::ios::out);
+
+  if (!out.is_open())
+  {
+    throw IOException("storePointCloud(): Cannot create file: "+name);
+  }
+
+  const bool has_normal=(normal.size() > 0);
+  writeHeader(out, fmt, n, tn, has_normal, cps != 0, eps != 0);
+
+  if (filter.voxel_size > 0)
+  {
+    // store centroids of voxels with average color, confidence and error
+
+    for (size_t j=0; j<voxel.size(); j++)
+    {
+      const Voxel &v=voxel[j];
+
+      PointValues pv;
+      pv.x=v.x/v.n;
+      pv.y=v.y/v.n;
+      pv.z=v.z/v.n;
+
+      if (has_normal)
+      {
+        double len=std::sqrt(v.normal[0]*v.normal[0]+v.normal[1]*v.normal[1]+
+                             v.normal[2]*v.normal[2]);
+
+        if (len > 0)
+        {
+          pv.normal[0]=v.normal[0]/len;
+          pv.normal[1]=v.normal[1]/len;
+          pv.normal[2]=v.normal[2]/len;
+        }
+      }
+
+      pv.size=filter.voxel_size;
+      pv.conf=v.conf/v.n;
+      pv.error=v.error/v.n;
+      pv.rgb[0]=static_cast<uint8_t>((v.rgb[0]+v.n/2)/v.n);
+      pv.rgb[1]=static_cast<uint8_t>((v.rgb[1]+v.n/2)/v.n);
+      pv.rgb[2]=static_cast<uint8_t>((v.rgb[2]+v.n/2)/v.n);
+
+      writePoint(out, fmt, pv, has_normal, cps != 0, eps != 0);
+    }
+  }
+  else
+  {
+    // create colored point cloud
+
+    for (size_t k=0; k<height; k++)
+    {
+      for (size_t i=0; i<width; i++)
+      {
+        // if disparity is valid and passes the filter
+
+        if (vindex[k*width+i] != vinvalid)
+        {
+          // convert disparity from fixed comma 16 bit integer into float value
+
+          double d=scale*D::get(dps, i);
+
+          // reconstruct 3D point from disparity value
+
+          PointValues pv;
+          pv.x=(i+0.5-0.5*width)*t/d;
+          pv.y=(k+0.5-0.5*height)*t/d;
+          pv.z=f*t/d;
+
+          // compute size of reconstructed point
+
+          double x2=(i-0.5*width)*t/d;
+          pv.size=2*1.4*std::abs(x2-pv.x);
+
+          if (has_normal)
+          {
+            const float *nv=&normal[3*(k*width+i)];
+            pv.normal[0]=nv[0];
+            pv.normal[1]=nv[1];
+            pv.normal[2]=nv[2];
+          }
+
+          // get corresponding color value
+
+          if (i < cwidth && k < cheight)
+          {
+            const uint8_t *rgb=&color[3*(k*cwidth+i)];
+            pv.rgb[0]=rgb[0];
+            pv.rgb[1]=rgb[1];
+            pv.rgb[2]=rgb[2];
+          }
+          else
+          {
+            getColor(pv.rgb, left, static_cast<uint32_t>(ds), static_cast<uint32_t>(i),
+                     static_cast<uint32_t>(k));
+          }
+
+          // store colored point, optionally with confidence and error
+
+          if (cps != 0)
+          {
+            pv.conf=cps[i]/255.0;
+          }
+
+          if (eps != 0)
+          {
+            pv.error=eps[i]*scale*f*t/(d*d);
+          }
+
+          writePoint(out, fmt, pv, has_normal, cps != 0, eps != 0);
+        }
+      }
+
+      dps+=dstep;
+      cps+=cstep;
+      eps+=estep;
+    }
+
+    dps=disp.getPixels();
+  }
+
+  // create triangles, which are only counted for the PLY format
+
+  if (tn > 0)
+  {
+    ips=vindex.data();
+    for (size_t k=1; k<height; k++)
+    {
+      for (size_t i=1; i<width; i++)
+      {
+        uint16_t v[4];
+        v[0]=(ips[i-1] != vinvalid ? D::get(dps, i-1) : 0);
+        v[1]=(ips[i] != vinvalid ? D::get(dps, i) : 0);
+        v[2]=(ips[width+i-1] != vinvalid ? D::get(dps+dstep, i-1) : 0);
+        v[3]=(ips[width+i] != vinvalid ? D::get(dps+dstep, i) : 0);
+
+        uint16_t vmin=65535;
+        uint16_t vmax=0;
+        int valid=0;
+
+        for (int jj=0; jj<4; jj++)
+        {
+          if (v[jj])
+          {
+            vmin=std::min(vmin, v[jj]);
+            vmax=std::max(vmax, v[jj]);
+            valid++;
+          }
+        }
+
+        if (valid >= 3 && vmax-vmin <= vstep)
+        {
+          int j=0;
+          uint32_t fc[4];
+
+          if (ips[i-1] != vinvalid)
+          {
+            fc[j++]=ips[i-1];
+          }
+
+          if (ips[width+i-1] != vinvalid)
+          {
+            fc[j++]=ips[width+i-1];
+          }
+
+          if (ips[width+i] != vinvalid)
+          {
+            fc[j++]=ips[width+i];
+          }
+
+          if (ips[i] != vinvalid)
+          {
+            fc[j++]=ips[i];
+          }
+
+          out << "3 " << fc[0] << ' ' << fc[1] << ' ' << fc[2] << std::endl;
+
+          if (j == 4)
+          {
+            out << "3 " << fc[2] << ' ' << fc[3] << ' ' << fc[0] << std::endl;
+          }
+        }
+      }
+
+      ips+=width;
+      dps+=dstep;
+    }
+  }
+
+  out.close();
+
+  if (!out)
+  {
+    throw IOException("storePointCloud(): Cannot write file: "+name);
+  }
+}
+
+/*
+  Header of the compressed point cloud format, which is followed by the
+  compressed images, each preceded by its size.
+*/
+
+const uint8_t rcp_magic[4]={'R', 'C', 'P', 1};
+const size_t rcp_header_size=32;
+
+inline void put32(uint8_t *p, uint32_t v)
+{
+  p[0]=static_cast<uint8_t>(v);
+  p[1]=static_cast<uint8_t>(v>>8);
+  p[2]=static_cast<uint8_t>(v>>16);
+  p[3]=static_cast<uint8_t>(v>>24);
+}
+
+inline void put64(uint8_t *p, uint64_t v)
+{
+  put32(p, static_cast<uint32_t>(v));
+  put32(p+4, static_cast<uint32_t>(v>>32));
+}
+
+inline uint32_t get32(const uint8_t *p)
+{
+  return static_cast<uint32_t>(p[0])|(static_cast<uint32_t>(p[1])<<8)|
+    (static_cast<uint32_t>(p[2])<<16)|(static_cast<uint32_t>(p[3])<<24);
+}
+
+inline uint64_t get64(const uint8_t *p)
+{
+  return static_cast<uint64_t>(get32(p))|(static_cast<uint64_t>(get32(p+4))<<32);
+}
+
+inline void putDouble(uint8_t *p, double v)
+{
+  uint64_t u;
+  memcpy(&u, &v, sizeof(u));
+  put64(p, u);
+}
+
+inline double getDouble(const uint8_t *p)
+{
+  uint64_t u=get64(p);
+  double v;
+  memcpy(&v, &u, sizeof(v));
+  return v;
+}
+
+/*
+  Appends the size of the compressed image and the compressed image.
+*/
+
+void appendImage(std::vector<uint8_t> &data, const ImageView &image)
+{
+  size_t start=data.size();
+  data.resize(start+8);
+
+  encodeImage(data, image);
+
+  put64(data.data()+start, data.size()-start-8);
+}
+
+/*
+  Decodes the next image and advances the data pointer.
+*/
+
+std::shared_ptr<Image> nextImage(const uint8_t *&data, const uint8_t *end)
+{
+  if (end-data < 8)
+  {
+    throw std::invalid_argument("decodePointCloud(): Data too short");
+  }
+
+  uint64_t size=get64(data);
+  data+=8;
+
+  if (size > static_cast<uint64_t>(end-data))
+  {
+    throw std::invalid_argument("decodePointCloud(): Data too short");
+  }
+
+  std::shared_ptr<Image> ret=decodeImage(data, static_cast<size_t>(size));
+  data+=size;
+
+  return ret;
+}
+
+/*
+  Compresses the point cloud with the pixel traits D of the disparity image.
+*/
+
+template<class D> void encodePointCloudT(std::vector<uint8_t> &data, double f, double t,
+                                         double scale, const ImageView &left,
+                                         const ImageView &disp, const ImageView &conf,
+                                         const ImageView &error, const PointCloudFilter &filter)
+{
+  if (filter.voxel_size > 0)
+  {
+    throw std::invalid_argument("encodePointCloud(): Voxel grid downsampling is not supported");
+  }
+
+  const size_t width=disp.getWidth();
+  const size_t height=disp.getHeight();
+  const size_t ds=(left.getWidth()+disp.getWidth()-1)/disp.getWidth();
+
+  std::vector<uint32_t> vindex;
+  computeVertexIndex<D>(vindex, f*width, t, scale, disp, conf, error, filter);
+
+  // disparity image in little endian, in which all dropped points are
+  // invalid, and color, confidence and error of each point, which are set
+  // to the values of the left neighbor or 0 for pixels without point to
+  // support prediction
+
+  const size_t cwidth=left.getWidth()/ds;
+  const size_t cheight=left.getHeight()/ds;
+
+  std::vector<uint8_t> color(3*cwidth*cheight);
+  getColorImage(color.data(), left, static_cast<uint32_t>(ds));
+
+  std::vector<uint8_t> dimg(2*width*height);
+  std::vector<uint8_t> rgb(3*width*height);
+  std::vector<uint8_t> cimg(conf.getPixels() ? width*height : 0);
+  std::vector<uint8_t> eimg(error.getPixels() ? width*height : 0);
+
+  const uint8_t *dps=disp.getPixels();
+  const uint8_t *cps=conf.getPixels();
+  const uint8_t *eps=error.getPixels();
+
+  for (size_t k=0; k<height; k++)
+  {
+    for (size_t i=0; i<width; i++)
+    {
+      size_t j=k*width+i;
+      uint8_t *p=&rgb[3*j];
+
+      if (vindex[j] != vinvalid)
+      {
+        uint16_t d=D::get(dps, i);
+        dimg[2*j]=static_cast<uint8_t>(d);
+        dimg[2*j+1]=static_cast<uint8_t>(d>>8);
+
+        if (i < cwidth && k < cheight)
+        {
+          memcpy(p, &color[3*(k*cwidth+i)], 3);
+        }
+        else
+        {
+          getColor(p, left, static_cast<uint32_t>(ds), static_cast<uint32_t>(i),
+                   static_cast<uint32_t>(k));
+        }
+
+        if (cps) cimg[j]=cps[i];
+        if (eps) eimg[j]=eps[i];
+      }
+      else if (i > 0)
+      {
+        memcpy(p, p-3, 3);
+      }
+    }
+
+    dps+=disp.getStride();
+    if (cps) cps+=conf.getStride();
+    if (eps) eps+=error.getStride();
+  }
+
+  // write header and compressed images
+
+  size_t start=data.size();
+  data.resize(start+rcp_header_size);
+
+  uint8_t *out=data.data()+start;
+  memcpy(out, rcp_magic, 4);
+  putDouble(out+4, f);
+  putDouble(out+12, t);
+  putDouble(out+20, scale);
+  put32(out+28, (cimg.size() > 0 ? 1 : 0) | (eimg.size() > 0 ? 2 : 0));
+
+  appendImage(data, ImageView(dimg.data(), width, height, 2*width, Coord3D_C16, false,
+                              disp.getTimestampNS(), disp.getFrameID()));
+  appendImage(data, ImageView(rgb.data(), width, height, 3*width, RGB8, false,
+                              left.getTimestampNS(), left.getFrameID()));
+
+  if (cimg.size() > 0)
+  {
+    appendImage(data, ImageView(cimg.data(), width, height, width, Confidence8, false,
+                                conf.getTimestampNS(), conf.getFrameID()));
+  }
+
+  if (eimg.size() > 0)
+  {
+    appendImage(data, ImageView(eimg.data(), width, height, width, Error8, false,
+                                error.getTimestampNS(), error.getFrameID()));
+  }
+}
+
+/*
+  Converts a row of disparities in host byte order into depth in meters.
+  Invalid pixels are set to NaN.
+*/
+
+void depthRow(float *target, const uint16_t *disp, const uint8_t *conf, size_t width, float ft,
+              float scale, float offset, int inv, int cmin)
+{
+  const float nan=std::numeric_limits<float>::quiet_NaN();
+
+  size_t i=0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128i zero=_mm_setzero_si128();
+  const __m128 vft=_mm_set1_ps(ft);
+  const __m128 vscale=_mm_set1_ps(scale);
+  const __m128 voffset=_mm_set1_ps(offset);
+  const __m128 vnan=_mm_set1_ps(nan);
+  const __m128i vinv=_mm_set1_epi32(inv);
+  const __m128i vcmin=_mm_set1_epi32(cmin-1);
+
+  for (; i+4 <= width; i+=4)
+  {
+    __m128i d=_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(disp+i)),
+      zero);
+
+    __m128 df=_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(d), vscale), voffset);
+    __m128 valid=_mm_cmpgt_ps(df, _mm_setzero_ps());
+
+    valid=_mm_andnot_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(d, vinv)), valid);
+
+    if (conf)
+    {
+      int c4;
+      std::memcpy(&c4, conf+i, 4);
+
+      __m128i c=_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(c4), zero), zero);
+      valid=_mm_and_ps(valid, _mm_castsi128_ps(_mm_cmpgt_epi32(c, vcmin)));
+    }
+
+    __m128 z=_mm_div_ps(vft, df);
+    z=_mm_or_ps(_mm_and_ps(valid, z), _mm_andnot_ps(valid, vnan));
+
+    _mm_storeu_ps(target+i, z);
+  }
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+  const float32x4_t vft=vdupq_n_f32(ft);
+  const float32x4_t vscale=vdupq_n_f32(scale);
+  const float32x4_t voffset=vdupq_n_f32(offset);
+  const float32x4_t vnan=vdupq_n_f32(nan);
+  const uint32x4_t vinv=vdupq_n_u32(static_cast<uint32_t>(inv));
+  const uint32x4_t vcmin=vdupq_n_u32(static_cast<uint32_t>(cmin));
+
+  for (; i+4 <= width; i+=4)
+  {
+    uint32x4_t d=vmovl_u16(vld1_u16(disp+i));
+
+    float32x4_t df=vmlaq_f32(voffset, vcvtq_f32_u32(d), vscale);
+    uint32x4_t valid=vcgtq_f32(df, vdupq_n_f32(0));
+
+    valid=vbicq_u32(valid, vceqq_u32(d, vinv));
+
+    if (conf)
+    {
+      uint32x4_t c={conf[i], conf[i+1], conf[i+2], conf[i+3]};
+      valid=vandq_u32(valid, vcgeq_u32(c, vcmin));
+    }
+
+    vst1q_f32(target+i, vbslq_f32(valid, vdivq_f32(vft, df), vnan));
+  }
+#endif
+
+  for (; i<width; i++)
+  {
+    const float df=scale*disp[i]+offset;
+
+    if (df > 0 && disp[i] != inv && (conf == 0 || conf[i] >= cmin))
+    {
+      target[i]=ft/df;
+    }
+    else
+    {
+      target[i]=nan;
+    }
+  }
+}
+
+/*
+  Calls op(row, width) for every row of depth values in meters.
+*/
+
+template<class Op> void computeDepth(const ImageView &disp, const DepthParameter &param,
+                                     const ImageView &conf, Op &op)
+{
+  if (disp.getPixelFormat() != Coord3D_C16)
+  {
+    throw std::invalid_argument("disparityToDepth(): Format Coord3D_C16 expected");
+  }
+
+  const uint8_t *cps=0;
+
+  if (conf.getPixels() != 0)
+  {
+    if (conf.getPixelFormat() != Confidence8 || conf.getWidth() != disp.getWidth() ||
+      conf.getHeight() != disp.getHeight())
+    {
+      throw std::invalid_argument("disparityToDepth(): Confidence8 image of the same size as "
+        "disparity image expected");
+    }
+
+    cps=conf.getPixels();
+  }
+
+  const size_t width=disp.getWidth();
+  const float ft=static_cast<float>(param.f*param.t);
+  const int cmin=static_cast<int>(std::ceil(255*param.min_conf));
+
+  std::vector<uint16_t> d(width);
+  std::vector<float> z(width);
+
+  const uint8_t *dps=disp.getPixels();
+
+  for (size_t k=0; k<disp.getHeight(); k++)
+  {
+    unpackPixels(d.data(), dps, Coord3D_C16, width, disp.isBigEndian());
+
+    depthRow(z.data(), d.data(), cps, width, ft, static_cast<float>(param.scale),
+      static_cast<float>(param.offset), param.inv, cmin);
+
+    op(z.data(), width);
+
+    dps+=disp.getStride();
+    if (cps) cps+=conf.getStride();
+  }
+}
+
+/*
+  Operation for computeDepth() that copies the depth in meters.
+*/
+
+struct DepthMeterOp
+{
+  float *depth;
+
+  void operator()(const float *z, size_t width)
+  {
+    std::memcpy(depth, z, width*sizeof(float));
+    depth+=width;
+  }
+};
+
+/*
+  Operation for computeDepth() that converts the depth into millimeters.
+*/
+
+struct DepthMillimeterOp
+{
+  uint16_t *depth;
+
+  void operator()(const float *z, size_t width)
+  {
+    for (size_t i=0; i<width; i++)
+    {
+      const float v=1000*z[i]+0.5f;
+
+      // comparison is false for NaN
+
+      *depth++=(v >= 1 && v < 65535) ? static_cast<uint16_t>(v) : 0;
+    }
+  }
+};
+
+}
+
+void storePointCloud(std::string name, double f, double t, double scale,
+                     std::shared_ptr<const Image> left,
+                     std::shared_ptr<const Image> disp,
+                     std::shared_ptr<const Image> conf,
+                     std::shared_ptr<const Image> error,
+                     const PointCloudFilter &filter, const NormalParameter &normal,
+                     PointCloudFmt fmt)
+{
+  storePointCloud(name, f, t, scale, ImageView(*left), ImageView(*disp),
+                  conf ? ImageView(*conf) : ImageView(), error ? ImageView(*error) : ImageView(),
+                  filter, normal, fmt);
+}
+
+void storePointCloud(const std::string &name, double f, double t, double scale,
+                     const ImageView &left, const ImageView &disp, const ImageView &conf,
+                     const ImageView &error, const PointCloudFilter &filter,
+                     const NormalParameter &normal, PointCloudFmt fmt)
+{
+  if (fmt == RCP)
+  {
+    std::vector<uint8_t> data;
+    encodePointCloud(data, f, t, scale, left, disp, conf, error, filter);
+
+    std::string fname=name;
+
+    if (fname.size() == 0)
+    {
+      std::ostringstream os;
+      double timestamp=left.getTimestampNS()/1000000000.0;
+      os << "rc_visard_" << std::setprecision(16) << timestamp << ".rcp";
+      fname=os.str();
+    }
+
+    std::ofstream out(fname, std::ios::out | std::ios::binary);
+
+    if (!out.is_open())
+    {
+      throw IOException("storePointCloud(): Cannot create file: "+fname);
+    }
+
+    out.write(reinterpret_cast<const char *>(data.data()),
+              static_cast<std::streamsize>(data.size()));
+    out.close();
+
+    if (!out)
+    {
+      throw IOException("storePointCloud(): Cannot write file: "+fname);
+    }
+
+    return;
+  }
+
+  if (disp.isBigEndian())
+  {
+    storePointCloudT<PixelTraits<Coord3D_C16, true> >(name, f, t, scale, left, disp, conf,
+      error, filter, normal, fmt);
+  }
+  else
+  {
+    storePointCloudT<PixelTraits<Coord3D_C16, false> >(name, f, t, scale, left, disp, conf,
+      error, filter, normal, fmt);
+  }
+}
+
+void encodePointCloud(std::vector<uint8_t> &data, double f, double t, double scale,
+                      const ImageView &left, const ImageView &disp, const ImageView &conf,
+                      const ImageView &error, const PointCloudFilter &filter)
+{
+  if (disp.isBigEndian())
+  {
+    encodePointCloudT<PixelTraits<Coord3D_C16, true> >(data, f, t, scale, left, disp, conf,
+      error, filter);
+  }
+  else
+  {
+    encodePointCloudT<PixelTraits<Coord3D_C16, false> >(data, f, t, scale, left, disp, conf,
+      error, filter);
+  }
+}
+
+DecodedPointCloud decodePointCloud(const uint8_t *data, size_t size)
+{
+  if (size < rcp_header_size || memcmp(data, rcp_magic, 4) != 0)
+  {
+    throw std::invalid_argument("decodePointCloud(): Invalid header");
+  }
+
+  DecodedPointCloud ret;
+  ret.f=getDouble(data+4);
+  ret.t=getDouble(data+12);
+  ret.scale=getDouble(data+20);
+  uint32_t flags=get32(data+28);
+
+  const uint8_t *p=data+rcp_header_size;
+  const uint8_t *end=data+size;
+
+  ret.disp=nextImage(p, end);
+  ret.color=nextImage(p, end);
+
+  if (flags & 1)
+  {
+    ret.conf=nextImage(p, end);
+  }
+
+  if (flags & 2)
+  {
+    ret.error=nextImage(p, end);
+  }
+
+  // check that all images fit together
+
+  const size_t width=ret.disp->getWidth();
+  const size_t height=ret.disp->getHeight();
+
+  if (ret.disp->getPixelFormat() != Coord3D_C16 || ret.color->getPixelFormat() != RGB8 ||
+      ret.color->getWidth() != width || ret.color->getHeight() != height ||
+      (ret.conf && (ret.conf->getWidth() != width || ret.conf->getHeight() != height)) ||
+      (ret.error && (ret.error->getWidth() != width || ret.error->getHeight() != height)))
+  {
+    throw std::invalid_argument("decodePointCloud(): Images do not fit together");
+  }
+
+  return ret;
+}
+
+void disparityToDepth(float *depth, const ImageView &disp, const DepthParameter &param,
+                      const ImageView &conf)
+{
+  DepthMeterOp op;
+  op.depth=depth;
+
+  computeDepth(disp, param, conf, op);
+}
+
+void disparityToDepth(uint16_t *depth, const ImageView &disp, const DepthParameter &param,
+                      const ImageView &conf)
+{
+  DepthMillimeterOp op;
+  op.depth=depth;
+
+  computeDepth(disp, param, conf, op);
 }
 
 }
@@ -39,35 +39,220 @@
 #include "image.h"
 
 #include <string>
+#include <vector>
 #include <memory>
 
 namespace rcg
 {
 
+/**
+  Criteria for dropping points while computing point clouds. Dropped points
+  are neither computed nor stored and are not part of any triangle.
+
+  If a voxel size is given, the remaining points are reduced to one point per
+  occupied voxel, which is the centroid of all points in this voxel with their
+  average color, confidence and error. No triangles are stored in this case.
+*/
+
+struct PointCloudFilter
+{
+  PointCloudFilter() : min_conf(0), max_error(0), min_z(0), max_z(0), voxel_size(0) { }
+
+  double min_conf;   // minimum confidence from 0 to 1, if a confidence image is given
+  double max_error;  // maximum error in m along the line of sight, if an error image is given, or 0
+  double min_z;      // minimum distance in m or 0
+  double max_z;      // maximum distance in m or 0
+  double voxel_size; // edge length of voxels in m for downsampling or 0
+};
+
+/**
+  Parameters for estimating surface normals of point clouds. Since the points
+  are organized like the pixels of the disparity image, the normal of each
+  point is computed from all valid points in a square window around its pixel
+  by integral images in constant time per point. The normal is the direction
+  of least variance of these points and points towards the camera. Normals
+  are undefined, i.e. 0, if less than 3 points are in the window or if the
+  points are on a line.
+*/
+
+struct NormalParameter
+{
+  NormalParameter() : radius(0), threads(1) { }
+
+  int radius;  // radius of the window in pixels of the disparity image, or 0 for no normals
+  int threads; // number of threads for computing normals of horizontal bands in parallel
+};
+
+/**
+  File formats for storing point clouds.
+*/
+
+enum PointCloudFmt
+{
+  PLY, // ASCII PLY with optional triangles
+  PCD, // binary PCD as used by PCL, without triangles
+  RCP  // compressed format of encodePointCloud()
+};
+
 /*
   Computes a point cloud from the given synchronized left and disparity image
-  pair and stores it in ply ascii format.
+  pair and stores it in ply ascii format or in the given format.
 
   @param name    Name of output file. If empty, a standard file name with
                  timestamp is used.
   @param f       Focal length factor (to be multiplicated with image width).
   @param t       Baseline in m.
   @param scale   Disparity scale factor.
-  @param left    Left camera image. The image must have format Mono8 or
-                 YCbCr411_8.
+  @param left    Left camera image. Supported formats are Mono8, RGB8,
+                 YCbCr411_8, YCbCr422_8, YUV422_8 and bayer formats with 8
+                 bit, as well as monochrome and bayer formats with 10, 12 and
+                 16 bit, packed or unpacked (see getColorImage()). Points get
+                 black color for other formats.
   @param disp    Corresponding disparity image, possibly downscaled by an
                  integer factor. The image must be in format Coord3D_C16.
   @param conf    Optional corresponding confidence image in the same size as
                  disp. The image must be in format Confidence8.
   @param error   Optional corresponding error image in the same size as disp.
                  The image must be in format Error8.
+  @param filter  Criteria for dropping points.
+  @param normal  Parameters for optionally computing normals, which are stored
+                 as nx, ny and nz in PLY and normal_x, normal_y and normal_z in
+                 PCD format. Normals are not stored in RCP format.
+  @param fmt     File format.
+
+  An exception is thrown if the file cannot be created or written.
 */
 
 void storePointCloud(std::string name, double f, double t, double scale,
                      std::shared_ptr<const Image> left,
                      std::shared_ptr<const Image> disp,
                      std::shared_ptr<const Image> conf=0,
-                     std::shared_ptr<const Image> error=0);
+                     std::shared_ptr<const Image> error=0,
+                     const PointCloudFilter &filter=PointCloudFilter(),
+                     const NormalParameter &normal=NormalParameter(),
+                     PointCloudFmt fmt=PLY);
+
+/*
+  Same as above, but for views onto images, e.g. regions of interest. Empty
+  views can be given for the optional confidence and error images.
+*/
+
+void storePointCloud(const std::string &name, double f, double t, double scale,
+                     const ImageView &left, const ImageView &disp,
+                     const ImageView &conf=ImageView(), const ImageView &error=ImageView(),
+                     const PointCloudFilter &filter=PointCloudFilter(),
+                     const NormalParameter &normal=NormalParameter(),
+                     PointCloudFmt fmt=PLY);
+
+/**
+  Compresses the point cloud of the given synchronized left and disparity
+  image pair and appends it to the given vector. Instead of coordinates, the
+  disparity image is stored, in which all points that are dropped by the
+  filter are invalid. Thus, the coordinates are quantized to the disparity
+  grid and can be reconstructed exactly. The disparity image, the color of
+  each point and the optional confidence and error images are compressed
+  losslessly by encodeImage(), which predicts each value from its left and
+  upper neighbors.
+
+  NOTE: An exception that is based on std::exception is thrown if voxel grid
+  downsampling is requested, since voxels are not organized like pixels.
+
+  @param data   Vector to which the compressed point cloud is appended.
+  @param f      Focal length factor (to be multiplicated with image width).
+  @param t      Baseline in m.
+  @param scale  Disparity scale factor.
+  @param left   Left camera image.
+  @param disp   Corresponding disparity image, possibly downscaled by an
+                integer factor. The image must be in format Coord3D_C16.
+  @param conf   Optional confidence image in the same size as disp.
+  @param error  Optional error image in the same size as disp.
+  @param filter Criteria for dropping points.
+*/
+
+void encodePointCloud(std::vector<uint8_t> &data, double f, double t, double scale,
+                      const ImageView &left, const ImageView &disp,
+                      const ImageView &conf=ImageView(), const ImageView &error=ImageView(),
+                      const PointCloudFilter &filter=PointCloudFilter());
+
+/**
+  Point cloud that is decompressed by decodePointCloud(). The members can be
+  passed to storePointCloud() for storing the point cloud in another format.
+*/
+
+struct DecodedPointCloud
+{
+  DecodedPointCloud() : f(0), t(0), scale(0) { }
+
+  double f;                      // focal length factor
+  double t;                      // baseline in m
+  double scale;                  // disparity scale factor
+  std::shared_ptr<Image> color;  // RGB8 image in the size of the disparity image
+  std::shared_ptr<Image> disp;   // Coord3D_C16 image with dropped points set to 0
+  std::shared_ptr<Image> conf;   // optional Confidence8 image or 0
+  std::shared_ptr<Image> error;  // optional Error8 image or 0
+};
+
+/**
+  Decompresses a point cloud that has been compressed by encodePointCloud().
+
+  NOTE: An exception that is based on std::exception is thrown if the data is
+  invalid.
+
+  @param data Pointer to compressed data.
+  @param size Number of bytes of compressed data.
+  @return     Decompressed point cloud.
+*/
+
+DecodedPointCloud decodePointCloud(const uint8_t *data, size_t size);
+
+/**
+  Parameters for computing depth from disparity images. The values
+  correspond to the ChunkScan3d parameters of the disparity component.
+*/
+
+struct DepthParameter
+{
+  DepthParameter() : f(0), t(0), scale(1), offset(0), inv(-1), min_conf(0) { }
+
+  double f;        // focal length in pixels of the disparity image, i.e. ChunkScan3dFocalLength
+  double t;        // baseline in m, i.e. ChunkScan3dBaseline
+  double scale;    // disparity scale, i.e. ChunkScan3dCoordinateScale
+  double offset;   // disparity offset, i.e. ChunkScan3dCoordinateOffset
+  int inv;         // invalid value, i.e. ChunkScan3dInvalidDataValue, or -1 if not available
+  double min_conf; // minimum confidence from 0 to 1, if a confidence image is given
+};
+
+/**
+  Converts a disparity image into a depth image in meters, i.e.
+  z=f*t/(scale*d+offset). Disparities with the invalid value, disparities that
+  do not give a positive depth and pixels with a confidence below the
+  minimum confidence are invalid and set to NaN.
+
+  NOTE: An exception that is based on std::exception is thrown if the format
+  of the disparity image is not Coord3D_C16 or if the confidence image does
+  not fit.
+
+  @param depth Target array of size width*height.
+  @param disp  Disparity image in format Coord3D_C16.
+  @param param Parameters for computing depth.
+  @param conf  Optional corresponding confidence image in format Confidence8.
+*/
+
+void disparityToDepth(float *depth, const ImageView &disp, const DepthParameter &param,
+                      const ImageView &conf=ImageView());
+
+/**
+  Same as above, but the depth is given in millimeters. Invalid pixels and
+  pixels with a depth of 65535 mm or more are set to 0.
+
+  @param depth Target array of size width*height.
+  @param disp  Disparity image in format Coord3D_C16.
+  @param param Parameters for computing depth.
+  @param conf  Optional corresponding confidence image in format Confidence8.
+*/
+
+void disparityToDepth(uint16_t *depth, const ImageView &disp, const DepthParameter &param,
+                      const ImageView &conf=ImageView());
 
 }
 
@@ -0,0 +1,1276 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "recording.h"
+#include "image_codec.h"
+#include "pixel_formats.h"
+
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+
+#ifdef _WIN32
+#include <Windows.h>
+#undef min
+#undef max
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#endif
+
+namespace rcg
+{
+
+namespace
+{
+
+class IOException : public std::exception
+{
+  public:
+
+    IOException(const std::string &_msg) { msg=_msg; }
+    virtual const char *what() const noexcept { return msg.c_str(); }
+
+  private:
+
+    std::string msg;
+};
+
+const uint8_t file_magic[8]={'R', 'C', 'R', 'E', 'C', 0, 0, 1};
+const uint8_t frame_magic[4]={'R', 'C', 'F', 'R'};
+const uint8_t index_magic[8]={'R', 'C', 'I', 'X', 0, 0, 0, 1};
+
+const size_t frame_header_size=32;
+const size_t part_header_size=40;
+
+// size of blocks for writing, which is a multiple of typical file system
+// block sizes
+
+const size_t block_size=4*1024*1024;
+
+inline uint8_t *put32(uint8_t *p, uint32_t v)
+{
+  p[0]=static_cast<uint8_t>(v);
+  p[1]=static_cast<uint8_t>(v>>8);
+  p[2]=static_cast<uint8_t>(v>>16);
+  p[3]=static_cast<uint8_t>(v>>24);
+
+  return p+4;
+}
+
+inline uint8_t *put64(uint8_t *p, uint64_t v)
+{
+  put32(p, static_cast<uint32_t>(v));
+  put32(p+4, static_cast<uint32_t>(v>>32));
+
+  return p+8;
+}
+
+inline uint32_t get32(const uint8_t *p)
+{
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1])<<8) |
+    (static_cast<uint32_t>(p[2])<<16) | (static_cast<uint32_t>(p[3])<<24);
+}
+
+inline uint64_t get64(const uint8_t *p)
+{
+  return static_cast<uint64_t>(get32(p)) | (static_cast<uint64_t>(get32(p+4))<<32);
+}
+
+inline size_t pad8(size_t n)
+{
+  return (8-(n&7))&7;
+}
+
+inline size_t getRowSize(const Image &image)
+{
+  return (image.getWidth()*((image.getPixelFormat()>>16)&0xff)+7)/8;
+}
+
+}
+
+RecordingWriter::RecordingWriter(const std::string &_name, bool _compress,
+  uint64_t _prealloc) : name(_name), compress(_compress), prealloc(_prealloc)
+{
+#ifndef __linux__
+  prealloc=0;
+#endif
+
+  file=fopen(name.c_str(), "wb");
+
+  if (file == 0)
+  {
+    throw IOException("Cannot create file: "+name);
+  }
+
+  // buffering is done in large blocks by this class
+
+  setvbuf(file, 0, _IONBF, 0);
+
+  block.resize(block_size);
+  block_n=0;
+  written=0;
+  allocated=0;
+
+  uint8_t header[16];
+  memcpy(header, file_magic, 8);
+  memset(header+8, 0, 8);
+
+  append(header, sizeof(header));
+}
+
+RecordingWriter::~RecordingWriter()
+{
+  try
+  {
+    close();
+  }
+  catch (const std::exception &)
+  { }
+}
+
+void RecordingWriter::write(uint64_t timestamp, uint64_t frameid,
+  const std::vector<RecordingPart> &part)
+{
+  // compress images and create headers before locking, so that this can be
+  // done in parallel
+
+  std::vector<std::vector<uint8_t> > data(part.size());
+  std::vector<uint8_t> header(frame_header_size+part_header_size*part.size());
+  uint64_t size=header.size();
+
+  uint8_t *p=header.data()+frame_header_size;
+  for (size_t i=0; i<part.size(); i++)
+  {
+    const Image &image=*part[i].image;
+
+    size_t yoffset=std::min(part[i].yoffset, image.getHeight());
+    size_t height=image.getHeight()-yoffset;
+
+    if (part[i].height > 0) height=std::min(height, part[i].height);
+
+    uint32_t flags=0;
+    uint64_t dsize;
+
+    if (compress && isEncodingSupported(image.getPixelFormat()))
+    {
+      encodeImage(data[i], image, yoffset, height);
+      dsize=data[i].size();
+      flags|=2;
+    }
+    else
+    {
+      dsize=static_cast<uint64_t>(getRowSize(image))*height;
+      if (image.isBigEndian()) flags|=1;
+    }
+
+    p=put64(p, image.getPixelFormat());
+    p=put32(p, static_cast<uint32_t>(image.getWidth()));
+    p=put32(p, static_cast<uint32_t>(height));
+    p=put32(p, flags);
+    p=put32(p, static_cast<uint32_t>(part[i].component.size()));
+    p=put32(p, static_cast<uint32_t>(part[i].param.size()));
+    p=put32(p, 0);
+    p=put64(p, dsize);
+
+    size_t n=part[i].component.size()+part[i].param.size();
+    size+=n+pad8(n)+dsize+pad8(dsize);
+  }
+
+  p=header.data();
+  memcpy(p, frame_magic, 4);
+  put32(p+4, static_cast<uint32_t>(part.size()));
+  put64(p+8, size);
+  put64(p+16, timestamp);
+  put64(p+24, frameid);
+
+  // append frame record
+
+  std::lock_guard<std::mutex> lock(mtx);
+
+  if (file == 0)
+  {
+    throw IOException("Recording is already closed: "+name);
+  }
+
+  IndexEntry entry;
+  entry.offset=written+block_n;
+  entry.timestamp=timestamp;
+  entry.frameid=frameid;
+
+  append(header.data(), header.size());
+
+  const uint8_t zero[8]={0, 0, 0, 0, 0, 0, 0, 0};
+
+  for (size_t i=0; i<part.size(); i++)
+  {
+    const std::string &component=part[i].component;
+    const std::string &param=part[i].param;
+
+    append(reinterpret_cast<const uint8_t *>(component.data()), component.size());
+    append(reinterpret_cast<const uint8_t *>(param.data()), param.size());
+    append(zero, pad8(component.size()+param.size()));
+
+    uint64_t dsize;
+
+    if (data[i].size() > 0)
+    {
+      dsize=data[i].size();
+      append(data[i].data(), data[i].size());
+    }
+    else
+    {
+      // store rows of pixels without padding
+
+      const Image &image=*part[i].image;
+
+      size_t yoffset=std::min(part[i].yoffset, image.getHeight());
+      size_t height=image.getHeight()-yoffset;
+
+      if (part[i].height > 0) height=std::min(height, part[i].height);
+
+      size_t rsize=getRowSize(image);
+      size_t lstep=rsize+image.getXPadding();
+      const uint8_t *s=image.getPixels()+yoffset*lstep;
+
+      if (image.getXPadding() == 0)
+      {
+        append(s, rsize*height);
+      }
+      else
+      {
+        for (size_t k=0; k<height; k++)
+        {
+          append(s, rsize);
+          s+=lstep;
+        }
+      }
+
+      dsize=static_cast<uint64_t>(rsize)*height;
+    }
+
+    append(zero, pad8(static_cast<size_t>(dsize)));
+  }
+
+  index.push_back(entry);
+}
+
+void RecordingWriter::close()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+
+  if (file != 0)
+  {
+    // append index and footer
+
+    uint64_t offset=written+block_n;
+
+    std::vector<uint8_t> tmp(24*index.size()+24);
+    uint8_t *p=tmp.data();
+
+    for (size_t i=0; i<index.size(); i++)
+    {
+      p=put64(p, index[i].offset);
+      p=put64(p, index[i].timestamp);
+      p=put64(p, index[i].frameid);
+    }
+
+    p=put64(p, offset);
+    p=put64(p, index.size());
+    memcpy(p, index_magic, 8);
+
+    bool ok=true;
+
+    try
+    {
+      append(tmp.data(), tmp.size());
+      flush();
+    }
+    catch (const std::exception &)
+    {
+      ok=false;
+    }
+
+#ifdef __linux__
+    // release the unused, preallocated part of the file
+
+    if (allocated > written)
+    {
+      if (ftruncate(fileno(file), static_cast<off_t>(written)) != 0) ok=false;
+    }
+#endif
+
+    if (fclose(file) != 0) ok=false;
+
+    file=0;
+
+    if (!ok)
+    {
+      throw IOException("Cannot write file: "+name);
+    }
+  }
+}
+
+size_t RecordingWriter::getFrameCount()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return index.size();
+}
+
+uint64_t RecordingWriter::getSize()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return written+block_n;
+}
+
+void RecordingWriter::append(const uint8_t *p, size_t n)
+{
+  while (n > 0)
+  {
+    if (block_n == 0 && n >= block.size())
+    {
+      // write full blocks directly without copying, which keeps all writes
+      // aligned to the block size
+
+      size_t m=n-n%block.size();
+
+      writeFile(p, m);
+
+      p+=m;
+      n-=m;
+    }
+    else
+    {
+      size_t m=std::min(n, block.size()-block_n);
+
+      memcpy(block.data()+block_n, p, m);
+
+      block_n+=m;
+      p+=m;
+      n-=m;
+
+      if (block_n == block.size())
+      {
+        flush();
+      }
+    }
+  }
+}
+
+void RecordingWriter::flush()
+{
+  if (block_n > 0)
+  {
+    writeFile(block.data(), block_n);
+    block_n=0;
+  }
+}
+
+void RecordingWriter::writeFile(const uint8_t *p, size_t n)
+{
+#ifdef __linux__
+  // extend the file in large steps for reducing fragmentation and meta data
+  // updates
+
+  while (prealloc > 0 && written+n > allocated)
+  {
+    if (posix_fallocate(fileno(file), static_cast<off_t>(allocated),
+        static_cast<off_t>(prealloc)) != 0)
+    {
+      // preallocation is not supported by all file systems
+
+      prealloc=0;
+    }
+    else
+    {
+      allocated+=prealloc;
+    }
+  }
+#endif
+
+  if (fwrite(p, 1, n, file) != n)
+  {
+    throw IOException("Cannot write file: "+name);
+  }
+
+  written+=n;
+}
+
+class RecordingReader::MappedFile
+{
+  public:
+
+    MappedFile(const std::string &name, bool sequential)
+    {
+      data=0;
+      size=0;
+
+#ifdef _WIN32
+      map=0;
+      file=CreateFileA(name.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+        sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS, 0);
+
+      LARGE_INTEGER n;
+      if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &n))
+      {
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        throw IOException("Cannot open file: "+name);
+      }
+
+      size=static_cast<size_t>(n.QuadPart);
+
+      if (size > 0)
+      {
+        map=CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+
+        if (map != 0)
+        {
+          data=static_cast<const uint8_t *>(MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0));
+        }
+
+        if (data == 0)
+        {
+          if (map != 0) CloseHandle(map);
+          CloseHandle(file);
+          throw IOException("Cannot map file: "+name);
+        }
+      }
+#else
+      int fd=open(name.c_str(), O_RDONLY);
+
+      struct stat st;
+      if (fd < 0 || fstat(fd, &st) != 0)
+      {
+        if (fd >= 0) ::close(fd);
+        throw IOException("Cannot open file: "+name);
+      }
+
+      size=static_cast<size_t>(st.st_size);
+
+      if (size > 0)
+      {
+        void *p=mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+
+        if (p == MAP_FAILED)
+        {
+          ::close(fd);
+          throw IOException("Cannot map file: "+name);
+        }
+
+        data=static_cast<const uint8_t *>(p);
+
+        // a larger read ahead window is used for sequential access
+
+        madvise(p, size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+      }
+
+      // the mapping stays valid after closing the file
+
+      ::close(fd);
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifdef _WIN32
+      if (data != 0) UnmapViewOfFile(data);
+      if (map != 0) CloseHandle(map);
+      CloseHandle(file);
+#else
+      if (data != 0) munmap(const_cast<uint8_t *>(data), size);
+#endif
+    }
+
+    const uint8_t *getData() const { return data; }
+    size_t getSize() const { return size; }
+
+    /*
+      Advises the operating system that the given range will be needed soon.
+    */
+
+    void prefetch(size_t offset, size_t n)
+    {
+#ifndef _WIN32
+      if (offset < size)
+      {
+        n=std::min(n, size-offset);
+
+        // madvise() expects an address that is aligned to the page size
+
+        size_t page=static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t a=offset-offset%page;
+
+        madvise(const_cast<uint8_t *>(data)+a, offset+n-a, MADV_WILLNEED);
+      }
+#else
+      (void) offset;
+      (void) n;
+#endif
+    }
+
+  private:
+
+    MappedFile(const MappedFile &); // forbidden
+    MappedFile &operator=(const MappedFile &); // forbidden
+
+    const uint8_t *data;
+    size_t size;
+
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE map;
+#endif
+};
+
+namespace
+{
+
+/*
+  Returns true if the given string ends with the given suffix.
+*/
+
+inline bool endsWith(const std::string &s, const std::string &suffix)
+{
+  return s.size() >= suffix.size() && s.compare(s.size()-suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/*
+  Removes the status of digital inputs and outputs, i.e. _<out>_<in> with
+  one digit per line, that is appended by gc_stream to the component name.
+*/
+
+std::string removeDigitalIO(const std::string &component)
+{
+  size_t n=component.size();
+
+  for (int k=0; k<2; k++)
+  {
+    size_t i=component.rfind('_', n-1);
+
+    if (i == std::string::npos || i == 0 || i+1 >= n ||
+        component.find_first_not_of("01", i+1) < n)
+    {
+      return component;
+    }
+
+    n=i;
+  }
+
+  return component.substr(0, n);
+}
+
+/*
+  Parses a file name as created by gc_stream, i.e.
+  [<session>-<counter>_]image_<sec>.<nsec>[_<component>[_<out>_<in>]]<suffix>,
+  with an optional prefix from FileNameGenerator. A path before the name is
+  ignored. False is returned if the name does not match or the suffix is not
+  supported.
+*/
+
+bool parseFileName(std::string name, uint64_t &timestamp, std::string &component,
+  std::string &suffix)
+{
+  size_t i=name.find_last_of("/\\");
+
+  if (i != std::string::npos)
+  {
+    name=name.substr(i+1);
+  }
+
+  if (name.compare(0, 6, "image_") != 0)
+  {
+    size_t k=name.find('-');
+    i=name.find('_');
+
+    if (k == std::string::npos || i == std::string::npos || k == 0 ||
+        name.find_first_not_of("0123456789abcdef") != k ||
+        name.find_first_not_of("0123456789", k+1) != i)
+    {
+      return false;
+    }
+
+    name=name.substr(i+1);
+
+    if (name.compare(0, 6, "image_") != 0)
+    {
+      return false;
+    }
+  }
+
+  i=name.find('.', 6);
+
+  if (i == std::string::npos || i == 6 || name.size() < i+10 ||
+      name.find_first_not_of("0123456789", 6) != i ||
+      name.find_first_not_of("0123456789", i+1) != i+10)
+  {
+    return false;
+  }
+
+  timestamp=std::strtoull(name.substr(6, i-6).c_str(), 0, 10)*1000000000ull+
+    std::strtoull(name.substr(i+1, 9).c_str(), 0, 10);
+
+  const char *supported[]={"_param.txt", ".pgm", ".ppm", ".pfm"};
+
+  suffix.clear();
+  for (const char *s : supported)
+  {
+    if (endsWith(name, s))
+    {
+      suffix=s;
+      break;
+    }
+  }
+
+  if (suffix.size() == 0 || name.size() < i+10+suffix.size())
+  {
+    return false;
+  }
+
+  component=name.substr(i+10, name.size()-i-10-suffix.size());
+
+  if (component.size() > 0)
+  {
+    if (component[0] != '_')
+    {
+      return false;
+    }
+
+    component=removeDigitalIO(component.substr(1));
+  }
+
+  return true;
+}
+
+/*
+  Parses the header of a PNM or PFM file, i.e. the two magic characters,
+  followed by the given number of values, which are separated by white space
+  or comments. Exactly one white space character follows the last value. The
+  offset of the data is returned or 0 in case of an error.
+*/
+
+size_t parsePNMHeader(const uint8_t *p, size_t size, std::string &magic,
+  std::vector<std::string> &value, size_t n)
+{
+  if (size < 3 || p[0] != 'P')
+  {
+    return 0;
+  }
+
+  magic=std::string(reinterpret_cast<const char *>(p), 2);
+  value.clear();
+
+  size_t i=2;
+  while (value.size() < n)
+  {
+    while (i < size && (isspace(p[i]) || p[i] == '#'))
+    {
+      if (p[i] == '#')
+      {
+        while (i < size && p[i] != '\n') i++;
+      }
+      else
+      {
+        i++;
+      }
+    }
+
+    size_t k=i;
+    while (i < size && !isspace(p[i]) && p[i] != '#') i++;
+
+    if (i == k)
+    {
+      return 0;
+    }
+
+    value.push_back(std::string(reinterpret_cast<const char *>(p+k), i-k));
+  }
+
+  if (i >= size || !isspace(p[i]))
+  {
+    return 0;
+  }
+
+  return i+1;
+}
+
+/*
+  Creates an image from a memory mapped PNM or PFM file. The given pointer
+  must refer to the beginning of the mapped file. The pixel format is derived
+  from the component name, since PNM files do not distinguish e.g.
+  intensity, confidence and error images. 0 is returned if the file is
+  not supported.
+*/
+
+std::shared_ptr<const Image> createImageFromPNM(const std::shared_ptr<const uint8_t> &base,
+  size_t size, const std::string &component, uint64_t timestamp)
+{
+  const uint8_t *p=base.get();
+
+  std::string magic;
+  std::vector<std::string> value;
+  size_t offset=parsePNMHeader(p, size, magic, value, 3);
+
+  if (offset == 0)
+  {
+    return std::shared_ptr<const Image>();
+  }
+
+  long width=std::strtol(value[0].c_str(), 0, 10);
+  long height=std::strtol(value[1].c_str(), 0, 10);
+
+  if (width <= 0 || height <= 0)
+  {
+    return std::shared_ptr<const Image>();
+  }
+
+  size_t w=static_cast<size_t>(width);
+  size_t h=static_cast<size_t>(height);
+
+  if (magic == "P5" || magic == "P6")
+  {
+    long maxval=std::strtol(value[2].c_str(), 0, 10);
+    uint64_t format;
+
+    if (magic == "P6")
+    {
+      format=RGB8;
+
+      if (maxval > 255)
+      {
+        return std::shared_ptr<const Image>();
+      }
+    }
+    else if (maxval > 255)
+    {
+      format=Mono16;
+      if (component.compare(0, 9, "Disparity") == 0) format=Coord3D_C16;
+    }
+    else
+    {
+      format=Mono8;
+      if (component == "Confidence") format=Confidence8;
+      if (component == "Error") format=Error8;
+    }
+
+    size_t bpp=(format>>16)&0xff;
+
+    if ((size-offset)/h < w*bpp/8)
+    {
+      return std::shared_ptr<const Image>();
+    }
+
+    // pixels of PNM files are always big endian
+
+    return std::make_shared<Image>(std::shared_ptr<const uint8_t>(base, p+offset), w, h, 0,
+      format, true, timestamp);
+  }
+  else if (magic == "Pf")
+  {
+    // rows of PFM files are stored bottom up and must therefore be copied,
+    // which is combined with conversion into the byte order of the host
+
+    bool bigendian=std::strtod(value[2].c_str(), 0) > 0;
+
+    if ((size-offset)/h < w*4)
+    {
+      return std::shared_ptr<const Image>();
+    }
+
+    bool msbfirst;
+
+    {
+      int pp=1;
+      char *cc=reinterpret_cast<char *>(&pp);
+      msbfirst=(cc[0] != 1);
+    }
+
+    std::shared_ptr<uint8_t> pixel(new uint8_t [w*h*4], std::default_delete<uint8_t []>());
+
+    for (size_t k=0; k<h; k++)
+    {
+      uint8_t *t=pixel.get()+4*w*k;
+      const uint8_t *s=p+offset+4*w*(h-1-k);
+
+      if (bigendian == msbfirst)
+      {
+        memcpy(t, s, 4*w);
+      }
+      else
+      {
+        for (size_t i=0; i<4*w; i+=4)
+        {
+          t[i]=s[i+3];
+          t[i+1]=s[i+2];
+          t[i+2]=s[i+1];
+          t[i+3]=s[i];
+        }
+      }
+    }
+
+    return std::make_shared<Image>(std::shared_ptr<const uint8_t>(pixel), w, h, 0,
+      Coord3D_C32f, msbfirst, timestamp);
+  }
+
+  return std::shared_ptr<const Image>();
+}
+
+bool isDirectory(const std::string &name)
+{
+#ifdef _WIN32
+  DWORD attr=GetFileAttributesA(name.c_str());
+  return attr != INVALID_FILE_ATTRIBUTES && (attr & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+  struct stat st;
+  return stat(name.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+}
+
+/*
+  Returns the names of all files and subdirectories in the given directory.
+*/
+
+void listDirectory(std::vector<std::string> &file, std::vector<std::string> &subdir,
+  const std::string &dir)
+{
+  file.clear();
+  subdir.clear();
+
+#ifdef _WIN32
+  WIN32_FIND_DATAA data;
+  HANDLE p=FindFirstFileA((dir+"\\*").c_str(), &data);
+
+  if (p == INVALID_HANDLE_VALUE)
+  {
+    throw IOException("Cannot open directory: "+dir);
+  }
+
+  do
+  {
+    std::string name=data.cFileName;
+
+    if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+    {
+      file.push_back(name);
+    }
+    else if (name != "." && name != "..")
+    {
+      subdir.push_back(name);
+    }
+  }
+  while (FindNextFileA(p, &data));
+
+  FindClose(p);
+#else
+  DIR *p=opendir(dir.c_str());
+
+  if (p == 0)
+  {
+    throw IOException("Cannot open directory: "+dir);
+  }
+
+  struct dirent *entry=readdir(p);
+
+  while (entry != 0)
+  {
+    std::string name=entry->d_name;
+
+    if (name != "." && name != "..")
+    {
+      if (isDirectory(dir+"/"+name))
+      {
+        subdir.push_back(name);
+      }
+      else
+      {
+        file.push_back(name);
+      }
+    }
+
+    entry=readdir(p);
+  }
+
+  closedir(p);
+#endif
+}
+
+}
+
+RecordingReader::RecordingReader(const std::string &_name, bool _sequential) :
+  name(_name), sequential(_sequential)
+{
+  if (isDirectory(name))
+  {
+    openDirectory();
+  }
+  else
+  {
+    openFile();
+  }
+}
+
+RecordingReader::~RecordingReader()
+{ }
+
+uint64_t RecordingReader::getTimestampNS(size_t i) const
+{
+  if (i >= frame.size())
+  {
+    throw std::invalid_argument("RecordingReader::getTimestampNS(): Index out of range");
+  }
+
+  return frame[i].timestamp;
+}
+
+void RecordingReader::read(RecordingFrame &ret, size_t i)
+{
+  if (i >= frame.size())
+  {
+    throw std::invalid_argument("RecordingReader::read(): Index out of range");
+  }
+
+  const FrameEntry &entry=frame[i];
+
+  ret.timestamp=entry.timestamp;
+  ret.frameid=entry.frameid;
+  ret.part.clear();
+
+  if (mapping)
+  {
+    // parse frame record, the size of which has been checked on opening
+
+    const uint8_t *p=mapping->getData()+entry.offset;
+    const uint64_t n=get64(p+8);
+    const size_t npart=get32(p+4);
+
+    if ((n-frame_header_size)/part_header_size < npart)
+    {
+      throw IOException("Invalid frame in recording: "+name);
+    }
+
+    uint64_t k=frame_header_size+part_header_size*npart;
+
+    for (size_t j=0; j<npart; j++)
+    {
+      const uint8_t *h=p+frame_header_size+part_header_size*j;
+
+      uint64_t format=get64(h);
+      size_t width=get32(h+8);
+      size_t height=get32(h+12);
+      uint32_t flags=get32(h+16);
+      size_t cl=get32(h+20);
+      size_t pl=get32(h+24);
+      uint64_t dsize=get64(h+32);
+
+      if (n-k < cl+pl)
+      {
+        throw IOException("Invalid frame in recording: "+name);
+      }
+
+      RecordingPart part;
+
+      part.component=std::string(reinterpret_cast<const char *>(p+k), cl);
+      part.param=std::string(reinterpret_cast<const char *>(p+k+cl), pl);
+
+      k+=cl+pl+pad8(cl+pl);
+
+      if (k > n || n-k < dsize)
+      {
+        throw IOException("Invalid frame in recording: "+name);
+      }
+
+      if (flags & 2)
+      {
+        part.image=decodeImage(p+k, static_cast<size_t>(dsize));
+      }
+      else
+      {
+        size_t rsize=(width*((format>>16)&0xff)+7)/8;
+
+        if (height > 0 && dsize/height < rsize)
+        {
+          throw IOException("Invalid frame in recording: "+name);
+        }
+
+        // the image points into the mapping and keeps it alive
+
+        part.image=std::make_shared<Image>(std::shared_ptr<const uint8_t>(mapping, p+k),
+          width, height, 0, format, (flags & 1) != 0, entry.timestamp, entry.frameid);
+      }
+
+      k+=dsize+pad8(static_cast<size_t>(dsize));
+
+      ret.part.push_back(part);
+    }
+  }
+  else
+  {
+    // read all files of the frame
+
+    std::map<std::string, std::string> param;
+
+    for (size_t j=0; j<entry.file.size(); j++)
+    {
+      uint64_t timestamp;
+      std::string component, suffix;
+
+      parseFileName(entry.file[j], timestamp, component, suffix);
+
+      std::string full_name=name+"/"+entry.file[j];
+
+      if (suffix == "_param.txt")
+      {
+        std::ifstream in(full_name);
+        std::stringstream text;
+        text << in.rdbuf();
+
+        param[component]=text.str();
+      }
+      else
+      {
+        std::shared_ptr<MappedFile> file=std::make_shared<MappedFile>(full_name, sequential);
+
+        RecordingPart part;
+
+        part.component=component;
+        part.image=createImageFromPNM(std::shared_ptr<const uint8_t>(file, file->getData()),
+          file->getSize(), component, entry.timestamp);
+
+        if (part.image)
+        {
+          ret.part.push_back(part);
+        }
+      }
+    }
+
+    for (size_t j=0; j<ret.part.size(); j++)
+    {
+      std::map<std::string, std::string>::const_iterator it=param.find(ret.part[j].component);
+
+      if (it != param.end())
+      {
+        ret.part[j].param=it->second;
+      }
+    }
+  }
+
+  if (sequential)
+  {
+    prefetch(i+1);
+  }
+}
+
+void RecordingReader::prefetch(size_t i, size_t n)
+{
+  if (i >= frame.size())
+  {
+    return;
+  }
+
+  n=std::min(n, frame.size()-i);
+
+  if (mapping)
+  {
+    uint64_t start=frame[i].offset;
+    uint64_t end=mapping->getSize();
+
+    if (i+n < frame.size())
+    {
+      end=frame[i+n].offset;
+    }
+
+    if (end > start)
+    {
+      mapping->prefetch(static_cast<size_t>(start), static_cast<size_t>(end-start));
+    }
+  }
+  else
+  {
+#if defined(__linux__)
+    // files of a directory are only mapped when they are read, but reading
+    // ahead can be triggered already
+
+    for (size_t k=i; k<i+n; k++)
+    {
+      for (size_t j=0; j<frame[k].file.size(); j++)
+      {
+        int fd=open((name+"/"+frame[k].file[j]).c_str(), O_RDONLY);
+
+        if (fd >= 0)
+        {
+          posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+          ::close(fd);
+        }
+      }
+    }
+#endif
+  }
+}
+
+void RecordingReader::openFile()
+{
+  mapping=std::make_shared<MappedFile>(name, sequential);
+
+  const uint8_t *p=mapping->getData();
+  const uint64_t size=mapping->getSize();
+
+  if (size < sizeof(file_magic)+8 || memcmp(p, file_magic, sizeof(file_magic)) != 0)
+  {
+    throw IOException("Invalid recording: "+name);
+  }
+
+  // use index at the end of the file if available
+
+  bool indexed=false;
+
+  if (size >= 16+24 && memcmp(p+size-8, index_magic, 8) == 0)
+  {
+    uint64_t offset=get64(p+size-24);
+    uint64_t n=get64(p+size-16);
+
+    if (offset >= 16 && offset <= size-24 && (size-24-offset)/24 == n &&
+        (size-24-offset)%24 == 0)
+    {
+      frame.resize(static_cast<size_t>(n));
+
+      indexed=true;
+      for (size_t i=0; i<frame.size() && indexed; i++)
+      {
+        const uint8_t *e=p+offset+24*i;
+
+        frame[i].offset=get64(e);
+        frame[i].timestamp=get64(e+8);
+        frame[i].frameid=get64(e+16);
+
+        // check that the frame record is inside the file
+
+        uint64_t k=frame[i].offset;
+
+        indexed=k >= 16 && k <= offset-frame_header_size &&
+          memcmp(p+k, frame_magic, 4) == 0 && get64(p+k+8) >= frame_header_size &&
+          get64(p+k+8) <= offset-k;
+      }
+    }
+  }
+
+  // otherwise, e.g. if recording has not been closed, find all frames by
+  // following the chain of frame records
+
+  if (!indexed)
+  {
+    frame.clear();
+
+    uint64_t k=16;
+    while (size-k >= frame_header_size && memcmp(p+k, frame_magic, 4) == 0)
+    {
+      uint64_t n=get64(p+k+8);
+
+      if (n < frame_header_size || n > size-k)
+      {
+        break;
+      }
+
+      FrameEntry entry;
+
+      entry.offset=k;
+      entry.timestamp=get64(p+k+16);
+      entry.frameid=get64(p+k+24);
+
+      frame.push_back(entry);
+
+      k+=n;
+    }
+  }
+}
+
+void RecordingReader::openDirectory()
+{
+  // get files of the directory and of its subdirectories, which are created
+  // by FileNameGenerator
+
+  std::vector<std::string> list, subdir;
+  listDirectory(list, subdir, name);
+
+  for (size_t i=0; i<subdir.size(); i++)
+  {
+    std::vector<std::string> sublist, tmp;
+    listDirectory(sublist, tmp, name+"/"+subdir[i]);
+
+    for (size_t k=0; k<sublist.size(); k++)
+    {
+      list.push_back(subdir[i]+"/"+sublist[k]);
+    }
+  }
+
+  // group all files by the timestamp that is encoded in their name
+
+  std::map<uint64_t, std::vector<std::string> > files;
+
+  for (size_t i=0; i<list.size(); i++)
+  {
+    uint64_t timestamp;
+    std::string component, suffix;
+
+    if (parseFileName(list[i], timestamp, component, suffix))
+    {
+      files[timestamp].push_back(list[i]);
+    }
+  }
+
+  for (std::map<uint64_t, std::vector<std::string> >::iterator it=files.begin();
+       it != files.end(); ++it)
+  {
+    FrameEntry entry;
+
+    entry.offset=0;
+    entry.timestamp=it->first;
+    entry.frameid=0;
+
+    std::sort(it->second.begin(), it->second.end());
+    entry.file.swap(it->second);
+
+    frame.push_back(entry);
+  }
+}
+
+}
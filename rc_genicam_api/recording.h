@@ -0,0 +1,315 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RC_GENICAM_API_RECORDING
+#define RC_GENICAM_API_RECORDING
+
+#include "image.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdio>
+
+namespace rcg
+{
+
+/**
+  One part of a recorded frame, i.e. an image together with the name of its
+  component and optional parameters, e.g. the chunk parameters of the buffer
+  as text of key=value lines.
+*/
+
+struct RecordingPart
+{
+  RecordingPart() : yoffset(0), height(0) { }
+
+  std::string component;
+  std::shared_ptr<const Image> image;
+  size_t yoffset, height;
+  std::string param;
+};
+
+/**
+  Writes frames, i.e. all image parts of a buffer, into one file that can be
+  read much faster than many small files and causes much less file system
+  overhead while recording.
+
+  The file is preallocated in large steps and written sequentially in large
+  blocks that are aligned to the file system block size. The file starts with
+  a header, followed by one record per frame. Each frame record contains a
+  header with timestamp, frame ID and the meta data of all parts, followed by
+  the component names, parameters and the pixel data of the parts. The pixel
+  data is stored either without padding or compressed by encodeImage() of
+  image_codec.h. An index with offset, timestamp and frame ID of all frames is
+  appended when the recording is closed. The index permits random access to
+  all frames. Without it, e.g. after a crash, frames can still be found by
+  reading the records sequentially.
+
+  All numbers are stored in little endian byte order:
+
+  file header:   "RCREC\0\0\1", 8 bytes reserved
+  frame record:  "RCFR", uint32 number of parts, uint64 size of record
+                 including header, uint64 timestamp, uint64 frame ID
+  part header:   uint64 pixel format, uint32 width, uint32 height, uint32
+                 flags (1: big endian, 2: compressed), uint32 length of
+                 component name, uint32 length of parameters, 4 bytes
+                 reserved, uint64 size of data
+  part data:     component name, parameters, zero padding to multiple of 8,
+                 data, zero padding to multiple of 8
+  index entry:   uint64 offset of frame record, uint64 timestamp, uint64 frame
+                 ID
+  file footer:   uint64 offset of index, uint64 number of frames, "RCIX\0\0\0\1"
+
+  The headers of all parts directly follow the frame header.
+
+  Writing is thread safe, i.e. frames can be compressed and written by
+  different threads in parallel. The order of frames in the file is then the
+  order in which they are passed to write().
+*/
+
+class RecordingWriter
+{
+  public:
+
+    /**
+      Creates the recording file.
+
+      NOTE: An exception that is based on std::exception is thrown if the file
+      cannot be created.
+
+      @param name     Name of file.
+      @param compress True for compressing images with encodeImage() if the
+                      pixel format is supported. Otherwise, the pixels are
+                      stored as they are.
+      @param prealloc Size of steps in which the file is preallocated. 0 for
+                      no preallocation. Preallocation is only available on
+                      Linux.
+    */
+
+    RecordingWriter(const std::string &name, bool compress=false,
+      uint64_t prealloc=256*1024*1024);
+
+    /**
+      Closes the recording if this has not been done before.
+    */
+
+    ~RecordingWriter();
+
+    /**
+      Writes a frame with the given parts.
+
+      NOTE: An exception that is based on std::exception is thrown if writing
+      fails.
+
+      @param timestamp Timestamp of the frame, e.g. of the buffer.
+      @param frameid   Frame ID.
+      @param part      Parts of the frame.
+    */
+
+    void write(uint64_t timestamp, uint64_t frameid, const std::vector<RecordingPart> &part);
+
+    /**
+      Writes all outstanding data and the index and closes the file. Nothing
+      can be written after closing.
+
+      NOTE: An exception that is based on std::exception is thrown if writing
+      fails.
+    */
+
+    void close();
+
+    /**
+      Returns the number of frames that have been written.
+
+      @return Number of frames.
+    */
+
+    size_t getFrameCount();
+
+    /**
+      Returns the number of bytes that have been written so far.
+
+      @return Number of bytes.
+    */
+
+    uint64_t getSize();
+
+  private:
+
+    RecordingWriter(const RecordingWriter &); // forbidden
+    RecordingWriter &operator=(const RecordingWriter &); // forbidden
+
+    void append(const uint8_t *p, size_t n);
+    void flush();
+    void writeFile(const uint8_t *p, size_t n);
+
+    struct IndexEntry
+    {
+      uint64_t offset;
+      uint64_t timestamp;
+      uint64_t frameid;
+    };
+
+    std::mutex mtx;
+    std::string name;
+    bool compress;
+    uint64_t prealloc;
+    FILE *file;
+
+    std::vector<uint8_t> block;
+    size_t block_n;
+    uint64_t written;
+    uint64_t allocated;
+
+    std::vector<IndexEntry> index;
+};
+
+/**
+  A frame as read from a recording.
+*/
+
+struct RecordingFrame
+{
+  RecordingFrame() : timestamp(0), frameid(0) { }
+
+  uint64_t timestamp;
+  uint64_t frameid;
+  std::vector<RecordingPart> part;
+};
+
+/**
+  Reads frames from a file that has been written by RecordingWriter or from a
+  directory with images in PNM format as stored by gc_stream. Subdirectories
+  and name prefixes as created by FileNameGenerator are supported.
+
+  Files are memory mapped and the returned images point directly into the
+  mapping without copying, except for compressed images, which are decoded,
+  and PFM images, which are stored bottom up. A mapping stays valid as long as
+  images that point into it exist, even if the reader is destroyed. Therefore,
+  images can be put into an ImageList or processed by all functions that
+  take images as input, e.g. storePointCloud().
+
+  In sequential mode, the operating system is advised to read ahead, which
+  is best for playing back frames in their order. Otherwise, prefetch() can be
+  used for giving hints about frames that will be needed soon.
+*/
+
+class RecordingReader
+{
+  public:
+
+    /**
+      Opens a recording.
+
+      NOTE: An exception that is based on std::exception is thrown if the file
+      or directory cannot be opened or if the file is invalid.
+
+      @param name       Name of file or directory.
+      @param sequential True if frames will mainly be read in their order.
+    */
+
+    RecordingReader(const std::string &name, bool sequential=true);
+
+    ~RecordingReader();
+
+    /**
+      Returns the number of frames of the recording.
+
+      @return Number of frames.
+    */
+
+    size_t getFrameCount() const { return frame.size(); }
+
+    /**
+      Returns the timestamp of the given frame without reading it.
+
+      @param i Index of frame.
+      @return  Timestamp in nanoseconds.
+    */
+
+    uint64_t getTimestampNS(size_t i) const;
+
+    /**
+      Reads the given frame. In sequential mode, reading ahead of the next
+      frame is requested.
+
+      NOTE: An exception that is based on std::exception is thrown if the index
+      is out of range or if the frame cannot be read.
+
+      @param ret Frame with all its parts.
+      @param i   Index of frame.
+    */
+
+    void read(RecordingFrame &ret, size_t i);
+
+    /**
+      Advises the operating system to read the given range of frames in the
+      background, so that they are available when needed.
+
+      @param i Index of first frame.
+      @param n Number of frames.
+    */
+
+    void prefetch(size_t i, size_t n=1);
+
+  private:
+
+    RecordingReader(const RecordingReader &); // forbidden
+    RecordingReader &operator=(const RecordingReader &); // forbidden
+
+    class MappedFile;
+
+    struct FrameEntry
+    {
+      uint64_t offset;
+      uint64_t timestamp;
+      uint64_t frameid;
+      std::vector<std::string> file;
+    };
+
+    void openFile();
+    void openDirectory();
+
+    std::string name;
+    bool sequential;
+    std::shared_ptr<MappedFile> mapping;
+    std::vector<FrameEntry> frame;
+};
+
+}
+
+#endif
@@ -45,8 +45,26 @@
 
 #include <rc_genicam_api/pixel_formats.h>
 
+#include "worker_queue.h"
+
 #include <Base/GCException.h>
 
+#include <signal.h>
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+
+#ifdef _WIN32
+#undef min
+#undef max
+#endif
+
 namespace
 {
 
@@ -58,13 +76,22 @@ void printHelp(const char *prgname)
 {
   // show help
 
-  std::cout << prgname << " -h | [-o <output-filename>] [<interface-id>:]<device-id> [<key>=<value>] ..." << std::endl;
+  std::cout << prgname << " -h | [-o <output-filename>] [-f <fmt>] [-c <conf>] [-e <error>] [-z <min>,<max>] [-v <size>] [-r <radius>] [-n <n>] [-p <n>] [-q <n>] [<interface-id>:]<device-id> [<key>=<value>] ..." << std::endl;
   std::cout << std::endl;
-  std::cout << "Gets the first synchronized image set of the Roboception rc_visard, consisting of left, disparity, confidence and error image, creates a point cloud and stores it in ply ascii format." << std::endl;
+  std::cout << "Gets the first synchronized image set of the Roboception rc_visard, consisting of left, disparity, confidence and error image, creates a point cloud and stores it in ply ascii format or the given format. In continuous mode, point clouds of all synchronized image sets are created and stored." << std::endl;
   std::cout << std::endl;
   std::cout << "Options:" << std::endl;
   std::cout << "-h        Prints help information and exits" << std::endl;
-  std::cout << "-o <file> Set name of output file (default is 'rc_visard_<timestamp>.ply')" << std::endl;
+  std::cout << "-o <file> Set name of output file (default is 'rc_visard_<timestamp>.<fmt>')" << std::endl;
+  std::cout << "-f <fmt>  Format of output file, i.e. ply, pcd (binary, as used by PCL) or rcp (compressed). Default is ply" << std::endl;
+  std::cout << "-c <conf> Drops points with a confidence below the given value between 0 and 1" << std::endl;
+  std::cout << "-e <err>  Drops points with an error above the given value in m" << std::endl;
+  std::cout << "-z <min>,<max> Drops points outside the given distance range in m. 0 means no limit" << std::endl;
+  std::cout << "-v <size> Reduces points to the centroids of occupied voxels of given size in m, without triangles" << std::endl;
+  std::cout << "-r <r>    Computes normals from all points in a window with the given radius in pixels of the disparity image" << std::endl;
+  std::cout << "-n <n>    Continuous mode, which stores point clouds of n synchronized image sets or of all sets until interrupted with Ctrl+C if n is 0. A counter is appended to the name of the output file" << std::endl;
+  std::cout << "-p <n>    Number of threads for creating point clouds in continuous mode or for computing normals otherwise. Default is the number of cores" << std::endl;
+  std::cout << "-q <n>    Maximum number of image sets waiting in continuous mode. Further sets are dropped. Default is 8" << std::endl;
   std::cout << std::endl;
   std::cout << "Parameters:" << std::endl;
   std::cout << "<interface-id> Optional GenICam ID of interface for connecting to the device" << std::endl;
@@ -72,17 +99,98 @@ void printHelp(const char *prgname)
   std::cout << "<key>=<value>  Optional GenICam parameters to be changed in the given order" << std::endl;
 }
 
+/*
+  Returns the name of the output file with the given counter or an empty
+  name if no name is given.
+*/
+
+std::string getCloudName(const std::string &name, uint64_t counter)
+{
+  if (name.size() == 0)
+  {
+    return name;
+  }
+
+  size_t i=name.rfind('.');
+  size_t j=name.find_last_of("/\\");
+
+  if (i == std::string::npos || (j != std::string::npos && i < j))
+  {
+    i=name.size();
+  }
+
+  std::ostringstream os;
+  os << name.substr(0, i) << "_" << std::setfill('0') << std::setw(6) << counter << name.substr(i);
+
+  return os.str();
+}
+
+/*
+  Synchronized image set and name of the point cloud that is created from it.
+*/
+
+struct CloudTask
+{
+  std::string name;
+  std::shared_ptr<const rcg::Image> left, disp, conf, error;
+};
+
+/*
+  Creates and stores the point cloud of one image set in a background thread
+  of the continuous mode. False is returned if this fails.
+*/
+
+bool storeCloud(const CloudTask &task, double f, double t, double scale,
+                const rcg::PointCloudFilter &filter, const rcg::NormalParameter &normal,
+                rcg::PointCloudFmt fmt, std::mutex &print_mtx)
+{
+  try
+  {
+    rcg::storePointCloud(task.name, f, t, scale, task.left, task.disp, task.conf, task.error,
+                         filter, normal, fmt);
+  }
+  catch (const std::exception &ex)
+  {
+    std::lock_guard<std::mutex> lock(print_mtx);
+    std::cerr << "Cannot store point cloud: " << ex.what() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+// set the boolean flag when the user presses Ctrl+C
+
+std::atomic<bool> user_interrupt(false);
+
+void interruptHandler(int)
+{
+  std::cout << "Stopping ..." << std::endl;
+
+  user_interrupt=true;
+}
+
 }
 
 int main(int argc, char *argv[])
 {
   int ret=0;
 
+  signal(SIGINT, interruptHandler);
+
   try
   {
     // optional parameters
 
     std::string name="";
+    rcg::PointCloudFilter filter;
+    rcg::NormalParameter normal;
+    rcg::PointCloudFmt fmt=rcg::PLY;
+
+    bool continuous=false;
+    int n=1;
+    int nthreads=std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int queue_size=8;
 
     int i=1;
 
@@ -93,6 +201,79 @@ int main(int argc, char *argv[])
         i++;
         name=argv[i++];
       }
+      else if (std::string(argv[i]) == "-f" && i+1 < argc)
+      {
+        i++;
+        std::string v=argv[i++];
+
+        if (v == "ply")
+        {
+          fmt=rcg::PLY;
+        }
+        else if (v == "pcd")
+        {
+          fmt=rcg::PCD;
+        }
+        else if (v == "rcp")
+        {
+          fmt=rcg::RCP;
+        }
+        else
+        {
+          std::cerr << "Unknown format: " << v << std::endl;
+          return 1;
+        }
+      }
+      else if (std::string(argv[i]) == "-c" && i+1 < argc)
+      {
+        i++;
+        filter.min_conf=std::stod(argv[i++]);
+      }
+      else if (std::string(argv[i]) == "-e" && i+1 < argc)
+      {
+        i++;
+        filter.max_error=std::stod(argv[i++]);
+      }
+      else if (std::string(argv[i]) == "-z" && i+1 < argc)
+      {
+        i++;
+
+        std::string v=argv[i++];
+        size_t j=v.find(',');
+
+        filter.min_z=std::stod(v.substr(0, j));
+
+        if (j != std::string::npos)
+        {
+          filter.max_z=std::stod(v.substr(j+1));
+        }
+      }
+      else if (std::string(argv[i]) == "-v" && i+1 < argc)
+      {
+        i++;
+        filter.voxel_size=std::stod(argv[i++]);
+      }
+      else if (std::string(argv[i]) == "-r" && i+1 < argc)
+      {
+        i++;
+        normal.radius=std::max(0, std::stoi(argv[i++]));
+      }
+      else if (std::string(argv[i]) == "-n" && i+1 < argc)
+      {
+        i++;
+        continuous=true;
+        n=std::max(0, std::stoi(argv[i++]));
+      }
+      else if (std::string(argv[i]) == "-p" && i+1 < argc)
+      {
+        i++;
+        nthreads=std::max(1, std::stoi(argv[i++]));
+      }
+      else if (std::string(argv[i]) == "-q" && i+1 < argc)
+      {
+        i++;
+        queue_size=std::max(1, std::stoi(argv[i++]));
+      }
       else
       {
         std::cout << "Unknown parameter: " << argv[i] << std::endl;
@@ -143,9 +324,9 @@ int main(int argc, char *argv[])
       {
         rcg::setEnum(nodemap, "LineSelector", "Out1", true);
         std::string linesource=rcg::getEnum(nodemap, "LineSource", true);
-        std::string filter=rcg::getEnum(nodemap, "AcquisitionAlternateFilter", true);
+        std::string alternate_filter=rcg::getEnum(nodemap, "AcquisitionAlternateFilter", true);
 
-        if (linesource == "ExposureAlternateActive" && filter == "OnlyLow")
+        if (linesource == "ExposureAlternateActive" && alternate_filter == "OnlyLow")
         {
           tol=50*1000*1000; // set tolerance to 50 ms
         }
@@ -234,10 +415,33 @@ int main(int argc, char *argv[])
         rcg::ImageList conf_list(25);
         rcg::ImageList error_list(25);
 
+        // in continuous mode, point clouds are created in background threads
+
+        std::mutex print_mtx;
+        std::unique_ptr<WorkerQueue<CloudTask> > pipeline;
+
+        if (continuous)
+        {
+          pipeline.reset(new WorkerQueue<CloudTask>(static_cast<size_t>(queue_size), nthreads,
+            [f, t, scale, filter, normal, fmt, &print_mtx](CloudTask &task)
+            {
+              return storeCloud(task, f, t, scale, filter, normal, fmt, print_mtx);
+            }));
+        }
+        else
+        {
+          // use all threads for computing normals of a single point cloud
+
+          normal.threads=nthreads;
+        }
+
+        uint64_t sets=0, accepted=0, incomplete=0;
+        std::chrono::steady_clock::time_point t0;
+
         bool run=true;
         int async=0, maxasync=50; // maximum number of asynchroneous images before giving up
 
-        while (run && async < maxasync)
+        while (run && async < maxasync && !user_interrupt)
         {
           async++;
 
@@ -248,14 +452,22 @@ int main(int argc, char *argv[])
           {
             // check for a complete image in the buffer
 
-            if (!buffer->getIsIncomplete())
+            if (buffer->getIsIncomplete())
+            {
+              incomplete++;
+            }
+            else
             {
+              // copy all parts of the multi-part buffer at once
+
+              std::vector<std::shared_ptr<const rcg::Image> > images=rcg::createImages(buffer);
+
               // go through all parts in case of multi-part buffer
 
               size_t partn=buffer->getNumberOfParts();
               for (uint32_t part=0; part<partn; part++)
               {
-                if (buffer->getImagePresent(part))
+                if (images[part])
                 {
                   // store image in the corresponding list
 
@@ -266,22 +478,22 @@ int main(int argc, char *argv[])
 
                   if (component == "Intensity")
                   {
-                    left_list.add(buffer, part);
+                    left_list.add(images[part]);
                     disp_tol=tol;
                   }
                   else if (component == "Disparity")
                   {
-                    disp_list.add(buffer, part);
+                    disp_list.add(images[part]);
                     left_tol=tol;
                   }
                   else if (component == "Confidence")
                   {
-                    conf_list.add(buffer, part);
+                    conf_list.add(images[part]);
                     left_tol=tol;
                   }
                   else if (component == "Error")
                   {
-                    error_list.add(buffer, part);
+                    error_list.add(images[part]);
                     left_tol=tol;
                   }
 
@@ -303,11 +515,44 @@ int main(int argc, char *argv[])
                     error=error_list.find(disp->getTimestampNS());
                   }
 
-                  if (left && disp && conf && error)
+                  if (run && left && disp && conf && error)
                   {
-                    // compute and store point cloud from synchronized image pair
-
-                    rcg::storePointCloud(name, f, t, scale, left, disp, conf, error);
+                    if (pipeline)
+                    {
+                      // pass synchronized image set to the background threads
+
+                      if (sets == 0)
+                      {
+                        t0=std::chrono::steady_clock::now();
+                      }
+
+                      CloudTask task;
+                      task.name=getCloudName(name, sets);
+                      task.left=left;
+                      task.disp=disp;
+                      task.conf=conf;
+                      task.error=error;
+
+                      if (pipeline->push(task))
+                      {
+                        accepted++;
+                        run=(n == 0 || accepted < static_cast<uint64_t>(n));
+                      }
+
+                      sets++;
+                    }
+                    else
+                    {
+                      // compute and store point cloud from synchronized image pair
+
+                      rcg::storePointCloud(name, f, t, scale, left, disp, conf, error, filter,
+                                           normal, fmt);
+
+                      // exit the grabbing loop after the first synchronized
+                      // image set
+
+                      run=false;
+                    }
 
                     // remove all images from the buffer with the current or an
                     // older time stamp
@@ -317,11 +562,6 @@ int main(int argc, char *argv[])
                     disp_list.removeOld(timestamp);
                     conf_list.removeOld(timestamp);
                     error_list.removeOld(timestamp);
-
-                    // in this example, we exit the grabbing loop after receiving
-                    // the first synchronized image pair
-
-                    run=false;
                   }
                 }
               }
@@ -346,6 +586,28 @@ int main(int argc, char *argv[])
 
         stream[0]->stopStreaming();
         stream[0]->close();
+
+        // wait for remaining point clouds and report the sustained rate
+
+        if (pipeline)
+        {
+          pipeline->finish();
+
+          double duration=0;
+          if (sets > 0)
+          {
+            duration=std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+          }
+
+          uint64_t stored=pipeline->getProcessed();
+
+          std::cout << "Stored " << stored << " point clouds of " << sets
+                    << " synchronized image sets in " << std::fixed << std::setprecision(1)
+                    << duration << " s, " << (duration > 0 ? stored/duration : 0)
+                    << " clouds/s, dropped " << pipeline->getDropped() << " sets, "
+                    << incomplete << " incomplete buffers" << std::endl;
+          std::cout.unsetf(std::ios_base::floatfield);
+        }
       }
       else
       {
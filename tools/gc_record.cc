@@ -0,0 +1,375 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rc_genicam_api/system.h>
+#include <rc_genicam_api/interface.h>
+#include <rc_genicam_api/device.h>
+#include <rc_genicam_api/stream.h>
+#include <rc_genicam_api/buffer.h>
+#include <rc_genicam_api/config.h>
+
+#include <Base/GCException.h>
+
+#include <signal.h>
+#include <stdlib.h>
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#ifdef _WIN32
+#undef min
+#undef max
+#endif
+
+#ifndef REPLAY_PRODUCER_PATH
+#define REPLAY_PRODUCER_PATH "rc_replay.cti"
+#endif
+
+namespace
+{
+
+void printHelp()
+{
+  // show help
+
+  std::cout << "gc_record -h | [-o <file>] [-p <cti>] [<interface-id>:]<device-id> [n=<n>] [<key>=<value>] ..." << std::endl;
+  std::cout << std::endl;
+  std::cout << "Records the communication with the specified device, including the XML description," << std::endl;
+  std::cout << "register access and received buffers, after applying the given optional GenICam" << std::endl;
+  std::cout << "parameters. The recording can be replayed by the rc_replay GenTL producer." << std::endl;
+  std::cout << std::endl;
+  std::cout << "Options:" << std::endl;
+  std::cout << "-h         Prints help information and exits" << std::endl;
+  std::cout << "-o <file>  Name of recording. Default is 'recording.rcg'" << std::endl;
+  std::cout << "-p <cti>   Path to the rc_replay GenTL producer. Default is" << std::endl;
+  std::cout << "           '" << REPLAY_PRODUCER_PATH << "'" << std::endl;
+  std::cout << std::endl;
+  std::cout << "Parameters:" << std::endl;
+  std::cout << "<interface-id> Optional GenICam ID of interface for connecting to the device" << std::endl;
+  std::cout << "<device-id>    GenICam device ID, serial number or user defined name of device" << std::endl;
+  std::cout << "n=<n>          Optional number of buffers to be recorded (default is 100)" << std::endl;
+  std::cout << "<key>=<value>  Optional GenICam parameters to be changed in the given order" << std::endl;
+  std::cout << std::endl;
+  std::cout << "For replaying, set GENICAM_GENTL64_PATH (or GENICAM_GENTL32_PATH) to the directory" << std::endl;
+  std::cout << "of rc_replay.cti and RC_REPLAY_FILE to the name of the recording. RC_REPLAY_SPEED" << std::endl;
+  std::cout << "can be 'original' (default) or 'max' and RC_REPLAY_LOOP defines how often the" << std::endl;
+  std::cout << "recording is replayed, with 0 for infinite (default is 1)." << std::endl;
+#ifdef _WIN32
+  std::cout << std::endl;
+  std::cout << "Recording can be aborted by hitting the 'Enter' key." << std::endl;
+#endif
+}
+
+void setEnv(const char *name, const std::string &value)
+{
+#ifdef _WIN32
+  _putenv_s(name, value.c_str());
+#else
+  setenv(name, value.c_str(), 1);
+#endif
+}
+
+// simple mechanism to set the boolean flag when the user presses enter in the
+// terminal
+
+std::atomic<bool> user_interrupt(false);
+
+void interruptHandler(int)
+{
+  std::cout << "Stopping ..." << std::endl;
+
+  user_interrupt=true;
+}
+
+#ifdef _WIN32
+
+void checkUserInterrupt()
+{
+  char a;
+  std::cin.get(a);
+
+  std::cout << "Stopping ..." << std::endl;
+
+  user_interrupt=true;
+}
+
+#endif
+
+}
+
+int main(int argc, char *argv[])
+{
+  int ret=0;
+
+  signal(SIGINT, interruptHandler);
+
+  try
+  {
+    std::string file="recording.rcg";
+    std::string replay=REPLAY_PRODUCER_PATH;
+    int i=1;
+
+    // get parameters
+
+    while (i < argc && argv[i][0] == '-')
+    {
+      std::string param=argv[i];
+
+      if (param == "-h")
+      {
+        printHelp();
+        return 0;
+      }
+      else if (param == "-o" || param == "-p")
+      {
+        i++;
+
+        if (i < argc)
+        {
+          if (param == "-o")
+          {
+            file=argv[i];
+          }
+          else
+          {
+            replay=argv[i];
+          }
+
+          i++;
+        }
+        else
+        {
+          throw std::invalid_argument("Argument expected after '"+param+"'!");
+        }
+      }
+      else
+      {
+        throw std::invalid_argument("Unknown parameter: "+param);
+      }
+    }
+
+    if (i < argc)
+    {
+      // find the producer that offers the device
+
+      std::string producer;
+
+      {
+        std::shared_ptr<rcg::Device> dev=rcg::getDevice(argv[i]);
+
+        if (dev)
+        {
+          producer=dev->getParent()->getParent()->getFilename();
+        }
+      }
+
+      rcg::System::clearSystems();
+
+      if (producer.size() == 0)
+      {
+        std::cerr << "Device '" << argv[i] << "' not found!" << std::endl;
+        return 1;
+      }
+
+      // load only the replay producer, which forwards everything to the
+      // original producer and records it
+
+      setEnv("RC_REPLAY_RECORD", file);
+      setEnv("RC_REPLAY_PRODUCER", producer);
+
+      rcg::System::setSystemsPath(replay.c_str(), 0);
+
+      std::shared_ptr<rcg::Device> dev=rcg::getDevice(argv[i]);
+
+      if (dev)
+      {
+        i++;
+        dev->open(rcg::Device::CONTROL);
+        std::shared_ptr<GenApi::CNodeMapRef> nodemap=dev->getRemoteNodeMap();
+
+        // set values as given on the command line
+
+        int n=100;
+        while (i < argc)
+        {
+          // split argument in key and value
+
+          std::string key=argv[i++];
+          std::string value;
+
+          size_t k=key.find('=');
+          if (k != std::string::npos)
+          {
+            value=key.substr(k+1);
+            key=key.substr(0, k);
+          }
+
+          if (key == "n") // set number of buffers
+          {
+            n=std::max(1, std::stoi(value));
+          }
+          else // set key=value pair through GenICam
+          {
+            if (value.size() > 0)
+            {
+              rcg::setString(nodemap, key.c_str(), value.c_str(), true);
+            }
+            else
+            {
+              rcg::callCommand(nodemap, key.c_str(), true);
+            }
+          }
+        }
+
+        // open stream and record n buffers
+
+        std::vector<std::shared_ptr<rcg::Stream> > stream=dev->getStreams();
+
+        if (stream.size() > 0)
+        {
+#ifdef _WIN32
+          // start background thread for checking user input
+          std::thread thread_cui(checkUserInterrupt);
+          thread_cui.detach();
+
+          std::cout << "Press 'Enter' to abort recording." << std::endl;
+#endif
+
+          stream[0]->open();
+          stream[0]->startStreaming();
+
+          int buffers_received=0;
+          int buffers_incomplete=0;
+          auto time_start=std::chrono::steady_clock::now();
+
+          while (buffers_received < n && !user_interrupt)
+          {
+            // buffers are recorded by the producer when they are grabbed
+
+            const rcg::Buffer *buffer=stream[0]->grab(3000);
+
+            if (buffer != 0)
+            {
+              if (buffers_received == 0)
+              {
+                time_start=std::chrono::steady_clock::now();
+              }
+
+              buffers_received++;
+
+              if (buffer->getIsIncomplete())
+              {
+                buffers_incomplete++;
+              }
+
+              std::cout << "\rRecorded buffers: " << buffers_received << std::flush;
+            }
+            else
+            {
+              std::cerr << std::endl << "Cannot grab images" << std::endl;
+              break;
+            }
+          }
+
+          auto time_stop=std::chrono::steady_clock::now();
+
+          stream[0]->stopStreaming();
+          stream[0]->close();
+
+          // report received and incomplete buffers
+
+          std::cout << std::endl;
+          std::cout << "Recording:          " << file << std::endl;
+          std::cout << "Received buffers:   " << buffers_received << std::endl;
+          std::cout << "Incomplete buffers: " << buffers_incomplete << std::endl;
+
+          if (buffers_received > 1)
+          {
+            std::cout << "Buffers per second: " << std::setprecision(3)
+                      << 1000.0*(buffers_received-1)/
+                         std::chrono::duration_cast<std::chrono::milliseconds>(time_stop-time_start).count()
+                      << std::endl;
+          }
+
+          if (buffers_received == 0)
+          {
+            ret=1;
+          }
+        }
+        else
+        {
+          std::cerr << "No streams available" << std::endl;
+          ret=1;
+        }
+
+        dev->close();
+      }
+      else
+      {
+        std::cerr << "Cannot open device '" << argv[i] << "' through '" << replay << "'!"
+                  << std::endl;
+        ret=1;
+      }
+    }
+    else
+    {
+      printHelp();
+      ret=1;
+    }
+  }
+  catch (const std::exception &ex)
+  {
+    std::cerr << "Exception: " << ex.what() << std::endl;
+    ret=2;
+  }
+  catch (const GENICAM_NAMESPACE::GenericException &ex)
+  {
+    std::cerr << "Exception: " << ex.what() << std::endl;
+    ret=2;
+  }
+  catch (...)
+  {
+    std::cerr << "Unknown exception!" << std::endl;
+    ret=2;
+  }
+
+  rcg::System::clearSystems();
+
+  return ret;
+}
@@ -40,11 +40,14 @@
 #include <rc_genicam_api/buffer.h>
 #include <rc_genicam_api/image.h>
 #include <rc_genicam_api/image_store.h>
+#include <rc_genicam_api/recording.h>
 #include <rc_genicam_api/config.h>
 #include <rc_genicam_api/nodemap_out.h>
 
 #include <rc_genicam_api/pixel_formats.h>
 
+#include "worker_queue.h"
+
 #include <Base/GCException.h>
 
 #include <signal.h>
@@ -55,6 +58,7 @@
 #include <algorithm>
 #include <atomic>
 #include <thread>
+#include <mutex>
 #include <chrono>
 
 #ifdef _WIN32
@@ -69,7 +73,7 @@ void printHelp()
 {
   // show help
 
-  std::cout << "gc_stream -h | [-c] [-f <fmt>] [-t] [<interface-id>:]<device-id> [n=<n>] [<key>=<value>] ..." << std::endl;
+  std::cout << "gc_stream -h | [-c] [-f <fmt> [-z <l>] [-y <f>] [-j <n>]] [-d] [-r <file>] [-o <dir> [-s <n>[s]] [-x]] [-t] [-b [-i <s>]] [-p <n> [-q <n>]] [<interface-id>:]<device-id> [n=<n>] [<key>=<value>] ..." << std::endl;
   std::cout << std::endl;
   std::cout << "Stores images from the specified device after applying the given optional GenICam parameters." << std::endl;
   std::cout << std::endl;
@@ -77,7 +81,29 @@ void printHelp()
   std::cout << "-h         Prints help information and exits" << std::endl;
   std::cout << "-c         Print ChunkDataControl category for all received buffers" << std::endl;
   std::cout << "-t         Testmode, which does not store images and provides extended statistics" << std::endl;
-  std::cout << "-f pnm|png Format for storing images. Default is pnm" << std::endl;
+  std::cout << "-f <fmt>   Format for storing images, i.e. pnm, png or rcl (fast lossless" << std::endl;
+  std::cout << "           compression that can be loaded with rcg::loadImage()). Default is pnm" << std::endl;
+  std::cout << "-z <l>     Compression level for png from 0 (none) to 9 (best). Default is 6" << std::endl;
+  std::cout << "-y <f>     Row filter for png, i.e. none, sub, up, avg, paeth or adaptive. Default" << std::endl;
+  std::cout << "           is adaptive" << std::endl;
+  std::cout << "-j <n>     Number of threads for compressing horizontal strips of each png image in" << std::endl;
+  std::cout << "           parallel. Default is 1" << std::endl;
+  std::cout << "-d         Additionally stores depth images that are computed from disparity images," << std::endl;
+  std::cout << "           in m as pfm for format pnm and in mm as 16 bit images otherwise" << std::endl;
+  std::cout << "-r <file>  Records all buffers into the given file instead of storing separate" << std::endl;
+  std::cout << "           files. Images are compressed if the format is rcl" << std::endl;
+  std::cout << "-o <dir>   Directory for storing files. Names get a unique session prefix and" << std::endl;
+  std::cout << "           counter instead of checking for existing files" << std::endl;
+  std::cout << "-s <n>[s]  Distributes files into subdirectories of the output directory with n" << std::endl;
+  std::cout << "           files each or, with suffix s, n seconds each. Default is 0 for none" << std::endl;
+  std::cout << "-x         Creates files in the output directory exclusively, i.e. fails if a file" << std::endl;
+  std::cout << "           exists instead of overwriting it" << std::endl;
+  std::cout << "-b         Benchmark mode, which reports timing of all processing stages instead of" << std::endl;
+  std::cout << "           printing information about every buffer. Can be combined with -t" << std::endl;
+  std::cout << "-i <s>     Interval in seconds for printing summaries in benchmark mode. Default is 10" << std::endl;
+  std::cout << "-p <n>     Pipeline mode, which stores images with n threads while grabbing continues." << std::endl;
+  std::cout << "           Buffers are dropped if storing cannot keep up" << std::endl;
+  std::cout << "-q <n>     Maximum number of buffers waiting for storage in pipeline mode. Default is 16" << std::endl;
   std::cout << std::endl;
   std::cout << "Parameters:" << std::endl;
   std::cout << "<interface-id> Optional GenICam ID of interface for connecting to the device" << std::endl;
@@ -135,15 +161,39 @@ std::string getDigitalIO(const std::shared_ptr<GenApi::CNodeMapRef> &nodemap)
 }
 
 /**
-  Store image in given buffer.
+  Description of a file that should be stored. All information that requires
+  access to the buffer or the nodemap is collected in advance, so that storing
+  can be done after the buffer has been given back to the stream and in a
+  different thread.
 */
 
-std::string storeBuffer(rcg::ImgFmt fmt, const std::shared_ptr<GenApi::CNodeMapRef> &nodemap,
-                        const std::string &component, const rcg::Buffer *buffer, uint32_t part,
-                        size_t yoffset=0, size_t height=0)
+struct StoreTask
 {
-  // prepare file name
+  StoreTask() : naming(rcg::NAME_PROBE) { }
+
+  enum Type { IMAGE, DISPARITY, DEPTH, PARAMETER, RECORD };
+
+  Type type;
+  std::string name;
+  rcg::FileNaming naming;
+  std::string component;
+  std::shared_ptr<const rcg::Image> image;
+  size_t yoffset, height;
+  int inv;
+  float scale, offset;
+  double f, t;
+  std::string text;
+  uint64_t timestamp, frameid;
+  std::vector<rcg::RecordingPart> part;
+};
+
+/**
+  Returns the name of the file without suffix, which is based on the timestamp
+  of the buffer and the given component.
+*/
 
+std::string getBaseName(const rcg::Buffer *buffer, const std::string &component)
+{
   std::ostringstream name;
 
   uint64_t t_sec = buffer->getTimestampNS()/1000000000;
@@ -156,120 +206,138 @@ std::string storeBuffer(rcg::ImgFmt fmt, const std::shared_ptr<GenApi::CNodeMapR
     name << '_' << component;
   }
 
-  if (buffer->getContainsChunkdata())
-  {
-    name << getDigitalIO(nodemap);
-  }
+  return name.str();
+}
 
-  // store image (see e.g. the sv tool of cvkit for show images)
+/**
+  Adds a task for storing the given image of the buffer.
+*/
 
-  std::string full_name;
-  if (!buffer->getIsIncomplete() && buffer->getImagePresent(part))
-  {
-    rcg::Image image(buffer, part);
-    full_name=storeImage(name.str(), fmt, image, yoffset, height);
-  }
-  else if (buffer->getIsIncomplete())
-  {
-    std::cerr << "storeBuffer(): Received incomplete buffer" << std::endl;
-  }
-  else if (!buffer->getImagePresent(part))
+void addImageTask(std::vector<StoreTask> &task, const std::shared_ptr<GenApi::CNodeMapRef> &nodemap,
+                  const std::string &component, const rcg::Buffer *buffer,
+                  const std::shared_ptr<const rcg::Image> &image, size_t yoffset=0,
+                  size_t height=0)
+{
+  StoreTask st;
+
+  st.type=StoreTask::IMAGE;
+  st.name=getBaseName(buffer, component);
+  st.component=component;
+
+  if (buffer->getContainsChunkdata())
   {
-    std::cerr << "storeBuffer(): Received buffer without image" << std::endl;
+    st.name+=getDigitalIO(nodemap);
   }
 
-  return full_name;
+  st.image=image;
+  st.yoffset=yoffset;
+  st.height=height;
+
+  task.push_back(st);
 }
 
 /**
-  This method expects in the given buffer an image of format Coord3D_C16 and
-  ChunkScan3d parameters in the nodemap. The chunk adapter must have already
-  been attached to the nodemap. If this function succeeds, then a floating
-  point disparity image and a parameter file is stored and the name of the
-  disparity image returned.
+  This method expects an image of format Coord3D_C16 and ChunkScan3d
+  parameters in the nodemap. The chunk adapter must have already been attached
+  to the nodemap. If this function succeeds, then a task for storing a floating
+  point disparity image is added and true is returned.
 */
 
-std::string storeBufferAsDisparity(const std::shared_ptr<GenApi::CNodeMapRef> &nodemap,
-                                   const rcg::Buffer *buffer, uint32_t part)
+bool addDisparityTask(std::vector<StoreTask> &task,
+                      const std::shared_ptr<GenApi::CNodeMapRef> &nodemap,
+                      const rcg::Buffer *buffer, const std::shared_ptr<const rcg::Image> &image)
 {
-  std::string dispname;
-
-  if (!buffer->getIsIncomplete() && buffer->getImagePresent(part) &&
-      buffer->getPixelFormat(part) == Coord3D_C16 && buffer->getContainsChunkdata())
+  if (image->getPixelFormat() == Coord3D_C16 && buffer->getContainsChunkdata())
   {
+    StoreTask st;
+
     // get necessary information from ChunkScan3d parameters
 
-    int inv=-1;
+    st.inv=-1;
 
     rcg::setString(nodemap, "ChunkComponentSelector", "Disparity");
 
     if (rcg::getBoolean(nodemap, "ChunkScan3dInvalidDataFlag"))
     {
-      inv=static_cast<int>(rcg::getFloat(nodemap, "ChunkScan3dInvalidDataValue"));
+      st.inv=static_cast<int>(rcg::getFloat(nodemap, "ChunkScan3dInvalidDataValue"));
     }
 
-    double scale=rcg::getFloat(nodemap, "ChunkScan3dCoordinateScale");
-    double offset=rcg::getFloat(nodemap, "ChunkScan3dCoordinateOffset");
-
-    // prepare file name
-
-    std::ostringstream name;
-
-    uint64_t t_sec = buffer->getTimestampNS()/1000000000;
-    uint64_t t_nsec = buffer->getTimestampNS()%1000000000;
-
-    name << "image_" << t_sec << "." << std::setfill('0') << std::setw(9) << t_nsec;
-    name << "_Disparity";
+    st.scale=static_cast<float>(rcg::getFloat(nodemap, "ChunkScan3dCoordinateScale"));
+    st.offset=static_cast<float>(rcg::getFloat(nodemap, "ChunkScan3dCoordinateOffset"));
 
     // Append out1 and out2 status to file name: _<out1>_<out2>
 
-    name << getDigitalIO(nodemap);
+    st.type=StoreTask::DISPARITY;
+    st.name=getBaseName(buffer, "Disparity")+getDigitalIO(nodemap);
+    st.image=image;
+    st.yoffset=0;
+    st.height=0;
 
-    // store image
+    task.push_back(st);
 
-    rcg::Image image(buffer, part);
-    dispname=storeImageAsDisparityPFM(name.str(), image, inv, static_cast<float>(scale), static_cast<float>(offset));
-  }
-  else if (buffer->getIsIncomplete())
-  {
-    std::cerr << "storeBuffer(): Received incomplete buffer" << std::endl;
-  }
-  else if (!buffer->getImagePresent(part))
-  {
-    std::cerr << "storeBuffer(): Received buffer without image" << std::endl;
+    return true;
   }
 
-  return dispname;
+  return false;
 }
 
 /**
-  Stores 3D parameters into parameter file if possible.
+  Adds a task for storing the depth image that is computed from the disparity
+  image, if chunk data is available.
 */
 
-void storeParameter(const std::shared_ptr<GenApi::CNodeMapRef> &nodemap,
-                    const std::string &component, const rcg::Buffer *buffer,
-                    size_t height=0, bool dispinfo=false)
+void addDepthTask(std::vector<StoreTask> &task,
+                  const std::shared_ptr<GenApi::CNodeMapRef> &nodemap,
+                  const rcg::Buffer *buffer, const std::shared_ptr<const rcg::Image> &image)
 {
-  if (buffer->getContainsChunkdata())
+  if (image->getPixelFormat() == Coord3D_C16 && buffer->getContainsChunkdata())
   {
-    // prepare file name
+    StoreTask st;
 
-    std::ostringstream name;
+    // get necessary information from ChunkScan3d parameters
 
-    uint64_t t_sec = buffer->getTimestampNS()/1000000000;
-    uint64_t t_nsec = buffer->getTimestampNS()%1000000000;
+    st.inv=-1;
 
-    name << "image_" << t_sec << "." << std::setfill('0') << std::setw(9) << t_nsec;
+    rcg::setString(nodemap, "ChunkComponentSelector", "Disparity");
 
-    if (component.size() > 0)
+    if (rcg::getBoolean(nodemap, "ChunkScan3dInvalidDataFlag"))
     {
-      name << '_' << component;
+      st.inv=static_cast<int>(rcg::getFloat(nodemap, "ChunkScan3dInvalidDataValue"));
     }
 
+    st.scale=static_cast<float>(rcg::getFloat(nodemap, "ChunkScan3dCoordinateScale"));
+    st.offset=static_cast<float>(rcg::getFloat(nodemap, "ChunkScan3dCoordinateOffset"));
+    st.f=rcg::getFloat(nodemap, "ChunkScan3dFocalLength");
+    st.t=rcg::getFloat(nodemap, "ChunkScan3dBaseline");
+
+    st.type=StoreTask::DEPTH;
+    st.name=getBaseName(buffer, "Depth")+getDigitalIO(nodemap);
+    st.image=image;
+    st.yoffset=0;
+    st.height=0;
+
+    task.push_back(st);
+  }
+}
+
+/**
+  Adds a task for storing 3D parameters into parameter file if possible.
+*/
+
+void addParameterTask(std::vector<StoreTask> &task,
+                      const std::shared_ptr<GenApi::CNodeMapRef> &nodemap,
+                      const std::string &component, const rcg::Buffer *buffer,
+                      size_t height=0, bool dispinfo=false)
+{
+  if (buffer->getContainsChunkdata())
+  {
     // Append out1 and out2 status to file name: _<out1>_<out2>
 
-    name << getDigitalIO(nodemap);
-    name << "_param.txt";
+    StoreTask st;
+
+    st.type=StoreTask::PARAMETER;
+    st.name=getBaseName(buffer, component)+getDigitalIO(nodemap)+"_param.txt";
+    st.component=component;
 
     // get 3D parameter
 
@@ -297,11 +365,11 @@ void storeParameter(const std::shared_ptr<GenApi::CNodeMapRef> &nodemap,
       offset=rcg::getFloat(nodemap, "ChunkScan3dCoordinateOffset");
     }
 
-    // create parameter file
+    // create content of parameter file
 
     if (width > 0 && height > 0 && f > 0 && t > 0)
     {
-      std::ofstream out(rcg::ensureNewFileName(name.str()));
+      std::ostringstream out;
 
       out << "# Created by gc_stream" << std::endl;
       out << std::fixed << std::setprecision(5);
@@ -356,9 +424,426 @@ void storeParameter(const std::shared_ptr<GenApi::CNodeMapRef> &nodemap,
         out << "disp.offset=" << offset << std::endl;
       }
 
-      out.close();
+      st.text=out.str();
+
+      task.push_back(st);
+    }
+  }
+}
+
+/**
+  Creates the tasks for storing the images of all parts of the given buffer,
+  including parameter files and optionally depth images. If image_ms is
+  given, then the time for copying the buffer into images is added to it.
+*/
+
+void createStoreTasks(std::vector<StoreTask> &task, rcg::ImgFmt fmt,
+                      const std::shared_ptr<GenApi::CNodeMapRef> &nodemap,
+                      const rcg::Buffer *buffer, bool depth=false, double *image_ms=0)
+{
+  // copy all parts at once, the images share the memory
+
+  auto t0=std::chrono::steady_clock::now();
+
+  std::vector<std::shared_ptr<const rcg::Image> > images=rcg::createImages(buffer);
+
+  if (image_ms)
+  {
+    *image_ms+=std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-t0).count();
+  }
+
+  uint32_t npart=buffer->getNumberOfParts();
+  for (uint32_t part=0; part<npart; part++)
+  {
+    if (images[part])
+    {
+      // get component name
+
+      std::string component=rcg::getComponetOfPart(nodemap, buffer, part);
+
+      std::shared_ptr<const rcg::Image> image=images[part];
+
+      // try storing disparity as float image with meta information
+
+      if (component == "Disparity" && depth)
+      {
+        addDepthTask(task, nodemap, buffer, image);
+      }
+
+      if (component == "Disparity" && fmt == rcg::PNM &&
+          addDisparityTask(task, nodemap, buffer, image))
+      {
+        addParameterTask(task, nodemap, component, buffer);
+      }
+      else
+      {
+        // otherwise, store as ordinary image
+
+        if (component == "IntensityCombined")
+        {
+          // splitting left and right image of combined format of
+          // Roboceptions rc_visard camera
+
+          size_t h2=image->getHeight()/2;
+          addImageTask(task, nodemap, "Intensity", buffer, image, 0, h2);
+          addImageTask(task, nodemap, "IntensityRight", buffer, image, h2, h2);
+        }
+        else
+        {
+          addImageTask(task, nodemap, component, buffer, image);
+        }
+
+        // store 3D parameters for intensity and disparity components (nothing
+        // is done if chunk parameters are not available)
+
+        if (component == "Intensity")
+        {
+          addParameterTask(task, nodemap, component, buffer);
+        }
+        else if (component == "Disparity")
+        {
+          addParameterTask(task, nodemap, component, buffer, 0, true);
+        }
+        else if (component == "IntensityCombined")
+        {
+          size_t h2=image->getHeight()/2;
+          addParameterTask(task, nodemap, "Intensity", buffer, h2, false);
+        }
+      }
+    }
+  }
+}
+
+/**
+  Creates one task for recording the images of all parts of the given buffer
+  together with their parameters. If image_ms is given, then the time for
+  copying the buffer into images is added to it.
+*/
+
+void createRecordTask(std::vector<StoreTask> &task,
+                      const std::shared_ptr<GenApi::CNodeMapRef> &nodemap,
+                      const rcg::Buffer *buffer, double *image_ms=0)
+{
+  std::vector<StoreTask> tmp;
+  createStoreTasks(tmp, rcg::RCL, nodemap, buffer, false, image_ms);
+
+  StoreTask st;
+
+  st.type=StoreTask::RECORD;
+  st.name=getBaseName(buffer, "");
+  st.timestamp=buffer->getTimestampNS();
+  st.frameid=buffer->getFrameID();
+
+  for (size_t i=0; i<tmp.size(); i++)
+  {
+    if (tmp[i].type == StoreTask::IMAGE)
+    {
+      rcg::RecordingPart part;
+
+      part.component=tmp[i].component;
+      part.image=tmp[i].image;
+      part.yoffset=tmp[i].yoffset;
+      part.height=tmp[i].height;
+
+      st.part.push_back(part);
+    }
+  }
+
+  for (size_t i=0; i<tmp.size(); i++)
+  {
+    if (tmp[i].type == StoreTask::PARAMETER)
+    {
+      for (size_t k=0; k<st.part.size(); k++)
+      {
+        if (st.part[k].component == tmp[i].component)
+        {
+          st.part[k].param=tmp[i].text;
+        }
+      }
+    }
+  }
+
+  if (st.part.size() > 0)
+  {
+    task.push_back(st);
+  }
+}
+
+/**
+  Stores the file of the given task. The name of the stored image is returned.
+  An empty string is returned for parameter files and recorded buffers. If
+  timing is given, then the time for converting images is added to it.
+*/
+
+std::string executeStoreTask(const StoreTask &task, rcg::ImgFmt fmt,
+                             const rcg::PNGParameter &png_param,
+                             rcg::RecordingWriter *recording, rcg::StoreTiming *timing=0)
+{
+  std::string ret;
+
+  switch (task.type)
+  {
+    case StoreTask::IMAGE:
+      {
+        // store region of image, e.g. left or right half of IntensityCombined,
+        // without copying
+
+        rcg::ImageView view(*task.image);
+
+        if (task.height > 0)
+        {
+          view=view.getROI(0, task.yoffset, view.getWidth(), task.height);
+        }
+
+        ret=rcg::storeImage(task.name, fmt, view, png_param, task.naming, timing);
+      }
+      break;
+
+    case StoreTask::DISPARITY:
+      ret=rcg::storeImageAsDisparityPFM(task.name, *task.image, task.inv, task.scale,
+        task.offset, task.naming, timing);
+      break;
+
+    case StoreTask::DEPTH:
+      {
+        rcg::DepthParameter param;
+        param.f=task.f;
+        param.t=task.t;
+        param.scale=task.scale;
+        param.offset=task.offset;
+        param.inv=task.inv;
+
+        ret=rcg::storeImageAsDepth(task.name, fmt, *task.image, param, rcg::ImageView(),
+          png_param, task.naming, timing);
+      }
+      break;
+
+    case StoreTask::PARAMETER:
+      {
+        std::ofstream out(rcg::ensureNewFileName(task.name, task.naming));
+        out << task.text;
+        out.close();
+      }
+      break;
+
+    case StoreTask::RECORD:
+      recording->write(task.timestamp, task.frameid, task.part);
+      break;
+  }
+
+  return ret;
+}
+
+/**
+  Collects values, e.g. durations in milliseconds, for computing statistics.
+*/
+
+class Statistics
+{
+  public:
+
+    Statistics() : sum(0), vmax(0) { }
+
+    void add(double v)
+    {
+      value.push_back(v);
+      sum+=v;
+      vmax=std::max(vmax, v);
+    }
+
+    void clear()
+    {
+      value.clear();
+      sum=0;
+      vmax=0;
+    }
+
+    size_t count() const { return value.size(); }
+    double mean() const { return value.size() > 0 ? sum/value.size() : 0; }
+    double maximum() const { return vmax; }
+
+    /**
+      Returns the value below which the given fraction of all values lies.
+    */
+
+    double percentile(double p) const
+    {
+      if (value.size() == 0)
+      {
+        return 0;
+      }
+
+      std::vector<double> v(value);
+      size_t i=std::min(v.size()-1, static_cast<size_t>(p*v.size()));
+      std::nth_element(v.begin(), v.begin()+static_cast<std::ptrdiff_t>(i), v.end());
+
+      return v[i];
+    }
+
+  private:
+
+    std::vector<double> value;
+    double sum, vmax;
+};
+
+/**
+  Timing of all processing stages of the benchmark mode, over the whole run
+  and over the current summary interval.
+*/
+
+class BenchmarkStatistics
+{
+  public:
+
+    enum Stage { GRAB, IMAGE, CONVERT, STORE, LATENCY, NSTAGES };
+
+    BenchmarkStatistics() : total_buffers(0), interval_buffers(0) { }
+
+    void addBuffer()
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+
+      total_buffers++;
+      interval_buffers++;
+    }
+
+    void add(Stage stage, double ms)
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+
+      total[stage].add(ms);
+      interval[stage].add(ms);
+    }
+
+    /**
+      Prints a one line summary of the current interval and starts the next
+      interval.
+    */
+
+    void printInterval(double elapsed, double duration, uint64_t delivered, uint64_t underrun,
+      uint64_t dropped, bool latency)
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+
+      std::cout << std::fixed << std::setprecision(1) << "[" << std::setw(7) << elapsed << " s] "
+                << interval_buffers << " buffers, " << interval_buffers/duration << " Hz, delivered "
+                << delivered << ", underrun " << underrun << ", dropped " << dropped
+                << std::setprecision(2) << " | grab "
+                << interval[GRAB].mean() << " image " << interval[IMAGE].mean() << " convert "
+                << interval[CONVERT].mean() << " store " << interval[STORE].mean() << " ms";
+
+      if (latency)
+      {
+        std::cout << " | latency p50 " << interval[LATENCY].percentile(0.5) << " p99 "
+                  << interval[LATENCY].percentile(0.99) << " p999 "
+                  << interval[LATENCY].percentile(0.999) << " ms";
+      }
+
+      std::cout << std::endl;
+      std::cout.unsetf(std::ios_base::floatfield);
+
+      for (int i=0; i<NSTAGES; i++)
+      {
+        interval[i].clear();
+      }
+
+      interval_buffers=0;
+    }
+
+    /**
+      Prints a table with the statistics of all stages over the whole run.
+    */
+
+    void printTotal(bool latency)
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+
+      const char *name[]={"grab", "image", "convert", "store", "latency"};
+      const int n=latency ? NSTAGES : LATENCY;
+
+      std::cout << std::endl;
+      std::cout << "Stage [ms]        mean       p50       p99      p999       max" << std::endl;
+
+      for (int i=0; i<n; i++)
+      {
+        std::cout << std::left << std::setw(12) << name[i] << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(10) << total[i].mean()
+                  << std::setw(10) << total[i].percentile(0.5)
+                  << std::setw(10) << total[i].percentile(0.99)
+                  << std::setw(10) << total[i].percentile(0.999)
+                  << std::setw(10) << total[i].maximum() << std::endl;
+      }
+
+      std::cout.unsetf(std::ios_base::floatfield);
+    }
+
+  private:
+
+    std::mutex mtx;
+    Statistics total[NSTAGES];
+    Statistics interval[NSTAGES];
+    uint64_t total_buffers;
+    uint64_t interval_buffers;
+};
+
+/**
+  Returns the duration between the given time points in milliseconds.
+*/
+
+inline double durationMS(const std::chrono::steady_clock::time_point &t0,
+  const std::chrono::steady_clock::time_point &t1)
+{
+  return std::chrono::duration<double, std::milli>(t1-t0).count();
+}
+
+/**
+  Stores the tasks of one buffer in a storage thread of the pipeline mode.
+  Errors are reported, but do not stop storing the remaining tasks.
+
+  @param task       Tasks of one buffer.
+  @param fmt        Image file format.
+  @param png_param  Compression parameters for png.
+  @param recording  Recording for tasks of type RECORD or 0.
+  @param bench_stat Statistics for timing of storage or 0.
+  @param print_mtx  Mutex for serializing output of all storage threads.
+  @return           Always true, i.e. the buffer is counted as stored.
+*/
+
+bool storeJob(std::vector<StoreTask> &task, rcg::ImgFmt fmt, const rcg::PNGParameter &png_param,
+              rcg::RecordingWriter *recording, BenchmarkStatistics *bench_stat,
+              std::mutex &print_mtx)
+{
+  auto t0=std::chrono::steady_clock::now();
+  rcg::StoreTiming timing;
+
+  for (size_t i=0; i<task.size(); i++)
+  {
+    try
+    {
+      std::string name=executeStoreTask(task[i], fmt, png_param, recording,
+        bench_stat ? &timing : 0);
+
+      if (name.size() > 0 && !bench_stat)
+      {
+        std::lock_guard<std::mutex> lock(print_mtx);
+        std::cout << "Image '" << name << "' stored" << std::endl;
+      }
+    }
+    catch (const std::exception &ex)
+    {
+      std::lock_guard<std::mutex> lock(print_mtx);
+      std::cerr << "Cannot store '" << task[i].name << "': " << ex.what() << std::endl;
     }
   }
+
+  if (bench_stat)
+  {
+    bench_stat->add(BenchmarkStatistics::CONVERT, timing.convert_ms);
+    bench_stat->add(BenchmarkStatistics::STORE,
+      durationMS(t0, std::chrono::steady_clock::now()));
+  }
+
+  return true;
 }
 
 // simple mechanism to set the boolean flag when the user presses enter in the
@@ -399,7 +884,18 @@ int main(int argc, char *argv[])
   {
     bool print_chunk_data=false;
     bool store=true;
+    bool bench=false;
+    double interval=10;
+    int nthreads=0;
+    int queue_size=16;
     rcg::ImgFmt fmt=rcg::PNM;
+    rcg::PNGParameter png_param;
+    std::string record_name;
+    std::string output_dir;
+    size_t files_per_dir=0;
+    uint64_t seconds_per_dir=0;
+    bool exclusive=false;
+    bool depth=false;
     int i=1;
 
     // get parameters
@@ -423,6 +919,112 @@ int main(int argc, char *argv[])
         store=false;
         i++;
       }
+      else if (param == "-b")
+      {
+        bench=true;
+        i++;
+      }
+      else if (param == "-i")
+      {
+        i++;
+
+        if (i < argc)
+        {
+          interval=std::max(0.1, std::stod(argv[i]));
+          i++;
+        }
+        else
+        {
+          throw std::invalid_argument("Argument expected after '-i'!");
+        }
+      }
+      else if (param == "-p" || param == "-q")
+      {
+        i++;
+
+        if (i < argc)
+        {
+          int v=std::max(1, std::stoi(argv[i]));
+
+          if (param == "-p")
+          {
+            nthreads=v;
+          }
+          else
+          {
+            queue_size=v;
+          }
+
+          i++;
+        }
+        else
+        {
+          throw std::invalid_argument("Argument expected after '"+param+"'!");
+        }
+      }
+      else if (param == "-r")
+      {
+        i++;
+
+        if (i < argc)
+        {
+          record_name=argv[i];
+          i++;
+        }
+        else
+        {
+          throw std::invalid_argument("Argument expected after '-r'!");
+        }
+      }
+      else if (param == "-o")
+      {
+        i++;
+
+        if (i < argc)
+        {
+          output_dir=argv[i];
+          i++;
+        }
+        else
+        {
+          throw std::invalid_argument("Argument expected after '-o'!");
+        }
+      }
+      else if (param == "-s")
+      {
+        i++;
+
+        if (i < argc)
+        {
+          std::string v=argv[i];
+          int n=std::max(0, std::stoi(v));
+
+          if (v.size() > 0 && v[v.size()-1] == 's')
+          {
+            seconds_per_dir=static_cast<uint64_t>(n);
+          }
+          else
+          {
+            files_per_dir=static_cast<size_t>(n);
+          }
+
+          i++;
+        }
+        else
+        {
+          throw std::invalid_argument("Argument expected after '-s'!");
+        }
+      }
+      else if (param == "-x")
+      {
+        exclusive=true;
+        i++;
+      }
+      else if (param == "-d")
+      {
+        depth=true;
+        i++;
+      }
       else if (param == "-f")
       {
         i++;
@@ -438,6 +1040,10 @@ int main(int argc, char *argv[])
           {
             fmt=rcg::PNG;
           }
+          else if (imgfmt == "rcl")
+          {
+            fmt=rcg::RCL;
+          }
           else
           {
             throw std::invalid_argument(std::string("Invalid argument of '-f': ")+argv[i]);
@@ -450,6 +1056,73 @@ int main(int argc, char *argv[])
           throw std::invalid_argument("Argument expected after '-f'!");
         }
       }
+      else if (param == "-z" || param == "-j")
+      {
+        i++;
+
+        if (i < argc)
+        {
+          int v=std::stoi(argv[i]);
+
+          if (param == "-z")
+          {
+            png_param.level=std::min(9, std::max(0, v));
+          }
+          else
+          {
+            png_param.threads=std::max(1, v);
+          }
+
+          i++;
+        }
+        else
+        {
+          throw std::invalid_argument("Argument expected after '"+param+"'!");
+        }
+      }
+      else if (param == "-y")
+      {
+        i++;
+
+        if (i < argc)
+        {
+          std::string filter=argv[i];
+          if (filter == "none")
+          {
+            png_param.filter=rcg::PNG_NONE;
+          }
+          else if (filter == "sub")
+          {
+            png_param.filter=rcg::PNG_SUB;
+          }
+          else if (filter == "up")
+          {
+            png_param.filter=rcg::PNG_UP;
+          }
+          else if (filter == "avg")
+          {
+            png_param.filter=rcg::PNG_AVG;
+          }
+          else if (filter == "paeth")
+          {
+            png_param.filter=rcg::PNG_PAETH;
+          }
+          else if (filter == "adaptive")
+          {
+            png_param.filter=rcg::PNG_ADAPTIVE;
+          }
+          else
+          {
+            throw std::invalid_argument(std::string("Invalid argument of '-y': ")+argv[i]);
+          }
+
+          i++;
+        }
+        else
+        {
+          throw std::invalid_argument("Argument expected after '-y'!");
+        }
+      }
       else
       {
         throw std::invalid_argument("Unknown parameter: "+param);
@@ -578,6 +1251,52 @@ int main(int argc, char *argv[])
           auto time_start=std::chrono::steady_clock::now();
           double latency_ns=0;
 
+          // latency can only be computed if the camera clock is synchronized
+
+          bool ptp=false;
+          BenchmarkStatistics bench_stat;
+          auto time_interval=time_start;
+
+          if (bench)
+          {
+            ptp=rcg::getBoolean(nodemap, "PtpEnable") || rcg::getBoolean(nodemap, "GevIEEE1588");
+          }
+
+          // open recording file if requested
+
+          std::unique_ptr<rcg::RecordingWriter> recording;
+
+          if (store && record_name.size() > 0)
+          {
+            recording.reset(new rcg::RecordingWriter(record_name, fmt == rcg::RCL));
+          }
+
+          // create unique names in the output directory if requested
+
+          std::unique_ptr<rcg::FileNameGenerator> namer;
+
+          if (store && !recording && output_dir.size() > 0)
+          {
+            namer.reset(new rcg::FileNameGenerator(output_dir, files_per_dir, seconds_per_dir));
+          }
+
+          // start storage threads in pipeline mode
+
+          std::mutex print_mtx;
+          std::unique_ptr<WorkerQueue<std::vector<StoreTask> > > queue;
+
+          if (store && nthreads > 0)
+          {
+            rcg::RecordingWriter *rec=recording.get();
+            BenchmarkStatistics *bs=bench ? &bench_stat : 0;
+
+            queue.reset(new WorkerQueue<std::vector<StoreTask> >(static_cast<size_t>(queue_size),
+              nthreads, [fmt, png_param, rec, bs, &print_mtx](std::vector<StoreTask> &task)
+              {
+                return storeJob(task, fmt, png_param, rec, bs, print_mtx);
+              }));
+          }
+
           for (int k=0; k<n && !user_interrupt; k++)
           {
             // grab next image with timeout of 3 seconds
@@ -585,106 +1304,105 @@ int main(int argc, char *argv[])
             int retry=5;
             while (retry > 0 && !user_interrupt)
             {
+              auto time_grab=std::chrono::steady_clock::now();
               const rcg::Buffer *buffer=stream[0]->grab(3000);
 
               if (buffer != 0)
               {
+                auto time_grabbed=std::chrono::steady_clock::now();
+
                 if (buffers_received == 0)
                 {
-                  time_start=std::chrono::steady_clock::now();
+                  time_start=time_grabbed;
+                  time_interval=time_grabbed;
+                }
+                else if (bench)
+                {
+                  bench_stat.add(BenchmarkStatistics::GRAB, durationMS(time_grab, time_grabbed));
                 }
 
                 buffers_received++;
 
                 if (!buffer->getIsIncomplete())
                 {
+                  if (bench)
+                  {
+                    bench_stat.addBuffer();
+
+                    if (ptp)
+                    {
+                      auto current=std::chrono::system_clock::now();
+                      bench_stat.add(BenchmarkStatistics::LATENCY,
+                        (static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(current.time_since_epoch()).count())-
+                        static_cast<double>(buffer->getTimestampNS()))/1.0e6);
+                    }
+                  }
+
+                  auto time_store=std::chrono::steady_clock::now();
+
                   // store images in all parts
 
                   if (store)
                   {
-                    uint32_t npart=buffer->getNumberOfParts();
-                    for (uint32_t part=0; part<npart; part++)
+                    std::vector<StoreTask> task;
+                    double image_ms=0;
+
+                    if (recording)
                     {
-                      if (buffer->getImagePresent(part))
-                      {
-                        std::string name;
+                      createRecordTask(task, nodemap, buffer, bench ? &image_ms : 0);
+                    }
+                    else
+                    {
+                      createStoreTasks(task, fmt, nodemap, buffer, depth, bench ? &image_ms : 0);
 
-                        // get component name
+                      if (namer)
+                      {
+                        for (size_t j=0; j<task.size(); j++)
+                        {
+                          task[j].name=namer->getName(task[j].name, buffer->getTimestampNS());
+                          task[j].naming=exclusive ? rcg::NAME_EXCLUSIVE : rcg::NAME_UNIQUE;
+                        }
+                      }
+                    }
 
-                        std::string component=rcg::getComponetOfPart(nodemap, buffer, part);
+                    if (bench)
+                    {
+                      bench_stat.add(BenchmarkStatistics::IMAGE, image_ms);
+                    }
 
-                        // try storing disparity as float image with meta information
+                    for (size_t j=0; j<task.size(); j++)
+                    {
+                      if (task[j].type != StoreTask::PARAMETER)
+                      {
+                        retry=0;
+                      }
+                    }
 
-                        if (component == "Disparity" && fmt == rcg::PNM)
-                        {
-                          name=storeBufferAsDisparity(nodemap, buffer, part);
+                    if (queue)
+                    {
+                      // storing is done by the storage threads, the buffer is
+                      // counted as dropped if the queue is full
 
-                          if (name.size() != 0)
-                          {
-                            std::cout << "Image '" << name << "' stored" << std::endl;
-                            storeParameter(nodemap, component, buffer);
-                          }
-                        }
+                      queue->push(task);
+                    }
+                    else
+                    {
+                      rcg::StoreTiming timing;
 
-                        // otherwise, store as ordinary image
+                      for (size_t j=0; j<task.size(); j++)
+                      {
+                        std::string name=executeStoreTask(task[j], fmt, png_param, recording.get(),
+                          bench ? &timing : 0);
 
-                        if (name.size() == 0)
+                        if (name.size() > 0 && !bench)
                         {
-                          if (component == "IntensityCombined")
-                          {
-                            // splitting left and right image of combined format of
-                            // Roboceptions rc_visard camera
-
-                            size_t h2=buffer->getHeight(part)/2;
-                            name=storeBuffer(fmt, nodemap, "Intensity", buffer, part, 0, h2);
-
-                            if (name.size() > 0)
-                            {
-                              std::cout << "Image '" << name << "' stored" << std::endl;
-                            }
-
-                            name=storeBuffer(fmt, nodemap, "IntensityRight", buffer, part, h2, h2);
-
-                            if (name.size() > 0)
-                            {
-                              std::cout << "Image '" << name << "' stored" << std::endl;
-                            }
-                          }
-                          else
-                          {
-                            name=storeBuffer(fmt, nodemap, component, buffer, part);
-
-                            if (name.size() > 0)
-                            {
-                              std::cout << "Image '" << name << "' stored" << std::endl;
-                            }
-                          }
-
-                          // store 3D parameters for intensity and disparity
-                          // components (nothing is done if chunk parameters are
-                          // not available)
-
-                          if (component == "Intensity")
-                          {
-                            storeParameter(nodemap, component, buffer);
-                          }
-                          else if (component == "Disparity")
-                          {
-                            storeParameter(nodemap, component, buffer, 0, true);
-                          }
-                          else if (component == "IntensityCombined")
-                          {
-                            size_t h2=buffer->getHeight(part)/2;
-                            storeParameter(nodemap, "Intensity", buffer, h2, false);
-                          }
+                          std::cout << "Image '" << name << "' stored" << std::endl;
                         }
+                      }
 
-                        // report success
-
-                        if (name.size() > 0)
-                        {
-                          retry=0;
-                        }
+                      if (bench)
+                      {
+                        bench_stat.add(BenchmarkStatistics::CONVERT, timing.convert_ms);
                       }
                     }
                   }
@@ -692,11 +1410,15 @@ int main(int argc, char *argv[])
                   {
                     // just print timestamp of received buffer
 
-                    uint64_t t_sec = buffer->getTimestampNS()/1000000000;
-                    uint64_t t_nsec = buffer->getTimestampNS()%1000000000;
+                    if (!bench)
+                    {
+                      uint64_t t_sec = buffer->getTimestampNS()/1000000000;
+                      uint64_t t_nsec = buffer->getTimestampNS()%1000000000;
+
+                      std::cout << "Received buffer with timestamp: " << t_sec << "."
+                                << std::setfill('0') << std::setw(9) << t_nsec << std::endl;
+                    }
 
-                    std::cout << "Received buffer with timestamp: " << t_sec << "."
-                              << std::setfill('0') << std::setw(9) << t_nsec << std::endl;
                     retry=0;
 
                     // accumulate mean latency
@@ -707,6 +1429,29 @@ int main(int argc, char *argv[])
                       static_cast<double>(buffer->getTimestampNS());
                   }
 
+                  // timing of storage and periodic summary in benchmark mode
+
+                  if (bench)
+                  {
+                    auto now=std::chrono::steady_clock::now();
+
+                    if (store && !queue)
+                    {
+                      bench_stat.add(BenchmarkStatistics::STORE, durationMS(time_store, now));
+                    }
+
+                    double duration=durationMS(time_interval, now)/1000;
+
+                    if (duration >= interval)
+                    {
+                      bench_stat.printInterval(durationMS(time_start, now)/1000, duration,
+                        stream[0]->getNumDelivered(), stream[0]->getNumUnderrun(),
+                        queue ? queue->getDropped() : 0, ptp);
+
+                      time_interval=now;
+                    }
+                  }
+
                   // optinally print chunk data
 
                   if (print_chunk_data)
@@ -739,9 +1484,34 @@ int main(int argc, char *argv[])
 
           auto time_stop=std::chrono::steady_clock::now();
 
+          uint64_t delivered=stream[0]->getNumDelivered();
+          uint64_t underrun=stream[0]->getNumUnderrun();
+
           stream[0]->stopStreaming();
           stream[0]->close();
 
+          // wait until all queued buffers are stored
+
+          uint64_t buffers_stored=0;
+          uint64_t buffers_dropped=0;
+          size_t max_queued=0;
+
+          if (queue)
+          {
+            queue->finish();
+
+            buffers_stored=queue->getProcessed();
+            buffers_dropped=queue->getDropped();
+            max_queued=queue->getMaxFill();
+          }
+
+          // write index of recording
+
+          if (recording)
+          {
+            recording->close();
+          }
+
           // report received and incomplete buffers
 
           std::cout << std::endl;
@@ -752,7 +1522,27 @@ int main(int argc, char *argv[])
                     << 1000.0*buffers_received/std::chrono::duration_cast<std::chrono::milliseconds>(time_stop-time_start).count()
                     << std::endl;
 
-          if (!store)
+          if (queue)
+          {
+            std::cout << "Stored buffers:     " << buffers_stored << std::endl;
+            std::cout << "Dropped buffers:    " << buffers_dropped << std::endl;
+            std::cout << "Max. queued:        " << max_queued << std::endl;
+          }
+
+          if (recording)
+          {
+            std::cout << "Recorded buffers:   " << recording->getFrameCount() << std::endl;
+            std::cout << "Recorded bytes:     " << recording->getSize() << std::endl;
+          }
+
+          if (bench)
+          {
+            std::cout << "Delivered buffers:  " << delivered << std::endl;
+            std::cout << "Underrun buffers:   " << underrun << std::endl;
+
+            bench_stat.printTotal(ptp);
+          }
+          else if (!store)
           {
             if (rcg::getBoolean(nodemap, "PtpEnable") || rcg::getBoolean(nodemap, "GevIEEE1588"))
             {
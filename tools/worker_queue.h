@@ -0,0 +1,222 @@
+/*
+ * This file is part of the rc_genicam_api package.
+ *
+ * Copyright (c) 2023 Roboception GmbH
+ * All rights reserved
+ *
+ * Author: Heiko Hirschmueller
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef RC_GENICAM_API_WORKER_QUEUE
+#define RC_GENICAM_API_WORKER_QUEUE
+
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <stdint.h>
+
+/**
+  Bounded queue of jobs that are processed by background threads. Jobs are
+  dropped if the queue is full, so that the producer of jobs, e.g. the
+  grabbing loop of a tool, is never blocked.
+*/
+
+template<class T> class WorkerQueue
+{
+  public:
+
+    /**
+      Function for processing one job. It is called concurrently by all
+      threads and returns false if processing failed.
+    */
+
+    typedef std::function<bool (T &job)> Process;
+
+    /**
+      Starts the worker threads.
+
+      @param capacity Maximum number of jobs in the queue.
+      @param nthreads Number of worker threads.
+      @param process  Function for processing one job.
+    */
+
+    WorkerQueue(size_t _capacity, int nthreads, const Process &_process) :
+      capacity(_capacity), process(_process), closed(false), dropped(0), max_fill(0),
+      processed(0)
+    {
+      for (int i=0; i<nthreads; i++)
+      {
+        thread.push_back(std::thread(&WorkerQueue::run, this));
+      }
+    }
+
+    ~WorkerQueue()
+    {
+      finish();
+    }
+
+    /**
+      Processes all remaining jobs of the queue and stops the threads. No jobs
+      can be added afterwards.
+    */
+
+    void finish()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed=true;
+        cv.notify_all();
+      }
+
+      for (size_t i=0; i<thread.size(); i++)
+      {
+        thread[i].join();
+      }
+
+      thread.clear();
+    }
+
+    /**
+      Adds a job to the queue if possible.
+
+      @param job Job, which is moved into the queue.
+      @return    False if the job is dropped because the queue is full.
+    */
+
+    bool push(T &job)
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+
+      if (closed || queue.size() >= capacity)
+      {
+        dropped++;
+        return false;
+      }
+
+      queue.push_back(std::move(job));
+      max_fill=std::max(max_fill, queue.size());
+
+      cv.notify_one();
+
+      return true;
+    }
+
+    uint64_t getDropped()
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      return dropped;
+    }
+
+    size_t getMaxFill()
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      return max_fill;
+    }
+
+    /**
+      Returns the number of jobs that have been processed successfully.
+    */
+
+    uint64_t getProcessed()
+    {
+      return processed;
+    }
+
+  private:
+
+    WorkerQueue(const WorkerQueue &); // forbidden
+    WorkerQueue &operator=(const WorkerQueue &); // forbidden
+
+    /**
+      Waits for the next job. False is returned if the queue is closed and
+      empty.
+    */
+
+    bool pop(T &job)
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+
+      while (!closed && queue.size() == 0)
+      {
+        cv.wait(lock);
+      }
+
+      if (queue.size() == 0)
+      {
+        return false;
+      }
+
+      job=std::move(queue.front());
+      queue.pop_front();
+
+      return true;
+    }
+
+    /**
+      Worker thread, which processes all jobs from the queue.
+    */
+
+    void run()
+    {
+      T job;
+
+      while (pop(job))
+      {
+        if (process(job))
+        {
+          processed++;
+        }
+
+        // release the job, e.g. images, before waiting for the next one
+
+        job=T();
+      }
+    }
+
+    size_t capacity;
+    Process process;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<T> queue;
+    bool closed;
+    uint64_t dropped;
+    size_t max_fill;
+
+    std::atomic<uint64_t> processed;
+    std::vector<std::thread> thread;
+};
+
+#endif